@@ -0,0 +1,116 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_BENCHMARK_CONTEXT_HPP
+#define MORTON_BENCHMARK_CONTEXT_HPP
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <string>
+
+#ifdef MORTON_USE_TUNED_TAGS
+#include "morton/tuned_tags.hpp"
+#endif
+
+#define MORTON_BENCHMARK_STRING(x) MORTON_BENCHMARK_STRING_IMPL(x)
+#define MORTON_BENCHMARK_STRING_IMPL(x) #x
+
+/// @brief Tags selected by the auto-tuner for a dimension (2D or 3D) and a
+/// width of codes (32 or 64) as a string literal.
+#define MORTON_BENCHMARK_TUNED_TAGS(D, W)                                  \
+  "encode=" MORTON_BENCHMARK_STRING(MORTON##D##_TUNED_ENCODE##W##_TAG)     \
+  " decode=" MORTON_BENCHMARK_STRING(MORTON##D##_TUNED_DECODE##W##_TAG)    \
+  " batch_encode=" MORTON_BENCHMARK_STRING(                                \
+      MORTON##D##_TUNED_BATCH_ENCODE##W##_TAG)                             \
+  " batch_decode=" MORTON_BENCHMARK_STRING(                                \
+      MORTON##D##_TUNED_BATCH_DECODE##W##_TAG)
+
+/// @brief Returns the model name of the CPU, or an empty string if unknown.
+inline std::string cpu_model() {
+#ifdef __linux__
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") != 0) continue;
+    const auto colon = line.find(':');
+    if (colon == std::string::npos) break;
+    const auto first = line.find_first_not_of(' ', colon + 1);
+    return first == std::string::npos ? std::string() : line.substr(first);
+  }
+#endif
+  return std::string();
+}
+
+/// @brief Returns instruction set extensions used by morton library, which
+/// are those enabled at compile time.
+inline std::string instruction_sets() {
+  std::string isa;
+#ifdef __BMI2__
+  isa += "bmi2 ";
+#endif
+#ifdef __AVX2__
+  isa += "avx2 ";
+#endif
+#ifdef __SSSE3__
+  isa += "ssse3 ";
+#endif
+  if (!isa.empty()) isa.pop_back();
+  return isa;
+}
+
+/// @brief Returns the compiler and its version.
+inline std::string compiler() {
+#if defined(__clang__)
+  return "clang " __clang_version__;
+#elif defined(__GNUC__)
+  return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+  return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+  return "unknown";
+#endif
+}
+
+/// @brief Returns the tags selected by the auto-tuner, or "off" if tuned
+/// tags are not used.
+inline std::string tuned_tags() {
+#ifdef MORTON_USE_TUNED_TAGS
+  return "2d32: " MORTON_BENCHMARK_TUNED_TAGS(2D, 32)
+         "; 2d64: " MORTON_BENCHMARK_TUNED_TAGS(2D, 64)
+         "; 3d32: " MORTON_BENCHMARK_TUNED_TAGS(3D, 32)
+         "; 3d64: " MORTON_BENCHMARK_TUNED_TAGS(3D, 64);
+#else
+  return "off";
+#endif
+}
+
+/// @brief Adds the host and build configuration to the context of results.
+///
+/// Google benchmark reports the number of CPUs, their frequency and caches.
+/// The context is written to JSON output (--benchmark_out_format=json), so
+/// that results are compared with a baseline of the same configuration by
+/// tools/compare_benchmarks.py.
+inline void add_morton_context() {
+  benchmark::AddCustomContext("morton_cpu_model", cpu_model());
+  benchmark::AddCustomContext("morton_isa", instruction_sets());
+  benchmark::AddCustomContext("morton_compiler", compiler());
+  benchmark::AddCustomContext("morton_tuned_tags", tuned_tags());
+}
+
+/// @brief Defines main() which runs benchmarks with the context of morton
+/// library, instead of BENCHMARK_MAIN().
+#define MORTON_BENCHMARK_MAIN()                                     \
+  int main(int argc, char** argv) {                                 \
+    ::benchmark::Initialize(&argc, argv);                           \
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {     \
+      return 1;                                                     \
+    }                                                               \
+    add_morton_context();                                           \
+    ::benchmark::RunSpecifiedBenchmarks();                          \
+    ::benchmark::Shutdown();                                        \
+    return 0;                                                       \
+  }                                                                 \
+  int main(int, char**)
+
+#endif  // MORTON_BENCHMARK_CONTEXT_HPP
@@ -0,0 +1,159 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "benchmark_context.hpp"
+#include "morton/layout.hpp"
+#include "perf_counters.hpp"
+
+/// @brief Element of N bytes
+template <std::size_t N>
+struct element {
+  unsigned char data[N];
+};
+
+/// @brief Sets the throughput of copying n elements of a type.
+template <typename T>
+void set_processed(benchmark::State& state, std::size_t n) {
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(n) *
+                          static_cast<int64_t>(sizeof(T)));
+}
+
+/// @brief Baseline: plain copy of the same number of bytes.
+template <typename T>
+void BM_Memcpy2d(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  std::vector<T> src(n * n), dst(n * n);
+
+  perf_counters counters;
+  counters.start();
+  for (auto _ : state) {
+    std::memcpy(dst.data(), src.data(), src.size() * sizeof(T));
+    benchmark::ClobberMemory();
+  }
+  counters.stop();
+  set_processed<T>(state, n * n);
+  counters.report(state, n * n);
+}
+
+/// @brief Swizzling by encoding the index of every element.
+template <typename T>
+void BM_Swizzle2dPerElement(benchmark::State& state) {
+  const auto n = static_cast<uint32_t>(state.range(0));
+  std::vector<T> src(n * n), dst(n * n);
+
+  perf_counters counters;
+  counters.start();
+  for (auto _ : state) {
+    for (uint32_t y = 0; y < n; ++y) {
+      for (uint32_t x = 0; x < n; ++x) {
+        const auto i = morton2d::encode(morton2d::coordinates32_t(x, y));
+        dst[i.value] = src[y * n + x];
+      }
+    }
+    benchmark::ClobberMemory();
+  }
+  counters.stop();
+  set_processed<T>(state, n * n);
+  counters.report(state, n * n);
+}
+
+template <typename T>
+void BM_Swizzle2d(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const morton2d::layout l(n, n);
+  std::vector<T> src(n * n), dst(l.size());
+
+  perf_counters counters;
+  counters.start();
+  for (auto _ : state) {
+    morton2d::swizzle(src.data(), dst.data(), l);
+    benchmark::ClobberMemory();
+  }
+  counters.stop();
+  set_processed<T>(state, n * n);
+  counters.report(state, n * n);
+}
+
+template <typename T>
+void BM_Unswizzle2d(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const morton2d::layout l(n, n);
+  std::vector<T> src(l.size()), dst(n * n);
+
+  perf_counters counters;
+  counters.start();
+  for (auto _ : state) {
+    morton2d::unswizzle(src.data(), dst.data(), l);
+    benchmark::ClobberMemory();
+  }
+  counters.stop();
+  set_processed<T>(state, n * n);
+  counters.report(state, n * n);
+}
+
+template <typename T>
+void BM_Swizzle3d(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const morton3d::layout l(n, n, n);
+  std::vector<T> src(n * n * n), dst(l.size());
+
+  perf_counters counters;
+  counters.start();
+  for (auto _ : state) {
+    morton3d::swizzle(src.data(), dst.data(), l);
+    benchmark::ClobberMemory();
+  }
+  counters.stop();
+  set_processed<T>(state, n * n * n);
+  counters.report(state, n * n * n);
+}
+
+template <typename T>
+void BM_Unswizzle3d(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const morton3d::layout l(n, n, n);
+  std::vector<T> src(l.size()), dst(n * n * n);
+
+  perf_counters counters;
+  counters.start();
+  for (auto _ : state) {
+    morton3d::unswizzle(src.data(), dst.data(), l);
+    benchmark::ClobberMemory();
+  }
+  counters.stop();
+  set_processed<T>(state, n * n * n);
+  counters.report(state, n * n * n);
+}
+
+// Square images of 256 KiB to 64 MiB for 4-byte elements
+BENCHMARK_TEMPLATE(BM_Memcpy2d, uint32_t)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+BENCHMARK_TEMPLATE(BM_Swizzle2dPerElement, uint32_t)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+BENCHMARK_TEMPLATE(BM_Swizzle2d, uint8_t)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+BENCHMARK_TEMPLATE(BM_Swizzle2d, uint32_t)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+BENCHMARK_TEMPLATE(BM_Swizzle2d, element<12>)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+BENCHMARK_TEMPLATE(BM_Swizzle2d, element<16>)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+BENCHMARK_TEMPLATE(BM_Unswizzle2d, uint32_t)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096);
+
+// Cubic volumes, including a non-power-of-two extent
+BENCHMARK_TEMPLATE(BM_Swizzle3d, uint32_t)->Arg(64)->Arg(100)->Arg(256);
+BENCHMARK_TEMPLATE(BM_Unswizzle3d, uint32_t)->Arg(64)->Arg(100)->Arg(256);
+
+MORTON_BENCHMARK_MAIN();
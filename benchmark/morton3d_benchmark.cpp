@@ -1,55 +1,343 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <random>
 #include <vector>
 
+#include "benchmark_context.hpp"
 #include "morton/morton3d.hpp"
+#include "perf_counters.hpp"
 
 using namespace morton3d;
 
+/// Fixed seed so that every run benchmarks exactly the same inputs.
+constexpr std::mt19937::result_type seed = 20200401;
+
+/// Input distributions. The value is passed as the second benchmark argument.
+enum class distribution : int {
+  /// Uniformly random coordinates over the whole domain
+  uniform = 0,
+  /// Slice-by-slice, row-by-row raster scan of a volume
+  scanline = 1,
+  /// Gaussian clusters around a few random centers, as in point clouds
+  clustered = 2,
+  /// Uniformly random coordinates, visited in increasing morton order
+  sorted = 3,
+};
+
+/// @brief Returns a label for a distribution.
+inline const char* to_string(distribution d) {
+  switch (d) {
+    case distribution::uniform:
+      return "uniform";
+    case distribution::scanline:
+      return "scanline";
+    case distribution::clustered:
+      return "clustered";
+    case distribution::sorted:
+      return "sorted";
+  }
+  return "";
+}
+
+/// @brief Generates coordinates following a given distribution.
+/// @tparam T Integral type for coordinates
+/// @tparam MaxBits Maximum number of bits of each coordinate
+/// @param[in] n Number of coordinates
+/// @param[in] d Distribution
+template <typename T, int MaxBits>
+std::vector<coordinates<T>> make_coordinates(std::size_t n, distribution d) {
+  constexpr T max = (T(1) << MaxBits) - 1;
+  std::mt19937 engine(seed);
+  std::uniform_int_distribution<T> uniform(0, max);
+  std::vector<coordinates<T>> coords(n);
+  switch (d) {
+    case distribution::uniform:
+    case distribution::sorted:
+      for (auto&& c : coords) {
+        c.x = uniform(engine);
+        c.y = uniform(engine);
+        c.z = uniform(engine);
+      }
+      break;
+    case distribution::scanline: {
+      // 64 x 64 voxels slices starting at a random origin
+      const std::size_t width = 64;
+      const T x0 = uniform(engine) / 2;
+      const T y0 = uniform(engine) / 2;
+      const T z0 = uniform(engine) / 2;
+      for (std::size_t i = 0; i < n; ++i) {
+        coords[i].x = static_cast<T>(x0 + i % width);
+        coords[i].y = static_cast<T>(y0 + i / width % width);
+        coords[i].z = static_cast<T>(z0 + i / (width * width));
+      }
+      break;
+    }
+    case distribution::clustered: {
+      constexpr int num_clusters = 8;
+      std::vector<coordinates<T>> centers(num_clusters);
+      for (auto&& c : centers) {
+        c.x = uniform(engine);
+        c.y = uniform(engine);
+        c.z = uniform(engine);
+      }
+      std::uniform_int_distribution<int> pick(0, num_clusters - 1);
+      std::normal_distribution<double> offset(0.0, 16.0);
+      const auto clamp = [](double v) {
+        return static_cast<T>(
+            std::min(std::max(v, 0.0), static_cast<double>(max)));
+      };
+      for (auto&& c : coords) {
+        const auto& center = centers[pick(engine)];
+        c.x = clamp(center.x + offset(engine));
+        c.y = clamp(center.y + offset(engine));
+        c.z = clamp(center.z + offset(engine));
+      }
+      break;
+    }
+  }
+  return coords;
+}
+
+/// @brief Generates morton codes of coordinates following a given
+/// distribution.
+/// @tparam T Integral type for morton_code
+/// @tparam U Integral type for coordinates
+/// @tparam MaxBits Maximum number of bits of each coordinate
+template <typename T, typename U, int MaxBits>
+std::vector<morton_code<T>> make_codes(std::size_t n, distribution d) {
+  const auto coords = make_coordinates<U, MaxBits>(n, d);
+  std::vector<morton_code<T>> codes;
+  codes.reserve(n);
+  for (auto&& c : coords) {
+    codes.push_back(encode(c, tag::magic_bits{}));
+  }
+  if (d == distribution::sorted) {
+    std::sort(codes.begin(), codes.end(),
+              [](morton_code<T> a, morton_code<T> b) {
+                return a.value < b.value;
+              });
+  }
+  return codes;
+}
+
+/// @brief Registers input sizes for distributions up to a given one.
+void add_inputs(benchmark::internal::Benchmark* b, distribution last) {
+  for (int d = 0; d <= static_cast<int>(last); ++d) {
+    for (int n = 8; n <= (8 << 10); n *= 8) {
+      b->Args({n, d});
+    }
+  }
+}
+
+/// @brief Registers inputs of encoding benchmarks.
+void encoding_inputs(benchmark::internal::Benchmark* b) {
+  // Sorting by the output does not make sense for encoding.
+  add_inputs(b, distribution::clustered);
+}
+
+/// @brief Registers inputs of decoding benchmarks.
+void decoding_inputs(benchmark::internal::Benchmark* b) {
+  add_inputs(b, distribution::sorted);
+}
+
 template <typename T, int MaxBits, typename Tag>
 void BM_Morton3dEncoding(benchmark::State& state) {
-  std::random_device seed_gen;
-  std::mt19937 engine(seed_gen());
-  std::uniform_int_distribution<T> dist(0, (T(1) << MaxBits) - 1);
-  std::vector<coordinates<T>> coords(state.range(0));
-  for (auto&& c : coords) {
-    c.x = dist(engine);
-    c.y = dist(engine);
-    c.z = dist(engine);
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto d = static_cast<distribution>(state.range(1));
+  const auto coords = make_coordinates<T, MaxBits>(n, d);
+
+  perf_counters counters;
+  counters.start();
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto m = encode(coords[i], Tag{});
+      benchmark::DoNotOptimize(m);
+    }
   }
+  counters.stop();
+  state.SetLabel(to_string(d));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          sizeof(coordinates<T>));
+  counters.report(state, state.range(0));
+}
 
+template <typename T, typename U, int MaxBits, typename Tag>
+void BM_Morton3dDecoding(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto d = static_cast<distribution>(state.range(1));
+  const auto codes = make_codes<T, U, MaxBits>(n, d);
+
+  perf_counters counters;
+  counters.start();
   for (auto _ : state) {
-    for (int i = 0; i < state.range(0); ++i) {
-      const auto c = encode(coords[i], Tag{});
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto c = decode(codes[i], Tag{});
       benchmark::DoNotOptimize(c);
     }
   }
+  counters.stop();
+  state.SetLabel(to_string(d));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          sizeof(morton_code<T>));
+  counters.report(state, state.range(0));
+}
+
+/// @brief Benchmarks encoding of an array at once.
+template <typename T, int MaxBits, typename Tag>
+void BM_Morton3dBatchEncoding(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto d = static_cast<distribution>(state.range(1));
+  const auto coords = make_coordinates<T, MaxBits>(n, d);
+  std::vector<decltype(encode(coords[0]))> codes(n);
+
+  perf_counters counters;
+  counters.start();
+  for (auto _ : state) {
+    encode(coords.data(), n, codes.data(), Tag{});
+    benchmark::DoNotOptimize(codes.data());
+    benchmark::ClobberMemory();
+  }
+  counters.stop();
+  state.SetLabel(to_string(d));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          sizeof(coordinates<T>));
+  counters.report(state, state.range(0));
+}
+
+/// @brief Benchmarks decoding of an array at once.
+template <typename T, typename U, int MaxBits, typename Tag>
+void BM_Morton3dBatchDecoding(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto d = static_cast<distribution>(state.range(1));
+  const auto codes = make_codes<T, U, MaxBits>(n, d);
+  std::vector<coordinates<U>> coords(n);
+
+  perf_counters counters;
+  counters.start();
+  for (auto _ : state) {
+    decode(codes.data(), n, coords.data(), Tag{});
+    benchmark::DoNotOptimize(coords.data());
+    benchmark::ClobberMemory();
+  }
+  counters.stop();
+  state.SetLabel(to_string(d));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          sizeof(morton_code<T>));
+  counters.report(state, state.range(0));
 }
 
 BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint16_t, 10,
                    tag::preshifted_lookup_table)
-    ->Range(8, 8 << 10);
+    ->Apply(encoding_inputs);
 BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint16_t, 10, tag::lookup_table)
-    ->Range(8, 8 << 10);
+    ->Apply(encoding_inputs);
 BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint16_t, 10, tag::magic_bits)
-    ->Range(8, 8 << 10);
+    ->Apply(encoding_inputs);
 #ifdef MORTON3D_USE_BMI
 BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint16_t, 10, tag::bmi)
-    ->Range(8, 8 << 10);
+    ->Apply(encoding_inputs);
+#endif
+#ifdef MORTON3D_USE_SSSE3
+BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint16_t, 10, tag::nibble_shuffle)
+    ->Apply(encoding_inputs);
 #endif
 
 BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint32_t, 21,
                    tag::preshifted_lookup_table)
-    ->Range(8, 8 << 10);
+    ->Apply(encoding_inputs);
 BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint32_t, 21, tag::lookup_table)
-    ->Range(8, 8 << 10);
+    ->Apply(encoding_inputs);
 BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint32_t, 21, tag::magic_bits)
-    ->Range(8, 8 << 10);
+    ->Apply(encoding_inputs);
 #ifdef MORTON3D_USE_BMI
 BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint32_t, 21, tag::bmi)
-    ->Range(8, 8 << 10);
+    ->Apply(encoding_inputs);
+#endif
+#ifdef MORTON3D_USE_SSSE3
+BENCHMARK_TEMPLATE(BM_Morton3dEncoding, uint32_t, 21, tag::nibble_shuffle)
+    ->Apply(encoding_inputs);
+#endif
+
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint32_t, uint16_t, 10,
+                   tag::preshifted_lookup_table)
+    ->Apply(decoding_inputs);
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint32_t, uint16_t, 10,
+                   tag::lookup_table)
+    ->Apply(decoding_inputs);
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint32_t, uint16_t, 10,
+                   tag::magic_bits)
+    ->Apply(decoding_inputs);
+#ifdef MORTON3D_USE_BMI
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint32_t, uint16_t, 10, tag::bmi)
+    ->Apply(decoding_inputs);
+#endif
+#ifdef MORTON3D_USE_SSSE3
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint32_t, uint16_t, 10,
+                   tag::nibble_shuffle)
+    ->Apply(decoding_inputs);
+#endif
+
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint64_t, uint32_t, 21,
+                   tag::preshifted_lookup_table)
+    ->Apply(decoding_inputs);
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint64_t, uint32_t, 21,
+                   tag::lookup_table)
+    ->Apply(decoding_inputs);
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint64_t, uint32_t, 21,
+                   tag::magic_bits)
+    ->Apply(decoding_inputs);
+#ifdef MORTON3D_USE_BMI
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint64_t, uint32_t, 21, tag::bmi)
+    ->Apply(decoding_inputs);
+#endif
+#ifdef MORTON3D_USE_SSSE3
+BENCHMARK_TEMPLATE(BM_Morton3dDecoding, uint64_t, uint32_t, 21,
+                   tag::nibble_shuffle)
+    ->Apply(decoding_inputs);
+#endif
+
+BENCHMARK_TEMPLATE(BM_Morton3dBatchEncoding, uint16_t, 10,
+                   tag::preshifted_lookup_table)
+    ->Apply(encoding_inputs);
+BENCHMARK_TEMPLATE(BM_Morton3dBatchEncoding, uint16_t, 10, tag::magic_bits)
+    ->Apply(encoding_inputs);
+#ifdef MORTON3D_USE_BMI
+BENCHMARK_TEMPLATE(BM_Morton3dBatchEncoding, uint16_t, 10, tag::bmi)
+    ->Apply(encoding_inputs);
+#endif
+#ifdef MORTON3D_USE_SSSE3
+BENCHMARK_TEMPLATE(BM_Morton3dBatchEncoding, uint16_t, 10,
+                   tag::nibble_shuffle)
+    ->Apply(encoding_inputs);
+BENCHMARK_TEMPLATE(BM_Morton3dBatchEncoding, uint32_t, 21,
+                   tag::nibble_shuffle)
+    ->Apply(encoding_inputs);
+#endif
+
+BENCHMARK_TEMPLATE(BM_Morton3dBatchDecoding, uint32_t, uint16_t, 10,
+                   tag::preshifted_lookup_table)
+    ->Apply(decoding_inputs);
+BENCHMARK_TEMPLATE(BM_Morton3dBatchDecoding, uint32_t, uint16_t, 10,
+                   tag::magic_bits)
+    ->Apply(decoding_inputs);
+#ifdef MORTON3D_USE_BMI
+BENCHMARK_TEMPLATE(BM_Morton3dBatchDecoding, uint32_t, uint16_t, 10, tag::bmi)
+    ->Apply(decoding_inputs);
+#endif
+#ifdef MORTON3D_USE_SSSE3
+BENCHMARK_TEMPLATE(BM_Morton3dBatchDecoding, uint32_t, uint16_t, 10,
+                   tag::nibble_shuffle)
+    ->Apply(decoding_inputs);
+BENCHMARK_TEMPLATE(BM_Morton3dBatchDecoding, uint64_t, uint32_t, 21,
+                   tag::nibble_shuffle)
+    ->Apply(decoding_inputs);
 #endif
 
-BENCHMARK_MAIN();
\ No newline at end of file
+MORTON_BENCHMARK_MAIN();
@@ -0,0 +1,187 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_BENCHMARK_PERF_COUNTERS_HPP
+#define MORTON_BENCHMARK_PERF_COUNTERS_HPP
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#if defined(MORTON_BENCHMARK_USE_PERF_COUNTERS) && defined(__linux__)
+#define MORTON_BENCHMARK_HAS_PERF_EVENT
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#endif
+
+/// @brief Hardware performance counters measured around a benchmark loop.
+///
+/// Cycles, instructions, L1 data cache read misses and branch misses are
+/// counted by perf_event_open(2) and reported per item as user counters of
+/// Google benchmark. Counting is enabled by MORTON_BENCHMARK_USE_PERF_COUNTERS
+/// macro on Linux. Otherwise, or if the kernel refuses to open the counters
+/// (see /proc/sys/kernel/perf_event_paranoid), nothing is reported.
+///
+/// @code
+/// perf_counters counters;
+/// counters.start();
+/// for (auto _ : state) {
+///   ...
+/// }
+/// counters.stop();
+/// counters.report(state, n);
+/// @endcode
+class perf_counters {
+ public:
+  /// Number of events
+  static constexpr int num_events = 4;
+
+  perf_counters() noexcept;
+  ~perf_counters();
+
+  perf_counters(const perf_counters&) = delete;
+  perf_counters& operator=(const perf_counters&) = delete;
+
+  /// @brief Resets and starts counting.
+  void start() noexcept;
+
+  /// @brief Stops counting.
+  void stop() noexcept;
+
+  /// @brief Adds counted events divided by the number of processed items to
+  /// user counters.
+  /// @param[in] state Benchmark state
+  /// @param[in] items Number of items processed in an iteration
+  void report(benchmark::State& state, int64_t items) const;
+
+ private:
+#ifdef MORTON_BENCHMARK_HAS_PERF_EVENT
+  /// @brief Opens an event as a member of the group led by leader_.
+  /// @returns File descriptor, or -1 if the event is not available.
+  int open(uint32_t type, uint64_t config) noexcept;
+#endif
+
+  int leader_;                   /// File descriptor of the group leader
+  int fds_[num_events];          /// File descriptors of events
+  uint64_t values_[num_events];  /// Counted values
+};
+
+/// Names of events reported as user counters
+static const char* const perf_counter_names[perf_counters::num_events] = {
+    "cycles", "instructions", "L1D-misses", "branch-misses"};
+
+#ifdef MORTON_BENCHMARK_HAS_PERF_EVENT
+
+inline int perf_counters::open(uint32_t type, uint64_t config) noexcept {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = leader_ == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                     PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0));
+}
+
+inline perf_counters::perf_counters() noexcept : leader_{-1} {
+  const uint32_t types[num_events] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                      PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+  const uint64_t configs[num_events] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_BRANCH_MISSES};
+  for (int i = 0; i < num_events; ++i) {
+    values_[i] = 0;
+    fds_[i] = open(types[i], configs[i]);
+    if (leader_ == -1) leader_ = fds_[i];
+  }
+  static bool warned = false;
+  if (leader_ == -1 && !warned) {
+    std::fprintf(stderr,
+                 "warning: hardware performance counters are not available: "
+                 "%s\n",
+                 std::strerror(errno));
+    warned = true;
+  }
+}
+
+inline perf_counters::~perf_counters() {
+  for (int i = 0; i < num_events; ++i) {
+    if (fds_[i] != -1) close(fds_[i]);
+  }
+}
+
+inline void perf_counters::start() noexcept {
+  if (leader_ == -1) return;
+  ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+inline void perf_counters::stop() noexcept {
+  if (leader_ == -1) return;
+  ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  // Layout of PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_*:
+  // nr, time_enabled, time_running, {value, id} * nr
+  uint64_t buffer[3 + 2 * num_events];
+  if (read(leader_, buffer, sizeof(buffer)) <= 0) return;
+  const auto nr = buffer[0];
+  const auto enabled = buffer[1];
+  const auto running = buffer[2];
+  // Scale values if events were multiplexed with other groups.
+  const double scale =
+      running > 0 ? static_cast<double>(enabled) / running : 0.0;
+  for (int i = 0; i < num_events; ++i) {
+    if (fds_[i] == -1) continue;
+    uint64_t id = 0;
+    if (ioctl(fds_[i], PERF_EVENT_IOC_ID, &id) == -1) continue;
+    for (uint64_t j = 0; j < nr; ++j) {
+      if (buffer[4 + 2 * j] == id) {
+        values_[i] = static_cast<uint64_t>(buffer[3 + 2 * j] * scale);
+      }
+    }
+  }
+}
+
+inline void perf_counters::report(benchmark::State& state,
+                                  int64_t items) const {
+  if (leader_ == -1) return;
+  const double total = static_cast<double>(state.iterations() * items);
+  for (int i = 0; i < num_events; ++i) {
+    if (fds_[i] == -1) continue;
+    state.counters[perf_counter_names[i]] = values_[i] / total;
+  }
+}
+
+#else  // MORTON_BENCHMARK_HAS_PERF_EVENT
+
+inline perf_counters::perf_counters() noexcept : leader_{-1} {
+  for (int i = 0; i < num_events; ++i) {
+    fds_[i] = -1;
+    values_[i] = 0;
+  }
+}
+
+inline perf_counters::~perf_counters() {}
+
+inline void perf_counters::start() noexcept {}
+
+inline void perf_counters::stop() noexcept {}
+
+inline void perf_counters::report(benchmark::State&, int64_t) const {}
+
+#endif  // MORTON_BENCHMARK_HAS_PERF_EVENT
+
+#endif  // MORTON_BENCHMARK_PERF_COUNTERS_HPP
@@ -0,0 +1,477 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_ANISOTROPIC_HPP
+#define MORTON_ANISOTROPIC_HPP
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Returns the number of bits of an axis.
+constexpr unsigned int bits_of(unsigned int axis, unsigned int bx,
+                               unsigned int by, unsigned int bz) {
+  return axis == 0 ? bx : (axis == 1 ? by : bz);
+}
+
+/// @brief Returns the number of axes which have a bit at a level.
+constexpr unsigned int axes_at(unsigned int level, unsigned int bx,
+                               unsigned int by, unsigned int bz) {
+  return (level < bx ? 1U : 0U) + (level < by ? 1U : 0U) +
+         (level < bz ? 1U : 0U);
+}
+
+/// @brief Returns the number of axes before a given axis which have a bit at
+/// a level.
+constexpr unsigned int axes_before(unsigned int axis, unsigned int level,
+                                   unsigned int bx, unsigned int by) {
+  return (axis > 0 && level < bx ? 1U : 0U) + (axis > 1 && level < by ? 1U : 0U);
+}
+
+/// @brief Returns bits of an axis in morton codes.
+///
+/// Bits of x, y and z are interleaved from the least significant bit in this
+/// order while the axes have bits, so that codes are still in Z-order.
+/// @tparam T Integral type for morton codes
+/// @param[in] axis Axis
+/// @param[in] bx Number of bits of x coordinate
+/// @param[in] by Number of bits of y coordinate
+/// @param[in] bz Number of bits of z coordinate
+/// @param[in] level Current level
+/// @param[in] pos Position of the first bit of the current level
+template <typename T>
+constexpr T axis_mask(unsigned int axis, unsigned int bx, unsigned int by,
+                      unsigned int bz, unsigned int level = 0,
+                      unsigned int pos = 0) {
+  return axes_at(level, bx, by, bz) == 0
+             ? T(0)
+             : static_cast<T>(
+                   (level < bits_of(axis, bx, by, bz)
+                        ? T(1) << (pos + axes_before(axis, level, bx, by))
+                        : T(0)) |
+                   axis_mask<T>(axis, bx, by, bz, level + 1,
+                                pos + axes_at(level, bx, by, bz)));
+}
+
+/// @brief Returns the parallel suffix (prefix XOR from the right) of bits.
+template <typename T>
+constexpr T parallel_suffix(T x, unsigned int shift = 1) {
+  return shift >= static_cast<unsigned int>(std::numeric_limits<T>::digits)
+             ? x
+             : parallel_suffix<T>(static_cast<T>(x ^ (x << shift)), shift * 2);
+}
+
+/// @brief Returns the bits moved at a step of compress and expand in
+/// Hacker's Delight (7-4 and 7-5).
+/// @param[in] m Mask compressed by the previous steps
+/// @param[in] mk Bits counting zeros of the mask to the right
+/// @param[in] i Current step
+/// @param[in] step Target step
+template <typename T>
+constexpr T move_mask(T m, T mk, unsigned int i, unsigned int step) {
+  return i == step
+             ? static_cast<T>(parallel_suffix(mk) & m)
+             : move_mask<T>(
+                   static_cast<T>((m ^ (parallel_suffix(mk) & m)) |
+                                  ((parallel_suffix(mk) & m) >> (1U << i))),
+                   static_cast<T>(mk & ~parallel_suffix(mk)), i + 1, step);
+}
+
+/// @brief Returns the bits moved at a step for a mask.
+template <typename T>
+constexpr T move_mask(T mask, unsigned int step) {
+  return move_mask<T>(mask, static_cast<T>(~mask << 1), 0, step);
+}
+
+/// @brief Number of steps of compress and expand
+template <typename T>
+constexpr int num_steps() {
+  return std::numeric_limits<T>::digits == 64 ? 6 : 5;
+}
+
+/// @brief Deposits low bits of an integer to positions of a constant mask
+/// by shifts and masks, i.e. PDEP without BMI2.
+/// @tparam T Integral type
+/// @tparam Mask Mask
+/// @tparam Step Current step, counted down to -1
+template <typename T, T Mask, int Step = num_steps<T>() - 1>
+struct bit_expander {
+  static T apply(T x) noexcept {
+    constexpr T mv = move_mask<T>(Mask, Step);
+    x = static_cast<T>((x & ~mv) | ((x << (1 << Step)) & mv));
+    return bit_expander<T, Mask, Step - 1>::apply(x);
+  }
+};
+
+template <typename T, T Mask>
+struct bit_expander<T, Mask, -1> {
+  static T apply(T x) noexcept { return x & Mask; }
+};
+
+/// @brief Gathers bits of an integer at positions of a constant mask to low
+/// bits by shifts and masks, i.e. PEXT without BMI2.
+/// @tparam T Integral type
+/// @tparam Mask Mask
+/// @tparam Remaining Number of remaining steps
+template <typename T, T Mask, int Remaining = num_steps<T>()>
+struct bit_compressor {
+  static T apply(T x) noexcept {
+    constexpr int step = num_steps<T>() - Remaining;
+    constexpr T mv = move_mask<T>(Mask, step);
+    const T t = x & mv;
+    x = static_cast<T>((x ^ t) | (t >> (1 << step)));
+    return bit_compressor<T, Mask, Remaining - 1>::apply(x);
+  }
+};
+
+template <typename T, T Mask>
+struct bit_compressor<T, Mask, 0> {
+  static T apply(T x) noexcept { return x; }
+};
+
+/// @brief Returns the smallest unsigned type holding a number of bits.
+template <unsigned int Bits>
+using coordinate_type_for =
+    typename std::conditional<(Bits <= 16), uint16_t, uint32_t>::type;
+
+#if defined(MORTON2D_USE_BMI) || defined(MORTON3D_USE_BMI)
+
+inline uint32_t pdep(uint32_t x, uint32_t mask) noexcept {
+  return _pdep_u32(x, mask);
+}
+
+inline uint64_t pdep(uint64_t x, uint64_t mask) noexcept {
+  return _pdep_u64(x, mask);
+}
+
+inline uint32_t pext(uint32_t x, uint32_t mask) noexcept {
+  return _pext_u32(x, mask);
+}
+
+inline uint64_t pext(uint64_t x, uint64_t mask) noexcept {
+  return _pext_u64(x, mask);
+}
+
+#endif
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Morton codes with a number of bits chosen for each axis at compile
+/// time.
+///
+/// Bits of x and y are interleaved while both axes have them, and the rest
+/// of the longer axis follows, so that codes are still in Z-order. For
+/// example, anisotropic<uint32_t, 20, 12> packs 20 bits of x and 12 bits of
+/// y into 32 bits. Masks of the axes and the shift-and-mask sequences used
+/// without BMI2 are computed at compile time.
+/// @tparam T Integral type for morton codes (uint32_t or uint64_t)
+/// @tparam BitsX Number of bits of x coordinate
+/// @tparam BitsY Number of bits of y coordinate
+template <typename T, unsigned int BitsX, unsigned int BitsY>
+class anisotropic {
+  static_assert(std::is_same<T, uint32_t>::value ||
+                    std::is_same<T, uint64_t>::value,
+                "T must be uint32_t or uint64_t");
+  static_assert(BitsX + BitsY <= std::numeric_limits<T>::digits,
+                "Bits of coordinates exceed bits of morton codes");
+  static_assert(BitsX <= 32 && BitsY <= 32,
+                "Bits of a coordinate exceed 32 bits");
+
+ public:
+  using code_type = morton_code<T>;
+  using coordinate_type =
+      morton::detail::coordinate_type_for<(BitsX > BitsY ? BitsX : BitsY)>;
+  using coordinates_type = coordinates<coordinate_type>;
+
+  static constexpr unsigned int bits_x = BitsX;
+  static constexpr unsigned int bits_y = BitsY;
+  static constexpr T mask_x = morton::detail::axis_mask<T>(0, BitsX, BitsY, 0);
+  static constexpr T mask_y = morton::detail::axis_mask<T>(1, BitsX, BitsY, 0);
+
+  /// @brief Encodes coordinates.
+  static code_type encode(const coordinates_type& c) noexcept {
+    return encode(c, default_tag{});
+  }
+
+  /// @brief Decodes a morton code.
+  static coordinates_type decode(const code_type m) noexcept {
+    return decode(m, default_tag{});
+  }
+
+  /// @brief Encodes coordinates by shifts and masks.
+  static code_type encode(const coordinates_type& c,
+                          tag::magic_bits) noexcept {
+    using morton::detail::bit_expander;
+    return code_type{static_cast<T>(
+        bit_expander<T, mask_x>::apply(static_cast<T>(c.x)) |
+        bit_expander<T, mask_y>::apply(static_cast<T>(c.y)))};
+  }
+
+  /// @brief Decodes a morton code by shifts and masks.
+  static coordinates_type decode(const code_type m, tag::magic_bits) noexcept {
+    using morton::detail::bit_compressor;
+    return coordinates_type(
+        static_cast<coordinate_type>(
+            bit_compressor<T, mask_x>::apply(m.value & mask_x)),
+        static_cast<coordinate_type>(
+            bit_compressor<T, mask_y>::apply(m.value & mask_y)));
+  }
+
+#ifdef MORTON2D_USE_BMI
+  /// @brief Encodes coordinates by PDEP.
+  static code_type encode(const coordinates_type& c, tag::bmi) noexcept {
+    using morton::detail::pdep;
+    return code_type{static_cast<T>(pdep(static_cast<T>(c.x), mask_x) |
+                                    pdep(static_cast<T>(c.y), mask_y))};
+  }
+
+  /// @brief Decodes a morton code by PEXT.
+  static coordinates_type decode(const code_type m, tag::bmi) noexcept {
+    using morton::detail::pext;
+    return coordinates_type(
+        static_cast<coordinate_type>(pext(m.value, mask_x)),
+        static_cast<coordinate_type>(pext(m.value, mask_y)));
+  }
+#else
+  static code_type encode(const coordinates_type& c, tag::bmi) noexcept {
+    return encode(c, tag::magic_bits{});
+  }
+
+  static coordinates_type decode(const code_type m, tag::bmi) noexcept {
+    return decode(m, tag::magic_bits{});
+  }
+#endif  // MORTON2D_USE_BMI
+
+  // Look-up tables are specific to the same number of bits for each axis.
+  static code_type encode(const coordinates_type& c,
+                          tag::preshifted_lookup_table) noexcept {
+    return encode(c, tag::magic_bits{});
+  }
+
+  static coordinates_type decode(const code_type m,
+                                 tag::preshifted_lookup_table) noexcept {
+    return decode(m, tag::magic_bits{});
+  }
+
+  static code_type encode(const coordinates_type& c,
+                          tag::lookup_table) noexcept {
+    return encode(c, tag::magic_bits{});
+  }
+
+  static coordinates_type decode(const code_type m,
+                                 tag::lookup_table) noexcept {
+    return decode(m, tag::magic_bits{});
+  }
+
+  static code_type encode(const coordinates_type& c,
+                          tag::nibble_shuffle) noexcept {
+    return encode(c, tag::magic_bits{});
+  }
+
+  static coordinates_type decode(const code_type m,
+                                 tag::nibble_shuffle) noexcept {
+    return decode(m, tag::magic_bits{});
+  }
+
+  // Tags selected by the auto-tuner for uniform codes, which fall back to
+  // magic bits above unless they are BMI.
+  static code_type encode(const coordinates_type& c, tag::tuned) noexcept {
+    return encode(c, typename detail::tuned_tags<T>::encode{});
+  }
+
+  static coordinates_type decode(const code_type m, tag::tuned) noexcept {
+    return decode(m, typename detail::tuned_tags<T>::decode{});
+  }
+};
+
+template <typename T, unsigned int BitsX, unsigned int BitsY>
+constexpr unsigned int anisotropic<T, BitsX, BitsY>::bits_x;
+template <typename T, unsigned int BitsX, unsigned int BitsY>
+constexpr unsigned int anisotropic<T, BitsX, BitsY>::bits_y;
+template <typename T, unsigned int BitsX, unsigned int BitsY>
+constexpr T anisotropic<T, BitsX, BitsY>::mask_x;
+template <typename T, unsigned int BitsX, unsigned int BitsY>
+constexpr T anisotropic<T, BitsX, BitsY>::mask_y;
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Morton codes with a number of bits chosen for each axis at compile
+/// time.
+///
+/// Bits of x, y and z are interleaved while the axes have them, so that
+/// codes are still in Z-order. For example, anisotropic<uint32_t, 12, 12, 8>
+/// packs 4096 x 4096 x 256 cells into 32-bit codes, where the uniform
+/// morton3d codes would need 64 bits. Masks of the axes and the
+/// shift-and-mask sequences used without BMI2 are computed at compile time.
+/// @tparam T Integral type for morton codes (uint32_t or uint64_t)
+/// @tparam BitsX Number of bits of x coordinate
+/// @tparam BitsY Number of bits of y coordinate
+/// @tparam BitsZ Number of bits of z coordinate
+template <typename T, unsigned int BitsX, unsigned int BitsY,
+          unsigned int BitsZ>
+class anisotropic {
+  static_assert(std::is_same<T, uint32_t>::value ||
+                    std::is_same<T, uint64_t>::value,
+                "T must be uint32_t or uint64_t");
+  static_assert(BitsX + BitsY + BitsZ <= std::numeric_limits<T>::digits,
+                "Bits of coordinates exceed bits of morton codes");
+  static_assert(BitsX <= 32 && BitsY <= 32 && BitsZ <= 32,
+                "Bits of a coordinate exceed 32 bits");
+
+  static constexpr unsigned int max_bits =
+      BitsX > BitsY ? (BitsX > BitsZ ? BitsX : BitsZ)
+                    : (BitsY > BitsZ ? BitsY : BitsZ);
+
+ public:
+  using code_type = morton_code<T>;
+  using coordinate_type = morton::detail::coordinate_type_for<max_bits>;
+  using coordinates_type = coordinates<coordinate_type>;
+
+  static constexpr unsigned int bits_x = BitsX;
+  static constexpr unsigned int bits_y = BitsY;
+  static constexpr unsigned int bits_z = BitsZ;
+  static constexpr T mask_x =
+      morton::detail::axis_mask<T>(0, BitsX, BitsY, BitsZ);
+  static constexpr T mask_y =
+      morton::detail::axis_mask<T>(1, BitsX, BitsY, BitsZ);
+  static constexpr T mask_z =
+      morton::detail::axis_mask<T>(2, BitsX, BitsY, BitsZ);
+
+  /// @brief Encodes coordinates.
+  static code_type encode(const coordinates_type& c) noexcept {
+    return encode(c, default_tag{});
+  }
+
+  /// @brief Decodes a morton code.
+  static coordinates_type decode(const code_type m) noexcept {
+    return decode(m, default_tag{});
+  }
+
+  /// @brief Encodes coordinates by shifts and masks.
+  static code_type encode(const coordinates_type& c,
+                          tag::magic_bits) noexcept {
+    using morton::detail::bit_expander;
+    return code_type{static_cast<T>(
+        bit_expander<T, mask_x>::apply(static_cast<T>(c.x)) |
+        bit_expander<T, mask_y>::apply(static_cast<T>(c.y)) |
+        bit_expander<T, mask_z>::apply(static_cast<T>(c.z)))};
+  }
+
+  /// @brief Decodes a morton code by shifts and masks.
+  static coordinates_type decode(const code_type m, tag::magic_bits) noexcept {
+    using morton::detail::bit_compressor;
+    return coordinates_type(
+        static_cast<coordinate_type>(
+            bit_compressor<T, mask_x>::apply(m.value & mask_x)),
+        static_cast<coordinate_type>(
+            bit_compressor<T, mask_y>::apply(m.value & mask_y)),
+        static_cast<coordinate_type>(
+            bit_compressor<T, mask_z>::apply(m.value & mask_z)));
+  }
+
+#ifdef MORTON3D_USE_BMI
+  /// @brief Encodes coordinates by PDEP.
+  static code_type encode(const coordinates_type& c, tag::bmi) noexcept {
+    using morton::detail::pdep;
+    return code_type{static_cast<T>(pdep(static_cast<T>(c.x), mask_x) |
+                                    pdep(static_cast<T>(c.y), mask_y) |
+                                    pdep(static_cast<T>(c.z), mask_z))};
+  }
+
+  /// @brief Decodes a morton code by PEXT.
+  static coordinates_type decode(const code_type m, tag::bmi) noexcept {
+    using morton::detail::pext;
+    return coordinates_type(
+        static_cast<coordinate_type>(pext(m.value, mask_x)),
+        static_cast<coordinate_type>(pext(m.value, mask_y)),
+        static_cast<coordinate_type>(pext(m.value, mask_z)));
+  }
+#else
+  static code_type encode(const coordinates_type& c, tag::bmi) noexcept {
+    return encode(c, tag::magic_bits{});
+  }
+
+  static coordinates_type decode(const code_type m, tag::bmi) noexcept {
+    return decode(m, tag::magic_bits{});
+  }
+#endif  // MORTON3D_USE_BMI
+
+  // Look-up tables are specific to the same number of bits for each axis.
+  static code_type encode(const coordinates_type& c,
+                          tag::preshifted_lookup_table) noexcept {
+    return encode(c, tag::magic_bits{});
+  }
+
+  static coordinates_type decode(const code_type m,
+                                 tag::preshifted_lookup_table) noexcept {
+    return decode(m, tag::magic_bits{});
+  }
+
+  static code_type encode(const coordinates_type& c,
+                          tag::lookup_table) noexcept {
+    return encode(c, tag::magic_bits{});
+  }
+
+  static coordinates_type decode(const code_type m,
+                                 tag::lookup_table) noexcept {
+    return decode(m, tag::magic_bits{});
+  }
+
+  static code_type encode(const coordinates_type& c,
+                          tag::nibble_shuffle) noexcept {
+    return encode(c, tag::magic_bits{});
+  }
+
+  static coordinates_type decode(const code_type m,
+                                 tag::nibble_shuffle) noexcept {
+    return decode(m, tag::magic_bits{});
+  }
+
+  // Tags selected by the auto-tuner for uniform codes, which fall back to
+  // magic bits above unless they are BMI.
+  static code_type encode(const coordinates_type& c, tag::tuned) noexcept {
+    return encode(c, typename detail::tuned_tags<T>::encode{});
+  }
+
+  static coordinates_type decode(const code_type m, tag::tuned) noexcept {
+    return decode(m, typename detail::tuned_tags<T>::decode{});
+  }
+};
+
+template <typename T, unsigned int BitsX, unsigned int BitsY,
+          unsigned int BitsZ>
+constexpr unsigned int anisotropic<T, BitsX, BitsY, BitsZ>::bits_x;
+template <typename T, unsigned int BitsX, unsigned int BitsY,
+          unsigned int BitsZ>
+constexpr unsigned int anisotropic<T, BitsX, BitsY, BitsZ>::bits_y;
+template <typename T, unsigned int BitsX, unsigned int BitsY,
+          unsigned int BitsZ>
+constexpr unsigned int anisotropic<T, BitsX, BitsY, BitsZ>::bits_z;
+template <typename T, unsigned int BitsX, unsigned int BitsY,
+          unsigned int BitsZ>
+constexpr T anisotropic<T, BitsX, BitsY, BitsZ>::mask_x;
+template <typename T, unsigned int BitsX, unsigned int BitsY,
+          unsigned int BitsZ>
+constexpr T anisotropic<T, BitsX, BitsY, BitsZ>::mask_y;
+template <typename T, unsigned int BitsX, unsigned int BitsY,
+          unsigned int BitsZ>
+constexpr T anisotropic<T, BitsX, BitsY, BitsZ>::mask_z;
+
+}  // namespace morton3d
+
+#endif  // MORTON_ANISOTROPIC_HPP
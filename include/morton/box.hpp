@@ -0,0 +1,311 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_BOX_HPP
+#define MORTON_BOX_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Check if a morton code is inside a box.
+/// @tparam Dimension Number of dimensions
+/// @tparam T Integral type for morton codes
+/// @param[in] m Morton code
+/// @param[in] zmin Morton code of the lower corner of the box
+/// @param[in] zmax Morton code of the upper corner of the box
+/// @param[in] mask_x Bits of x coordinate
+template <unsigned int Dimension, typename T>
+inline bool in_box(const T m, const T zmin, const T zmax,
+                   const T mask_x) noexcept {
+  for (unsigned int d = 0; d < Dimension; ++d) {
+    // Dilated coordinates are compared in the same way as coordinates.
+    const T mask = static_cast<T>(mask_x << d);
+    const T v = m & mask;
+    if (v < (zmin & mask) || v > (zmax & mask)) return false;
+  }
+  return true;
+}
+
+/// @brief Returns the smallest morton code inside a box which is greater than
+/// a given code outside the box, i.e. BIGMIN in Tropf and Herzog (1981).
+/// @tparam Dimension Number of dimensions
+/// @tparam T Integral type for morton codes
+/// @param[in] m Morton code outside the box which satisfies zmin < m < zmax
+/// @param[in] zmin Morton code of the lower corner of the box
+/// @param[in] zmax Morton code of the upper corner of the box
+/// @param[in] mask_x Bits of x coordinate
+/// @param[in] bits Number of significant bits of morton codes
+template <unsigned int Dimension, typename T>
+inline T bigmin(const T m, T zmin, T zmax, const T mask_x,
+                const unsigned int bits) noexcept {
+  T result = 0;
+  for (unsigned int i = bits; i > 0; --i) {
+    const T bit = static_cast<T>(T(1) << (i - 1));
+    // Lower bits of the same dimension as the current bit
+    const T lower = static_cast<T>((mask_x << ((i - 1) % Dimension)) &
+                                   static_cast<T>(bit - 1));
+    const unsigned int pattern = ((m & bit) ? 4U : 0U) |
+                                 ((zmin & bit) ? 2U : 0U) |
+                                 ((zmax & bit) ? 1U : 0U);
+    switch (pattern) {
+      case 0:  // 000
+      case 7:  // 111
+        break;
+      case 1:  // 001
+        result = static_cast<T>((zmin & ~(bit | lower)) | bit);
+        zmax = static_cast<T>((zmax & ~(bit | lower)) | lower);
+        break;
+      case 3:  // 011
+        return zmin;
+      case 4:  // 100
+        return result;
+      case 5:  // 101
+        zmin = static_cast<T>((zmin & ~(bit | lower)) | bit);
+        break;
+      default:  // 010 and 110 never happen if zmin <= zmax in every dimension
+        assert(false && "Lower corner of a box exceeds the upper corner");
+        return result;
+    }
+  }
+  return result;
+}
+
+/// @brief Forward iterator over morton codes inside a box in increasing order.
+/// @tparam Code Morton code type
+/// @tparam Traits morton_traits of the code
+/// @tparam Dimension Number of dimensions
+template <typename Code, typename Traits, unsigned int Dimension>
+class box_iterator {
+ public:
+  using value_type = Code;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Code*;
+  using reference = const Code&;
+  using iterator_category = std::forward_iterator_tag;
+
+  /// @brief Constructs an end iterator.
+  box_iterator() noexcept : current_{}, zmin_{}, zmax_{}, end_{true} {}
+
+  /// @param[in] current Current morton code inside the box
+  /// @param[in] zmin Morton code of the lower corner of the box
+  /// @param[in] zmax Morton code of the upper corner of the box
+  box_iterator(Code current, Code zmin, Code zmax) noexcept
+      : current_{current}, zmin_{zmin}, zmax_{zmax}, end_{false} {}
+
+  reference operator*() const noexcept { return current_; }
+  pointer operator->() const noexcept { return &current_; }
+
+  /// @brief Moves to the next code inside the box.
+  box_iterator& operator++() noexcept {
+    using T = typename Code::value_type;
+    if (current_ == zmax_) {
+      end_ = true;
+      return *this;
+    }
+    const T next = static_cast<T>(current_.value + 1);
+    current_.value = in_box<Dimension>(next, zmin_.value, zmax_.value,
+                                       Traits::mask_x)
+                         ? next
+                         : bigmin<Dimension>(next, zmin_.value, zmax_.value,
+                                             Traits::mask_x,
+                                             Dimension * Traits::bits);
+    return *this;
+  }
+
+  box_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  friend bool operator==(const box_iterator& it1,
+                         const box_iterator& it2) noexcept {
+    return it1.end_ == it2.end_ && (it1.end_ || it1.current_ == it2.current_);
+  }
+
+  friend bool operator!=(const box_iterator& it1,
+                         const box_iterator& it2) noexcept {
+    return !(it1 == it2);
+  }
+
+ private:
+  Code current_;  /// Current morton code
+  Code zmin_;     /// Morton code of the lower corner
+  Code zmax_;     /// Morton code of the upper corner
+  bool end_;      /// True if the iterator is past the last code
+};
+
+/// @brief Range of morton codes inside a box in increasing order.
+/// @tparam Code Morton code type
+/// @tparam Traits morton_traits of the code
+/// @tparam Dimension Number of dimensions
+template <typename Code, typename Traits, unsigned int Dimension>
+class box_range {
+ public:
+  using value_type = Code;
+  using iterator = box_iterator<Code, Traits, Dimension>;
+  using const_iterator = iterator;
+
+  box_range() = default;
+
+  /// @param[in] zmin Morton code of the lower corner of the box
+  /// @param[in] zmax Morton code of the upper corner of the box
+  box_range(Code zmin, Code zmax) noexcept : zmin_{zmin}, zmax_{zmax} {
+    for (unsigned int d = 0; d < Dimension; ++d) {
+      const auto mask = Traits::mask_x << d;
+      assert((zmin.value & mask) <= (zmax.value & mask) &&
+             "Lower corner of a box exceeds the upper corner");
+      static_cast<void>(mask);
+    }
+  }
+
+  iterator begin() const noexcept { return iterator{zmin_, zmin_, zmax_}; }
+  iterator end() const noexcept { return iterator{}; }
+
+  /// @brief Returns the morton code of the lower corner, which is the first
+  /// code in the range.
+  Code front() const noexcept { return zmin_; }
+
+  /// @brief Returns the morton code of the upper corner, which is the last
+  /// code in the range.
+  Code back() const noexcept { return zmax_; }
+
+  /// @brief Check if a morton code is inside the box.
+  /// @param[in] m Morton code
+  bool contains(const Code m) const noexcept {
+    return in_box<Dimension>(m.value, zmin_.value, zmax_.value,
+                             Traits::mask_x);
+  }
+
+  /// @brief Returns an iterator to the first code in the box which is not
+  /// less than a given code. Codes outside the box are skipped at once.
+  /// @param[in] m Morton code
+  iterator lower_bound(const Code m) const noexcept {
+    if (m <= zmin_) return begin();
+    if (m > zmax_) return end();
+    if (contains(m)) return iterator{m, zmin_, zmax_};
+    const Code next{bigmin<Dimension>(m.value, zmin_.value, zmax_.value,
+                                      Traits::mask_x,
+                                      Dimension * Traits::bits)};
+    return iterator{next, zmin_, zmax_};
+  }
+
+ private:
+  Code zmin_;  /// Morton code of the lower corner
+  Code zmax_;  /// Morton code of the upper corner
+};
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Axis-aligned box in two dimensions. Both bounds are inclusive.
+/// @tparam T Integral type for coordinates
+template <typename T>
+struct box {
+  coordinates<T> lower;  /// Lower corner
+  coordinates<T> upper;  /// Upper corner
+
+  /// @param[in] tlower Lower corner
+  /// @param[in] tupper Upper corner
+  box(const coordinates<T>& tlower, const coordinates<T>& tupper) noexcept
+      : lower{tlower}, upper{tupper} {}
+
+  box() = default;
+
+  /// @brief Check if coordinates are inside the box.
+  bool contains(const coordinates<T>& c) const noexcept {
+    return lower.x <= c.x && c.x <= upper.x &&  //
+           lower.y <= c.y && c.y <= upper.y;
+  }
+};
+
+/// @brief Range of morton codes inside a box in increasing order.
+///
+/// Codes are generated lazily. Codes outside the box are skipped by jumping
+/// to the next code inside the box, so that the cost is proportional to the
+/// number of codes inside the box.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using box_range =
+    morton::detail::box_range<morton_code<T>, morton_traits<T>, 2>;
+
+/// @brief Returns a range of 32-bit morton codes inside a box in increasing
+/// order.
+/// @param[in] b Box
+inline box_range<uint32_t> codes_in_box(const box<uint16_t>& b) noexcept {
+  return {encode(b.lower), encode(b.upper)};
+}
+
+/// @brief Returns a range of 64-bit morton codes inside a box in increasing
+/// order.
+/// @param[in] b Box
+inline box_range<uint64_t> codes_in_box(const box<uint32_t>& b) noexcept {
+  return {encode(b.lower), encode(b.upper)};
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Axis-aligned box in three dimensions. Both bounds are inclusive.
+/// @tparam T Integral type for coordinates
+template <typename T>
+struct box {
+  coordinates<T> lower;  /// Lower corner
+  coordinates<T> upper;  /// Upper corner
+
+  /// @param[in] tlower Lower corner
+  /// @param[in] tupper Upper corner
+  box(const coordinates<T>& tlower, const coordinates<T>& tupper) noexcept
+      : lower{tlower}, upper{tupper} {}
+
+  box() = default;
+
+  /// @brief Check if coordinates are inside the box.
+  bool contains(const coordinates<T>& c) const noexcept {
+    return lower.x <= c.x && c.x <= upper.x &&  //
+           lower.y <= c.y && c.y <= upper.y &&  //
+           lower.z <= c.z && c.z <= upper.z;
+  }
+};
+
+/// @brief Range of morton codes inside a box in increasing order.
+///
+/// Codes are generated lazily. Codes outside the box are skipped by jumping
+/// to the next code inside the box, so that the cost is proportional to the
+/// number of codes inside the box.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using box_range =
+    morton::detail::box_range<morton_code<T>, morton_traits<T>, 3>;
+
+/// @brief Returns a range of 32-bit morton codes inside a box in increasing
+/// order.
+/// @param[in] b Box
+inline box_range<uint32_t> codes_in_box(const box<uint16_t>& b) noexcept {
+  return {encode(b.lower), encode(b.upper)};
+}
+
+/// @brief Returns a range of 64-bit morton codes inside a box in increasing
+/// order.
+/// @param[in] b Box
+inline box_range<uint64_t> codes_in_box(const box<uint32_t>& b) noexcept {
+  return {encode(b.lower), encode(b.upper)};
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_BOX_HPP
@@ -0,0 +1,198 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_BOX_COUNT_HPP
+#define MORTON_BOX_COUNT_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "morton/box.hpp"
+#include "morton/parallel.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Read-only index over sorted morton codes counting codes in boxes.
+///
+/// A box is decomposed into ranges of morton codes of quadtree/octree cells
+/// inside it, and codes in every range are counted by two binary searches.
+/// Cells on the boundary of the box are split into their children as long as
+/// they have many codes, and codes in the other boundary cells are tested one
+/// by one. The decomposition thus follows the distribution of codes rather
+/// than the size of the box.
+/// @tparam Code Morton code type
+/// @tparam Traits morton_traits of the code
+/// @tparam Dimension Number of dimensions
+template <typename Code, typename Traits, unsigned int Dimension>
+class box_count_index {
+ public:
+  using value_type = typename Code::value_type;
+  using range_type = box_range<Code, Traits, Dimension>;
+
+  box_count_index() = default;
+
+  /// @param[in] codes Morton codes sorted in increasing order, which are
+  /// copied into the index
+  /// @param[in] n Number of codes
+  /// @param[in] max_scan Maximum number of codes in a cell on the boundary of
+  /// a box which are counted one by one instead of splitting the cell
+  box_count_index(const Code* codes, std::size_t n, std::size_t max_scan = 512)
+      : codes_(n), max_scan_{max_scan} {
+    for (std::size_t i = 0; i < n; ++i) codes_[i] = codes[i].value;
+    assert(std::is_sorted(codes_.begin(), codes_.end()) &&
+           "Codes are not sorted");
+  }
+
+  /// @brief Returns the number of codes in the index.
+  std::size_t size() const noexcept { return codes_.size(); }
+
+  /// @brief Returns the number of codes inside a box.
+  /// @param[in] box Range of morton codes inside a box
+  std::size_t count(const range_type& box) const noexcept {
+    const T zmin = box.front().value;
+    const T zmax = box.back().value;
+    const T* const end = codes_.data() + codes_.size();
+    const T* first = std::lower_bound(codes_.data(), end, zmin);
+    const T* last = std::upper_bound(first, end, zmax);
+    return count_cell(0, code_bits, first, last, zmin, zmax);
+  }
+
+  /// @brief Counts codes inside boxes by multiple threads.
+  /// @param[in] boxes Ranges of morton codes inside boxes
+  /// @param[in] n Number of boxes
+  /// @param[out] counts Numbers of codes inside the boxes
+  /// @param[in] num_threads Number of threads, or 0 for the number of
+  /// hardware threads
+  void count(const range_type* boxes, std::size_t n, std::size_t* counts,
+             unsigned int num_threads = 0) const {
+    constexpr std::size_t min_boxes_per_thread = 64;
+    const std::size_t t = num_blocks(n, num_threads, min_boxes_per_thread);
+    run_in_parallel(t, [&](std::size_t b) {
+      const std::size_t last = block_begin(n, t, b + 1);
+      for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+        counts[i] = count(boxes[i]);
+      }
+    });
+  }
+
+ private:
+  using T = value_type;
+
+  /// Number of significant bits of morton codes
+  static constexpr unsigned int code_bits = Dimension * Traits::bits;
+
+  /// @brief Returns the last code of a cell.
+  /// @param[in] lo First code of the cell
+  /// @param[in] shift Number of bits of codes inside the cell
+  static T cell_last(T lo, unsigned int shift) noexcept {
+    return shift >= static_cast<unsigned int>(std::numeric_limits<T>::digits)
+               ? std::numeric_limits<T>::max()
+               : static_cast<T>(lo | ((T(1) << shift) - 1));
+  }
+
+  /// @brief Returns 1 if a cell is inside a box, 0 if it overlaps the box
+  /// partially, or -1 if it is outside the box.
+  static int classify(T lo, T hi, T zmin, T zmax) noexcept {
+    bool inside = true;
+    for (unsigned int d = 0; d < Dimension; ++d) {
+      // Dilated coordinates are compared in the same way as coordinates.
+      const T mask = static_cast<T>(Traits::mask_x << d);
+      if ((hi & mask) < (zmin & mask) || (lo & mask) > (zmax & mask)) {
+        return -1;
+      }
+      inside = inside && (zmin & mask) <= (lo & mask) &&
+               (hi & mask) <= (zmax & mask);
+    }
+    return inside ? 1 : 0;
+  }
+
+  /// @brief Counts codes in [first, last) inside a box one by one.
+  ///
+  /// The loop has no branches on codes, so that it is vectorized.
+  static std::size_t count_partial(const T* first, const T* last, T zmin,
+                                   T zmax) noexcept {
+    std::size_t n = 0;
+    for (; first < last; ++first) {
+      n += in_box<Dimension>(*first, zmin, zmax, Traits::mask_x) ? 1 : 0;
+    }
+    return n;
+  }
+
+  /// @brief Counts codes of a cell inside a box.
+  /// @param[in] lo First code of the cell
+  /// @param[in] shift Number of bits of codes inside the cell
+  /// @param[in] first First code in the cell
+  /// @param[in] last End of codes in the cell
+  std::size_t count_cell(T lo, unsigned int shift, const T* first,
+                         const T* last, T zmin, T zmax) const noexcept {
+    if (first == last) return 0;
+    switch (classify(lo, cell_last(lo, shift), zmin, zmax)) {
+      case 1:
+        return static_cast<std::size_t>(last - first);
+      case -1:
+        return 0;
+      default:
+        break;
+    }
+    if (static_cast<std::size_t>(last - first) <= max_scan_) {
+      return count_partial(first, last, zmin, zmax);
+    }
+    constexpr T num_children = T(1) << Dimension;
+    shift -= Dimension;
+    std::size_t n = 0;
+    for (T k = 0; k < num_children && first < last; ++k) {
+      const T child = static_cast<T>(lo | (k << shift));
+      const T* child_last =
+          k + 1 == num_children
+              ? last
+              : std::upper_bound(first, last, cell_last(child, shift));
+      n += count_cell(child, shift, first, child_last, zmin, zmax);
+      first = child_last;
+    }
+    return n;
+  }
+
+  std::vector<T> codes_;        /// Sorted morton codes
+  std::size_t max_scan_ = 512;  /// Maximum number of codes scanned in a cell
+};
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Read-only index over sorted morton codes counting codes inside
+/// boxes.
+///
+/// Boxes are given by codes_in_box(). Every box is decomposed into ranges of
+/// codes of quadtree cells, each of which is counted by two binary searches.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using box_count_index =
+    morton::detail::box_count_index<morton_code<T>, morton_traits<T>, 2>;
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Read-only index over sorted morton codes counting codes inside
+/// boxes.
+///
+/// Boxes are given by codes_in_box(). Every box is decomposed into ranges of
+/// codes of octree cells, each of which is counted by two binary searches.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using box_count_index =
+    morton::detail::box_count_index<morton_code<T>, morton_traits<T>, 3>;
+
+}  // namespace morton3d
+
+#endif  // MORTON_BOX_COUNT_HPP
@@ -0,0 +1,352 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_CELL_LIST_HPP
+#define MORTON_CELL_LIST_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "morton/histogram.hpp"
+#include "morton/join.hpp"
+#include "morton/layout.hpp"
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+#include "morton/parallel.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Cell list of particles for neighbor searches within a cutoff.
+///
+/// Particles are binned in cubic cells of a given size from the minimum
+/// corner of their bounding box. Morton codes of the cells are sorted with
+/// particle indices by parallel radix sort, so that particles of a cell are
+/// contiguous and nearby cells are close in memory. Non-empty cells are
+/// listed with offsets of their particles. Cells are looked up in a dense
+/// table if the grid is not much larger than the number of particles, or by
+/// binary search otherwise.
+///
+/// Buffers are kept by build(), so that rebuilding at every time step does
+/// not allocate memory once the number of particles settles.
+/// @tparam Code morton_code type
+/// @tparam Traits morton_traits
+/// @tparam Dimension Number of dimensions
+/// @tparam Quantize Function object which quantizes and encodes positions
+template <typename Code, typename Traits, unsigned int Dimension,
+          typename Quantize>
+class basic_cell_list {
+ public:
+  using T = typename Code::value_type;
+
+  /// Index returned by find() if a cell is empty
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  basic_cell_list() noexcept : level_{0}, cell_size_{0}, origin_{} {}
+
+  /// @brief Bins particles in cells.
+  /// @tparam Real Floating point type
+  /// @param[in] positions Coordinates of particles, Dimension values per
+  /// particle
+  /// @param[in] n Number of particles
+  /// @param[in] cell_size Edge length of cells, which is usually the cutoff
+  /// distance
+  /// @param[in] num_threads Number of threads, or 0 for the number of
+  /// hardware threads
+  template <typename Real>
+  void build(const Real* positions, std::size_t n, Real cell_size,
+             unsigned int num_threads = 0) {
+    assert(cell_size > 0 && "Cell size is not positive");
+    cell_size_ = cell_size;
+    codes_.resize(n);
+    order_.resize(n);
+    const std::size_t t = num_blocks(n, num_threads);
+
+    // Bounding box
+    std::vector<Real> bounds(2 * Dimension * t);
+    run_in_parallel(t, [&](std::size_t b) {
+      Real* lo = bounds.data() + 2 * Dimension * b;
+      Real* hi = lo + Dimension;
+      std::fill(lo, hi, std::numeric_limits<Real>::max());
+      std::fill(hi, hi + Dimension, std::numeric_limits<Real>::lowest());
+      const std::size_t last = block_begin(n, t, b + 1);
+      for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+        for (unsigned int a = 0; a < Dimension; ++a) {
+          lo[a] = std::min(lo[a], positions[Dimension * i + a]);
+          hi[a] = std::max(hi[a], positions[Dimension * i + a]);
+        }
+      }
+    });
+    std::size_t extent = 1;
+    for (unsigned int a = 0; a < Dimension; ++a) {
+      Real lo = bounds[a];
+      Real hi = bounds[Dimension + a];
+      for (std::size_t b = 1; b < t; ++b) {
+        lo = std::min(lo, bounds[2 * Dimension * b + a]);
+        hi = std::max(hi, bounds[2 * Dimension * b + Dimension + a]);
+      }
+      if (n == 0) lo = hi = 0;
+      origin_[a] = lo;
+      const double cells = std::floor((hi - lo) / cell_size_) + 1;
+      extent = std::max(extent, cells < 1e18 ? static_cast<std::size_t>(cells)
+                                             : ~std::size_t(0));
+    }
+    level_ = ceil_log2(extent);
+    assert(level_ <= Traits::bits && "Too many cells for the code type");
+    // Particles outside the grid of codes are clamped into the last cells.
+    if (level_ > Traits::bits) level_ = Traits::bits;
+
+    // Morton codes of cells
+    run_in_parallel(t, [&](std::size_t b) {
+      const std::size_t first = block_begin(n, t, b);
+      const std::size_t last = block_begin(n, t, b + 1);
+      Quantize{}(positions + Dimension * first, last - first, origin_,
+                 1.0 / cell_size_, level_, codes_.data() + first);
+      std::iota(order_.begin() + first, order_.begin() + last, first);
+    });
+    code_buffer_.resize(n);
+    order_buffer_.resize(n);
+    parallel_radix_sort(codes_.data(), order_.data(), n, Dimension * level_,
+                        code_buffer_.data(), order_buffer_.data(),
+                        num_threads);
+
+    // Non-empty cells and offsets of their particles
+    std::vector<std::size_t> counts(t + 1, 0);
+    const auto is_first = [&](std::size_t i) {
+      return i == 0 || codes_[i] != codes_[i - 1];
+    };
+    run_in_parallel(t, [&](std::size_t b) {
+      std::size_t count = 0;
+      const std::size_t last = block_begin(n, t, b + 1);
+      for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+        count += is_first(i) ? 1 : 0;
+      }
+      counts[b + 1] = count;
+    });
+    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+    cells_.resize(counts[t]);
+    starts_.resize(counts[t] + 1);
+    starts_.back() = n;
+    run_in_parallel(t, [&](std::size_t b) {
+      std::size_t j = counts[b];
+      const std::size_t last = block_begin(n, t, b + 1);
+      for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+        if (!is_first(i)) continue;
+        cells_[j] = codes_[i];
+        starts_[j++] = i;
+      }
+    });
+
+    cell_masks<Dimension>(level_, masks_);
+    index_.clear();
+    if (use_dense_histogram<Dimension>(n, level_)) {
+      index_.assign(std::size_t(1) << (Dimension * level_), npos);
+      for (std::size_t i = 0; i < cells_.size(); ++i) {
+        index_[static_cast<std::size_t>(cells_[i].value)] = i;
+      }
+    }
+  }
+
+  /// @brief Number of particles
+  std::size_t size() const noexcept { return order_.size(); }
+
+  /// @brief Number of non-empty cells
+  std::size_t num_cells() const noexcept { return cells_.size(); }
+
+  /// @brief Level of the grid, i.e. cell coordinates are less than 2^level.
+  unsigned int level() const noexcept { return level_; }
+
+  /// @brief Edge length of cells
+  double cell_size() const noexcept { return cell_size_; }
+
+  /// @brief Coordinate of the minimum corner of the grid along an axis
+  double origin(unsigned int axis) const noexcept { return origin_[axis]; }
+
+  /// @brief Morton code of the coordinates of a non-empty cell
+  /// @param[in] i Index of the cell in [0, num_cells())
+  Code cell(std::size_t i) const noexcept { return cells_[i]; }
+
+  /// @brief Returns the first position of particles of a cell in order().
+  std::size_t begin(std::size_t i) const noexcept { return starts_[i]; }
+
+  /// @brief Returns the position next to the last particle of a cell in
+  /// order().
+  std::size_t end(std::size_t i) const noexcept { return starts_[i + 1]; }
+
+  /// @brief Indices of particles sorted by cells
+  const std::vector<std::size_t>& order() const noexcept { return order_; }
+
+  /// @brief Morton codes of cells of particles in order()
+  const std::vector<Code>& codes() const noexcept { return codes_; }
+
+  /// @brief Returns the index of a cell, or npos if it is empty.
+  std::size_t find(const Code cell) const noexcept {
+    if (!index_.empty()) {
+      const auto c = static_cast<std::size_t>(cell.value);
+      return c < index_.size() ? index_[c] : npos;
+    }
+    const auto it = std::lower_bound(cells_.begin(), cells_.end(), cell);
+    return it != cells_.end() && *it == cell
+               ? static_cast<std::size_t>(it - cells_.begin())
+               : npos;
+  }
+
+  /// @brief Calls f(j) for a non-empty cell i and every non-empty cell j
+  /// sharing a face, an edge, or a corner with it.
+  /// @param[in] i Index of a cell in [0, num_cells())
+  template <typename F>
+  void for_each_neighbor(std::size_t i, const F& f) const {
+    f(i);
+    morton::detail::for_each_neighbor<Dimension>(
+        cells_[i].value, masks_, [&](T c) {
+          const std::size_t j = find(Code{c});
+          if (j != npos) f(j);
+        });
+  }
+
+ private:
+  unsigned int level_;                    /// Level of the grid
+  double cell_size_;                      /// Edge length of cells
+  double origin_[Dimension];              /// Minimum corner of the grid
+  T masks_[Dimension];                    /// Bits of coordinates in cells
+  std::vector<Code> codes_;               /// Cells of sorted particles
+  std::vector<std::size_t> order_;        /// Indices of sorted particles
+  std::vector<Code> code_buffer_;         /// Buffer of radix sort
+  std::vector<std::size_t> order_buffer_; /// Buffer of radix sort
+  std::vector<Code> cells_;               /// Non-empty cells
+  std::vector<std::size_t> starts_;       /// Offsets of cells in order_
+  std::vector<std::size_t> index_;        /// Dense table of cells
+};
+
+template <typename Code, typename Traits, unsigned int Dimension,
+          typename Quantize>
+constexpr std::size_t
+    basic_cell_list<Code, Traits, Dimension, Quantize>::npos;
+
+/// @brief Returns a cell coordinate of a position clamped into the grid.
+template <typename U, typename Real>
+inline U quantize(Real p, double origin, double inv_cell_size,
+                  U max) noexcept {
+  const double q = (p - origin) * inv_cell_size;
+  // Also maps NaN to zero.
+  if (!(q > 0)) return 0;
+  return q < static_cast<double>(max) ? static_cast<U>(q) : max;
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+namespace detail {
+
+/// @brief Quantizes positions into cell coordinates and encodes them.
+struct quantize_positions {
+  template <typename Real, typename T>
+  void operator()(const Real* p, std::size_t n, const double (&origin)[2],
+                  double inv_cell_size, unsigned int level,
+                  morton_code<T>* codes) const noexcept {
+    using U = typename morton_traits<T>::coordinate_type;
+    const U max = static_cast<U>((uint64_t(1) << level) - 1);
+    using morton::detail::quantize;
+    constexpr std::size_t chunk = 256;
+    coordinates<U> c[chunk];
+    for (std::size_t i = 0; i < n; i += chunk) {
+      const std::size_t m = std::min(chunk, n - i);
+      for (std::size_t j = 0; j < m; ++j) {
+        const Real* q = p + 2 * (i + j);
+        c[j].x = quantize(q[0], origin[0], inv_cell_size, max);
+        c[j].y = quantize(q[1], origin[1], inv_cell_size, max);
+      }
+      encode(c, m, codes + i);
+    }
+  }
+};
+
+}  // namespace detail
+
+/// @brief Cell list of particles in two dimensions.
+///
+/// @code
+/// cell_list<uint64_t> cells;
+/// cells.build(positions, n, cutoff);
+/// for (std::size_t i = 0; i < cells.num_cells(); ++i) {
+///   cells.for_each_neighbor(i, [&](std::size_t j) {
+///     // Pairs of order()[cells.begin(i), cells.end(i)) and
+///     // order()[cells.begin(j), cells.end(j))
+///   });
+/// }
+/// @endcode
+/// @tparam T Integral type for morton_code
+template <typename T>
+using cell_list =
+    morton::detail::basic_cell_list<morton_code<T>, morton_traits<T>, 2,
+                                    detail::quantize_positions>;
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+namespace detail {
+
+/// @brief Quantizes positions into cell coordinates and encodes them.
+struct quantize_positions {
+  template <typename Real, typename T>
+  void operator()(const Real* p, std::size_t n, const double (&origin)[3],
+                  double inv_cell_size, unsigned int level,
+                  morton_code<T>* codes) const noexcept {
+    using U = typename morton_traits<T>::coordinate_type;
+    const U max = static_cast<U>((uint64_t(1) << level) - 1);
+    using morton::detail::quantize;
+    constexpr std::size_t chunk = 256;
+    coordinates<U> c[chunk];
+    for (std::size_t i = 0; i < n; i += chunk) {
+      const std::size_t m = std::min(chunk, n - i);
+      for (std::size_t j = 0; j < m; ++j) {
+        const Real* q = p + 3 * (i + j);
+        c[j].x = quantize(q[0], origin[0], inv_cell_size, max);
+        c[j].y = quantize(q[1], origin[1], inv_cell_size, max);
+        c[j].z = quantize(q[2], origin[2], inv_cell_size, max);
+      }
+      encode(c, m, codes + i);
+    }
+  }
+};
+
+}  // namespace detail
+
+/// @brief Cell list of particles in three dimensions, e.g. for molecular
+/// dynamics and SPH.
+///
+/// @code
+/// cell_list<uint64_t> cells;
+/// cells.build(positions, n, cutoff);  // x, y, z of every particle
+/// for (std::size_t i = 0; i < cells.num_cells(); ++i) {
+///   // 27 neighbor cells including the cell itself
+///   cells.for_each_neighbor(i, [&](std::size_t j) {
+///     for (auto p = cells.begin(i); p < cells.end(i); ++p) {
+///       for (auto q = cells.begin(j); q < cells.end(j); ++q) {
+///         interact(cells.order()[p], cells.order()[q]);
+///       }
+///     }
+///   });
+/// }
+/// @endcode
+/// @tparam T Integral type for morton_code
+template <typename T>
+using cell_list =
+    morton::detail::basic_cell_list<morton_code<T>, morton_traits<T>, 3,
+                                    detail::quantize_positions>;
+
+}  // namespace morton3d
+
+#endif  // MORTON_CELL_LIST_HPP
@@ -0,0 +1,259 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_DOWNSAMPLE_HPP
+#define MORTON_DOWNSAMPLE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "morton/histogram.hpp"
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Summary of points in a voxel.
+///
+/// The first point is copied into the summary, since the chunk holding it
+/// may have been dropped by the time the voxel is completed. Arrays of
+/// attributes are owned by the downsampler and valid only while the voxel is
+/// passed to a function.
+/// @tparam Code Morton code type
+/// @tparam Dimension Number of dimensions
+template <typename Code, unsigned int Dimension>
+struct voxel_summary {
+  Code cell;                      /// Morton code of the voxel at its level
+  std::size_t count;              /// Number of points
+  Code first_code;                /// Morton code of the first point
+  const float* first_attributes;  /// Attributes of the first point
+  std::size_t first_index;        /// Index of the first point in the stream
+  double centroid[Dimension];     /// Mean coordinates of points
+  const float* min;               /// Minimum of every attribute
+  const float* max;               /// Maximum of every attribute
+  const float* mean;              /// Mean of every attribute
+};
+
+/// @brief Streaming downsampler aggregating sorted points in voxels of a
+/// level.
+///
+/// Points are pushed in chunks of any size in increasing order of their
+/// morton codes. Points of a voxel are consecutive, so that only the
+/// aggregates of the current voxel are held, which may span chunks. Runs of
+/// codes in a voxel are found by galloping search on codes truncated to the
+/// level.
+/// @tparam Code Morton code type
+/// @tparam Traits morton_traits of the code
+/// @tparam Dimension Number of dimensions
+/// @tparam AddCoordinates Function object adding coordinates of codes to sums
+template <typename Code, typename Traits, unsigned int Dimension,
+          typename AddCoordinates>
+class voxel_downsampler {
+ public:
+  using voxel = voxel_summary<Code, Dimension>;
+
+  /// @param[in] level Level of voxels from the root (0) to the leaves
+  /// (Traits::bits)
+  /// @param[in] num_attributes Number of float attributes of every point
+  explicit voxel_downsampler(unsigned int level,
+                             std::size_t num_attributes = 0)
+      : shift_{cell_shift<Dimension, Traits>(level)},
+        num_attributes_{num_attributes}, num_points_{0}, open_{false},
+        cell_{0}, count_{0}, first_code_{0}, first_index_{0},
+        first_row_(num_attributes), min_(num_attributes),
+        max_(num_attributes), sum_(num_attributes), mean_(num_attributes) {
+    std::fill(sums_, sums_ + Dimension, uint64_t(0));
+  }
+
+  /// @brief Returns the number of points pushed so far.
+  std::size_t num_points() const noexcept { return num_points_; }
+
+  /// @brief Aggregates a chunk of points, and calls emit(voxel) for every
+  /// voxel completed by the chunk.
+  /// @param[in] codes Morton codes in increasing order, which are not less
+  /// than codes pushed before
+  /// @param[in] attributes n x num_attributes attributes in row-major order,
+  /// or nullptr if there are no attributes
+  /// @param[in] n Number of points
+  /// @param[in] emit Function object called as emit(const voxel&)
+  template <typename F>
+  void push(const Code* codes, const float* attributes, std::size_t n,
+            const F& emit) {
+    assert((num_attributes_ == 0 || attributes) && "Attributes are missing");
+    for_each_run(codes, 0, n, shift_,
+                 [&](T cell, std::size_t first, std::size_t last) {
+                   assert((!open_ || cell >= cell_) && "Codes are not sorted");
+                   if (open_ && cell != cell_) flush(emit);
+                   if (!open_) open(cell, num_points_ + first);
+                   add(codes + first, attributes, first, last);
+                 });
+    num_points_ += n;
+  }
+
+  /// @brief Calls emit(voxel) for the last voxel, which is then reset. This
+  /// is called after all the points are pushed.
+  /// @param[in] emit Function object called as emit(const voxel&)
+  template <typename F>
+  void flush(const F& emit) {
+    if (!open_) return;
+    voxel v;
+    v.cell = Code{cell_};
+    v.count = count_;
+    v.first_code = Code{first_code_};
+    v.first_attributes = first_row_.data();
+    v.first_index = first_index_;
+    for (unsigned int a = 0; a < Dimension; ++a) {
+      v.centroid[a] = static_cast<double>(sums_[a]) / count_;
+    }
+    for (std::size_t a = 0; a < num_attributes_; ++a) {
+      mean_[a] = static_cast<float>(sum_[a] / count_);
+    }
+    v.min = min_.data();
+    v.max = max_.data();
+    v.mean = mean_.data();
+    emit(static_cast<const voxel&>(v));
+    open_ = false;
+  }
+
+ private:
+  using T = typename Code::value_type;
+
+  /// @brief Starts aggregating a voxel.
+  void open(T cell, std::size_t first_index) noexcept {
+    open_ = true;
+    cell_ = cell;
+    count_ = 0;
+    first_index_ = first_index;
+    std::fill(sums_, sums_ + Dimension, uint64_t(0));
+    std::fill(min_.begin(), min_.end(), std::numeric_limits<float>::max());
+    std::fill(max_.begin(), max_.end(), std::numeric_limits<float>::lowest());
+    std::fill(sum_.begin(), sum_.end(), 0.0);
+  }
+
+  /// @brief Adds points [first, last) of a chunk to the current voxel.
+  void add(const Code* codes, const float* attributes, std::size_t first,
+           std::size_t last) noexcept {
+    if (count_ == 0) {
+      first_code_ = codes[0].value;
+      std::copy(attributes + first * num_attributes_,
+                attributes + (first + 1) * num_attributes_,
+                first_row_.begin());
+    }
+    count_ += last - first;
+    AddCoordinates{}(codes, last - first, sums_);
+    for (std::size_t i = first; i < last; ++i) {
+      const float* row = attributes + i * num_attributes_;
+      for (std::size_t a = 0; a < num_attributes_; ++a) {
+        min_[a] = std::min(min_[a], row[a]);
+        max_[a] = std::max(max_[a], row[a]);
+        sum_[a] += row[a];
+      }
+    }
+  }
+
+  unsigned int shift_;            /// Number of bits truncated from codes
+  std::size_t num_attributes_;    /// Number of attributes of a point
+  std::size_t num_points_;        /// Number of points pushed so far
+  bool open_;                     /// True if a voxel is being aggregated
+  T cell_;                        /// Current voxel
+  std::size_t count_;             /// Number of points in the voxel
+  T first_code_;                  /// Code of the first point in the voxel
+  std::size_t first_index_;       /// Index of the first point in the voxel
+  std::vector<float> first_row_;  /// Attributes of the first point
+  uint64_t sums_[Dimension];      /// Sums of coordinates
+  std::vector<float> min_;        /// Minimum of attributes
+  std::vector<float> max_;        /// Maximum of attributes
+  std::vector<double> sum_;       /// Sums of attributes
+  std::vector<float> mean_;       /// Means of attributes
+};
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+namespace detail {
+
+/// @brief Adds coordinates of morton codes to sums.
+struct add_coordinates {
+  template <typename T>
+  void operator()(const morton_code<T>* codes, std::size_t n,
+                  uint64_t (&sums)[2]) const noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto c = decode(codes[i]);
+      sums[0] += c.x;
+      sums[1] += c.y;
+    }
+  }
+};
+
+}  // namespace detail
+
+/// @brief Summary of points in a quadtree cell.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using voxel_summary = morton::detail::voxel_summary<morton_code<T>, 2>;
+
+/// @brief Streaming downsampler aggregating points sorted by morton codes in
+/// quadtree cells of a level.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using voxel_downsampler =
+    morton::detail::voxel_downsampler<morton_code<T>, morton_traits<T>, 2,
+                                      detail::add_coordinates>;
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+namespace detail {
+
+/// @brief Adds coordinates of morton codes to sums.
+struct add_coordinates {
+  template <typename T>
+  void operator()(const morton_code<T>* codes, std::size_t n,
+                  uint64_t (&sums)[3]) const noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto c = decode(codes[i]);
+      sums[0] += c.x;
+      sums[1] += c.y;
+      sums[2] += c.z;
+    }
+  }
+};
+
+}  // namespace detail
+
+/// @brief Summary of points in a voxel.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using voxel_summary = morton::detail::voxel_summary<morton_code<T>, 3>;
+
+/// @brief Streaming downsampler aggregating points sorted by morton codes in
+/// voxels of a level.
+///
+/// @code
+/// voxel_downsampler<uint64_t> d(level, 1);
+/// for (auto&& chunk : chunks) {
+///   d.push(chunk.codes, chunk.intensities, chunk.size, emit);
+/// }
+/// d.flush(emit);
+/// @endcode
+/// @tparam T Integral type for morton_code
+template <typename T>
+using voxel_downsampler =
+    morton::detail::voxel_downsampler<morton_code<T>, morton_traits<T>, 3,
+                                      detail::add_coordinates>;
+
+}  // namespace morton3d
+
+#endif  // MORTON_DOWNSAMPLE_HPP
@@ -0,0 +1,307 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_GEO_HPP
+#define MORTON_GEO_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "morton/morton2d.hpp"
+
+namespace morton2d {
+
+/// @brief Geographic coordinates in degrees.
+struct lat_lon {
+  double lat;  /// Latitude in [-90, 90]
+  double lon;  /// Longitude in [-180, 180]
+};
+
+/// @brief Map tile at a zoom level, whose x increases eastwards and y
+/// southwards from 0 to 2^zoom - 1.
+struct tile {
+  unsigned int zoom;  /// Zoom level from 0 to max_zoom
+  uint32_t x;         /// Column
+  uint32_t y;         /// Row
+};
+
+inline bool operator==(const tile& a, const tile& b) noexcept {
+  return a.zoom == b.zoom && a.x == b.x && a.y == b.y;
+}
+
+inline bool operator!=(const tile& a, const tile& b) noexcept {
+  return !(a == b);
+}
+
+/// Maximum zoom level, at which a tile is a cell of 64-bit morton codes
+constexpr unsigned int max_zoom = morton_traits<uint64_t>::bits;
+
+namespace detail {
+
+constexpr double pi = 3.14159265358979323846;
+/// Number of cells along each axis of 64-bit morton codes
+constexpr double geo_cells = 4294967296.0;
+
+/// @brief Quantizes a position in [0, 1) into a 32-bit cell coordinate.
+///
+/// Positions are rounded down, and those out of range are clamped, so that
+/// every service quantizes the same point into the same cell. NaN is mapped
+/// to zero.
+inline uint32_t quantize_unit(const double u) noexcept {
+  const double q = std::floor(u * geo_cells);
+  if (!(q > 0)) return 0;
+  return q < geo_cells ? static_cast<uint32_t>(q) : 0xFFFFFFFF;
+}
+
+/// @brief Returns the center of a cell in [0, 1).
+inline double cell_center(const uint32_t c) noexcept {
+  return (c + 0.5) / geo_cells;
+}
+
+/// @brief Projects a longitude to [0, 1) from west to east.
+inline double project_lon(const double lon) noexcept {
+  return (lon + 180.0) / 360.0;
+}
+
+/// @brief Projects a latitude to [0, 1) from north to south linearly.
+inline double project_lat(const double lat) noexcept {
+  return (90.0 - lat) / 180.0;
+}
+
+/// @brief Projects a latitude to [0, 1) from north to south by Web Mercator.
+///
+/// Latitudes beyond +-85.0511 degrees are out of [0, 1), and the poles are
+/// infinite.
+inline double project_mercator_lat(const double lat) noexcept {
+  const double s = std::sin(lat * (pi / 180.0));
+  return 0.5 - std::log((1.0 + s) / (1.0 - s)) / (4.0 * pi);
+}
+
+/// @brief Returns the cell of a point in linear projection.
+inline coordinates32_t quantize_lat_lon(const lat_lon& p) noexcept {
+  return {quantize_unit(project_lon(p.lon)), quantize_unit(project_lat(p.lat))};
+}
+
+/// @brief Returns the cell of a point in Web Mercator projection.
+inline coordinates32_t quantize_web_mercator(const lat_lon& p) noexcept {
+  return {quantize_unit(project_lon(p.lon)),
+          quantize_unit(project_mercator_lat(p.lat))};
+}
+
+/// @brief Returns the center of a cell in linear projection.
+inline lat_lon unquantize_lat_lon(const coordinates32_t& c) noexcept {
+  return {90.0 - 180.0 * cell_center(c.y), 360.0 * cell_center(c.x) - 180.0};
+}
+
+/// @brief Returns the center of a cell in Web Mercator projection.
+inline lat_lon unquantize_web_mercator(const coordinates32_t& c) noexcept {
+  const double y = pi * (1.0 - 2.0 * cell_center(c.y));
+  return {std::atan(std::sinh(y)) * (180.0 / pi),
+          360.0 * cell_center(c.x) - 180.0};
+}
+
+/// @brief Quantizes and encodes points in chunks, so that cells are encoded
+/// in batches.
+template <typename Quantize, typename Tag>
+void encode_points(const lat_lon* p, std::size_t n, morton_code64_t* m,
+                   Quantize quantize, Tag tag) noexcept {
+  constexpr std::size_t chunk = 256;
+  coordinates32_t c[chunk];
+  for (std::size_t i = 0; i < n; i += chunk) {
+    const std::size_t k = std::min(chunk, n - i);
+    for (std::size_t j = 0; j < k; ++j) c[j] = quantize(p[i + j]);
+    encode(c, k, m + i, tag);
+  }
+}
+
+/// @brief Decodes codes in batches and returns the centers of their cells.
+template <typename Unquantize, typename Tag>
+void decode_points(const morton_code64_t* m, std::size_t n, lat_lon* p,
+                   Unquantize unquantize, Tag tag) noexcept {
+  constexpr std::size_t chunk = 256;
+  coordinates32_t c[chunk];
+  for (std::size_t i = 0; i < n; i += chunk) {
+    const std::size_t k = std::min(chunk, n - i);
+    decode(m + i, k, c, tag);
+    for (std::size_t j = 0; j < k; ++j) p[i + j] = unquantize(c[j]);
+  }
+}
+
+/// @brief Returns the number of bits of a code below the cells of a zoom
+/// level.
+inline unsigned int zoom_shift(const unsigned int zoom) noexcept {
+  assert(zoom <= max_zoom && "Zoom level is too large");
+  return 2 * (max_zoom - zoom);
+}
+
+}  // namespace detail
+
+/// @brief Encodes a point into a morton code of its cell in linear
+/// projection of longitude and latitude.
+///
+/// The globe is divided into 2^32 x 2^32 cells. x increases eastwards from
+/// -180 degrees and y southwards from 90 degrees, as in map tiles, so that
+/// the tile and quadkey functions below also apply to the codes.
+template <typename Tag = default_tag>
+inline morton_code64_t encode_lat_lon(const lat_lon& p,
+                                      Tag tag = Tag{}) noexcept {
+  return encode(detail::quantize_lat_lon(p), tag);
+}
+
+/// @brief Returns the center of the cell of a code in linear projection.
+template <typename Tag = default_tag>
+inline lat_lon decode_lat_lon(const morton_code64_t m,
+                              Tag tag = Tag{}) noexcept {
+  return detail::unquantize_lat_lon(decode(m, tag));
+}
+
+/// @brief Encodes a point into a morton code of its cell in Web Mercator
+/// projection.
+///
+/// Cells at zoom level z are tiles of web maps. Latitudes beyond +-85.0511
+/// degrees are clamped into the first or last row.
+template <typename Tag = default_tag>
+inline morton_code64_t encode_web_mercator(const lat_lon& p,
+                                           Tag tag = Tag{}) noexcept {
+  return encode(detail::quantize_web_mercator(p), tag);
+}
+
+/// @brief Returns the center of the cell of a code in Web Mercator
+/// projection.
+template <typename Tag = default_tag>
+inline lat_lon decode_web_mercator(const morton_code64_t m,
+                                   Tag tag = Tag{}) noexcept {
+  return detail::unquantize_web_mercator(decode(m, tag));
+}
+
+/// @brief Encodes points in linear projection.
+///
+/// Points are projected and quantized in chunks, whose cells are then
+/// encoded by the batch encoder of the tag, e.g. in SIMD registers.
+/// @param[in] p Points
+/// @param[in] n Number of points
+/// @param[out] m Morton codes of n points
+template <typename Tag = default_tag>
+inline void encode_lat_lon(const lat_lon* p, std::size_t n,
+                           morton_code64_t* m, Tag tag = Tag{}) noexcept {
+  detail::encode_points(p, n, m, detail::quantize_lat_lon, tag);
+}
+
+/// @brief Decodes codes into the centers of their cells in linear
+/// projection.
+template <typename Tag = default_tag>
+inline void decode_lat_lon(const morton_code64_t* m, std::size_t n,
+                           lat_lon* p, Tag tag = Tag{}) noexcept {
+  detail::decode_points(m, n, p, detail::unquantize_lat_lon, tag);
+}
+
+/// @brief Encodes points in Web Mercator projection.
+/// @see encode_lat_lon
+template <typename Tag = default_tag>
+inline void encode_web_mercator(const lat_lon* p, std::size_t n,
+                                morton_code64_t* m, Tag tag = Tag{}) noexcept {
+  detail::encode_points(p, n, m, detail::quantize_web_mercator, tag);
+}
+
+/// @brief Decodes codes into the centers of their cells in Web Mercator
+/// projection.
+template <typename Tag = default_tag>
+inline void decode_web_mercator(const morton_code64_t* m, std::size_t n,
+                                lat_lon* p, Tag tag = Tag{}) noexcept {
+  detail::decode_points(m, n, p, detail::unquantize_web_mercator, tag);
+}
+
+/// @brief Returns the tile at a zoom level which contains the cell of a code.
+template <typename Tag = default_tag>
+inline tile to_tile(const morton_code64_t m, const unsigned int zoom,
+                    Tag tag = Tag{}) noexcept {
+  const unsigned int shift = detail::zoom_shift(zoom);
+  if (shift == 64) return {0, 0, 0};
+  const auto c = decode(morton_code64_t(m.value >> shift), tag);
+  return {zoom, c.x, c.y};
+}
+
+/// @brief Returns the first code in a tile.
+///
+/// Codes in a tile are the range [first_code(t), last_code(t)].
+template <typename Tag = default_tag>
+inline morton_code64_t first_code(const tile& t, Tag tag = Tag{}) noexcept {
+  const unsigned int shift = detail::zoom_shift(t.zoom);
+  assert((shift == 64 || ((uint64_t(t.x) | t.y) >> t.zoom) == 0) &&
+         "Tile is out of the zoom level");
+  if (shift == 64) return morton_code64_t(0);
+  return morton_code64_t(encode(coordinates32_t{t.x, t.y}, tag).value
+                         << shift);
+}
+
+/// @brief Returns the last code in a tile.
+template <typename Tag = default_tag>
+inline morton_code64_t last_code(const tile& t, Tag tag = Tag{}) noexcept {
+  const unsigned int shift = detail::zoom_shift(t.zoom);
+  if (shift == 64) return morton_code64_t(~uint64_t(0));
+  return morton_code64_t(first_code(t, tag).value |
+                         ((uint64_t(1) << shift) - 1));
+}
+
+/// @brief Returns the quadkey of the tile at a zoom level which contains the
+/// cell of a code.
+///
+/// A quadkey has a digit per zoom level, which is 2 * (y bit) + (x bit) of
+/// the tile at the level. These are exactly the pairs of bits of a morton
+/// code from the top, so that no decoding is needed.
+inline std::string to_quadkey(const morton_code64_t m,
+                              const unsigned int zoom) {
+  assert(zoom <= max_zoom && "Zoom level is too large");
+  std::string key(zoom, '0');
+  for (unsigned int i = 0; i < zoom; ++i) {
+    key[i] = static_cast<char>('0' + ((m.value >> (62 - 2 * i)) & 3));
+  }
+  return key;
+}
+
+/// @brief Returns the quadkey of a tile.
+template <typename Tag = default_tag>
+inline std::string to_quadkey(const tile& t, Tag tag = Tag{}) {
+  return to_quadkey(first_code(t, tag), t.zoom);
+}
+
+/// @brief Parses a quadkey into the first code of its tile.
+/// @param[in] key Quadkey of digits 0 to 3
+/// @param[out] m First code of the tile, which is unchanged on failure
+/// @param[out] zoom Zoom level, which is the length of the key
+/// @returns False if the key has other characters or is longer than max_zoom
+inline bool parse_quadkey(const std::string& key, morton_code64_t& m,
+                          unsigned int& zoom) noexcept {
+  if (key.size() > max_zoom) return false;
+  uint64_t value = 0;
+  for (std::size_t i = 0; i < key.size(); ++i) {
+    const unsigned int digit = static_cast<unsigned char>(key[i]) - '0';
+    if (digit > 3) return false;
+    value |= uint64_t(digit) << (62 - 2 * i);
+  }
+  m = morton_code64_t(value);
+  zoom = static_cast<unsigned int>(key.size());
+  return true;
+}
+
+/// @brief Parses a quadkey into a tile.
+/// @param[in] key Quadkey of digits 0 to 3
+/// @param[out] t Tile, which is unchanged on failure
+/// @returns False if the key has other characters or is longer than max_zoom
+template <typename Tag = default_tag>
+inline bool parse_quadkey(const std::string& key, tile& t,
+                          Tag tag = Tag{}) noexcept {
+  morton_code64_t m;
+  unsigned int zoom;
+  if (!parse_quadkey(key, m, zoom)) return false;
+  t = to_tile(m, zoom, tag);
+  return true;
+}
+
+}  // namespace morton2d
+
+#endif  // MORTON_GEO_HPP
@@ -0,0 +1,567 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_GRID_HPP
+#define MORTON_GRID_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "morton/layout.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Returns a dilated integer incremented by one.
+/// @param[in] d Dilated integer
+/// @param[in] mask Bits of the dilated integer
+inline std::size_t dilated_increment(std::size_t d, std::size_t mask) noexcept {
+  // Bits outside the mask propagate the carry.
+  return ((d | ~mask) + 1) & mask;
+}
+
+/// @brief Returns a dilated integer decremented by one.
+/// @param[in] d Dilated integer
+/// @param[in] mask Bits of the dilated integer
+inline std::size_t dilated_decrement(std::size_t d, std::size_t mask) noexcept {
+  // Bits outside the mask propagate the borrow.
+  return (d - 1) & mask;
+}
+
+/// @brief Returns the sum of two dilated integers.
+/// @param[in] a Dilated integer
+/// @param[in] b Dilated integer
+/// @param[in] mask Bits of the dilated integers
+inline std::size_t dilated_add(std::size_t a, std::size_t b,
+                               std::size_t mask) noexcept {
+  return ((a | ~mask) + (b & mask)) & mask;
+}
+
+/// @brief Extents of a grid as dilated integers.
+/// @tparam Dimension Number of dimensions
+template <unsigned int Dimension>
+struct dilated_bounds {
+  std::size_t masks[Dimension];   /// Bits of each coordinate in indices
+  /// Dilated maximum coordinate of each axis plus one, which does not
+  /// overflow even if the extent is a power of two
+  std::size_t limits[Dimension];
+
+  /// @brief Check if an index is inside the grid.
+  bool contains(std::size_t i) const noexcept {
+    for (unsigned int a = 0; a < Dimension; ++a) {
+      // Dilated coordinates are compared in the same way as coordinates.
+      if ((i & masks[a]) >= limits[a]) return false;
+    }
+    return true;
+  }
+
+  /// @brief Returns the bits at and below the highest bit at which a
+  /// coordinate of an index exceeds its maximum, or 0 inside the grid.
+  std::size_t excess(std::size_t i) const noexcept {
+    std::size_t bits = 0;
+    for (unsigned int a = 0; a < Dimension; ++a) {
+      const std::size_t d = i & masks[a];
+      if (d < limits[a]) continue;
+      if (limits[a] == 0) return ~std::size_t{0};
+      // The highest bit which differs from the maximum is set in d.
+      std::size_t x = d ^ (limits[a] - 1);
+      for (int s = 1; s < std::numeric_limits<std::size_t>::digits; s <<= 1) {
+        x |= x >> s;
+      }
+      bits |= x;
+    }
+    return bits;
+  }
+
+  /// @brief Returns the next index inside the grid in Z-order of the bits in
+  /// a mask, which wraps to zero after the last index.
+  ///
+  /// Every index which agrees with an index outside the grid above the bits
+  /// of excess() is outside too, so that the padding is skipped by a carry
+  /// past them as BIGMIN does for boxes.
+  /// @param[in] i Index
+  /// @param[in] mask Bits which vary
+  std::size_t next(std::size_t i, std::size_t mask) const noexcept {
+    const std::size_t fixed = i & ~mask;
+    std::size_t d = dilated_increment(i, mask);
+    std::size_t low = 0;
+    while (d != 0 && (low = excess(fixed | d) & mask) != 0) {
+      d = dilated_increment(d | low, mask);
+    }
+    return fixed | d;
+  }
+};
+
+/// @brief Forward iterator over elements of a grid in Z-order.
+///
+/// The iterator steps over indices whose bits in a mask vary while the other
+/// bits are fixed. Blocks of indices in the padding are skipped at once.
+/// @tparam T Element type, which is const for constant grids
+/// @tparam Dimension Number of dimensions
+template <typename T, unsigned int Dimension>
+class zorder_iterator {
+ public:
+  using value_type = typename std::remove_const<T>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T*;
+  using reference = T&;
+  using iterator_category = std::forward_iterator_tag;
+
+  zorder_iterator() noexcept
+      : data_{nullptr}, bounds_{nullptr}, index_{0}, mask_{0}, count_{0} {}
+
+  /// @param[in] data Storage of a grid
+  /// @param[in] bounds Bounds of the grid
+  /// @param[in] index Index of the current element
+  /// @param[in] mask Bits which vary
+  /// @param[in] count Number of elements visited so far
+  zorder_iterator(T* data, const dilated_bounds<Dimension>* bounds,
+                  std::size_t index, std::size_t mask,
+                  std::size_t count) noexcept
+      : data_{data},
+        bounds_{bounds},
+        index_{index},
+        mask_{mask},
+        count_{count} {}
+
+  reference operator*() const noexcept { return data_[index_]; }
+  pointer operator->() const noexcept { return data_ + index_; }
+
+  /// @brief Index of the current element in the storage
+  std::size_t index() const noexcept { return index_; }
+
+  zorder_iterator& operator++() noexcept {
+    ++count_;
+    index_ = bounds_->next(index_, mask_);
+    return *this;
+  }
+
+  zorder_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  friend bool operator==(const zorder_iterator& it1,
+                         const zorder_iterator& it2) noexcept {
+    return it1.count_ == it2.count_;
+  }
+
+  friend bool operator!=(const zorder_iterator& it1,
+                         const zorder_iterator& it2) noexcept {
+    return !(it1 == it2);
+  }
+
+ private:
+  T* data_;                                  /// Storage of the grid
+  const dilated_bounds<Dimension>* bounds_;  /// Bounds of the grid
+  std::size_t index_;                        /// Index of the current element
+  std::size_t mask_;                         /// Bits which vary
+  std::size_t count_;                        /// Number of visited elements
+};
+
+/// @brief Range of elements of a grid in Z-order.
+template <typename T, unsigned int Dimension>
+class zorder_range {
+ public:
+  using value_type = typename std::remove_const<T>::type;
+  using iterator = zorder_iterator<T, Dimension>;
+  using const_iterator = iterator;
+
+  /// @param[in] data Storage of a grid
+  /// @param[in] bounds Bounds of the grid
+  /// @param[in] first Index of the first element
+  /// @param[in] mask Bits which vary
+  /// @param[in] size Number of elements in the range
+  zorder_range(T* data, const dilated_bounds<Dimension>* bounds,
+               std::size_t first, std::size_t mask, std::size_t size) noexcept
+      : data_{data}, bounds_{bounds}, first_{first}, mask_{mask}, size_{size} {}
+
+  iterator begin() const noexcept {
+    return iterator(data_, bounds_, first_, mask_, 0);
+  }
+
+  iterator end() const noexcept {
+    return iterator(data_, bounds_, first_, mask_, size_);
+  }
+
+  std::size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+
+ private:
+  T* data_;
+  const dilated_bounds<Dimension>* bounds_;
+  std::size_t first_;
+  std::size_t mask_;
+  std::size_t size_;
+};
+
+/// @brief Array of default-constructed elements aligned to a boundary.
+/// @tparam T Element type
+/// @tparam Alignment Alignment in bytes, which is a power of two
+template <typename T, std::size_t Alignment>
+class aligned_buffer {
+  static_assert((Alignment & (Alignment - 1)) == 0,
+                "Alignment is not a power of two");
+  static_assert(Alignment >= alignof(T), "Alignment is less than alignof(T)");
+
+ public:
+  aligned_buffer() noexcept : raw_{nullptr}, data_{nullptr}, size_{0} {}
+
+  explicit aligned_buffer(std::size_t size) : aligned_buffer() {
+    allocate(size);
+    try {
+      for (; size_ < size; ++size_) new (data_ + size_) T();
+    } catch (...) {
+      release();
+      throw;
+    }
+  }
+
+  aligned_buffer(const aligned_buffer& other) : aligned_buffer() {
+    allocate(other.size_);
+    try {
+      // Copies already made are destroyed if a copy throws.
+      std::uninitialized_copy(other.data_, other.data_ + other.size_, data_);
+    } catch (...) {
+      release();
+      throw;
+    }
+    size_ = other.size_;
+  }
+
+  aligned_buffer(aligned_buffer&& other) noexcept : aligned_buffer() {
+    swap(other);
+  }
+
+  aligned_buffer& operator=(aligned_buffer other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~aligned_buffer() { release(); }
+
+  void swap(aligned_buffer& other) noexcept {
+    std::swap(raw_, other.raw_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+  }
+
+  T* data() noexcept { return data_; }
+  const T* data() const noexcept { return data_; }
+  std::size_t size() const noexcept { return size_; }
+
+  T& operator[](std::size_t i) noexcept { return data_[i]; }
+  const T& operator[](std::size_t i) const noexcept { return data_[i]; }
+
+ private:
+  void allocate(std::size_t size) {
+    if (size == 0) return;
+    raw_ = ::operator new(size * sizeof(T) + Alignment - 1);
+    const auto p = reinterpret_cast<std::uintptr_t>(raw_);
+    data_ = reinterpret_cast<T*>((p + Alignment - 1) & ~(Alignment - 1));
+  }
+
+  /// @brief Destroys the elements and frees the memory.
+  void release() noexcept {
+    while (size_ > 0) data_[--size_].~T();
+    ::operator delete(raw_);
+    raw_ = nullptr;
+    data_ = nullptr;
+  }
+
+  void* raw_;         /// Allocated memory
+  T* data_;           /// First element
+  std::size_t size_;  /// Number of constructed elements
+};
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+namespace detail {
+
+/// @brief Returns bounds of a layout as dilated integers.
+inline morton::detail::dilated_bounds<2> bounds_of(const layout& l) noexcept {
+  morton::detail::dilated_bounds<2> b;
+  b.masks[0] = l.mask_x();
+  b.masks[1] = l.mask_y();
+  b.limits[0] = 0;
+  b.limits[1] = 0;
+  if (l.size() > 0) {
+    b.limits[0] = l.index(l.width() - 1, 0) + 1;
+    b.limits[1] = l.index(0, l.height() - 1) + 1;
+  }
+  return b;
+}
+
+}  // namespace detail
+
+/// @brief Dense two-dimensional grid whose elements are stored in Z-order.
+///
+/// Elements are stored in morton2d::layout, so that neighbors in both axes
+/// are close in memory. Elements in the padding of the layout are
+/// default-constructed but never visited by iterators.
+/// @tparam T Element type, which is default constructible
+/// @tparam Alignment Alignment of the storage in bytes
+template <typename T, std::size_t Alignment = 64>
+class grid {
+ public:
+  using value_type = T;
+  using iterator = morton::detail::zorder_iterator<T, 2>;
+  using const_iterator = morton::detail::zorder_iterator<const T, 2>;
+  using range = morton::detail::zorder_range<T, 2>;
+  using const_range = morton::detail::zorder_range<const T, 2>;
+
+  grid() : grid(0, 0) {}
+
+  /// @param[in] width Number of elements along x axis
+  /// @param[in] height Number of elements along y axis
+  grid(std::size_t width, std::size_t height)
+      : layout_{width, height},
+        bounds_(detail::bounds_of(layout_)),
+        storage_{layout_.size()} {}
+
+  /// @param[in] width Number of elements along x axis
+  /// @param[in] height Number of elements along y axis
+  /// @param[in] value Initial value of elements
+  grid(std::size_t width, std::size_t height, const T& value)
+      : grid(width, height) {
+    fill(value);
+  }
+
+  /// @brief Layout of the storage
+  const morton2d::layout& layout() const noexcept { return layout_; }
+
+  std::size_t width() const noexcept { return layout_.width(); }
+  std::size_t height() const noexcept { return layout_.height(); }
+
+  /// @brief Number of elements, excluding the padding
+  std::size_t size() const noexcept { return width() * height(); }
+
+  /// @brief Storage of l.size() elements in Z-order layout
+  T* data() noexcept { return storage_.data(); }
+  const T* data() const noexcept { return storage_.data(); }
+
+  /// @brief Returns an element.
+  /// @param[in] x X coordinate
+  /// @param[in] y Y coordinate
+  T& operator()(std::size_t x, std::size_t y) noexcept {
+    return storage_[layout_.index(x, y)];
+  }
+
+  const T& operator()(std::size_t x, std::size_t y) const noexcept {
+    return storage_[layout_.index(x, y)];
+  }
+
+  /// @brief Sets a value to every element.
+  void fill(const T& value) {
+    for (std::size_t i = 0; i < storage_.size(); ++i) storage_[i] = value;
+  }
+
+  /// @brief Visits every element in Z-order.
+  iterator begin() noexcept { return all().begin(); }
+  iterator end() noexcept { return all().end(); }
+  const_iterator begin() const noexcept { return all().begin(); }
+  const_iterator end() const noexcept { return all().end(); }
+
+  /// @brief Returns every element in Z-order.
+  range all() noexcept {
+    return range(data(), &bounds_, 0, layout_.mask_x() | layout_.mask_y(),
+                 size());
+  }
+
+  const_range all() const noexcept {
+    return const_range(data(), &bounds_, 0,
+                       layout_.mask_x() | layout_.mask_y(), size());
+  }
+
+  /// @brief Returns elements in a row in increasing order of x.
+  /// @param[in] y Y coordinate of the row
+  range row(std::size_t y) noexcept {
+    return range(data(), &bounds_, layout_.index(0, y), layout_.mask_x(),
+                 width());
+  }
+
+  const_range row(std::size_t y) const noexcept {
+    return const_range(data(), &bounds_, layout_.index(0, y),
+                       layout_.mask_x(), width());
+  }
+
+  /// @brief Copies elements from a row-major array.
+  void assign_row_major(const T* src) { swizzle(src, data(), layout_); }
+
+  /// @brief Copies elements to a row-major array.
+  void copy_row_major(T* dst) const { unswizzle(data(), dst, layout_); }
+
+ private:
+  morton2d::layout layout_;
+  morton::detail::dilated_bounds<2> bounds_;
+  morton::detail::aligned_buffer<T, Alignment> storage_;
+};
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+namespace detail {
+
+/// @brief Returns bounds of a layout as dilated integers.
+inline morton::detail::dilated_bounds<3> bounds_of(const layout& l) noexcept {
+  morton::detail::dilated_bounds<3> b;
+  b.masks[0] = l.mask_x();
+  b.masks[1] = l.mask_y();
+  b.masks[2] = l.mask_z();
+  b.limits[0] = 0;
+  b.limits[1] = 0;
+  b.limits[2] = 0;
+  if (l.size() > 0) {
+    b.limits[0] = l.index(l.width() - 1, 0, 0) + 1;
+    b.limits[1] = l.index(0, l.height() - 1, 0) + 1;
+    b.limits[2] = l.index(0, 0, l.depth() - 1) + 1;
+  }
+  return b;
+}
+
+}  // namespace detail
+
+/// @brief Dense three-dimensional grid whose elements are stored in Z-order.
+///
+/// Elements are stored in morton3d::layout, so that neighbors in all axes
+/// are close in memory. Elements in the padding of the layout are
+/// default-constructed but never visited by iterators.
+/// @tparam T Element type, which is default constructible
+/// @tparam Alignment Alignment of the storage in bytes
+template <typename T, std::size_t Alignment = 64>
+class grid {
+ public:
+  using value_type = T;
+  using iterator = morton::detail::zorder_iterator<T, 3>;
+  using const_iterator = morton::detail::zorder_iterator<const T, 3>;
+  using range = morton::detail::zorder_range<T, 3>;
+  using const_range = morton::detail::zorder_range<const T, 3>;
+
+  grid() : grid(0, 0, 0) {}
+
+  /// @param[in] width Number of elements along x axis
+  /// @param[in] height Number of elements along y axis
+  /// @param[in] depth Number of elements along z axis
+  grid(std::size_t width, std::size_t height, std::size_t depth)
+      : layout_{width, height, depth},
+        bounds_(detail::bounds_of(layout_)),
+        storage_{layout_.size()} {}
+
+  /// @param[in] width Number of elements along x axis
+  /// @param[in] height Number of elements along y axis
+  /// @param[in] depth Number of elements along z axis
+  /// @param[in] value Initial value of elements
+  grid(std::size_t width, std::size_t height, std::size_t depth,
+       const T& value)
+      : grid(width, height, depth) {
+    fill(value);
+  }
+
+  /// @brief Layout of the storage
+  const morton3d::layout& layout() const noexcept { return layout_; }
+
+  std::size_t width() const noexcept { return layout_.width(); }
+  std::size_t height() const noexcept { return layout_.height(); }
+  std::size_t depth() const noexcept { return layout_.depth(); }
+
+  /// @brief Number of elements, excluding the padding
+  std::size_t size() const noexcept { return width() * height() * depth(); }
+
+  /// @brief Storage of l.size() elements in Z-order layout
+  T* data() noexcept { return storage_.data(); }
+  const T* data() const noexcept { return storage_.data(); }
+
+  /// @brief Returns an element.
+  /// @param[in] x X coordinate
+  /// @param[in] y Y coordinate
+  /// @param[in] z Z coordinate
+  T& operator()(std::size_t x, std::size_t y, std::size_t z) noexcept {
+    return storage_[layout_.index(x, y, z)];
+  }
+
+  const T& operator()(std::size_t x, std::size_t y, std::size_t z) const
+      noexcept {
+    return storage_[layout_.index(x, y, z)];
+  }
+
+  /// @brief Sets a value to every element.
+  void fill(const T& value) {
+    for (std::size_t i = 0; i < storage_.size(); ++i) storage_[i] = value;
+  }
+
+  /// @brief Visits every element in Z-order.
+  iterator begin() noexcept { return all().begin(); }
+  iterator end() noexcept { return all().end(); }
+  const_iterator begin() const noexcept { return all().begin(); }
+  const_iterator end() const noexcept { return all().end(); }
+
+  /// @brief Returns every element in Z-order.
+  range all() noexcept {
+    return range(data(), &bounds_, 0,
+                 layout_.mask_x() | layout_.mask_y() | layout_.mask_z(),
+                 size());
+  }
+
+  const_range all() const noexcept {
+    return const_range(data(), &bounds_, 0,
+                       layout_.mask_x() | layout_.mask_y() | layout_.mask_z(),
+                       size());
+  }
+
+  /// @brief Returns elements in a row in increasing order of x.
+  /// @param[in] y Y coordinate of the row
+  /// @param[in] z Z coordinate of the row
+  range row(std::size_t y, std::size_t z) noexcept {
+    return range(data(), &bounds_, layout_.index(0, y, z), layout_.mask_x(),
+                 width());
+  }
+
+  const_range row(std::size_t y, std::size_t z) const noexcept {
+    return const_range(data(), &bounds_, layout_.index(0, y, z),
+                       layout_.mask_x(), width());
+  }
+
+  /// @brief Returns elements in a slab of a constant z in Z-order of x and y.
+  /// @param[in] z Z coordinate of the slab
+  range slab(std::size_t z) noexcept {
+    return range(data(), &bounds_, layout_.index(0, 0, z),
+                 layout_.mask_x() | layout_.mask_y(), width() * height());
+  }
+
+  const_range slab(std::size_t z) const noexcept {
+    return const_range(data(), &bounds_, layout_.index(0, 0, z),
+                       layout_.mask_x() | layout_.mask_y(),
+                       width() * height());
+  }
+
+  /// @brief Copies elements from a row-major array.
+  void assign_row_major(const T* src) { swizzle(src, data(), layout_); }
+
+  /// @brief Copies elements to a row-major array.
+  void copy_row_major(T* dst) const { unswizzle(data(), dst, layout_); }
+
+ private:
+  morton3d::layout layout_;
+  morton::detail::dilated_bounds<3> bounds_;
+  morton::detail::aligned_buffer<T, Alignment> storage_;
+};
+
+}  // namespace morton3d
+
+#endif  // MORTON_GRID_HPP
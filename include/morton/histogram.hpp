@@ -0,0 +1,409 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_HISTOGRAM_HPP
+#define MORTON_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+#include "morton/parallel.hpp"
+#include "morton/partition.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Number of items in every cell of a level.
+///
+/// Cells are identified by morton codes truncated to the level, i.e. morton
+/// codes of cell coordinates in the grid of the level. Counts are held in a
+/// dense array indexed by the cell if the grid is small, or as non-empty
+/// cells sorted in increasing order otherwise.
+/// @tparam Code morton_code type
+template <typename Code>
+class basic_histogram {
+ public:
+  /// @brief Count of a non-empty cell
+  struct bin {
+    Code cell;          /// Cell
+    std::size_t count;  /// Number of items in the cell
+  };
+
+  /// @brief Constructs a dense histogram.
+  /// @param[in] level Level of cells
+  /// @param[in] counts Counts of all the cells
+  basic_histogram(unsigned int level, std::vector<std::size_t> counts)
+      : level_{level}, dense_{true}, counts_(std::move(counts)), bins_() {}
+
+  /// @brief Constructs a sparse histogram.
+  /// @param[in] level Level of cells
+  /// @param[in] bins Non-empty cells in increasing order
+  basic_histogram(unsigned int level, std::vector<bin> bins)
+      : level_{level}, dense_{false}, counts_(), bins_(std::move(bins)) {}
+
+  /// @brief Level of cells from the root
+  unsigned int level() const noexcept { return level_; }
+
+  /// @brief Check if counts are held in a dense array.
+  bool is_dense() const noexcept { return dense_; }
+
+  /// @brief Returns the number of items in a cell.
+  std::size_t count(const Code cell) const noexcept {
+    if (dense_) {
+      return cell.value < counts_.size()
+                 ? counts_[static_cast<std::size_t>(cell.value)]
+                 : 0;
+    }
+    const auto it = std::lower_bound(
+        bins_.begin(), bins_.end(), cell,
+        [](const bin& b, const Code c) { return b.cell.value < c.value; });
+    return it != bins_.end() && it->cell == cell ? it->count : 0;
+  }
+
+  /// @brief Counts of all the cells indexed by cells. Empty unless dense.
+  const std::vector<std::size_t>& dense_counts() const noexcept {
+    return counts_;
+  }
+
+  /// @brief Returns non-empty cells in increasing order.
+  std::vector<bin> bins() const {
+    if (!dense_) return bins_;
+    std::vector<bin> result;
+    for (std::size_t c = 0; c < counts_.size(); ++c) {
+      if (counts_[c] > 0) {
+        result.push_back({Code{static_cast<typename Code::value_type>(c)},
+                          counts_[c]});
+      }
+    }
+    return result;
+  }
+
+ private:
+  unsigned int level_;               /// Level of cells
+  bool dense_;                       /// True if counts_ is used
+  std::vector<std::size_t> counts_;  /// Counts of all the cells
+  std::vector<bin> bins_;            /// Non-empty cells
+};
+
+/// @brief Returns the number of bits dropped from codes to get cells.
+template <unsigned int Dimension, typename Traits>
+unsigned int cell_shift(unsigned int level) noexcept {
+  assert(level <= Traits::bits && "Level is deeper than leaves");
+  return Dimension * (Traits::bits - level);
+}
+
+/// @brief Check if a dense array is used for a level.
+///
+/// A dense array is used as long as it is not much larger than the input, so
+/// that memory stays proportional to the number of items.
+template <unsigned int Dimension>
+bool use_dense_histogram(std::size_t n, unsigned int level) noexcept {
+  constexpr std::size_t min_dense = std::size_t(1) << 16;
+  const unsigned int bits = Dimension * level;
+  if (bits >= static_cast<unsigned int>(
+                  std::numeric_limits<std::size_t>::digits - 2)) {
+    return false;
+  }
+  return (std::size_t(1) << bits) <= std::max(2 * n, min_dense);
+}
+
+/// @brief Adds counts of cells of codes into a dense array.
+///
+/// Codes are truncated a chunk at a time, so that the shifts are vectorized
+/// separately from the scattered increments.
+template <typename Code>
+void count_cells(const Code* codes, std::size_t n, unsigned int shift,
+                 std::size_t* counts) noexcept {
+  using T = typename Code::value_type;
+  if (shift >= static_cast<unsigned int>(std::numeric_limits<T>::digits)) {
+    counts[0] += n;
+    return;
+  }
+  constexpr std::size_t chunk = 256;
+  T cells[chunk];
+  for (std::size_t i = 0; i < n; i += chunk) {
+    const std::size_t m = std::min(chunk, n - i);
+    for (std::size_t j = 0; j < m; ++j) cells[j] = codes[i + j].value >> shift;
+    for (std::size_t j = 0; j < m; ++j) ++counts[cells[j]];
+  }
+}
+
+/// @brief Calls f(cell, first, last) for every run of codes of a cell in
+/// sorted codes [first, last).
+///
+/// The end of a run is found by galloping, so that the cost is logarithmic in
+/// the length of every run.
+template <typename Code, typename F>
+void for_each_run(const Code* codes, std::size_t first, std::size_t last,
+                  unsigned int shift, const F& f) {
+  using T = typename Code::value_type;
+  const auto cell = [shift](const Code& c) -> T {
+    return shift < std::numeric_limits<T>::digits ? c.value >> shift : T(0);
+  };
+  std::size_t i = first;
+  while (i < last) {
+    const T c = cell(codes[i]);
+    std::size_t lo = i + 1, step = 1;
+    while (lo + step <= last && cell(codes[lo + step - 1]) == c) {
+      lo += step;
+      step *= 2;
+    }
+    const std::size_t hi = std::min(lo + step, last);
+    const std::size_t end = static_cast<std::size_t>(
+        std::partition_point(codes + lo, codes + hi,
+                             [&](const Code& m) { return cell(m) == c; }) -
+        codes);
+    f(c, i, end);
+    i = end;
+  }
+}
+
+/// @brief Merges two sorted lists of bins adding counts of the same cell.
+template <typename Bin>
+std::vector<Bin> merge_bins(const std::vector<Bin>& a,
+                            const std::vector<Bin>& b) {
+  std::vector<Bin> result;
+  result.reserve(a.size() + b.size());
+  std::size_t i = 0, j = 0;
+  while (i < a.size() && j < b.size()) {
+    if (a[i].cell.value < b[j].cell.value) {
+      result.push_back(a[i++]);
+    } else if (b[j].cell.value < a[i].cell.value) {
+      result.push_back(b[j++]);
+    } else {
+      result.push_back({a[i].cell, a[i].count + b[j].count});
+      ++i;
+      ++j;
+    }
+  }
+  result.insert(result.end(), a.begin() + i, a.end());
+  result.insert(result.end(), b.begin() + j, b.end());
+  return result;
+}
+
+/// @brief Counts codes in every cell of a level.
+/// @param[in] codes Morton codes in any order
+template <unsigned int Dimension, typename Traits, typename Code>
+basic_histogram<Code> occupancy(const Code* codes, std::size_t n,
+                                unsigned int level,
+                                unsigned int num_threads) {
+  using T = typename Code::value_type;
+  using bin = typename basic_histogram<Code>::bin;
+  const unsigned int shift = cell_shift<Dimension, Traits>(level);
+  std::size_t t = num_blocks(n, num_threads);
+
+  if (use_dense_histogram<Dimension>(n, level)) {
+    const std::size_t num_cells = std::size_t(1) << (Dimension * level);
+    // Every thread but the first counts into its own array, which should not
+    // be larger than its share of codes.
+    t = std::max<std::size_t>(1, std::min(t, n / num_cells));
+    std::vector<std::size_t> counts(num_cells, 0);
+    std::vector<std::vector<std::size_t>> partial(t - 1);
+    run_in_parallel(t, [&](std::size_t b) {
+      std::size_t* dst = counts.data();
+      if (b > 0) {
+        partial[b - 1].assign(num_cells, 0);
+        dst = partial[b - 1].data();
+      }
+      const std::size_t first = block_begin(n, t, b);
+      count_cells(codes + first, block_begin(n, t, b + 1) - first, shift,
+                  dst);
+    });
+    if (t > 1) {
+      run_in_parallel(t, [&](std::size_t b) {
+        const std::size_t last = block_begin(num_cells, t, b + 1);
+        for (auto&& p : partial) {
+          for (std::size_t c = block_begin(num_cells, t, b); c < last; ++c) {
+            counts[c] += p[c];
+          }
+        }
+      });
+    }
+    return {level, std::move(counts)};
+  }
+
+  // Every thread sorts cells of its block and counts runs, and sorted lists
+  // of bins are then merged in pairs.
+  std::vector<std::vector<bin>> lists(t);
+  run_in_parallel(t, [&](std::size_t b) {
+    const std::size_t first = block_begin(n, t, b);
+    const std::size_t last = block_begin(n, t, b + 1);
+    std::vector<T> cells(last - first);
+    for (std::size_t i = first; i < last; ++i) {
+      cells[i - first] = codes[i].value >> shift;
+    }
+    std::sort(cells.begin(), cells.end());
+    std::size_t num_bins = cells.empty() ? 0 : 1;
+    for (std::size_t i = 1; i < cells.size(); ++i) {
+      num_bins += cells[i] != cells[i - 1] ? 1 : 0;
+    }
+    lists[b].reserve(num_bins);
+    for (std::size_t i = 0; i < cells.size();) {
+      std::size_t j = i + 1;
+      while (j < cells.size() && cells[j] == cells[i]) ++j;
+      lists[b].push_back({Code{cells[i]}, j - i});
+      i = j;
+    }
+  });
+  for (std::size_t width = 1; width < t; width *= 2) {
+    const std::size_t pairs = (t + 2 * width - 1) / (2 * width);
+    run_in_parallel(pairs, [&](std::size_t p) {
+      const std::size_t i = 2 * width * p;
+      if (i + width < t) {
+        lists[i] = merge_bins(lists[i], lists[i + width]);
+        std::vector<bin>().swap(lists[i + width]);
+      }
+    });
+  }
+  return {level, std::move(lists[0])};
+}
+
+/// @brief Counts codes in every cell of a level.
+/// @param[in] codes Morton codes sorted in increasing order
+template <unsigned int Dimension, typename Traits, typename Code>
+basic_histogram<Code> sorted_occupancy(const Code* codes, std::size_t n,
+                                       unsigned int level,
+                                       unsigned int num_threads) {
+  using T = typename Code::value_type;
+  using bin = typename basic_histogram<Code>::bin;
+  const unsigned int shift = cell_shift<Dimension, Traits>(level);
+  const std::size_t t = num_blocks(n, num_threads);
+  // Blocks do not share cells, so that threads write disjoint counts.
+  const auto offsets = partition_sorted<Dimension, Traits>(
+      codes, n, t, level, unit_weights{});
+
+  if (use_dense_histogram<Dimension>(n, level)) {
+    std::vector<std::size_t> counts(std::size_t(1) << (Dimension * level), 0);
+    run_in_parallel(t, [&](std::size_t b) {
+      for_each_run(codes, offsets[b], offsets[b + 1], shift,
+                   [&](T c, std::size_t first, std::size_t last) {
+                     counts[static_cast<std::size_t>(c)] = last - first;
+                   });
+    });
+    return {level, std::move(counts)};
+  }
+
+  // Runs are counted first, so that every thread writes its bins in place.
+  std::vector<std::size_t> num_bins(t + 1, 0);
+  run_in_parallel(t, [&](std::size_t b) {
+    for_each_run(codes, offsets[b], offsets[b + 1], shift,
+                 [&](T, std::size_t, std::size_t) { ++num_bins[b + 1]; });
+  });
+  for (std::size_t b = 0; b < t; ++b) num_bins[b + 1] += num_bins[b];
+  std::vector<bin> bins(num_bins[t]);
+  run_in_parallel(t, [&](std::size_t b) {
+    bin* dst = bins.data() + num_bins[b];
+    for_each_run(codes, offsets[b], offsets[b + 1], shift,
+                 [&](T c, std::size_t first, std::size_t last) {
+                   *dst++ = bin{Code{c}, last - first};
+                 });
+  });
+  return {level, std::move(bins)};
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Number of items in every quadtree cell of a level.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using histogram = morton::detail::basic_histogram<morton_code<T>>;
+
+/// @brief Counts morton codes in every quadtree cell of a level.
+///
+/// Codes are truncated to the level and counted by multiple threads. A dense
+/// array is used unless the grid of the level has many more cells than codes.
+/// @tparam T Integral type for morton_code
+/// @param[in] codes Morton codes in any order
+/// @param[in] n Number of codes
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits)
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+template <typename T>
+histogram<T> occupancy(const morton_code<T>* codes, std::size_t n,
+                       unsigned int level, unsigned int num_threads = 0) {
+  return morton::detail::occupancy<2, morton_traits<T>>(codes, n, level,
+                                                        num_threads);
+}
+
+/// @brief Counts sorted morton codes in every quadtree cell of a level.
+///
+/// The end of the codes in a cell is found by binary search, so that the
+/// cost is proportional to the number of non-empty cells rather than codes.
+/// @tparam T Integral type for morton_code
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] n Number of codes
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits)
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+template <typename T>
+histogram<T> sorted_occupancy(const morton_code<T>* codes, std::size_t n,
+                              unsigned int level,
+                              unsigned int num_threads = 0) {
+  return morton::detail::sorted_occupancy<2, morton_traits<T>>(
+      codes, n, level, num_threads);
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Number of items in every octree cell of a level.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using histogram = morton::detail::basic_histogram<morton_code<T>>;
+
+/// @brief Counts morton codes in every octree cell of a level.
+///
+/// Codes are truncated to the level and counted by multiple threads. A dense
+/// array is used unless the grid of the level has many more cells than codes.
+/// @tparam T Integral type for morton_code
+/// @param[in] codes Morton codes in any order
+/// @param[in] n Number of codes
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits)
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+template <typename T>
+histogram<T> occupancy(const morton_code<T>* codes, std::size_t n,
+                       unsigned int level, unsigned int num_threads = 0) {
+  return morton::detail::occupancy<3, morton_traits<T>>(codes, n, level,
+                                                        num_threads);
+}
+
+/// @brief Counts sorted morton codes in every octree cell of a level.
+///
+/// The end of the codes in a cell is found by binary search, so that the
+/// cost is proportional to the number of non-empty cells rather than codes.
+/// @tparam T Integral type for morton_code
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] n Number of codes
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits)
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+template <typename T>
+histogram<T> sorted_occupancy(const morton_code<T>* codes, std::size_t n,
+                              unsigned int level,
+                              unsigned int num_threads = 0) {
+  return morton::detail::sorted_occupancy<3, morton_traits<T>>(
+      codes, n, level, num_threads);
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_HISTOGRAM_HPP
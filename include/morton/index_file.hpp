@@ -0,0 +1,666 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_INDEX_FILE_HPP
+#define MORTON_INDEX_FILE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MORTON_INDEX_FILE_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// @brief Bytes of a payload in an index file
+struct byte_span {
+  const unsigned char* data;  /// First byte
+  std::size_t size;           /// Number of bytes
+};
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Header at the beginning of an index file.
+///
+/// An index file consists of the header followed by sections aligned to
+/// index_file_alignment bytes. Integers are stored in the byte order of the
+/// machine which wrote the file.
+/// - codes: sorted morton codes
+/// - payload offsets: n + 1 offsets of payloads of codes in the payload
+/// - directory blocks: skip table of the directory, an
+///   index_directory_block for every index_directory_block_size non-empty
+///   cells of a level
+/// - directory deltas: for every cell in increasing order, a varint of the
+///   difference of its key from the previous key, omitted for the first cell
+///   of a block, followed by a varint of its number of codes
+/// - payload: bytes of payloads
+///
+/// The directory takes about two bytes per cell instead of twelve for plain
+/// keys and indices. A search finds a block by a binary search of the skip
+/// table and decodes at most one block.
+struct index_file_header {
+  char magic[8];                     /// "MORTONIX"
+  uint32_t version;                  /// Format version
+  uint32_t byte_order;               /// 0x01020304 in the writer's order
+  uint32_t dimension;                /// Number of dimensions
+  uint32_t code_bytes;               /// Size of a morton code
+  uint32_t directory_level;          /// Level of cells of the directory
+  uint32_t reserved;                 /// Zero
+  uint64_t num_codes;                /// Number of codes
+  uint64_t num_cells;                /// Number of cells in the directory
+  uint64_t codes_offset;             /// Offset of codes
+  uint64_t payload_offsets_offset;   /// Offset of payload offsets, or 0
+  uint64_t directory_blocks_offset;  /// Offset of directory blocks, or 0
+  uint64_t directory_deltas_offset;  /// Offset of directory deltas, or 0
+  uint64_t directory_deltas_size;    /// Number of bytes of directory deltas
+  uint64_t payload_offset;           /// Offset of the payload, or 0
+  uint64_t payload_size;             /// Number of bytes of the payload
+  uint64_t file_size;                /// Size of the whole file
+};
+
+/// @brief Entry of the skip table of the directory of an index file, which
+/// samples the first cell of a block of cells.
+struct index_directory_block {
+  uint32_t key;       /// Key of the first cell
+  uint32_t reserved;  /// Zero
+  uint64_t first;     /// Index of the first code of the first cell
+  uint64_t position;  /// Offset of the block in directory deltas
+};
+
+/// Current format version
+constexpr uint32_t index_file_version = 2;
+/// Number of cells of the directory in a block
+constexpr uint64_t index_directory_block_size = 64;
+/// Alignment of sections, which is a multiple of cache line sizes
+constexpr uint64_t index_file_alignment = 64;
+/// Magic number at the beginning of index files
+constexpr char index_file_magic[8] = {'M', 'O', 'R', 'T', 'O', 'N', 'I', 'X'};
+
+/// @brief Returns an offset rounded up to the alignment of sections.
+inline uint64_t align_section(uint64_t offset) noexcept {
+  return (offset + index_file_alignment - 1) & ~(index_file_alignment - 1);
+}
+
+/// @brief Returns the number of blocks of a directory.
+inline uint64_t num_directory_blocks(uint64_t num_cells) noexcept {
+  return num_cells / index_directory_block_size +
+         (num_cells % index_directory_block_size != 0 ? 1 : 0);
+}
+
+/// @brief Appends an integer as a varint of 7 bits per byte from the least
+/// significant bits.
+inline void put_varint(std::vector<unsigned char>& bytes, uint64_t v) {
+  for (; v >= 0x80; v >>= 7) {
+    bytes.push_back(static_cast<unsigned char>(v | 0x80));
+  }
+  bytes.push_back(static_cast<unsigned char>(v));
+}
+
+/// @brief Reads a varint before an end.
+/// @returns The byte after the varint, or nullptr if it runs past the end or
+/// exceeds 64 bits.
+inline const unsigned char* get_varint(const unsigned char* p,
+                                       const unsigned char* end,
+                                       uint64_t& v) noexcept {
+  v = 0;
+  for (unsigned int shift = 0; p != end && shift < 64; shift += 7) {
+    const unsigned char byte = *p++;
+    v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return p;
+  }
+  return nullptr;
+}
+
+/// @brief Read-only view of a whole file.
+///
+/// The file is mapped into memory on POSIX systems, so that pages are read
+/// lazily and shared between processes. Otherwise, it is read into a buffer.
+class mapped_file {
+ public:
+  mapped_file() noexcept : data_{nullptr}, size_{0} {}
+  ~mapped_file() { close(); }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  mapped_file(mapped_file&& other) noexcept
+      : data_{other.data_}, size_{other.size_},
+        buffer_(std::move(other.buffer_)) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+
+  mapped_file& operator=(mapped_file&& other) noexcept {
+    if (this != &other) {
+      close();
+      data_ = other.data_;
+      size_ = other.size_;
+      buffer_ = std::move(other.buffer_);
+      other.data_ = nullptr;
+      other.size_ = 0;
+    }
+    return *this;
+  }
+
+  /// @brief Opens a file.
+  /// @returns False if the file cannot be opened.
+  bool open(const char* path) {
+    close();
+#ifdef MORTON_INDEX_FILE_USE_MMAP
+    const int fd = ::open(path, O_RDONLY);
+    if (fd == -1) return false;
+    struct stat st;
+    if (::fstat(fd, &st) == -1 || st.st_size <= 0) {
+      ::close(fd);
+      return false;
+    }
+    void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                     PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    data_ = static_cast<const unsigned char*>(p);
+    size_ = static_cast<std::size_t>(st.st_size);
+    return true;
+#else
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+    unsigned char chunk[1 << 16];
+    std::size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+      buffer_.insert(buffer_.end(), chunk, chunk + read);
+    }
+    const bool ok = !std::ferror(file) && !buffer_.empty();
+    std::fclose(file);
+    if (!ok) {
+      buffer_.clear();
+      return false;
+    }
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return true;
+#endif
+  }
+
+  /// @brief Closes the file.
+  void close() noexcept {
+#ifdef MORTON_INDEX_FILE_USE_MMAP
+    if (data_) ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    buffer_.clear();
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  /// @brief Returns the first byte of the file.
+  const unsigned char* data() const noexcept { return data_; }
+
+  /// @brief Returns the size of the file.
+  std::size_t size() const noexcept { return size_; }
+
+ private:
+  const unsigned char* data_;          /// First byte of the file
+  std::size_t size_;                   /// Size of the file
+  std::vector<unsigned char> buffer_;  /// Contents unless mapped
+};
+
+/// @brief Writes an index file of sorted morton codes and their payloads.
+/// @tparam Dimension Number of dimensions
+/// @tparam Traits morton_traits of codes
+/// @returns False if the file cannot be written.
+template <unsigned int Dimension, typename Traits, typename Code>
+bool write_index_file(const char* path, const Code* codes, std::size_t n,
+                      const uint64_t* payload_offsets, const void* payload,
+                      unsigned int directory_level) {
+  using T = typename Code::value_type;
+  assert(directory_level <= Traits::bits && "Level is deeper than leaves");
+  assert(Dimension * directory_level <= 32 &&
+         "Keys of the directory do not fit in 32 bits");
+  if (directory_level > Traits::bits || Dimension * directory_level > 32) {
+    return false;
+  }
+  assert(std::is_sorted(codes, codes + n) && "Codes are not sorted");
+
+  // Non-empty cells of the directory
+  std::vector<uint32_t> keys;
+  std::vector<uint64_t> firsts;
+  if (directory_level > 0) {
+    const unsigned int shift = Dimension * (Traits::bits - directory_level);
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto key = static_cast<uint32_t>(codes[i].value >> shift);
+      if (keys.empty() || keys.back() != key) {
+        keys.push_back(key);
+        firsts.push_back(i);
+      }
+    }
+    firsts.push_back(n);
+  }
+  std::vector<index_directory_block> blocks;
+  std::vector<unsigned char> deltas;
+  for (std::size_t c = 0; c < keys.size(); ++c) {
+    if (c % index_directory_block_size == 0) {
+      index_directory_block b;
+      std::memset(&b, 0, sizeof(b));
+      b.key = keys[c];
+      b.first = firsts[c];
+      b.position = deltas.size();
+      blocks.push_back(b);
+    } else {
+      put_varint(deltas, keys[c] - keys[c - 1]);
+    }
+    put_varint(deltas, firsts[c + 1] - firsts[c]);
+  }
+
+  index_file_header h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, index_file_magic, sizeof(h.magic));
+  h.version = index_file_version;
+  h.byte_order = 0x01020304;
+  h.dimension = Dimension;
+  h.code_bytes = sizeof(T);
+  h.directory_level = directory_level;
+  h.num_codes = n;
+  h.num_cells = keys.size();
+  uint64_t offset = align_section(sizeof(h));
+  h.codes_offset = offset;
+  offset = align_section(offset + n * sizeof(T));
+  if (payload_offsets) {
+    h.payload_offsets_offset = offset;
+    offset = align_section(offset + (n + 1) * sizeof(uint64_t));
+  }
+  if (!blocks.empty()) {
+    h.directory_blocks_offset = offset;
+    offset = align_section(offset +
+                           blocks.size() * sizeof(index_directory_block));
+    h.directory_deltas_offset = offset;
+    h.directory_deltas_size = deltas.size();
+    offset = align_section(offset + deltas.size());
+  }
+  if (payload_offsets) {
+    h.payload_offset = offset;
+    h.payload_size = payload_offsets[n];
+    offset += h.payload_size;
+  }
+  h.file_size = offset;
+
+  std::FILE* file = std::fopen(path, "wb");
+  if (!file) return false;
+  uint64_t written = 0;
+  bool ok = true;
+  const auto put = [&](uint64_t at, const void* p, uint64_t size) {
+    static const char zeros[index_file_alignment] = {};
+    while (ok && written < at) {
+      const auto pad = std::min<uint64_t>(at - written, sizeof(zeros));
+      ok = std::fwrite(zeros, 1, pad, file) == pad;
+      written += pad;
+    }
+    if (ok && size > 0) {
+      ok = std::fwrite(p, 1, size, file) == size;
+      written += size;
+    }
+  };
+  put(0, &h, sizeof(h));
+  std::vector<T> values(n);
+  for (std::size_t i = 0; i < n; ++i) values[i] = codes[i].value;
+  put(h.codes_offset, values.data(), n * sizeof(T));
+  if (payload_offsets) {
+    put(h.payload_offsets_offset, payload_offsets, (n + 1) * sizeof(uint64_t));
+  }
+  if (!blocks.empty()) {
+    put(h.directory_blocks_offset, blocks.data(),
+        blocks.size() * sizeof(index_directory_block));
+    put(h.directory_deltas_offset, deltas.data(), deltas.size());
+  }
+  if (payload_offsets) put(h.payload_offset, payload, h.payload_size);
+  put(h.file_size, nullptr, 0);
+  ok = std::fclose(file) == 0 && ok;
+  return ok;
+}
+
+/// @brief Read-only view of an index file of sorted morton codes.
+///
+/// Queries run directly on the file mapped into memory without copying.
+/// Searches first narrow down codes to a cell of the directory, if any, so
+/// that binary searches touch a few pages of the file. Finding the cell
+/// decodes at most one block of the compressed directory.
+/// @tparam Code Morton code type
+/// @tparam Traits morton_traits of the code
+/// @tparam Dimension Number of dimensions
+template <typename Code, typename Traits, unsigned int Dimension>
+class index_view {
+ public:
+  using value_type = Code;
+  using T = typename Code::value_type;
+
+  index_view() noexcept
+      : header_{}, codes_{nullptr}, payload_offsets_{nullptr},
+        blocks_{nullptr}, deltas_{nullptr}, payload_{nullptr} {}
+
+  /// @brief Opens an index file.
+  /// @returns False if the file cannot be opened, is corrupt, or does not
+  /// match the dimension and the code type.
+  bool open(const char* path) {
+    close();
+    if (!file_.open(path) || !validate()) {
+      close();
+      return false;
+    }
+    const unsigned char* base = file_.data();
+    const auto at = [base](uint64_t offset) {
+      return offset > 0 ? base + offset : nullptr;
+    };
+    codes_ = reinterpret_cast<const Code*>(base + header_.codes_offset);
+    payload_offsets_ =
+        reinterpret_cast<const uint64_t*>(at(header_.payload_offsets_offset));
+    blocks_ = reinterpret_cast<const index_directory_block*>(
+        at(header_.directory_blocks_offset));
+    deltas_ = at(header_.directory_deltas_offset);
+    payload_ = at(header_.payload_offset);
+    return true;
+  }
+
+  /// @brief Closes the file.
+  void close() noexcept {
+    file_.close();
+    *this = index_view{};
+  }
+
+  /// @brief Check if a file is open.
+  bool is_open() const noexcept { return file_.data() != nullptr; }
+
+  /// @brief Returns the number of codes.
+  std::size_t size() const noexcept {
+    return static_cast<std::size_t>(header_.num_codes);
+  }
+
+  /// @brief Returns the sorted codes.
+  const Code* codes() const noexcept { return codes_; }
+
+  /// @brief Returns the level of cells of the directory, or 0 if the file
+  /// has no directory.
+  unsigned int directory_level() const noexcept {
+    return blocks_ ? header_.directory_level : 0;
+  }
+
+  /// @brief Check if codes have payloads.
+  bool has_payload() const noexcept { return payload_offsets_ != nullptr; }
+
+  /// @brief Returns the payload of the i-th code, which is empty if codes
+  /// have no payloads.
+  byte_span payload(std::size_t i) const noexcept {
+    assert(i < size() && "Index out of range");
+    if (!payload_offsets_) return {nullptr, 0};
+    return {payload_ + payload_offsets_[i],
+            static_cast<std::size_t>(payload_offsets_[i + 1] -
+                                     payload_offsets_[i])};
+  }
+
+  /// @brief Returns the index of the first code not less than a code.
+  std::size_t lower_bound(const Code m) const noexcept {
+    return search(m, [](T a, T b) { return a < b; });
+  }
+
+  /// @brief Returns the index of the first code greater than a code.
+  std::size_t upper_bound(const Code m) const noexcept {
+    return search(m, [](T a, T b) { return !(b < a); });
+  }
+
+  /// @brief Returns indices [first, last) of codes equal to a code.
+  std::pair<std::size_t, std::size_t> equal_range(const Code m) const
+      noexcept {
+    return {lower_bound(m), upper_bound(m)};
+  }
+
+  /// @brief Returns indices [first, last) of codes in [lo, hi].
+  std::pair<std::size_t, std::size_t> range(const Code lo, const Code hi) const
+      noexcept {
+    const std::size_t first = lower_bound(lo);
+    return {first, std::max(first, upper_bound(hi))};
+  }
+
+ private:
+  /// @brief Check if the header and sections fit in the file, and offsets in
+  /// the sections point inside the sections they refer to.
+  ///
+  /// Payload offsets and the directory are read once, which touches every
+  /// page of them.
+  bool validate() noexcept {
+    if (file_.size() < sizeof(index_file_header)) return false;
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    const auto& h = header_;
+    const auto fits = [&](uint64_t offset, uint64_t count, uint64_t size) {
+      return offset % index_file_alignment == 0 && offset <= file_.size() &&
+             count <= (file_.size() - offset) / size;
+    };
+    if (std::memcmp(h.magic, index_file_magic, sizeof(h.magic)) != 0 ||
+        h.version != index_file_version || h.byte_order != 0x01020304 ||
+        h.dimension != Dimension || h.code_bytes != sizeof(T) ||
+        h.file_size != file_.size() ||
+        !fits(h.codes_offset, h.num_codes, sizeof(T))) {
+      return false;
+    }
+    if (h.payload_offsets_offset != 0 &&
+        (!fits(h.payload_offsets_offset, h.num_codes + 1, sizeof(uint64_t)) ||
+         h.payload_offset > file_.size() ||
+         h.payload_size > file_.size() - h.payload_offset)) {
+      return false;
+    }
+    if (h.directory_blocks_offset != 0 &&
+        (h.directory_level == 0 || h.directory_level > Traits::bits ||
+         Dimension * h.directory_level > 32 || h.num_cells == 0 ||
+         !fits(h.directory_blocks_offset, num_directory_blocks(h.num_cells),
+               sizeof(index_directory_block)) ||
+         h.directory_deltas_offset == 0 ||
+         !fits(h.directory_deltas_offset, h.directory_deltas_size, 1))) {
+      return false;
+    }
+    const unsigned char* base = file_.data();
+    // Payloads are in the payload section.
+    if (h.payload_offsets_offset != 0 &&
+        !valid_offsets(base + h.payload_offsets_offset, h.num_codes,
+                       h.payload_size)) {
+      return false;
+    }
+    if (h.directory_blocks_offset != 0 && !valid_directory(base)) {
+      return false;
+    }
+    return true;
+  }
+
+  /// @brief Check if cells of the directory have increasing keys within the
+  /// level and partition the codes, and the blocks sample them.
+  bool valid_directory(const unsigned char* base) const noexcept {
+    const auto& h = header_;
+    const auto* blocks = reinterpret_cast<const index_directory_block*>(
+        base + h.directory_blocks_offset);
+    const unsigned char* begin = base + h.directory_deltas_offset;
+    const unsigned char* end = begin + h.directory_deltas_size;
+    const uint64_t max_key =
+        (uint64_t(1) << (Dimension * h.directory_level)) - 1;
+    const unsigned char* p = begin;
+    uint64_t key = 0, first = 0;
+    for (uint64_t c = 0; c < h.num_cells; ++c) {
+      uint64_t delta = 0, count = 0;
+      if (c % index_directory_block_size == 0) {
+        const auto& b = blocks[c / index_directory_block_size];
+        if ((c > 0 && b.key <= key) || b.first != first ||
+            b.position != static_cast<uint64_t>(p - begin)) {
+          return false;
+        }
+        key = b.key;
+      } else if (!(p = get_varint(p, end, delta)) || delta == 0 ||
+                 delta > max_key - key) {
+        return false;
+      } else {
+        key += delta;
+      }
+      if (key > max_key || !(p = get_varint(p, end, count)) || count == 0 ||
+          count > h.num_codes - first) {
+        return false;
+      }
+      first += count;
+    }
+    return first == h.num_codes && p == end;
+  }
+
+  /// @brief Check if n + 1 offsets do not decrease and end at last.
+  static bool valid_offsets(const unsigned char* p, uint64_t n,
+                            uint64_t last) noexcept {
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(p);
+    for (uint64_t i = 0; i < n; ++i) {
+      if (offsets[i + 1] < offsets[i]) return false;
+    }
+    return offsets[n] == last;
+  }
+
+  /// @brief Returns the index of the first code c for which comp(c, m) is
+  /// false.
+  template <typename Compare>
+  std::size_t search(const Code m, const Compare& comp) const noexcept {
+    const T* codes = reinterpret_cast<const T*>(codes_);
+    std::size_t first = 0, last = size();
+    if (blocks_) {
+      // Codes in cells other than the cell of m are all less or greater.
+      const unsigned int shift =
+          Dimension * (Traits::bits - header_.directory_level);
+      const auto cell = find_cell(static_cast<uint32_t>(m.value >> shift));
+      first = cell.first;
+      last = cell.second;
+      if (first == last) return first;
+    }
+    return static_cast<std::size_t>(
+        std::partition_point(codes + first, codes + last,
+                             [&](T v) { return comp(v, m.value); }) -
+        codes);
+  }
+
+  /// @brief Returns indices [first, last) of codes in the cell of a key,
+  /// which are empty at the position of the cell if it has no codes.
+  std::pair<std::size_t, std::size_t> find_cell(const uint32_t key) const
+      noexcept {
+    const auto num_blocks =
+        static_cast<std::size_t>(num_directory_blocks(header_.num_cells));
+    const auto* b = std::upper_bound(
+        blocks_, blocks_ + num_blocks, key,
+        [](uint32_t k, const index_directory_block& e) { return k < e.key; });
+    if (b == blocks_) return {0, 0};
+    --b;
+    const uint64_t num_cells = std::min(
+        index_directory_block_size,
+        header_.num_cells -
+            static_cast<uint64_t>(b - blocks_) * index_directory_block_size);
+    const unsigned char* p = deltas_ + b->position;
+    const unsigned char* end = deltas_ + header_.directory_deltas_size;
+    uint64_t cell_key = b->key, first = b->first;
+    for (uint64_t c = 0; c < num_cells; ++c) {
+      uint64_t delta = 0, count = 0;
+      if (c > 0) p = get_varint(p, end, delta);
+      p = get_varint(p, end, count);
+      cell_key += delta;
+      if (cell_key >= key) {
+        const uint64_t last = cell_key == key ? first + count : first;
+        return {static_cast<std::size_t>(first),
+                static_cast<std::size_t>(last)};
+      }
+      first += count;
+    }
+    return {static_cast<std::size_t>(first), static_cast<std::size_t>(first)};
+  }
+
+  mapped_file file_;                     /// Mapped file
+  index_file_header header_;             /// Header of the file
+  const Code* codes_;                    /// Sorted codes
+  const uint64_t* payload_offsets_;      /// Offsets of payloads
+  const index_directory_block* blocks_;  /// Skip table of the directory
+  const unsigned char* deltas_;          /// Cells of the directory
+  const unsigned char* payload_;         /// Payload
+};
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+using morton::byte_span;
+
+/// @brief Read-only view of an index file of sorted 2D morton codes mapped
+/// into memory.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using index_view =
+    morton::detail::index_view<morton_code<T>, morton_traits<T>, 2>;
+
+/// @brief Writes an index file of sorted morton codes and their payloads,
+/// which is opened by index_view.
+/// @tparam T Integral type for morton_code
+/// @param[in] path Path of the file
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] n Number of codes
+/// @param[in] payload_offsets n + 1 offsets of the payload of every code in
+/// payload, or nullptr if codes have no payloads
+/// @param[in] payload Bytes of payloads
+/// @param[in] directory_level Level of quadtree cells of the directory up to
+/// 16, or 0 for no directory
+/// @returns False if the file cannot be written.
+template <typename T>
+bool write_index_file(const char* path, const morton_code<T>* codes,
+                      std::size_t n, const uint64_t* payload_offsets = nullptr,
+                      const void* payload = nullptr,
+                      unsigned int directory_level = 0) {
+  return morton::detail::write_index_file<2, morton_traits<T>>(
+      path, codes, n, payload_offsets, payload, directory_level);
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+using morton::byte_span;
+
+/// @brief Read-only view of an index file of sorted 3D morton codes mapped
+/// into memory.
+/// @tparam T Integral type for morton_code
+template <typename T>
+using index_view =
+    morton::detail::index_view<morton_code<T>, morton_traits<T>, 3>;
+
+/// @brief Writes an index file of sorted morton codes and their payloads,
+/// which is opened by index_view.
+/// @tparam T Integral type for morton_code
+/// @param[in] path Path of the file
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] n Number of codes
+/// @param[in] payload_offsets n + 1 offsets of the payload of every code in
+/// payload, or nullptr if codes have no payloads
+/// @param[in] payload Bytes of payloads
+/// @param[in] directory_level Level of octree cells of the directory up to
+/// 10, or 0 for no directory
+/// @returns False if the file cannot be written.
+template <typename T>
+bool write_index_file(const char* path, const morton_code<T>* codes,
+                      std::size_t n, const uint64_t* payload_offsets = nullptr,
+                      const void* payload = nullptr,
+                      unsigned int directory_level = 0) {
+  return morton::detail::write_index_file<3, morton_traits<T>>(
+      path, codes, n, payload_offsets, payload, directory_level);
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_INDEX_FILE_HPP
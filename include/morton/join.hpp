@@ -0,0 +1,372 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_JOIN_HPP
+#define MORTON_JOIN_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// @brief Reader of items in an array.
+///
+/// Readers are sources of items sorted by morton codes, which are consumed by
+/// merge_join one at a time.
+/// @tparam Item Item type
+template <typename Item>
+class span_reader {
+ public:
+  using value_type = Item;
+
+  /// @param[in] first Pointer to the first item
+  /// @param[in] last Pointer past the last item
+  span_reader(const Item* first, const Item* last) noexcept
+      : first_{first}, last_{last} {}
+
+  /// @brief Reads the next item.
+  /// @returns False if there are no more items.
+  bool next(Item& item) noexcept {
+    if (first_ == last_) return false;
+    item = *first_++;
+    return true;
+  }
+
+ private:
+  const Item* first_;  /// Next item
+  const Item* last_;   /// End of items
+};
+
+/// @brief Reader of items stored as raw bytes in a binary file.
+///
+/// Items are read in blocks into a buffer of a fixed size. The file is not
+/// closed by the reader.
+/// @tparam Item Trivially copyable item type
+template <typename Item>
+class file_reader {
+  static_assert(std::is_trivially_copyable<Item>::value,
+                "Item is not trivially copyable");
+
+ public:
+  using value_type = Item;
+
+  /// @param[in] file File opened in binary mode
+  /// @param[in] buffer_size Number of items read at a time
+  explicit file_reader(std::FILE* file, std::size_t buffer_size = 4096)
+      : file_{file}, buffer_(buffer_size > 0 ? buffer_size : 1), pos_{0},
+        size_{0}, error_{false} {}
+
+  /// @brief Reads the next item.
+  /// @returns False if there are no more items or reading failed.
+  bool next(Item& item) noexcept {
+    if (pos_ == size_) {
+      if (error_) return false;
+      size_ = std::fread(buffer_.data(), sizeof(Item), buffer_.size(), file_);
+      pos_ = 0;
+      if (size_ < buffer_.size()) error_ = std::ferror(file_) != 0;
+      if (size_ == 0) return false;
+    }
+    item = buffer_[pos_++];
+    return true;
+  }
+
+  /// @brief Check if reading failed before the end of the file.
+  bool error() const noexcept { return error_; }
+
+ private:
+  std::FILE* file_;           /// File
+  std::vector<Item> buffer_;  /// Items read from the file
+  std::size_t pos_;           /// Next item in the buffer
+  std::size_t size_;          /// Number of items in the buffer
+  bool error_;                /// True if reading failed
+};
+
+/// @brief Key of items which are morton codes themselves.
+struct identity_key {
+  template <typename Code>
+  const Code& operator()(const Code& code) const noexcept {
+    return code;
+  }
+};
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Returns bits of each coordinate in cells of a level.
+template <unsigned int Dimension, typename T>
+void cell_masks(unsigned int level, T (&masks)[Dimension]) noexcept {
+  for (unsigned int a = 0; a < Dimension; ++a) {
+    masks[a] = 0;
+    for (unsigned int i = 0; i < level; ++i) {
+      masks[a] |= T(1) << (Dimension * i + a);
+    }
+  }
+}
+
+/// @brief Returns the neighbor of a cell whose morton code is the largest.
+///
+/// Morton codes increase with every coordinate, so it is the +1 neighbor
+/// along every axis unless the cell is on the boundary.
+template <unsigned int Dimension, typename T>
+T max_neighbor(T cell, const T (&masks)[Dimension]) noexcept {
+  T result = 0;
+  for (unsigned int a = 0; a < Dimension; ++a) {
+    const T x = cell & masks[a];
+    result |= x == masks[a] ? x : ((x | ~masks[a]) + 1) & masks[a];
+  }
+  return result;
+}
+
+/// @brief Calls f(neighbor) for every neighbor of a cell sharing a face, an
+/// edge, or a corner with it inside the grid of a level.
+template <unsigned int Dimension, typename T, typename F>
+void for_each_neighbor(T cell, const T (&masks)[Dimension], const F& f) {
+  T values[Dimension][3];
+  bool valid[Dimension][3];
+  for (unsigned int a = 0; a < Dimension; ++a) {
+    const T m = masks[a];
+    const T x = cell & m;
+    values[a][0] = (x - 1) & m;
+    values[a][1] = x;
+    values[a][2] = ((x | ~m) + 1) & m;
+    valid[a][0] = x != 0;
+    valid[a][1] = true;
+    valid[a][2] = x != m;
+  }
+  unsigned int num = 1;
+  for (unsigned int a = 0; a < Dimension; ++a) num *= 3;
+  for (unsigned int k = 0; k < num; ++k) {
+    if (k == num / 2) continue;  // The cell itself
+    T n = 0;
+    bool inside = true;
+    for (unsigned int a = 0, r = k; a < Dimension; ++a, r /= 3) {
+      inside = inside && valid[a][r % 3];
+      n |= values[a][r % 3];
+    }
+    if (inside) f(n);
+  }
+}
+
+/// @brief Merge-joins two streams of items sorted by morton codes.
+/// @tparam Dimension Number of dimensions
+/// @tparam Traits morton_traits of codes
+template <unsigned int Dimension, typename Traits, typename ReaderA,
+          typename ReaderB, typename Key, typename F>
+void merge_join(ReaderA& a, ReaderB& b, unsigned int level, bool neighbors,
+                const Key& key, const F& f) {
+  using A = typename ReaderA::value_type;
+  using B = typename ReaderB::value_type;
+  using T = typename std::decay<decltype(key(std::declval<const A&>()))>::type::
+      value_type;
+  assert(level <= Traits::bits && "Level is deeper than leaves");
+  const unsigned int shift = Dimension * (Traits::bits - level);
+  const auto cell = [&](T value) -> T {
+    return shift < static_cast<unsigned int>(std::numeric_limits<T>::digits)
+               ? value >> shift
+               : T(0);
+  };
+
+  A item_a;
+  B item_b;
+  bool has_a = a.next(item_a);
+  bool has_b = b.next(item_b);
+  std::vector<A> group_a;
+  std::vector<B> group_b;
+
+  // Groups of past cells which have neighbors not visited yet, and a queue of
+  // them ordered by the last neighbors after which they are dropped
+  T masks[Dimension];
+  cell_masks<Dimension>(level, masks);
+  using retained_groups = std::pair<std::vector<A>, std::vector<B>>;
+  std::unordered_map<T, retained_groups> retained;
+  using expiry = std::pair<T, T>;  // (last neighbor, cell)
+  std::priority_queue<expiry, std::vector<expiry>, std::greater<expiry>>
+      expiries;
+
+  while (has_a || has_b) {
+    T c;
+    if (has_a && has_b) {
+      c = std::min(cell(key(item_a).value), cell(key(item_b).value));
+    } else {
+      c = has_a ? cell(key(item_a).value) : cell(key(item_b).value);
+    }
+    group_a.clear();
+    while (has_a && cell(key(item_a).value) == c) {
+      group_a.push_back(item_a);
+      has_a = a.next(item_a);
+    }
+    group_b.clear();
+    while (has_b && cell(key(item_b).value) == c) {
+      group_b.push_back(item_b);
+      has_b = b.next(item_b);
+    }
+    assert((!has_a || cell(key(item_a).value) > c) &&
+           (!has_b || cell(key(item_b).value) > c) && "Items are not sorted");
+
+    for (auto&& x : group_a) {
+      for (auto&& y : group_b) f(x, y);
+    }
+    if (!neighbors) continue;
+
+    while (!expiries.empty() && expiries.top().first < c) {
+      retained.erase(expiries.top().second);
+      expiries.pop();
+    }
+    // Pairs with neighbors visited before
+    for_each_neighbor<Dimension>(c, masks, [&](T n) {
+      if (n > c) return;
+      const auto it = retained.find(n);
+      if (it == retained.end()) return;
+      for (auto&& x : it->second.first) {
+        for (auto&& y : group_b) f(x, y);
+      }
+      for (auto&& x : group_a) {
+        for (auto&& y : it->second.second) f(x, y);
+      }
+    });
+    const T last = max_neighbor<Dimension>(c, masks);
+    if (last > c) {
+      retained.emplace(c, retained_groups(group_a, group_b));
+      expiries.push(expiry(last, c));
+    }
+  }
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+using morton::file_reader;
+using morton::identity_key;
+using morton::span_reader;
+
+/// @brief Joins two streams of items sorted by morton codes in the same
+/// quadtree cell of a level.
+///
+/// Both streams are read once in a merge, and only the items of the current
+/// cell are held in memory.
+/// @tparam ReaderA Reader type, e.g. span_reader or file_reader
+/// @tparam ReaderB Reader type, e.g. span_reader or file_reader
+/// @tparam F Function object called as f(item_a, item_b)
+/// @tparam Key Function object returning the morton code of an item
+/// @param[in] a Items sorted in increasing order of their morton codes
+/// @param[in] b Items sorted in increasing order of their morton codes
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits)
+/// @param[in] f Function object called for every pair
+/// @param[in] key Function object returning the morton code of an item
+template <typename ReaderA, typename ReaderB, typename F,
+          typename Key = identity_key>
+void merge_join(ReaderA& a, ReaderB& b, unsigned int level, const F& f,
+                const Key& key = Key{}) {
+  using Code = typename std::decay<decltype(
+      key(std::declval<const typename ReaderA::value_type&>()))>::type;
+  morton::detail::merge_join<2, morton_traits<typename Code::value_type>>(
+      a, b, level, false, key, f);
+}
+
+/// @brief Joins two streams of items sorted by morton codes in the same or
+/// neighboring quadtree cells of a level.
+///
+/// Candidates within a distance are found if cells of the level are not
+/// smaller than the distance. Groups of items of past cells are held in
+/// memory until their last neighbor is visited. Their number is about the
+/// square root of the number of non-empty cells for uniform distributions.
+/// @tparam ReaderA Reader type, e.g. span_reader or file_reader
+/// @tparam ReaderB Reader type, e.g. span_reader or file_reader
+/// @tparam F Function object called as f(item_a, item_b)
+/// @tparam Key Function object returning the morton code of an item
+/// @param[in] a Items sorted in increasing order of their morton codes
+/// @param[in] b Items sorted in increasing order of their morton codes
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits)
+/// @param[in] f Function object called for every pair
+/// @param[in] key Function object returning the morton code of an item
+template <typename ReaderA, typename ReaderB, typename F,
+          typename Key = identity_key>
+void merge_join_neighbors(ReaderA& a, ReaderB& b, unsigned int level,
+                          const F& f, const Key& key = Key{}) {
+  using Code = typename std::decay<decltype(
+      key(std::declval<const typename ReaderA::value_type&>()))>::type;
+  morton::detail::merge_join<2, morton_traits<typename Code::value_type>>(
+      a, b, level, true, key, f);
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+using morton::file_reader;
+using morton::identity_key;
+using morton::span_reader;
+
+/// @brief Joins two streams of items sorted by morton codes in the same
+/// octree cell of a level.
+///
+/// Both streams are read once in a merge, and only the items of the current
+/// cell are held in memory.
+/// @tparam ReaderA Reader type, e.g. span_reader or file_reader
+/// @tparam ReaderB Reader type, e.g. span_reader or file_reader
+/// @tparam F Function object called as f(item_a, item_b)
+/// @tparam Key Function object returning the morton code of an item
+/// @param[in] a Items sorted in increasing order of their morton codes
+/// @param[in] b Items sorted in increasing order of their morton codes
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits)
+/// @param[in] f Function object called for every pair
+/// @param[in] key Function object returning the morton code of an item
+template <typename ReaderA, typename ReaderB, typename F,
+          typename Key = identity_key>
+void merge_join(ReaderA& a, ReaderB& b, unsigned int level, const F& f,
+                const Key& key = Key{}) {
+  using Code = typename std::decay<decltype(
+      key(std::declval<const typename ReaderA::value_type&>()))>::type;
+  morton::detail::merge_join<3, morton_traits<typename Code::value_type>>(
+      a, b, level, false, key, f);
+}
+
+/// @brief Joins two streams of items sorted by morton codes in the same or
+/// neighboring octree cells of a level.
+///
+/// Candidates within a distance are found if cells of the level are not
+/// smaller than the distance. Groups of items of past cells are held in
+/// memory until their last neighbor is visited. Their number is about the
+/// two-thirds power of the number of non-empty cells for uniform
+/// distributions.
+/// @tparam ReaderA Reader type, e.g. span_reader or file_reader
+/// @tparam ReaderB Reader type, e.g. span_reader or file_reader
+/// @tparam F Function object called as f(item_a, item_b)
+/// @tparam Key Function object returning the morton code of an item
+/// @param[in] a Items sorted in increasing order of their morton codes
+/// @param[in] b Items sorted in increasing order of their morton codes
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits)
+/// @param[in] f Function object called for every pair
+/// @param[in] key Function object returning the morton code of an item
+template <typename ReaderA, typename ReaderB, typename F,
+          typename Key = identity_key>
+void merge_join_neighbors(ReaderA& a, ReaderB& b, unsigned int level,
+                          const F& f, const Key& key = Key{}) {
+  using Code = typename std::decay<decltype(
+      key(std::declval<const typename ReaderA::value_type&>()))>::type;
+  morton::detail::merge_join<3, morton_traits<typename Code::value_type>>(
+      a, b, level, true, key, f);
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_JOIN_HPP
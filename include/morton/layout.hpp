@@ -0,0 +1,837 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_LAYOUT_HPP
+#define MORTON_LAYOUT_HPP
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MORTON_LAYOUT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Returns the number of bits to represent indices in [0, n).
+inline unsigned int ceil_log2(std::size_t n) noexcept {
+  unsigned int bits = 0;
+  while (bits < 64 && (std::size_t(1) << bits) < n) ++bits;
+  return bits;
+}
+
+/// @brief Element size known at compile time.
+/// @tparam N Size in bytes
+template <std::size_t N>
+struct static_size {
+  constexpr std::size_t operator()() const noexcept { return N; }
+};
+
+/// @brief Element size known at run time.
+struct dynamic_size {
+  std::size_t n;  /// Size in bytes
+  std::size_t operator()() const noexcept { return n; }
+};
+
+/// @brief Copies two elements from each of two rows into a 2x2 block for
+/// every other column.
+/// @param[in] r0 First row
+/// @param[in] r1 Second row
+/// @param[out] d Destination of the first block
+/// @param[in] offsets Dilated x offsets
+/// @param[in] n Number of columns, which is even
+template <typename Size>
+inline void swizzle_row_pair(const unsigned char* r0, const unsigned char* r1,
+                             unsigned char* d, const std::size_t* offsets,
+                             std::size_t n, Size size) noexcept {
+  const std::size_t es = size();
+  for (std::size_t x = 0; x < n; x += 2) {
+    unsigned char* b = d + offsets[x] * es;
+    std::memcpy(b, r0 + x * es, 2 * es);
+    std::memcpy(b + 2 * es, r1 + x * es, 2 * es);
+  }
+}
+
+/// @brief Inverse of swizzle_row_pair.
+template <typename Size>
+inline void unswizzle_row_pair(const unsigned char* s, unsigned char* r0,
+                               unsigned char* r1, const std::size_t* offsets,
+                               std::size_t n, Size size) noexcept {
+  const std::size_t es = size();
+  for (std::size_t x = 0; x < n; x += 2) {
+    const unsigned char* b = s + offsets[x] * es;
+    std::memcpy(r0 + x * es, b, 2 * es);
+    std::memcpy(r1 + x * es, b + 2 * es, 2 * es);
+  }
+}
+
+#ifdef MORTON_LAYOUT_USE_SSE2
+
+/// @brief Stores 32 bits of each 32-bit lane to a destination.
+inline void store_lanes32(__m128i v, unsigned char* d0, unsigned char* d1,
+                          unsigned char* d2, unsigned char* d3) noexcept {
+  unsigned char* d[4] = {d0, d1, d2, d3};
+  for (int i = 0; i < 4; ++i) {
+    const int lane = _mm_cvtsi128_si32(v);
+    std::memcpy(d[i], &lane, 4);
+    v = _mm_srli_si128(v, 4);
+  }
+}
+
+/// @brief Loads four 32-bit lanes from sources.
+inline __m128i load_lanes32(const unsigned char* s0, const unsigned char* s1,
+                            const unsigned char* s2,
+                            const unsigned char* s3) noexcept {
+  int lanes[4];
+  std::memcpy(&lanes[0], s0, 4);
+  std::memcpy(&lanes[1], s1, 4);
+  std::memcpy(&lanes[2], s2, 4);
+  std::memcpy(&lanes[3], s3, 4);
+  return _mm_set_epi32(lanes[3], lanes[2], lanes[1], lanes[0]);
+}
+
+/// @brief swizzle_row_pair for 1-byte elements, which interleaves pairs of
+/// 2x16 elements by 128-bit unpacks.
+inline void swizzle_row_pair(const unsigned char* r0, const unsigned char* r1,
+                             unsigned char* d, const std::size_t* offsets,
+                             std::size_t n, static_size<1> size) noexcept {
+  if (n % 16 != 0) {
+    swizzle_row_pair<static_size<1>>(r0, r1, d, offsets, n, size);
+    return;
+  }
+  for (std::size_t x = 0; x < n; x += 16) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1));
+    const std::size_t* o = offsets + x;
+    store_lanes32(_mm_unpacklo_epi16(a, b), d + o[0], d + o[2], d + o[4],
+                  d + o[6]);
+    store_lanes32(_mm_unpackhi_epi16(a, b), d + o[8], d + o[10], d + o[12],
+                  d + o[14]);
+    r0 += 16;
+    r1 += 16;
+  }
+}
+
+/// @brief unswizzle_row_pair for 1-byte elements.
+inline void unswizzle_row_pair(const unsigned char* s, unsigned char* r0,
+                               unsigned char* r1, const std::size_t* offsets,
+                               std::size_t n, static_size<1> size) noexcept {
+  if (n % 8 != 0) {
+    unswizzle_row_pair<static_size<1>>(s, r0, r1, offsets, n, size);
+    return;
+  }
+  for (std::size_t x = 0; x < n; x += 8) {
+    const std::size_t* o = offsets + x;
+    // 16-bit lanes hold pairs of r0 and r1 alternately.
+    __m128i v = load_lanes32(s + o[0], s + o[2], s + o[4], s + o[6]);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+    v = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(r0), v);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(r1), _mm_srli_si128(v, 8));
+    r0 += 8;
+    r1 += 8;
+  }
+}
+
+/// @brief swizzle_row_pair for 2-byte elements.
+inline void swizzle_row_pair(const unsigned char* r0, const unsigned char* r1,
+                             unsigned char* d, const std::size_t* offsets,
+                             std::size_t n, static_size<2> size) noexcept {
+  if (n % 8 != 0) {
+    swizzle_row_pair<static_size<2>>(r0, r1, d, offsets, n, size);
+    return;
+  }
+  for (std::size_t x = 0; x < n; x += 8) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1));
+    const __m128i lo = _mm_unpacklo_epi32(a, b);
+    const __m128i hi = _mm_unpackhi_epi32(a, b);
+    const std::size_t* o = offsets + x;
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(d + o[0] * 2), lo);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(d + o[2] * 2),
+                     _mm_srli_si128(lo, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(d + o[4] * 2), hi);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(d + o[6] * 2),
+                     _mm_srli_si128(hi, 8));
+    r0 += 16;
+    r1 += 16;
+  }
+}
+
+/// @brief unswizzle_row_pair for 2-byte elements.
+inline void unswizzle_row_pair(const unsigned char* s, unsigned char* r0,
+                               unsigned char* r1, const std::size_t* offsets,
+                               std::size_t n, static_size<2> size) noexcept {
+  if (n % 4 != 0) {
+    unswizzle_row_pair<static_size<2>>(s, r0, r1, offsets, n, size);
+    return;
+  }
+  for (std::size_t x = 0; x < n; x += 4) {
+    const __m128i a =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + offsets[x] * 2));
+    const __m128i b = _mm_loadl_epi64(
+        reinterpret_cast<const __m128i*>(s + offsets[x + 2] * 2));
+    // 32-bit lanes hold pairs of r0 and r1 alternately.
+    const __m128i v =
+        _mm_shuffle_epi32(_mm_unpacklo_epi64(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(r0), v);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(r1), _mm_srli_si128(v, 8));
+    r0 += 8;
+    r1 += 8;
+  }
+}
+
+/// @brief swizzle_row_pair for 4-byte elements, which converts 2x4 elements
+/// by a pair of 128-bit unpacks.
+inline void swizzle_row_pair(const unsigned char* r0, const unsigned char* r1,
+                             unsigned char* d, const std::size_t* offsets,
+                             std::size_t n, static_size<4> size) noexcept {
+  if (n % 4 != 0) {
+    swizzle_row_pair<static_size<4>>(r0, r1, d, offsets, n, size);
+    return;
+  }
+  for (std::size_t x = 0; x < n; x += 4) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + offsets[x] * 4),
+                     _mm_unpacklo_epi64(a, b));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + offsets[x + 2] * 4),
+                     _mm_unpackhi_epi64(a, b));
+    r0 += 16;
+    r1 += 16;
+  }
+}
+
+/// @brief unswizzle_row_pair for 4-byte elements.
+inline void unswizzle_row_pair(const unsigned char* s, unsigned char* r0,
+                               unsigned char* r1, const std::size_t* offsets,
+                               std::size_t n, static_size<4> size) noexcept {
+  if (n % 4 != 0) {
+    unswizzle_row_pair<static_size<4>>(s, r0, r1, offsets, n, size);
+    return;
+  }
+  for (std::size_t x = 0; x < n; x += 4) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + offsets[x] * 4));
+    const __m128i b = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(s + offsets[x + 2] * 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(r0), _mm_unpacklo_epi64(a, b));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(r1), _mm_unpackhi_epi64(a, b));
+    r0 += 16;
+    r1 += 16;
+  }
+}
+
+#endif  // MORTON_LAYOUT_USE_SSE2
+
+/// @brief Calls f with the element size as a compile-time constant if
+/// possible.
+/// @param[in] element_size Size of an element in bytes
+/// @param[in] f Function object which accepts static_size or dynamic_size
+template <typename F>
+inline void dispatch_element_size(std::size_t element_size, const F& f) {
+  switch (element_size) {
+    case 1:
+      return f(static_size<1>{});
+    case 2:
+      return f(static_size<2>{});
+    case 4:
+      return f(static_size<4>{});
+    case 8:
+      return f(static_size<8>{});
+    case 16:
+      return f(static_size<16>{});
+    default:
+      return f(dynamic_size{element_size});
+  }
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Z-order layout of a dense two-dimensional array.
+///
+/// Each extent is rounded up to a power of two, and bits of x and y are
+/// interleaved from the least significant bit while both of them remain.
+/// Remaining bits of the longer axis are placed above them. The index of
+/// (x, y) is therefore the same as the 64-bit morton code for a square of
+/// power-of-two extents, while elongated arrays such as 4096 x 256 do not
+/// waste storage. Elements in the padding are not used.
+class layout {
+ public:
+  layout() noexcept : layout(0, 0) {}
+
+  /// @param[in] width Number of elements along x axis
+  /// @param[in] height Number of elements along y axis
+  layout(std::size_t width, std::size_t height) noexcept
+      : width_{width}, height_{height}, mask_x_{0}, mask_y_{0} {
+    const unsigned int bits_x = morton::detail::ceil_log2(width);
+    const unsigned int bits_y = morton::detail::ceil_log2(height);
+    common_bits_ = std::min(bits_x, bits_y);
+    unsigned int pos = 0;
+    for (unsigned int level = 0; level < std::max(bits_x, bits_y); ++level) {
+      if (level < bits_x) mask_x_ |= std::size_t(1) << pos++;
+      if (level < bits_y) mask_y_ |= std::size_t(1) << pos++;
+    }
+    size_ = (width == 0 || height == 0) ? 0 : std::size_t(1) << pos;
+  }
+
+  /// @brief Number of elements along x axis
+  std::size_t width() const noexcept { return width_; }
+
+  /// @brief Number of elements along y axis
+  std::size_t height() const noexcept { return height_; }
+
+  /// @brief Number of elements of the storage including padding
+  std::size_t size() const noexcept { return size_; }
+
+  /// @brief Bits of x coordinate in indices
+  std::size_t mask_x() const noexcept { return mask_x_; }
+
+  /// @brief Bits of y coordinate in indices
+  std::size_t mask_y() const noexcept { return mask_y_; }
+
+  /// @brief Number of low levels at which x and y are interleaved
+  unsigned int common_bits() const noexcept { return common_bits_; }
+
+  /// @brief Returns the index of an element.
+  /// @param[in] x X coordinate
+  /// @param[in] y Y coordinate
+  std::size_t index(std::size_t x, std::size_t y) const noexcept {
+    assert(x < width_ && y < height_);
+    const std::size_t low = (std::size_t(1) << common_bits_) - 1;
+    const coordinates32_t c(static_cast<uint32_t>(x & low),
+                            static_cast<uint32_t>(y & low));
+    // Either x or y has no bits above the common bits.
+    return static_cast<std::size_t>(encode(c).value) |
+           ((x >> common_bits_ | y >> common_bits_) << (2 * common_bits_));
+  }
+
+  /// @brief Returns coordinates of an element.
+  /// @param[in] i Index
+  coordinates32_t coordinates_of(std::size_t i) const noexcept {
+    const std::size_t low = (std::size_t(1) << (2 * common_bits_)) - 1;
+    auto c = decode(morton_code64_t{static_cast<uint64_t>(i & low)});
+    const auto high = static_cast<uint32_t>((i >> (2 * common_bits_))
+                                            << common_bits_);
+    if (mask_x_ > mask_y_) {
+      c.x |= high;
+    } else {
+      c.y |= high;
+    }
+    return c;
+  }
+
+ private:
+  std::size_t width_;         /// Number of elements along x axis
+  std::size_t height_;        /// Number of elements along y axis
+  std::size_t size_;          /// Number of elements including padding
+  std::size_t mask_x_;        /// Bits of x coordinate in indices
+  std::size_t mask_y_;        /// Bits of y coordinate in indices
+  unsigned int common_bits_;  /// Number of interleaved levels
+};
+
+namespace detail {
+
+/// Maximum number of levels of a tile processed at once
+constexpr unsigned int max_tile_bits = 5;
+
+/// Number of elements of the largest tile along an axis
+constexpr std::size_t max_tile = std::size_t(1) << max_tile_bits;
+
+/// @brief Fills dilated x offsets in a tile.
+/// @returns Number of levels of a tile
+inline unsigned int tile_offsets(const layout& l, std::size_t* offsets) {
+  const unsigned int bits = std::min(max_tile_bits, l.common_bits());
+  for (uint32_t i = 0; i < (1U << bits); ++i) {
+    offsets[i] = encode(coordinates16_t(static_cast<uint16_t>(i), 0)).value;
+  }
+  return bits;
+}
+
+template <typename Size>
+void swizzle(const unsigned char* src, unsigned char* dst, const layout& l,
+             Size size) {
+  const std::size_t es = size();
+  const std::size_t w = l.width();
+  const std::size_t h = l.height();
+  std::size_t offsets[max_tile];
+  const unsigned int bits = tile_offsets(l, offsets);
+  const std::size_t tile = std::size_t(1) << bits;
+  for (std::size_t ty = 0; ty < h; ty += tile) {
+    const std::size_t th = std::min(tile, h - ty);
+    for (std::size_t tx = 0; tx < w; tx += tile) {
+      const std::size_t tw = std::min(tile, w - tx);
+      // Elements of a tile are contiguous in Z-order.
+      unsigned char* d = dst + l.index(tx, ty) * es;
+      const unsigned char* s = src + (ty * w + tx) * es;
+      if (bits > 0 && tw == tile && th == tile) {
+        for (std::size_t y = 0; y < tile; y += 2) {
+          morton::detail::swizzle_row_pair(s + y * w * es,
+                                           s + (y + 1) * w * es,
+                                           d + (offsets[y] << 1) * es,
+                                           offsets, tile, size);
+        }
+      } else {
+        for (std::size_t y = 0; y < th; ++y) {
+          for (std::size_t x = 0; x < tw; ++x) {
+            std::memcpy(d + (offsets[x] | offsets[y] << 1) * es,
+                        s + (y * w + x) * es, es);
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename Size>
+void unswizzle(const unsigned char* src, unsigned char* dst, const layout& l,
+               Size size) {
+  const std::size_t es = size();
+  const std::size_t w = l.width();
+  const std::size_t h = l.height();
+  std::size_t offsets[max_tile];
+  const unsigned int bits = tile_offsets(l, offsets);
+  const std::size_t tile = std::size_t(1) << bits;
+  for (std::size_t ty = 0; ty < h; ty += tile) {
+    const std::size_t th = std::min(tile, h - ty);
+    for (std::size_t tx = 0; tx < w; tx += tile) {
+      const std::size_t tw = std::min(tile, w - tx);
+      const unsigned char* s = src + l.index(tx, ty) * es;
+      unsigned char* d = dst + (ty * w + tx) * es;
+      if (bits > 0 && tw == tile && th == tile) {
+        for (std::size_t y = 0; y < tile; y += 2) {
+          morton::detail::unswizzle_row_pair(s + (offsets[y] << 1) * es,
+                                             d + y * w * es,
+                                             d + (y + 1) * w * es, offsets,
+                                             tile, size);
+        }
+      } else {
+        for (std::size_t y = 0; y < th; ++y) {
+          for (std::size_t x = 0; x < tw; ++x) {
+            std::memcpy(d + (y * w + x) * es,
+                        s + (offsets[x] | offsets[y] << 1) * es, es);
+          }
+        }
+      }
+    }
+  }
+}
+
+/// @brief Function object calling swizzle for an element size
+struct swizzler {
+  const unsigned char* src;
+  unsigned char* dst;
+  const layout& l;
+
+  template <typename Size>
+  void operator()(Size size) const {
+    swizzle(src, dst, l, size);
+  }
+};
+
+/// @brief Function object calling unswizzle for an element size
+struct unswizzler {
+  const unsigned char* src;
+  unsigned char* dst;
+  const layout& l;
+
+  template <typename Size>
+  void operator()(Size size) const {
+    unswizzle(src, dst, l, size);
+  }
+};
+
+}  // namespace detail
+
+/// @brief Copies a row-major array into Z-order layout.
+///
+/// The array is processed in square tiles which are contiguous in Z-order,
+/// and 2x2 blocks of elements are moved at once. Padding elements of the
+/// destination are left untouched.
+/// @param[in] src Row-major array of width * height elements
+/// @param[out] dst Array of l.size() elements in Z-order layout
+/// @param[in] l Layout
+/// @param[in] element_size Size of an element in bytes
+inline void swizzle(const void* src, void* dst, const layout& l,
+                    std::size_t element_size) {
+  morton::detail::dispatch_element_size(
+      element_size,
+      detail::swizzler{static_cast<const unsigned char*>(src),
+                       static_cast<unsigned char*>(dst), l});
+}
+
+/// @brief Copies an array in Z-order layout into a row-major array.
+/// @param[in] src Array of l.size() elements in Z-order layout
+/// @param[out] dst Row-major array of width * height elements
+/// @param[in] l Layout
+/// @param[in] element_size Size of an element in bytes
+inline void unswizzle(const void* src, void* dst, const layout& l,
+                      std::size_t element_size) {
+  morton::detail::dispatch_element_size(
+      element_size,
+      detail::unswizzler{static_cast<const unsigned char*>(src),
+                         static_cast<unsigned char*>(dst), l});
+}
+
+/// @brief Copies a row-major array into Z-order layout.
+/// @tparam T Trivially copyable element type
+template <typename T>
+inline void swizzle(const T* src, T* dst, const layout& l) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "T is not trivially copyable");
+  swizzle(static_cast<const void*>(src), static_cast<void*>(dst), l,
+          sizeof(T));
+}
+
+/// @brief Copies an array in Z-order layout into a row-major array.
+/// @tparam T Trivially copyable element type
+template <typename T>
+inline void unswizzle(const T* src, T* dst, const layout& l) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "T is not trivially copyable");
+  unswizzle(static_cast<const void*>(src), static_cast<void*>(dst), l,
+            sizeof(T));
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Z-order layout of a dense three-dimensional array.
+///
+/// Each extent is rounded up to a power of two, and bits of x, y and z are
+/// interleaved from the least significant bit while they remain. Bits of
+/// the two longer axes are interleaved above them, followed by the remaining
+/// bits of the longest axis. The index of (x, y, z) is therefore the same as
+/// the 64-bit morton code for a cube of power-of-two extents. The shortest
+/// extent must not exceed 2^21.
+class layout {
+ public:
+  layout() noexcept : layout(0, 0, 0) {}
+
+  /// @param[in] width Number of elements along x axis
+  /// @param[in] height Number of elements along y axis
+  /// @param[in] depth Number of elements along z axis
+  layout(std::size_t width, std::size_t height, std::size_t depth) noexcept
+      : extents_{width, height, depth}, masks_{0, 0, 0} {
+    const unsigned int bits[3] = {morton::detail::ceil_log2(width),
+                                  morton::detail::ceil_log2(height),
+                                  morton::detail::ceil_log2(depth)};
+    unsigned int pos = 0;
+    const unsigned int levels = std::max(bits[0], std::max(bits[1], bits[2]));
+    for (unsigned int level = 0; level < levels; ++level) {
+      for (int a = 0; a < 3; ++a) {
+        if (level < bits[a]) masks_[a] |= std::size_t(1) << pos++;
+      }
+    }
+    size_ = (width == 0 || height == 0 || depth == 0) ? 0
+                                                      : std::size_t(1) << pos;
+
+    // Sort axes by the number of bits. Ties keep the order of axes so that
+    // the lower axis takes the lower bit, as in the loop above.
+    int order[3] = {0, 1, 2};
+    std::stable_sort(order, order + 3,
+                     [&](int a, int b) { return bits[a] < bits[b]; });
+    common_bits_ = bits[order[0]];
+    assert(common_bits_ <= 21);
+    pair_bits_ = bits[order[1]] - common_bits_;
+    pair_[0] = std::min(order[1], order[2]);
+    pair_[1] = std::max(order[1], order[2]);
+    top_ = order[2];
+  }
+
+  /// @brief Number of elements along x axis
+  std::size_t width() const noexcept { return extents_[0]; }
+
+  /// @brief Number of elements along y axis
+  std::size_t height() const noexcept { return extents_[1]; }
+
+  /// @brief Number of elements along z axis
+  std::size_t depth() const noexcept { return extents_[2]; }
+
+  /// @brief Number of elements of the storage including padding
+  std::size_t size() const noexcept { return size_; }
+
+  /// @brief Bits of x coordinate in indices
+  std::size_t mask_x() const noexcept { return masks_[0]; }
+
+  /// @brief Bits of y coordinate in indices
+  std::size_t mask_y() const noexcept { return masks_[1]; }
+
+  /// @brief Bits of z coordinate in indices
+  std::size_t mask_z() const noexcept { return masks_[2]; }
+
+  /// @brief Number of low levels at which x, y and z are interleaved
+  unsigned int common_bits() const noexcept { return common_bits_; }
+
+  /// @brief Returns the index of an element.
+  /// @param[in] x X coordinate
+  /// @param[in] y Y coordinate
+  /// @param[in] z Z coordinate
+  std::size_t index(std::size_t x, std::size_t y, std::size_t z) const
+      noexcept {
+    assert(x < extents_[0] && y < extents_[1] && z < extents_[2]);
+    const std::size_t c[3] = {x, y, z};
+    const std::size_t low = (std::size_t(1) << common_bits_) - 1;
+    std::size_t i = static_cast<std::size_t>(
+        encode(coordinates32_t(static_cast<uint32_t>(x & low),
+                               static_cast<uint32_t>(y & low),
+                               static_cast<uint32_t>(z & low)))
+            .value);
+    unsigned int shift = 3 * common_bits_;
+    if (pair_bits_ > 0) {
+      const std::size_t mid = (std::size_t(1) << pair_bits_) - 1;
+      const morton2d::coordinates32_t p(
+          static_cast<uint32_t>((c[pair_[0]] >> common_bits_) & mid),
+          static_cast<uint32_t>((c[pair_[1]] >> common_bits_) & mid));
+      i |= static_cast<std::size_t>(morton2d::encode(p).value) << shift;
+      shift += 2 * pair_bits_;
+    }
+    // Only the longest axis has bits above the others.
+    return i | (c[top_] >> (common_bits_ + pair_bits_)) << shift;
+  }
+
+  /// @brief Returns coordinates of an element.
+  /// @param[in] i Index
+  coordinates32_t coordinates_of(std::size_t i) const noexcept {
+    unsigned int shift = 3 * common_bits_;
+    const auto l = decode(morton_code64_t{
+        static_cast<uint64_t>(i & ((std::size_t(1) << shift) - 1))});
+    uint32_t c[3] = {l.x, l.y, l.z};
+    if (pair_bits_ > 0) {
+      const std::size_t mid = (std::size_t(1) << (2 * pair_bits_)) - 1;
+      const auto p = morton2d::decode(
+          morton2d::morton_code64_t{static_cast<uint64_t>(i >> shift & mid)});
+      c[pair_[0]] |= p.x << common_bits_;
+      c[pair_[1]] |= p.y << common_bits_;
+      shift += 2 * pair_bits_;
+    }
+    c[top_] |= static_cast<uint32_t>((i >> shift)
+                                     << (common_bits_ + pair_bits_));
+    return coordinates32_t(c[0], c[1], c[2]);
+  }
+
+ private:
+  std::size_t extents_[3];    /// Number of elements along each axis
+  std::size_t size_;          /// Number of elements including padding
+  std::size_t masks_[3];      /// Bits of each coordinate in indices
+  unsigned int common_bits_;  /// Number of levels shared by three axes
+  unsigned int pair_bits_;    /// Number of levels shared by two axes
+  int pair_[2];               /// Two longer axes in increasing order
+  int top_;                   /// Longest axis
+};
+
+namespace detail {
+
+/// Maximum number of levels of a tile processed at once
+constexpr unsigned int max_tile_bits = 4;
+
+/// Number of elements of the largest tile along an axis
+constexpr std::size_t max_tile = std::size_t(1) << max_tile_bits;
+
+/// @brief Fills dilated x offsets in a tile.
+/// @returns Number of levels of a tile
+inline unsigned int tile_offsets(const layout& l, std::size_t* offsets) {
+  const unsigned int bits = std::min(max_tile_bits, l.common_bits());
+  for (uint16_t i = 0; i < (1U << bits); ++i) {
+    offsets[i] = encode(coordinates16_t(i, 0, 0)).value;
+  }
+  return bits;
+}
+
+template <typename Size>
+void swizzle(const unsigned char* src, unsigned char* dst, const layout& l,
+             Size size) {
+  const std::size_t es = size();
+  const std::size_t w = l.width();
+  const std::size_t h = l.height();
+  const std::size_t d = l.depth();
+  const std::size_t row = w * es;
+  const std::size_t slice = h * row;
+  std::size_t offsets[max_tile];
+  const unsigned int bits = tile_offsets(l, offsets);
+  const std::size_t tile = std::size_t(1) << bits;
+  for (std::size_t tz = 0; tz < d; tz += tile) {
+    const std::size_t td = std::min(tile, d - tz);
+    for (std::size_t ty = 0; ty < h; ty += tile) {
+      const std::size_t th = std::min(tile, h - ty);
+      for (std::size_t tx = 0; tx < w; tx += tile) {
+        const std::size_t tw = std::min(tile, w - tx);
+        // Elements of a tile are contiguous in Z-order.
+        unsigned char* t = dst + l.index(tx, ty, tz) * es;
+        const unsigned char* s = src + tz * slice + ty * row + tx * es;
+        if (bits > 0 && tw == tile && th == tile && td == tile) {
+          for (std::size_t z = 0; z < tile; z += 2) {
+            for (std::size_t y = 0; y < tile; y += 2) {
+              // 2x2x2 blocks are filled by two pairs of rows.
+              const unsigned char* r = s + z * slice + y * row;
+              unsigned char* b = t + (offsets[y] << 1 | offsets[z] << 2) * es;
+              morton::detail::swizzle_row_pair(r, r + row, b, offsets, tile,
+                                               size);
+              morton::detail::swizzle_row_pair(r + slice, r + slice + row,
+                                               b + 4 * es, offsets, tile,
+                                               size);
+            }
+          }
+        } else {
+          for (std::size_t z = 0; z < td; ++z) {
+            for (std::size_t y = 0; y < th; ++y) {
+              for (std::size_t x = 0; x < tw; ++x) {
+                const std::size_t i =
+                    offsets[x] | offsets[y] << 1 | offsets[z] << 2;
+                std::memcpy(t + i * es, s + z * slice + y * row + x * es, es);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename Size>
+void unswizzle(const unsigned char* src, unsigned char* dst, const layout& l,
+               Size size) {
+  const std::size_t es = size();
+  const std::size_t w = l.width();
+  const std::size_t h = l.height();
+  const std::size_t d = l.depth();
+  const std::size_t row = w * es;
+  const std::size_t slice = h * row;
+  std::size_t offsets[max_tile];
+  const unsigned int bits = tile_offsets(l, offsets);
+  const std::size_t tile = std::size_t(1) << bits;
+  for (std::size_t tz = 0; tz < d; tz += tile) {
+    const std::size_t td = std::min(tile, d - tz);
+    for (std::size_t ty = 0; ty < h; ty += tile) {
+      const std::size_t th = std::min(tile, h - ty);
+      for (std::size_t tx = 0; tx < w; tx += tile) {
+        const std::size_t tw = std::min(tile, w - tx);
+        const unsigned char* t = src + l.index(tx, ty, tz) * es;
+        unsigned char* s = dst + tz * slice + ty * row + tx * es;
+        if (bits > 0 && tw == tile && th == tile && td == tile) {
+          for (std::size_t z = 0; z < tile; z += 2) {
+            for (std::size_t y = 0; y < tile; y += 2) {
+              unsigned char* r = s + z * slice + y * row;
+              const unsigned char* b =
+                  t + (offsets[y] << 1 | offsets[z] << 2) * es;
+              morton::detail::unswizzle_row_pair(b, r, r + row, offsets, tile,
+                                                 size);
+              morton::detail::unswizzle_row_pair(b + 4 * es, r + slice,
+                                                 r + slice + row, offsets,
+                                                 tile, size);
+            }
+          }
+        } else {
+          for (std::size_t z = 0; z < td; ++z) {
+            for (std::size_t y = 0; y < th; ++y) {
+              for (std::size_t x = 0; x < tw; ++x) {
+                const std::size_t i =
+                    offsets[x] | offsets[y] << 1 | offsets[z] << 2;
+                std::memcpy(s + z * slice + y * row + x * es, t + i * es, es);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/// @brief Function object calling swizzle for an element size
+struct swizzler {
+  const unsigned char* src;
+  unsigned char* dst;
+  const layout& l;
+
+  template <typename Size>
+  void operator()(Size size) const {
+    swizzle(src, dst, l, size);
+  }
+};
+
+/// @brief Function object calling unswizzle for an element size
+struct unswizzler {
+  const unsigned char* src;
+  unsigned char* dst;
+  const layout& l;
+
+  template <typename Size>
+  void operator()(Size size) const {
+    unswizzle(src, dst, l, size);
+  }
+};
+
+}  // namespace detail
+
+/// @brief Copies a row-major array into Z-order layout.
+///
+/// The array is processed in cubic tiles which are contiguous in Z-order,
+/// and 2x2x2 blocks of elements are moved at once. Padding elements of the
+/// destination are left untouched.
+/// @param[in] src Row-major array of width * height * depth elements, where
+/// x varies fastest
+/// @param[out] dst Array of l.size() elements in Z-order layout
+/// @param[in] l Layout
+/// @param[in] element_size Size of an element in bytes
+inline void swizzle(const void* src, void* dst, const layout& l,
+                    std::size_t element_size) {
+  morton::detail::dispatch_element_size(
+      element_size,
+      detail::swizzler{static_cast<const unsigned char*>(src),
+                       static_cast<unsigned char*>(dst), l});
+}
+
+/// @brief Copies an array in Z-order layout into a row-major array.
+/// @param[in] src Array of l.size() elements in Z-order layout
+/// @param[out] dst Row-major array of width * height * depth elements
+/// @param[in] l Layout
+/// @param[in] element_size Size of an element in bytes
+inline void unswizzle(const void* src, void* dst, const layout& l,
+                      std::size_t element_size) {
+  morton::detail::dispatch_element_size(
+      element_size,
+      detail::unswizzler{static_cast<const unsigned char*>(src),
+                         static_cast<unsigned char*>(dst), l});
+}
+
+/// @brief Copies a row-major array into Z-order layout.
+/// @tparam T Trivially copyable element type
+template <typename T>
+inline void swizzle(const T* src, T* dst, const layout& l) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "T is not trivially copyable");
+  swizzle(static_cast<const void*>(src), static_cast<void*>(dst), l,
+          sizeof(T));
+}
+
+/// @brief Copies an array in Z-order layout into a row-major array.
+/// @tparam T Trivially copyable element type
+template <typename T>
+inline void unswizzle(const T* src, T* dst, const layout& l) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "T is not trivially copyable");
+  unswizzle(static_cast<const void*>(src), static_cast<void*>(dst), l,
+            sizeof(T));
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_LAYOUT_HPP
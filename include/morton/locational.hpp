@@ -0,0 +1,407 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_LOCATIONAL_HPP
+#define MORTON_LOCATIONAL_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Returns the position of the highest set bit of a non-zero value.
+template <typename T>
+inline unsigned int highest_bit(T v) noexcept {
+  assert(v != 0);
+#if defined(__GNUC__)
+  return static_cast<unsigned int>(63 - __builtin_clzll(v));
+#else
+  unsigned int bit = 0;
+  while (v >>= 1) ++bit;
+  return bit;
+#endif
+}
+
+/// @brief Returns v shifted right by s bits, which is zero if s is not less
+/// than the number of bits of T.
+template <typename T>
+inline T shift_right(T v, unsigned int s) noexcept {
+  return s < static_cast<unsigned int>(std::numeric_limits<T>::digits)
+             ? static_cast<T>(v >> s)
+             : T(0);
+}
+
+/// @brief Returns v shifted left by s bits, which is zero if s is not less
+/// than the number of bits of T.
+template <typename T>
+inline T shift_left(T v, unsigned int s) noexcept {
+  return s < static_cast<unsigned int>(std::numeric_limits<T>::digits)
+             ? static_cast<T>(v << s)
+             : T(0);
+}
+
+/// @brief Locational code of a quadtree/octree cell at any level.
+///
+/// The value is the morton code of the cell coordinates in the grid of its
+/// level preceded by a sentinel bit, i.e. 1 for the root, 1xy for its
+/// children, 1xyxy for their children and so on. Cells of different levels
+/// therefore have different codes, and the level is given by the position of
+/// the highest set bit. One bit of T is spent on the sentinel, so that the
+/// deepest level max_level may be one less than that of morton codes.
+///
+/// Codes are ordered in depth-first (pre-)order of the tree, in which every
+/// cell precedes its descendants and cells of the same level follow Z-order.
+/// @tparam T Unsigned integral type
+/// @tparam Dimension Number of dimensions
+template <typename T, unsigned int Dimension>
+struct locational_code {
+  static_assert(std::is_unsigned<T>::value, "T is not an unsigned type");
+  using value_type = T;
+
+  /// Deepest level
+  static constexpr unsigned int max_level =
+      (std::numeric_limits<T>::digits - 1) / Dimension;
+  /// Number of children of a cell
+  static constexpr unsigned int num_children = 1u << Dimension;
+
+  T value;
+
+  /// @param[in] tvalue Value, which must not be zero
+  explicit locational_code(T tvalue) noexcept : value{tvalue} {}
+
+  locational_code() = default;
+  locational_code(const locational_code&) = default;
+  locational_code(locational_code&&) = default;
+
+  locational_code& operator=(const locational_code&) = default;
+  locational_code& operator=(locational_code&&) = default;
+
+  /// @brief Returns the root cell.
+  static locational_code root() noexcept { return locational_code{T(1)}; }
+
+  /// @brief Explicit conversion operator
+  explicit operator T() const noexcept { return value; }
+
+  /// @brief Level of the cell from the root (0)
+  unsigned int level() const noexcept {
+    return highest_bit(value) / Dimension;
+  }
+
+  /// @brief Morton code of the cell coordinates in the grid of its level,
+  /// i.e. the value without the sentinel bit.
+  T cell() const noexcept {
+    return static_cast<T>(value ^ (T(1) << (level() * Dimension)));
+  }
+
+  /// @brief Returns the parent. The cell must not be the root.
+  locational_code parent() const noexcept {
+    assert(value > 1);
+    return locational_code{static_cast<T>(value >> Dimension)};
+  }
+
+  /// @brief Returns the ancestor (or the cell itself) at a level.
+  /// @param[in] l Level which is not deeper than the cell
+  locational_code ancestor(unsigned int l) const noexcept {
+    assert(l <= level());
+    return locational_code{
+        static_cast<T>(value >> ((level() - l) * Dimension))};
+  }
+
+  /// @brief Returns a child. The cell must be shallower than max_level.
+  /// @param[in] i Child index in Z-order, less than num_children
+  locational_code child(unsigned int i) const noexcept {
+    assert(level() < max_level && i < num_children);
+    return locational_code{static_cast<T>((value << Dimension) | i)};
+  }
+
+  /// @brief Index of the cell among its siblings in Z-order.
+  unsigned int child_index() const noexcept {
+    return static_cast<unsigned int>(value & (num_children - 1));
+  }
+
+  /// @brief Check if a cell is the cell itself or one of its descendants.
+  bool contains(const locational_code c) const noexcept {
+    const unsigned int l = level();
+    const unsigned int lc = c.level();
+    return l <= lc && (c.value >> ((lc - l) * Dimension)) == value;
+  }
+
+  /// @brief Value shifted to the deepest level, whose order is Z-order of
+  /// the first descendants of cells.
+  T aligned() const noexcept {
+    return static_cast<T>(value << ((max_level - level()) * Dimension));
+  }
+};
+
+template <typename T, unsigned int Dimension>
+constexpr unsigned int locational_code<T, Dimension>::max_level;
+
+template <typename T, unsigned int Dimension>
+constexpr unsigned int locational_code<T, Dimension>::num_children;
+
+template <typename T, unsigned int Dimension>
+bool operator==(const locational_code<T, Dimension> c1,
+                const locational_code<T, Dimension> c2) noexcept {
+  return c1.value == c2.value;
+}
+
+template <typename T, unsigned int Dimension>
+bool operator!=(const locational_code<T, Dimension> c1,
+                const locational_code<T, Dimension> c2) noexcept {
+  return c1.value != c2.value;
+}
+
+/// @brief Depth-first order. A cell precedes its descendants, which precede
+/// the next sibling of the cell.
+template <typename T, unsigned int Dimension>
+bool operator<(const locational_code<T, Dimension> c1,
+               const locational_code<T, Dimension> c2) noexcept {
+  const T a1 = c1.aligned();
+  const T a2 = c2.aligned();
+  // Cells sharing the first descendant are ordered from the shallowest.
+  return a1 < a2 || (a1 == a2 && c1.value < c2.value);
+}
+
+template <typename T, unsigned int Dimension>
+bool operator>(const locational_code<T, Dimension> c1,
+               const locational_code<T, Dimension> c2) noexcept {
+  return c2 < c1;
+}
+
+template <typename T, unsigned int Dimension>
+bool operator<=(const locational_code<T, Dimension> c1,
+                const locational_code<T, Dimension> c2) noexcept {
+  return !(c2 < c1);
+}
+
+template <typename T, unsigned int Dimension>
+bool operator>=(const locational_code<T, Dimension> c1,
+                const locational_code<T, Dimension> c2) noexcept {
+  return !(c1 < c2);
+}
+
+/// @brief Returns the cell at a level which contains a morton code.
+/// @tparam Dimension Number of dimensions
+/// @tparam Traits morton_traits
+template <unsigned int Dimension, typename Traits, typename T>
+inline locational_code<T, Dimension> to_locational_code(
+    const T code, const unsigned int level) noexcept {
+  assert((level <= locational_code<T, Dimension>::max_level));
+  const T cell = shift_right(code, (Traits::bits - level) * Dimension);
+  return locational_code<T, Dimension>{
+      static_cast<T>(cell | (T(1) << (level * Dimension)))};
+}
+
+/// @brief Returns the first morton code in a cell.
+/// @tparam Traits morton_traits
+template <typename Traits, typename T, unsigned int Dimension>
+inline T first_code(const locational_code<T, Dimension> c) noexcept {
+  return shift_left(c.cell(), (Traits::bits - c.level()) * Dimension);
+}
+
+/// @brief Returns the last morton code in a cell.
+/// @tparam Traits morton_traits
+template <typename Traits, typename T, unsigned int Dimension>
+inline T last_code(const locational_code<T, Dimension> c) noexcept {
+  const unsigned int s = (Traits::bits - c.level()) * Dimension;
+  return static_cast<T>(shift_left(c.cell(), s) |
+                        static_cast<T>(shift_left(T(1), s) - 1));
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace std {
+
+/// @brief Hash of locational codes for unordered containers
+template <typename T, unsigned int Dimension>
+struct hash<morton::detail::locational_code<T, Dimension>> {
+  std::size_t operator()(
+      const morton::detail::locational_code<T, Dimension> c) const noexcept {
+    return std::hash<T>{}(c.value);
+  }
+};
+
+}  // namespace std
+
+namespace morton2d {
+
+/// @brief Locational code of a quadtree cell at any level.
+///
+/// max_level is 15 for 32-bit and 31 for 64-bit codes.
+/// @tparam T Unsigned integral type
+template <typename T>
+using locational_code = morton::detail::locational_code<T, 2>;
+
+/// Locational code in 32 bits
+using locational_code32_t = locational_code<uint32_t>;
+/// Locational code in 64 bits
+using locational_code64_t = locational_code<uint64_t>;
+
+/// @brief Returns the quadtree cell at a level which contains a morton code.
+/// @param[in] m Morton code
+/// @param[in] level Level from the root (0) to locational_code<T>::max_level
+template <typename T>
+inline locational_code<T> to_locational_code(
+    const morton_code<T> m, const unsigned int level) noexcept {
+  return morton::detail::to_locational_code<2, morton_traits<T>>(m.value,
+                                                                 level);
+}
+
+/// @brief Returns the first morton code in a quadtree cell, i.e. the code of
+/// its minimum corner.
+template <typename T>
+inline morton_code<T> first_code(const locational_code<T> c) noexcept {
+  return morton_code<T>{morton::detail::first_code<morton_traits<T>>(c)};
+}
+
+/// @brief Returns the last morton code in a quadtree cell.
+template <typename T>
+inline morton_code<T> last_code(const locational_code<T> c) noexcept {
+  return morton_code<T>{morton::detail::last_code<morton_traits<T>>(c)};
+}
+
+/// @brief Returns the quadtree cell of given coordinates in the grid of a
+/// level.
+/// @param[in] c Coordinates less than 2^level
+/// @param[in] level Level from the root (0) to locational_code<T>::max_level
+template <typename U, typename Tag = default_tag>
+inline auto make_locational_code(const coordinates<U>& c,
+                                 const unsigned int level, Tag tag = Tag{})
+    -> locational_code<decltype(encode(c, tag).value)> {
+  using T = decltype(encode(c, tag).value);
+  assert(level <= locational_code<T>::max_level);
+  return locational_code<T>{
+      static_cast<T>(encode(c, tag).value | (T(1) << (2 * level)))};
+}
+
+/// @brief Returns coordinates of a quadtree cell in the grid of its level.
+template <typename T, typename Tag = default_tag>
+inline coordinates<typename morton_traits<T>::coordinate_type>
+cell_coordinates(const locational_code<T> c, Tag tag = Tag{}) noexcept {
+  return decode(morton_code<T>{c.cell()}, tag);
+}
+
+/// @brief Finds a neighbor of a quadtree cell at the same level.
+/// @param[in] c Cell
+/// @param[in] dx Offset in x direction
+/// @param[in] dy Offset in y direction
+/// @param[out] result Neighbor, which is unchanged if it is out of the
+/// domain
+/// @returns False if the neighbor is out of the domain
+template <typename T, typename Tag = default_tag>
+inline bool neighbor(const locational_code<T> c, const int dx, const int dy,
+                     locational_code<T>& result, Tag tag = Tag{}) noexcept {
+  using U = typename morton_traits<T>::coordinate_type;
+  const unsigned int level = c.level();
+  const auto p = cell_coordinates(c, tag);
+  const long long n = 1ll << level;
+  const long long x = static_cast<long long>(p.x) + dx;
+  const long long y = static_cast<long long>(p.y) + dy;
+  if (x < 0 || x >= n || y < 0 || y >= n) return false;
+  result = make_locational_code(
+      coordinates<U>{static_cast<U>(x), static_cast<U>(y)}, level, tag);
+  return true;
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Locational code of an octree cell at any level.
+///
+/// max_level is 10 for 32-bit and 21 for 64-bit codes, which are the same as
+/// those of morton codes.
+/// @tparam T Unsigned integral type
+template <typename T>
+using locational_code = morton::detail::locational_code<T, 3>;
+
+/// Locational code in 32 bits
+using locational_code32_t = locational_code<uint32_t>;
+/// Locational code in 64 bits
+using locational_code64_t = locational_code<uint64_t>;
+
+/// @brief Returns the octree cell at a level which contains a morton code.
+/// @param[in] m Morton code
+/// @param[in] level Level from the root (0) to locational_code<T>::max_level
+template <typename T>
+inline locational_code<T> to_locational_code(
+    const morton_code<T> m, const unsigned int level) noexcept {
+  return morton::detail::to_locational_code<3, morton_traits<T>>(m.value,
+                                                                 level);
+}
+
+/// @brief Returns the first morton code in an octree cell, i.e. the code of
+/// its minimum corner.
+template <typename T>
+inline morton_code<T> first_code(const locational_code<T> c) noexcept {
+  return morton_code<T>{morton::detail::first_code<morton_traits<T>>(c)};
+}
+
+/// @brief Returns the last morton code in an octree cell.
+template <typename T>
+inline morton_code<T> last_code(const locational_code<T> c) noexcept {
+  return morton_code<T>{morton::detail::last_code<morton_traits<T>>(c)};
+}
+
+/// @brief Returns the octree cell of given coordinates in the grid of a
+/// level.
+/// @param[in] c Coordinates less than 2^level
+/// @param[in] level Level from the root (0) to locational_code<T>::max_level
+template <typename U, typename Tag = default_tag>
+inline auto make_locational_code(const coordinates<U>& c,
+                                 const unsigned int level, Tag tag = Tag{})
+    -> locational_code<decltype(encode(c, tag).value)> {
+  using T = decltype(encode(c, tag).value);
+  assert(level <= locational_code<T>::max_level);
+  return locational_code<T>{
+      static_cast<T>(encode(c, tag).value | (T(1) << (3 * level)))};
+}
+
+/// @brief Returns coordinates of an octree cell in the grid of its level.
+template <typename T, typename Tag = default_tag>
+inline coordinates<typename morton_traits<T>::coordinate_type>
+cell_coordinates(const locational_code<T> c, Tag tag = Tag{}) noexcept {
+  return decode(morton_code<T>{c.cell()}, tag);
+}
+
+/// @brief Finds a neighbor of an octree cell at the same level.
+/// @param[in] c Cell
+/// @param[in] dx Offset in x direction
+/// @param[in] dy Offset in y direction
+/// @param[in] dz Offset in z direction
+/// @param[out] result Neighbor, which is unchanged if it is out of the
+/// domain
+/// @returns False if the neighbor is out of the domain
+template <typename T, typename Tag = default_tag>
+inline bool neighbor(const locational_code<T> c, const int dx, const int dy,
+                     const int dz, locational_code<T>& result,
+                     Tag tag = Tag{}) noexcept {
+  using U = typename morton_traits<T>::coordinate_type;
+  const unsigned int level = c.level();
+  const auto p = cell_coordinates(c, tag);
+  const long long n = 1ll << level;
+  const long long x = static_cast<long long>(p.x) + dx;
+  const long long y = static_cast<long long>(p.y) + dy;
+  const long long z = static_cast<long long>(p.z) + dz;
+  if (x < 0 || x >= n || y < 0 || y >= n || z < 0 || z >= n) return false;
+  result = make_locational_code(
+      coordinates<U>{static_cast<U>(x), static_cast<U>(y), static_cast<U>(z)},
+      level, tag);
+  return true;
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_LOCATIONAL_HPP
@@ -0,0 +1,142 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_LOD_HPP
+#define MORTON_LOD_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "morton/locational.hpp"
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+#include "morton/parallel.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Returns the level of detail of a sorted code given its predecessor.
+///
+/// A code represents the cells of the levels in which it is the first code.
+/// It is the first of its cell at level l unless the previous code shares the
+/// cell, i.e. the top Dimension * l bits, so that the level is found from the
+/// highest bit in which the two codes differ. Duplicates of the previous code
+/// get Traits::bits + 1.
+template <unsigned int Dimension, typename Traits, typename T>
+inline unsigned int lod_level(const T previous, const T code) noexcept {
+  const T diff = static_cast<T>(previous ^ code);
+  if (diff == 0) return Traits::bits + 1;
+  return Traits::bits - highest_bit(diff) / Dimension;
+}
+
+/// @brief Reorders sorted codes in progressive levels of detail.
+/// @returns Ends of levels in the order
+template <unsigned int Dimension, typename Traits, typename Code>
+std::vector<std::size_t> lod_order(const Code* codes, std::size_t n,
+                                   std::size_t* order,
+                                   unsigned int num_threads) {
+  constexpr unsigned int num_levels = Traits::bits + 2;
+  const auto level = [codes](std::size_t i) -> unsigned int {
+    return i == 0 ? 0
+                  : lod_level<Dimension, Traits>(codes[i - 1].value,
+                                                 codes[i].value);
+  };
+  // Stable counting sort by levels, which is a pass of parallel_radix_sort.
+  const std::size_t t = num_blocks(n, num_threads);
+  std::vector<std::size_t> offsets(t * num_levels, 0);
+  run_in_parallel(t, [&](std::size_t b) {
+    std::size_t* counts = offsets.data() + b * num_levels;
+    const std::size_t last = block_begin(n, t, b + 1);
+    for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+      assert((i == 0 || codes[i - 1].value <= codes[i].value) &&
+             "Codes are not sorted");
+      ++counts[level(i)];
+    }
+  });
+  std::vector<std::size_t> ends(num_levels);
+  std::size_t sum = 0;
+  for (unsigned int l = 0; l < num_levels; ++l) {
+    for (std::size_t b = 0; b < t; ++b) {
+      const std::size_t count = offsets[b * num_levels + l];
+      offsets[b * num_levels + l] = sum;
+      sum += count;
+    }
+    ends[l] = sum;
+  }
+  run_in_parallel(t, [&](std::size_t b) {
+    std::size_t* next = offsets.data() + b * num_levels;
+    const std::size_t last = block_begin(n, t, b + 1);
+    for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+      order[next[level(i)]++] = i;
+    }
+  });
+  return ends;
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Reorders sorted morton codes in progressive levels of detail.
+///
+/// Codes are reordered so that any prefix of the order is a spatially uniform
+/// subset: the first code, then the first code of every non-empty quadtree
+/// cell at level 1 which is not taken yet, then those at level 2, and so on.
+/// The first ends[l] indices therefore have exactly one code in every
+/// non-empty cell at level l. Codes keep Z-order within a level. Duplicates
+/// of the previous code come last. The cost is linear in the number of
+/// codes.
+/// @tparam T Integral type for morton_code
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] n Number of codes
+/// @param[out] order Indices of n codes in progressive order
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+/// @returns Ends of levels 0 to morton_traits<T>::bits in the order followed
+/// by n, the end of duplicates
+template <typename T>
+std::vector<std::size_t> lod_order(const morton_code<T>* codes, std::size_t n,
+                                   std::size_t* order,
+                                   unsigned int num_threads = 0) {
+  return morton::detail::lod_order<2, morton_traits<T>>(codes, n, order,
+                                                        num_threads);
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Reorders sorted morton codes in progressive levels of detail.
+///
+/// Codes are reordered so that any prefix of the order is a spatially uniform
+/// subset: the first code, then the first code of every non-empty octree
+/// cell at level 1 which is not taken yet, then those at level 2, and so on.
+/// The first ends[l] indices therefore have exactly one code in every
+/// non-empty cell at level l. Codes keep Z-order within a level. Duplicates
+/// of the previous code come last. The cost is linear in the number of
+/// codes.
+/// @tparam T Integral type for morton_code
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] n Number of codes
+/// @param[out] order Indices of n codes in progressive order
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+/// @returns Ends of levels 0 to morton_traits<T>::bits in the order followed
+/// by n, the end of duplicates
+template <typename T>
+std::vector<std::size_t> lod_order(const morton_code<T>* codes, std::size_t n,
+                                   std::size_t* order,
+                                   unsigned int num_threads = 0) {
+  return morton::detail::lod_order<3, morton_traits<T>>(codes, n, order,
+                                                        num_threads);
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_LOD_HPP
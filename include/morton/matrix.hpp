@@ -0,0 +1,303 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_MATRIX_HPP
+#define MORTON_MATRIX_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "morton/grid.hpp"
+#include "morton/layout.hpp"
+
+namespace morton2d {
+
+namespace detail {
+
+/// @brief Returns the number of levels of tiles which are contiguous in all
+/// the layouts.
+inline unsigned int matrix_tile_bits(const layout& a, const layout& b,
+                                     const layout& c) noexcept {
+  return std::min(std::min(max_tile_bits, a.common_bits()),
+                  std::min(b.common_bits(), c.common_bits()));
+}
+
+/// @brief Swaps x and y bits of the morton code of a block in a tile.
+inline std::size_t swap_axes(std::size_t k) noexcept {
+  constexpr std::size_t mask = 0x5555;
+  return ((k & mask) << 1) | ((k >> 1) & mask);
+}
+
+/// @brief Transposes a contiguous tile of n elements in Z-order.
+///
+/// Elements of a 2x2 block are contiguous and stay in the same block, so that
+/// a block is moved at once with its two middle elements swapped.
+template <typename T>
+void transpose_tile(const T* src, T* dst, std::size_t n) noexcept {
+  if (n < 4) {
+    dst[0] = src[0];
+    return;
+  }
+  for (std::size_t k = 0; k < n / 4; ++k) {
+    const T* s = src + 4 * k;
+    T* d = dst + 4 * swap_axes(k);
+    d[0] = s[0];
+    d[1] = s[2];
+    d[2] = s[1];
+    d[3] = s[3];
+  }
+}
+
+/// @brief Matrix multiplication recursing on quadrants in Z-order.
+///
+/// Products of quadrants are computed recursively until they are tiles of at
+/// most max_tile x max_tile elements, which are contiguous in Z-order and fit
+/// in L1 cache together. Tiles are then gathered into row-major buffers and
+/// multiplied by loops over rows of the right-hand side which compilers
+/// vectorize.
+template <typename T>
+class matrix_multiplier {
+ public:
+  /// @param[in] a Storage of the left-hand side of m x k elements
+  /// @param[in] la Layout of a, whose width is k and height is m
+  /// @param[in] b Storage of the right-hand side of k x n elements
+  /// @param[in] lb Layout of b
+  /// @param[in,out] c Storage of the product of m x n elements
+  /// @param[in] lc Layout of c
+  matrix_multiplier(const T* a, const layout& la, const T* b,
+                    const layout& lb, T* c, const layout& lc)
+      : a_{a},
+        b_{b},
+        c_{c},
+        la_(la),
+        lb_(lb),
+        lc_(lc),
+        bits_{matrix_tile_bits(la, lb, lc)},
+        tile_{std::size_t(1) << bits_},
+        buffer_(3 * tile_ * tile_) {
+    for (uint32_t i = 0; i < tile_; ++i) {
+      offsets_[i] = encode(coordinates16_t(static_cast<uint16_t>(i), 0)).value;
+    }
+  }
+
+  /// @brief Adds the product to c.
+  void run() {
+    const std::size_t m = lc_.height(), n = lc_.width(), k = la_.width();
+    if (m == 0 || n == 0 || k == 0) return;
+    std::size_t size = tile_;
+    while (size < std::max(std::max(m, n), k)) size *= 2;
+    multiply(0, 0, 0, size);
+  }
+
+ private:
+  /// @brief Adds products of blocks of size x size elements.
+  /// @param[in] i Row of the blocks of a and c
+  /// @param[in] j Column of the blocks of b and c
+  /// @param[in] k Column of the block of a and row of the block of b
+  /// @param[in] size Number of rows and columns of blocks
+  void multiply(std::size_t i, std::size_t j, std::size_t k,
+                std::size_t size) {
+    if (i >= lc_.height() || j >= lc_.width() || k >= la_.width()) return;
+    if (size == tile_) {
+      multiply_tile(i, j, k);
+      return;
+    }
+    const std::size_t h = size / 2;
+    // Consecutive products share a quadrant of c, a or b.
+    multiply(i, j, k, h);
+    multiply(i, j + h, k, h);
+    multiply(i + h, j + h, k, h);
+    multiply(i + h, j, k, h);
+    multiply(i + h, j, k + h, h);
+    multiply(i + h, j + h, k + h, h);
+    multiply(i, j + h, k + h, h);
+    multiply(i, j, k + h, h);
+  }
+
+  /// @brief Copies a tile of at most rows x cols elements into a row-major
+  /// buffer.
+  void gather(const T* tile, std::size_t rows, std::size_t cols,
+              T* dst) const noexcept {
+    for (std::size_t y = 0; y < rows; ++y) {
+      for (std::size_t x = 0; x < cols; ++x) {
+        dst[y * tile_ + x] = tile[offsets_[x] | offsets_[y] << 1];
+      }
+    }
+  }
+
+  /// @brief Adds the product of row-major tiles of max_tile x max_tile
+  /// elements.
+  ///
+  /// Four rows of c are updated at once, so that every row of b loaded into
+  /// vector registers is used four times. Extents known at compile time let
+  /// compilers unroll and vectorize the loops over a row entirely.
+  static void multiply_full_tile(const T* a, const T* b, T* c) noexcept {
+    constexpr std::size_t t = max_tile;
+    for (std::size_t y = 0; y < t; y += 4) {
+      T* c0 = c + y * t;
+      T* c1 = c0 + t;
+      T* c2 = c1 + t;
+      T* c3 = c2 + t;
+      for (std::size_t z = 0; z < t; ++z) {
+        const T s0 = a[y * t + z];
+        const T s1 = a[(y + 1) * t + z];
+        const T s2 = a[(y + 2) * t + z];
+        const T s3 = a[(y + 3) * t + z];
+        const T* bz = b + z * t;
+        for (std::size_t x = 0; x < t; ++x) {
+          c0[x] += s0 * bz[x];
+          c1[x] += s1 * bz[x];
+          c2[x] += s2 * bz[x];
+          c3[x] += s3 * bz[x];
+        }
+      }
+    }
+  }
+
+  /// @brief Adds the product of tiles.
+  void multiply_tile(std::size_t i, std::size_t j, std::size_t k) {
+    const std::size_t rows = std::min(tile_, lc_.height() - i);
+    const std::size_t cols = std::min(tile_, lc_.width() - j);
+    const std::size_t depth = std::min(tile_, la_.width() - k);
+    T* at = buffer_.data();
+    T* bt = at + tile_ * tile_;
+    T* ct = bt + tile_ * tile_;
+    gather(a_ + la_.index(k, i), rows, depth, at);
+    gather(b_ + lb_.index(j, k), depth, cols, bt);
+    T* c = c_ + lc_.index(j, i);
+    gather(c, rows, cols, ct);
+    if (rows == max_tile && cols == max_tile && depth == max_tile) {
+      multiply_full_tile(at, bt, ct);
+    } else {
+      for (std::size_t y = 0; y < rows; ++y) {
+        T* cy = ct + y * tile_;
+        for (std::size_t z = 0; z < depth; ++z) {
+          const T s = at[y * tile_ + z];
+          const T* bz = bt + z * tile_;
+          for (std::size_t x = 0; x < cols; ++x) cy[x] += s * bz[x];
+        }
+      }
+    }
+    for (std::size_t y = 0; y < rows; ++y) {
+      for (std::size_t x = 0; x < cols; ++x) {
+        c[offsets_[x] | offsets_[y] << 1] = ct[y * tile_ + x];
+      }
+    }
+  }
+
+  const T* a_;
+  const T* b_;
+  T* c_;
+  const layout& la_;
+  const layout& lb_;
+  const layout& lc_;
+  unsigned int bits_;              /// Number of levels of tiles
+  std::size_t tile_;               /// Number of elements of a tile per axis
+  std::size_t offsets_[max_tile];  /// Dilated x offsets in a tile
+  std::vector<T> buffer_;          /// Row-major tiles of a, b and c
+};
+
+}  // namespace detail
+
+/// @brief Transposes a matrix in Z-order layout.
+///
+/// Tiles of up to 32 x 32 elements are contiguous in both grids, so that
+/// every tile is transposed from one contiguous block into another by moving
+/// 2x2 blocks.
+/// @param[in] a Matrix
+/// @param[out] b Transposed matrix, whose width and height are the height
+/// and width of a
+template <typename T, std::size_t A1, std::size_t A2>
+void transpose(const grid<T, A1>& a, grid<T, A2>& b) {
+  assert(b.width() == a.height() && b.height() == a.width() &&
+         "Extents do not match");
+  const layout& la = a.layout();
+  const layout& lb = b.layout();
+  const unsigned int bits = std::min(detail::max_tile_bits, la.common_bits());
+  const std::size_t tile = std::size_t(1) << bits;
+  for (std::size_t y = 0; y < a.height(); y += tile) {
+    for (std::size_t x = 0; x < a.width(); x += tile) {
+      // Padding in an edge tile is also the padding of the other.
+      detail::transpose_tile(a.data() + la.index(x, y),
+                             b.data() + lb.index(y, x), tile * tile);
+    }
+  }
+}
+
+/// @brief Copies a block of elements between matrices in Z-order layout.
+///
+/// Tiles of up to 32 x 32 elements which are aligned in both grids are
+/// copied as contiguous ranges. The other elements are copied one by one
+/// tile by tile.
+/// @param[in] src Source matrix
+/// @param[in] sx X coordinate of the block in src
+/// @param[in] sy Y coordinate of the block in src
+/// @param[in] width Number of elements of the block along x axis
+/// @param[in] height Number of elements of the block along y axis
+/// @param[out] dst Destination matrix
+/// @param[in] dx X coordinate of the block in dst
+/// @param[in] dy Y coordinate of the block in dst
+template <typename T, std::size_t A1, std::size_t A2>
+void copy(const grid<T, A1>& src, std::size_t sx, std::size_t sy,
+          std::size_t width, std::size_t height, grid<T, A2>& dst,
+          std::size_t dx, std::size_t dy) {
+  assert(sx + width <= src.width() && sy + height <= src.height() &&
+         dx + width <= dst.width() && dy + height <= dst.height() &&
+         "Block is out of matrices");
+  const layout& ls = src.layout();
+  const layout& ld = dst.layout();
+  const unsigned int bits = std::min(
+      detail::max_tile_bits, std::min(ls.common_bits(), ld.common_bits()));
+  const std::size_t tile = std::size_t(1) << bits;
+  const bool aligned = ((sx | sy | dx | dy) & (tile - 1)) == 0;
+  for (std::size_t y = 0; y < height; y += tile) {
+    const std::size_t th = std::min(tile, height - y);
+    for (std::size_t x = 0; x < width; x += tile) {
+      const std::size_t tw = std::min(tile, width - x);
+      if (aligned && tw == tile && th == tile) {
+        const T* s = src.data() + ls.index(sx + x, sy + y);
+        std::copy(s, s + tile * tile, dst.data() + ld.index(dx + x, dy + y));
+        continue;
+      }
+      for (std::size_t j = 0; j < th; ++j) {
+        for (std::size_t i = 0; i < tw; ++i) {
+          dst(dx + x + i, dy + y + j) = src(sx + x + i, sy + y + j);
+        }
+      }
+    }
+  }
+}
+
+/// @brief Adds the product of matrices in Z-order layout, c += a * b.
+///
+/// Quadrants of the matrices are multiplied recursively in Z-order, which is
+/// cache-oblivious, until they are tiles of at most 32 x 32 elements which
+/// fit in L1 cache. Tiles are multiplied in row-major buffers by loops which
+/// compilers vectorize. Elements are indexed as (column, row), i.e. the width
+/// of a grid is the number of columns.
+/// @param[in] a Left-hand side of k columns and m rows
+/// @param[in] b Right-hand side of n columns and k rows
+/// @param[in,out] c Product of n columns and m rows
+template <typename T, std::size_t A1, std::size_t A2, std::size_t A3>
+void multiply_add(const grid<T, A1>& a, const grid<T, A2>& b,
+                  grid<T, A3>& c) {
+  assert(a.width() == b.height() && c.height() == a.height() &&
+         c.width() == b.width() && "Extents do not match");
+  detail::matrix_multiplier<T>(a.data(), a.layout(), b.data(), b.layout(),
+                               c.data(), c.layout())
+      .run();
+}
+
+/// @brief Computes the product of matrices in Z-order layout, c = a * b.
+/// @see multiply_add
+template <typename T, std::size_t A1, std::size_t A2, std::size_t A3>
+void multiply(const grid<T, A1>& a, const grid<T, A2>& b, grid<T, A3>& c) {
+  c.fill(T(0));
+  multiply_add(a, b, c);
+}
+
+}  // namespace morton2d
+
+#endif  // MORTON_MATRIX_HPP
@@ -10,6 +10,16 @@
 #include <immintrin.h>
 #endif
 
+#if defined(__SSSE3__)
+#define MORTON2D_USE_SSSE3
+#include <immintrin.h>
+#endif
+
+#ifdef MORTON_USE_TUNED_TAGS
+#include "morton/tuned_tags.hpp"
+#endif
+
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <type_traits>
@@ -31,14 +41,23 @@ struct bmi {};
 /// Tag for magic-bits implementation
 struct magic_bits {};
 
+/// Tag for the implementation selected by the auto-tuner
+struct tuned {};
+
+/// Tag for the implementation looking up nibbles in SIMD registers by
+/// pshufb (SSSE3, and AVX2 for arrays)
+struct nibble_shuffle {};
+
 }  // namespace tag
 
 /// Default tag
-#ifdef MORTON2D_USE_BMI
+#if defined(MORTON_USE_TUNED_TAGS)
+using default_tag = tag::tuned;
+#elif defined(MORTON2D_USE_BMI)
 using default_tag = tag::bmi;
 #else
 using default_tag = tag::preshifted_lookup_table;
-#endif  // MORTON2D_USE_BMI
+#endif
 
 /// @brief Check if a given type is a tag.
 /// @tparam Tag Tag type
@@ -47,7 +66,9 @@ struct is_tag : std::conditional<
                     (std::is_same<Tag, tag::bmi>::value ||
                      std::is_same<Tag, tag::preshifted_lookup_table>::value ||
                      std::is_same<Tag, tag::lookup_table>::value ||
-                     std::is_same<Tag, tag::magic_bits>::value),
+                     std::is_same<Tag, tag::magic_bits>::value ||
+                     std::is_same<Tag, tag::tuned>::value ||
+                     std::is_same<Tag, tag::nibble_shuffle>::value),
                     std::true_type, std::false_type>::type {};
 
 /// @brief Morton code
@@ -88,6 +109,26 @@ bool operator!=(const morton_code<T> m1, const morton_code<T> m2) noexcept {
   return m1.value != m2.value;
 }
 
+template <typename T>
+bool operator<(const morton_code<T> m1, const morton_code<T> m2) noexcept {
+  return m1.value < m2.value;
+}
+
+template <typename T>
+bool operator>(const morton_code<T> m1, const morton_code<T> m2) noexcept {
+  return m1.value > m2.value;
+}
+
+template <typename T>
+bool operator<=(const morton_code<T> m1, const morton_code<T> m2) noexcept {
+  return m1.value <= m2.value;
+}
+
+template <typename T>
+bool operator>=(const morton_code<T> m1, const morton_code<T> m2) noexcept {
+  return m1.value >= m2.value;
+}
+
 template <typename T>
 std::ostream& operator<<(std::ostream& os, const morton_code<T> m) {
   return os << m.value;
@@ -125,6 +166,37 @@ using coordinates16_t = coordinates<uint16_t>;
 /// Coordinates in 32 bits
 using coordinates32_t = coordinates<uint32_t>;
 
+/// @brief Properties of morton codes in two dimensions.
+/// @tparam T Integral type for morton_code
+template <typename T>
+struct morton_traits {};
+
+/// @brief Properties of 32-bit morton codes.
+template <>
+struct morton_traits<uint32_t> {
+  /// Integral type for coordinates
+  using coordinate_type = uint16_t;
+  /// Number of bits of each coordinate
+  static constexpr unsigned int bits = 16;
+  /// Bits of x coordinate
+  static constexpr uint32_t mask_x = 0x55555555;
+  /// Bits of y coordinate
+  static constexpr uint32_t mask_y = 0xAAAAAAAA;
+};
+
+/// @brief Properties of 64-bit morton codes.
+template <>
+struct morton_traits<uint64_t> {
+  /// Integral type for coordinates
+  using coordinate_type = uint32_t;
+  /// Number of bits of each coordinate
+  static constexpr unsigned int bits = 32;
+  /// Bits of x coordinate
+  static constexpr uint64_t mask_x = 0x5555555555555555;
+  /// Bits of y coordinate
+  static constexpr uint64_t mask_y = 0xAAAAAAAAAAAAAAAA;
+};
+
 template <typename T>
 bool operator==(const coordinates<T>& c1, const coordinates<T>& c2) noexcept {
   return c1.x == c2.x && c1.y == c2.y;
@@ -285,9 +357,11 @@ inline U morton_impl<T, U, tag::preshifted_lookup_table>::decode(
   T code = 0;
   // 8-bit mask
   constexpr T mask = 0x000000FF;
-  for (unsigned int i = 0; i < sizeof(U); ++i) {
+  // Every byte of the morton code holds 4 bits of the coordinate.
+  for (unsigned int i = 0; i < sizeof(T); ++i) {
     const unsigned int shift = i * 8;
-    code |= static_cast<T>(table[(m >> shift) & mask] << (4 * i));
+    code |= static_cast<T>(static_cast<T>(table[(m >> shift) & mask])
+                           << (4 * i));
   }
   return static_cast<U>(code);
 }
@@ -447,6 +521,250 @@ inline coordinates<uint32_t> morton_impl<uint64_t, uint32_t, tag::bmi>::decode(
 
 #endif  // MORTON2D_USE_BMI
 
+#ifdef MORTON2D_USE_SSSE3
+
+/// Kernels of tag::nibble_shuffle. Every nibble of the input selects a byte
+/// of a 16-byte table held in a register, so that 16 (SSSE3) or 32 (AVX2)
+/// nibbles are converted by a pshufb without touching memory.
+///
+/// A lane holds coordinates {x, y} in its lower and upper halves, or a
+/// morton code of the same width. Nibble k of x and y is spread into byte k
+/// of each half, and bytes are then paired up and reordered by a shuffle.
+namespace nibble_shuffle {
+
+/// @brief Returns a table spreading the bits of a nibble into even bits of a
+/// byte.
+inline __m128i spread_table() noexcept {
+  return _mm_setr_epi8(0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15, 0x40,
+                       0x41, 0x44, 0x45, 0x50, 0x51, 0x54, 0x55);
+}
+
+/// @brief Returns a table collecting even bits of a nibble into bits 0-1 and
+/// odd bits into bits 4-5 of a byte.
+inline __m128i collect_table() noexcept {
+  return _mm_setr_epi8(0x00, 0x01, 0x10, 0x11, 0x02, 0x03, 0x12, 0x13, 0x20,
+                       0x21, 0x30, 0x31, 0x22, 0x23, 0x32, 0x33);
+}
+
+/// @brief Encodes 4 coordinates in 32-bit lanes.
+inline __m128i encode32(const __m128i v) noexcept {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i table = spread_table();
+  const __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(v, nibble));
+  const __m128i hi =
+      _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+  // Moves spread y to odd bits: even bytes of the code in the lower half and
+  // odd bytes in the upper half.
+  const __m128i even = _mm_or_si128(lo, _mm_srli_epi32(lo, 15));
+  const __m128i odd = _mm_or_si128(hi, _mm_srli_epi32(hi, 15));
+  const __m128i r = _mm_or_si128(_mm_and_si128(even, _mm_set1_epi32(0xFFFF)),
+                                 _mm_slli_epi32(odd, 16));
+  return _mm_shuffle_epi8(r, _mm_setr_epi8(0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 9,
+                                           11, 12, 14, 13, 15));
+}
+
+/// @brief Decodes 4 morton codes in 32-bit lanes.
+inline __m128i decode32(const __m128i v) noexcept {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i table = collect_table();
+  // Nibbles of x in bits 0-3 and nibbles of y in bits 4-7 of each byte
+  const __m128i e = _mm_or_si128(
+      _mm_shuffle_epi8(table, _mm_and_si128(v, nibble)),
+      _mm_shuffle_epi8(_mm_slli_epi16(table, 2),
+                       _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+  // Swaps the nibble of y in the lower byte with the nibble of x in the upper
+  // byte of every 16 bits.
+  const __m128i q = _mm_or_si128(
+      _mm_and_si128(e, _mm_set1_epi16(static_cast<short>(0xF00F))),
+      _mm_or_si128(
+          _mm_and_si128(_mm_srli_epi16(e, 4), _mm_set1_epi16(0x00F0)),
+          _mm_and_si128(_mm_slli_epi16(e, 4), _mm_set1_epi16(0x0F00))));
+  return _mm_shuffle_epi8(q, _mm_setr_epi8(0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 9,
+                                           11, 12, 14, 13, 15));
+}
+
+/// @brief Encodes 2 coordinates in 64-bit lanes.
+inline __m128i encode64(const __m128i v) noexcept {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i table = spread_table();
+  const __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(v, nibble));
+  const __m128i hi =
+      _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+  const __m128i even = _mm_or_si128(lo, _mm_srli_epi64(lo, 31));
+  const __m128i odd = _mm_or_si128(hi, _mm_srli_epi64(hi, 31));
+  const __m128i r =
+      _mm_or_si128(_mm_and_si128(even, _mm_set1_epi64x(0xFFFFFFFF)),
+                   _mm_slli_epi64(odd, 32));
+  return _mm_shuffle_epi8(r, _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9,
+                                           13, 10, 14, 11, 15));
+}
+
+/// @brief Decodes 2 morton codes in 64-bit lanes.
+inline __m128i decode64(const __m128i v) noexcept {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i table = collect_table();
+  const __m128i e = _mm_or_si128(
+      _mm_shuffle_epi8(table, _mm_and_si128(v, nibble)),
+      _mm_shuffle_epi8(_mm_slli_epi16(table, 2),
+                       _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+  const __m128i q = _mm_or_si128(
+      _mm_and_si128(e, _mm_set1_epi16(static_cast<short>(0xF00F))),
+      _mm_or_si128(
+          _mm_and_si128(_mm_srli_epi16(e, 4), _mm_set1_epi16(0x00F0)),
+          _mm_and_si128(_mm_slli_epi16(e, 4), _mm_set1_epi16(0x0F00))));
+  return _mm_shuffle_epi8(q, _mm_setr_epi8(0, 2, 4, 6, 1, 3, 5, 7, 8, 10, 12,
+                                           14, 9, 11, 13, 15));
+}
+
+#ifdef __AVX2__
+
+/// @brief Encodes 8 coordinates in 32-bit lanes.
+inline __m256i encode32(const __m256i v) noexcept {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i table = _mm256_broadcastsi128_si256(spread_table());
+  const __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble));
+  const __m256i hi = _mm256_shuffle_epi8(
+      table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+  const __m256i even = _mm256_or_si256(lo, _mm256_srli_epi32(lo, 15));
+  const __m256i odd = _mm256_or_si256(hi, _mm256_srli_epi32(hi, 15));
+  const __m256i r =
+      _mm256_or_si256(_mm256_and_si256(even, _mm256_set1_epi32(0xFFFF)),
+                      _mm256_slli_epi32(odd, 16));
+  return _mm256_shuffle_epi8(
+      r, _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 2, 1, 3, 4, 6, 5, 7, 8,
+                                                   10, 9, 11, 12, 14, 13, 15)));
+}
+
+/// @brief Decodes 8 morton codes in 32-bit lanes.
+inline __m256i decode32(const __m256i v) noexcept {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i table = _mm256_broadcastsi128_si256(collect_table());
+  const __m256i e = _mm256_or_si256(
+      _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble)),
+      _mm256_shuffle_epi8(_mm256_slli_epi16(table, 2),
+                          _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+  const __m256i q = _mm256_or_si256(
+      _mm256_and_si256(e, _mm256_set1_epi16(static_cast<short>(0xF00F))),
+      _mm256_or_si256(
+          _mm256_and_si256(_mm256_srli_epi16(e, 4), _mm256_set1_epi16(0x00F0)),
+          _mm256_and_si256(_mm256_slli_epi16(e, 4),
+                           _mm256_set1_epi16(0x0F00))));
+  return _mm256_shuffle_epi8(
+      q, _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 2, 1, 3, 4, 6, 5, 7, 8,
+                                                   10, 9, 11, 12, 14, 13, 15)));
+}
+
+/// @brief Encodes 4 coordinates in 64-bit lanes.
+inline __m256i encode64(const __m256i v) noexcept {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i table = _mm256_broadcastsi128_si256(spread_table());
+  const __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble));
+  const __m256i hi = _mm256_shuffle_epi8(
+      table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+  const __m256i even = _mm256_or_si256(lo, _mm256_srli_epi64(lo, 31));
+  const __m256i odd = _mm256_or_si256(hi, _mm256_srli_epi64(hi, 31));
+  const __m256i r =
+      _mm256_or_si256(_mm256_and_si256(even, _mm256_set1_epi64x(0xFFFFFFFF)),
+                      _mm256_slli_epi64(odd, 32));
+  return _mm256_shuffle_epi8(
+      r, _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8,
+                                                   12, 9, 13, 10, 14, 11, 15)));
+}
+
+/// @brief Decodes 4 morton codes in 64-bit lanes.
+inline __m256i decode64(const __m256i v) noexcept {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i table = _mm256_broadcastsi128_si256(collect_table());
+  const __m256i e = _mm256_or_si256(
+      _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble)),
+      _mm256_shuffle_epi8(_mm256_slli_epi16(table, 2),
+                          _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+  const __m256i q = _mm256_or_si256(
+      _mm256_and_si256(e, _mm256_set1_epi16(static_cast<short>(0xF00F))),
+      _mm256_or_si256(
+          _mm256_and_si256(_mm256_srli_epi16(e, 4), _mm256_set1_epi16(0x00F0)),
+          _mm256_and_si256(_mm256_slli_epi16(e, 4),
+                           _mm256_set1_epi16(0x0F00))));
+  return _mm256_shuffle_epi8(
+      q, _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 2, 4, 6, 1, 3, 5, 7, 8,
+                                                   10, 12, 14, 9, 11, 13, 15)));
+}
+
+#endif  // __AVX2__
+
+}  // namespace nibble_shuffle
+
+/// @brief Morton code implementation looking up nibbles by pshufb for 32-bit
+/// morton codes.
+template <>
+class morton_impl<uint32_t, uint16_t, tag::nibble_shuffle> {
+ public:
+  /// @brief Encode coordinates to morton code
+  /// @param[in] c Coordinates
+  /// @returns Moton code
+  static morton_code<uint32_t> encode(const coordinates<uint16_t>& c) noexcept;
+
+  /// @brief Decode morton code to coordinates
+  /// @param[in] m Morton code
+  /// @returns Coordinates
+  static coordinates<uint16_t> decode(const morton_code<uint32_t> m) noexcept;
+};
+
+inline morton_code<uint32_t>
+morton_impl<uint32_t, uint16_t, tag::nibble_shuffle>::encode(
+    const coordinates<uint16_t>& c) noexcept {
+  const uint32_t v = c.x | static_cast<uint32_t>(c.y) << 16;
+  const __m128i m =
+      nibble_shuffle::encode32(_mm_cvtsi32_si128(static_cast<int>(v)));
+  return morton_code<uint32_t>{static_cast<uint32_t>(_mm_cvtsi128_si32(m))};
+}
+
+inline coordinates<uint16_t>
+morton_impl<uint32_t, uint16_t, tag::nibble_shuffle>::decode(
+    const morton_code<uint32_t> m) noexcept {
+  const __m128i c = nibble_shuffle::decode32(
+      _mm_cvtsi32_si128(static_cast<int>(m.value)));
+  const auto v = static_cast<uint32_t>(_mm_cvtsi128_si32(c));
+  return {static_cast<uint16_t>(v), static_cast<uint16_t>(v >> 16)};
+}
+
+/// @brief Morton code implementation looking up nibbles by pshufb for 64-bit
+/// morton codes.
+template <>
+class morton_impl<uint64_t, uint32_t, tag::nibble_shuffle> {
+ public:
+  /// @brief Encode coordinates to morton code
+  /// @param[in] c Coordinates
+  /// @returns Moton code
+  static morton_code<uint64_t> encode(const coordinates<uint32_t>& c) noexcept;
+
+  /// @brief Decode morton code to coordinates
+  /// @param[in] m Morton code
+  /// @returns Coordinates
+  static coordinates<uint32_t> decode(const morton_code<uint64_t> m) noexcept;
+};
+
+inline morton_code<uint64_t>
+morton_impl<uint64_t, uint32_t, tag::nibble_shuffle>::encode(
+    const coordinates<uint32_t>& c) noexcept {
+  const __m128i m = nibble_shuffle::encode64(
+      _mm_set_epi32(0, 0, static_cast<int>(c.y), static_cast<int>(c.x)));
+  uint64_t v;
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(&v), m);
+  return morton_code<uint64_t>{v};
+}
+
+inline coordinates<uint32_t>
+morton_impl<uint64_t, uint32_t, tag::nibble_shuffle>::decode(
+    const morton_code<uint64_t> m) noexcept {
+  const __m128i c = nibble_shuffle::decode64(_mm_loadl_epi64(
+      reinterpret_cast<const __m128i*>(&m.value)));
+  return {static_cast<uint32_t>(_mm_cvtsi128_si32(c)),
+          static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_epi64(c, 32)))};
+}
+
+#endif  // MORTON2D_USE_SSSE3
+
 /// @brief Morton code implementation using magic bits in two dimensions for 32
 /// bits morton codes.
 template <>
@@ -577,6 +895,240 @@ morton_impl<uint64_t, uint32_t, tag::magic_bits>::collect_every_other_bit(
   return static_cast<uint32_t>(x);
 }
 
+/// Tag used by tag::tuned unless morton/tuned_tags.hpp generated by the
+/// auto-tuner selects one
+#ifdef MORTON2D_USE_BMI
+using untuned_tag = tag::bmi;
+#else
+using untuned_tag = tag::preshifted_lookup_table;
+#endif
+
+/// @brief Tags selected by the auto-tuner.
+///
+/// encode and decode are used for single items, and batch_encode and
+/// batch_decode for arrays, whose implementations may differ, e.g. SIMD
+/// kernels. Batch tags default to those of single items.
+/// @tparam T Integral type for morton_code
+template <typename T>
+struct tuned_tags {};
+
+template <>
+struct tuned_tags<uint32_t> {
+#ifdef MORTON2D_TUNED_ENCODE32_TAG
+  using encode = tag::MORTON2D_TUNED_ENCODE32_TAG;
+#else
+  using encode = untuned_tag;
+#endif
+#ifdef MORTON2D_TUNED_DECODE32_TAG
+  using decode = tag::MORTON2D_TUNED_DECODE32_TAG;
+#else
+  using decode = untuned_tag;
+#endif
+#ifdef MORTON2D_TUNED_BATCH_ENCODE32_TAG
+  using batch_encode = tag::MORTON2D_TUNED_BATCH_ENCODE32_TAG;
+#else
+  using batch_encode = encode;
+#endif
+#ifdef MORTON2D_TUNED_BATCH_DECODE32_TAG
+  using batch_decode = tag::MORTON2D_TUNED_BATCH_DECODE32_TAG;
+#else
+  using batch_decode = decode;
+#endif
+};
+
+template <>
+struct tuned_tags<uint64_t> {
+#ifdef MORTON2D_TUNED_ENCODE64_TAG
+  using encode = tag::MORTON2D_TUNED_ENCODE64_TAG;
+#else
+  using encode = untuned_tag;
+#endif
+#ifdef MORTON2D_TUNED_DECODE64_TAG
+  using decode = tag::MORTON2D_TUNED_DECODE64_TAG;
+#else
+  using decode = untuned_tag;
+#endif
+#ifdef MORTON2D_TUNED_BATCH_ENCODE64_TAG
+  using batch_encode = tag::MORTON2D_TUNED_BATCH_ENCODE64_TAG;
+#else
+  using batch_encode = encode;
+#endif
+#ifdef MORTON2D_TUNED_BATCH_DECODE64_TAG
+  using batch_decode = tag::MORTON2D_TUNED_BATCH_DECODE64_TAG;
+#else
+  using batch_decode = decode;
+#endif
+};
+
+/// @brief Morton code implementation dispatching to the implementations
+/// selected by the auto-tuner for each operation and code width.
+/// @tparam T Integral type for morton_code
+/// @tparam U Integral type for coordinates
+template <typename T, typename U>
+class morton_impl<T, U, tag::tuned> {
+ public:
+  /// @brief Encode coordinates to morton code
+  /// @param[in] c Coordinates
+  /// @returns Moton code
+  static morton_code<T> encode(const coordinates<U>& c) noexcept;
+
+  /// @brief Decode morton code to coordinates
+  /// @param[in] m Morton code
+  /// @returns Coordinates
+  static coordinates<U> decode(const morton_code<T> m) noexcept;
+};
+
+template <typename T, typename U>
+inline morton_code<T> morton_impl<T, U, tag::tuned>::encode(
+    const coordinates<U>& c) noexcept {
+  return morton_impl<T, U, typename tuned_tags<T>::encode>::encode(c);
+}
+
+template <typename T, typename U>
+inline coordinates<U> morton_impl<T, U, tag::tuned>::decode(
+    const morton_code<T> m) noexcept {
+  return morton_impl<T, U, typename tuned_tags<T>::decode>::decode(m);
+}
+
+/// @brief Conversion of arrays. Items are converted one by one unless an
+/// implementation is specialized for arrays.
+/// @tparam T Integral type for morton_code
+/// @tparam U Integral type for coordinates
+/// @tparam Tag Tag to switch implementation
+template <typename T, typename U, typename Tag>
+struct batch_impl {
+  static void encode(const coordinates<U>* c, std::size_t n,
+                     morton_code<T>* m) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      m[i] = morton_impl<T, U, Tag>::encode(c[i]);
+    }
+  }
+
+  static void decode(const morton_code<T>* m, std::size_t n,
+                     coordinates<U>* c) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      c[i] = morton_impl<T, U, Tag>::decode(m[i]);
+    }
+  }
+};
+
+template <typename T, typename U>
+struct batch_impl<T, U, tag::tuned> {
+  static void encode(const coordinates<U>* c, std::size_t n,
+                     morton_code<T>* m) noexcept {
+    using Tag = typename tuned_tags<T>::batch_encode;
+    batch_impl<T, U, Tag>::encode(c, n, m);
+  }
+
+  static void decode(const morton_code<T>* m, std::size_t n,
+                     coordinates<U>* c) noexcept {
+    using Tag = typename tuned_tags<T>::batch_decode;
+    batch_impl<T, U, Tag>::decode(m, n, c);
+  }
+};
+
+#ifdef MORTON2D_USE_SSSE3
+
+// Arrays are loaded into registers as they are.
+static_assert(sizeof(coordinates<uint16_t>) == 4 &&
+                  sizeof(coordinates<uint32_t>) == 8,
+              "coordinates are not packed");
+static_assert(sizeof(morton_code<uint32_t>) == 4 &&
+                  sizeof(morton_code<uint64_t>) == 8,
+              "morton codes are not packed");
+
+template <>
+struct batch_impl<uint32_t, uint16_t, tag::nibble_shuffle> {
+  using impl = morton_impl<uint32_t, uint16_t, tag::nibble_shuffle>;
+
+  static void encode(const coordinates<uint16_t>* c, std::size_t n,
+                     morton_code<uint32_t>* m) noexcept {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 8 <= n; i += 8) {
+      const __m256i v =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(m + i),
+                          nibble_shuffle::encode32(v));
+    }
+#endif
+    for (; i + 4 <= n; i += 4) {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(m + i),
+                       nibble_shuffle::encode32(v));
+    }
+    for (; i < n; ++i) m[i] = impl::encode(c[i]);
+  }
+
+  static void decode(const morton_code<uint32_t>* m, std::size_t n,
+                     coordinates<uint16_t>* c) noexcept {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 8 <= n; i += 8) {
+      const __m256i v =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + i),
+                          nibble_shuffle::decode32(v));
+    }
+#endif
+    for (; i + 4 <= n; i += 4) {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(m + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(c + i),
+                       nibble_shuffle::decode32(v));
+    }
+    for (; i < n; ++i) c[i] = impl::decode(m[i]);
+  }
+};
+
+template <>
+struct batch_impl<uint64_t, uint32_t, tag::nibble_shuffle> {
+  using impl = morton_impl<uint64_t, uint32_t, tag::nibble_shuffle>;
+
+  static void encode(const coordinates<uint32_t>* c, std::size_t n,
+                     morton_code<uint64_t>* m) noexcept {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= n; i += 4) {
+      const __m256i v =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(m + i),
+                          nibble_shuffle::encode64(v));
+    }
+#endif
+    for (; i + 2 <= n; i += 2) {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(m + i),
+                       nibble_shuffle::encode64(v));
+    }
+    for (; i < n; ++i) m[i] = impl::encode(c[i]);
+  }
+
+  static void decode(const morton_code<uint64_t>* m, std::size_t n,
+                     coordinates<uint32_t>* c) noexcept {
+    std::size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= n; i += 4) {
+      const __m256i v =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + i),
+                          nibble_shuffle::decode64(v));
+    }
+#endif
+    for (; i + 2 <= n; i += 2) {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(m + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(c + i),
+                       nibble_shuffle::decode64(v));
+    }
+    for (; i < n; ++i) c[i] = impl::decode(m[i]);
+  }
+};
+
+#endif  // MORTON2D_USE_SSSE3
+
 }  // namespace detail
 
 /// @brief Encode 2D coordinates into 32-bits morton code.
@@ -619,6 +1171,54 @@ inline coordinates32_t decode(const morton_code64_t m, Tag = Tag{}) noexcept {
   return detail::morton_impl<uint64_t, uint32_t, Tag>::decode(m);
 }
 
+/// @brief Encode an array of 2D coordinates into 32-bits morton codes.
+/// @tparam Tag Tag to switch implementation
+/// @param[in] c Coordinates
+/// @param[in] n Number of coordinates
+/// @param[out] m Morton codes
+template <typename Tag = default_tag>
+inline void encode(const coordinates16_t* c, std::size_t n, morton_code32_t* m,
+                   Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  detail::batch_impl<uint32_t, uint16_t, Tag>::encode(c, n, m);
+}
+
+/// @brief Encode an array of 2D coordinates into 64-bits morton codes.
+/// @tparam Tag Tag to switch implementation
+/// @param[in] c Coordinates
+/// @param[in] n Number of coordinates
+/// @param[out] m Morton codes
+template <typename Tag = default_tag>
+inline void encode(const coordinates32_t* c, std::size_t n, morton_code64_t* m,
+                   Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  detail::batch_impl<uint64_t, uint32_t, Tag>::encode(c, n, m);
+}
+
+/// @brief Decode an array of 32-bits morton codes into 2D coordinates.
+/// @tparam Tag Tag to switch implementation
+/// @param[in] m Morton codes
+/// @param[in] n Number of morton codes
+/// @param[out] c Coordinates
+template <typename Tag = default_tag>
+inline void decode(const morton_code32_t* m, std::size_t n, coordinates16_t* c,
+                   Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  detail::batch_impl<uint32_t, uint16_t, Tag>::decode(m, n, c);
+}
+
+/// @brief Decode an array of 64-bits morton codes into 2D coordinates.
+/// @tparam Tag Tag to switch implementation
+/// @param[in] m Morton codes
+/// @param[in] n Number of morton codes
+/// @param[out] c Coordinates
+template <typename Tag = default_tag>
+inline void decode(const morton_code64_t* m, std::size_t n, coordinates32_t* c,
+                   Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  detail::batch_impl<uint64_t, uint32_t, Tag>::decode(m, n, c);
+}
+
 }  // namespace morton2d
 
 #endif  // MORTON_MORTON2D_HPP
\ No newline at end of file
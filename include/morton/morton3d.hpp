@@ -10,8 +10,18 @@
 #include <immintrin.h>
 #endif
 
+#if defined(__SSSE3__)
+#define MORTON3D_USE_SSSE3
+#include <immintrin.h>
+#endif
+
+#ifdef MORTON_USE_TUNED_TAGS
+#include "morton/tuned_tags.hpp"
+#endif
+
 #include <bitset>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <type_traits>
@@ -34,14 +44,23 @@ struct bmi {};
 /// Tag for matic bits implementation
 struct magic_bits {};
 
+/// Tag for the implementation selected by the auto-tuner
+struct tuned {};
+
+/// Tag for the implementation looking up nibbles in SIMD registers by
+/// pshufb (SSSE3)
+struct nibble_shuffle {};
+
 }  // namespace tag
 
 /// Default tag
-#ifdef MORTON3D_USE_BMI
+#if defined(MORTON_USE_TUNED_TAGS)
+using default_tag = tag::tuned;
+#elif defined(MORTON3D_USE_BMI)
 using default_tag = tag::bmi;
 #else
 using default_tag = tag::preshifted_lookup_table;
-#endif  // MORTON3D_USE_BMI
+#endif
 
 /// @brief Check if a given type is a tag.
 /// @tparam Tag Tag type
@@ -50,7 +69,9 @@ struct is_tag : std::conditional<
                     (std::is_same<Tag, tag::bmi>::value ||
                      std::is_same<Tag, tag::preshifted_lookup_table>::value ||
                      std::is_same<Tag, tag::lookup_table>::value ||
-                     std::is_same<Tag, tag::magic_bits>::value),
+                     std::is_same<Tag, tag::magic_bits>::value ||
+                     std::is_same<Tag, tag::tuned>::value ||
+                     std::is_same<Tag, tag::nibble_shuffle>::value),
                     std::true_type, std::false_type>::type {};
 
 /// @brief Morton code
@@ -91,6 +112,26 @@ bool operator!=(const morton_code<T> m1, const morton_code<T> m2) noexcept {
   return m1.value != m2.value;
 }
 
+template <typename T>
+bool operator<(const morton_code<T> m1, const morton_code<T> m2) noexcept {
+  return m1.value < m2.value;
+}
+
+template <typename T>
+bool operator>(const morton_code<T> m1, const morton_code<T> m2) noexcept {
+  return m1.value > m2.value;
+}
+
+template <typename T>
+bool operator<=(const morton_code<T> m1, const morton_code<T> m2) noexcept {
+  return m1.value <= m2.value;
+}
+
+template <typename T>
+bool operator>=(const morton_code<T> m1, const morton_code<T> m2) noexcept {
+  return m1.value >= m2.value;
+}
+
 template <typename T>
 std::ostream& operator<<(std::ostream& os, const morton_code<T> m) {
   return os << m.value;
@@ -130,6 +171,41 @@ using coordinates16_t = coordinates<uint16_t>;
 /// Coordinates in 32 bits
 using coordinates32_t = coordinates<uint32_t>;
 
+/// @brief Properties of morton codes in three dimensions.
+/// @tparam T Integral type for morton_code
+template <typename T>
+struct morton_traits {};
+
+/// @brief Properties of 32-bit morton codes.
+template <>
+struct morton_traits<uint32_t> {
+  /// Integral type for coordinates
+  using coordinate_type = uint16_t;
+  /// Number of bits of each coordinate
+  static constexpr unsigned int bits = 10;
+  /// Bits of x coordinate
+  static constexpr uint32_t mask_x = 0x09249249;
+  /// Bits of y coordinate
+  static constexpr uint32_t mask_y = 0x12492492;
+  /// Bits of z coordinate
+  static constexpr uint32_t mask_z = 0x24924924;
+};
+
+/// @brief Properties of 64-bit morton codes.
+template <>
+struct morton_traits<uint64_t> {
+  /// Integral type for coordinates
+  using coordinate_type = uint32_t;
+  /// Number of bits of each coordinate
+  static constexpr unsigned int bits = 21;
+  /// Bits of x coordinate
+  static constexpr uint64_t mask_x = 0x1249249249249249;
+  /// Bits of y coordinate
+  static constexpr uint64_t mask_y = 0x2492492492492492;
+  /// Bits of z coordinate
+  static constexpr uint64_t mask_z = 0x4924924924924924;
+};
+
 template <typename T>
 bool operator==(const coordinates<T>& c1, const coordinates<T>& c2) noexcept {
   return c1.x == c2.x && c1.y == c2.y && c1.z == c2.z;
@@ -719,6 +795,493 @@ morton3d<uint64_t, uint32_t, tag::magic_bits>::collect_every_third_bit(
   return static_cast<uint32_t>(x);
 }
 
+#ifdef MORTON3D_USE_SSSE3
+
+/// Kernels of tag::nibble_shuffle. Every nibble of the input selects a byte
+/// of a 16-byte table held in a register, so that 16 nibbles are converted
+/// by a pshufb without touching memory.
+///
+/// A nibble of a coordinate spreads into 12 bits, whose lower and upper
+/// bytes are looked up in two tables. Byte k of a coordinate is first moved
+/// to byte 3k of a lane, so that the 24 bits it spreads into are put together
+/// by shifts of the lane. A nibble of a code holds at most two bits of an
+/// axis, which are collected by a table into the bits they take in a nibble
+/// of the coordinate, and the three nibbles of a coordinate nibble are ORed.
+///
+/// Four items of 32-bit codes or two items of 64-bit codes take 24 bytes of
+/// coordinates, which are held in two registers as bytes 0-15 and 8-23.
+namespace nibble_shuffle {
+
+/// @brief Returns a table spreading the bits of a nibble into bits 0, 3 and
+/// 6 of a byte, which is the lower byte of the 12 bits they spread into.
+inline __m128i spread_lo_table() noexcept {
+  return _mm_setr_epi8(0x00, 0x01, 0x08, 0x09, 0x40, 0x41, 0x48, 0x49, 0x00,
+                       0x01, 0x08, 0x09, 0x40, 0x41, 0x48, 0x49);
+}
+
+/// @brief Returns a table moving bit 3 of a nibble into bit 1 of a byte,
+/// which is the upper byte of the 12 bits the nibble spreads into.
+inline __m128i spread_hi_table() noexcept {
+  return _mm_setr_epi8(0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+                       0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02);
+}
+
+/// @brief Returns a table collecting bits 0, 3, 2 and 1 of a nibble into
+/// bits 0-3 of a byte.
+///
+/// A nibble of a code at bit 12k, 12k + 4 or 12k + 8 holds bits 0 and 3,
+/// bit 2 or bit 1 of an axis, which are bits 0-1, 2 or 3 of its nibble k.
+inline __m128i collect_table() noexcept {
+  return _mm_setr_epi8(0x00, 0x01, 0x08, 0x09, 0x04, 0x05, 0x0C, 0x0D, 0x02,
+                       0x03, 0x0A, 0x0B, 0x06, 0x07, 0x0E, 0x0F);
+}
+
+/// @brief Looks up the lower and upper nibbles of bytes in a table.
+inline void lookup(const __m128i table, const __m128i v, __m128i& lo,
+                   __m128i& hi) noexcept {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  lo = _mm_shuffle_epi8(table, _mm_and_si128(v, nibble));
+  hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+}
+
+/// @brief Returns bytes of a coordinate in bytes 0 and 3 of 32-bit lanes
+/// spread into every third bit.
+inline __m128i spread32(const __m128i e) noexcept {
+  __m128i lo_lo, hi_lo, lo_hi, hi_hi;
+  lookup(spread_lo_table(), e, lo_lo, hi_lo);
+  lookup(spread_hi_table(), e, lo_hi, hi_hi);
+  return _mm_or_si128(_mm_or_si128(lo_lo, _mm_slli_epi32(lo_hi, 8)),
+                      _mm_or_si128(_mm_slli_epi32(hi_lo, 12),
+                                   _mm_slli_epi32(hi_hi, 20)));
+}
+
+/// @brief Returns bytes of a coordinate in bytes 0, 3 and 6 of 64-bit lanes
+/// spread into every third bit.
+inline __m128i spread64(const __m128i e) noexcept {
+  __m128i lo_lo, hi_lo, lo_hi, hi_hi;
+  lookup(spread_lo_table(), e, lo_lo, hi_lo);
+  lookup(spread_hi_table(), e, lo_hi, hi_hi);
+  return _mm_or_si128(_mm_or_si128(lo_lo, _mm_slli_epi64(lo_hi, 8)),
+                      _mm_or_si128(_mm_slli_epi64(hi_lo, 12),
+                                   _mm_slli_epi64(hi_hi, 20)));
+}
+
+/// @brief Returns every third bit of 32-bit lanes collected into bytes 0 and
+/// 3 of the lanes. Other bytes are garbage.
+inline __m128i collect32(const __m128i m) noexcept {
+  __m128i lo, hi;
+  lookup(collect_table(), m, lo, hi);
+  // Nibbles of bytes 3k, 3k + 1 and 3k + 2 of a code make up the lower
+  // nibble, both nibbles and the upper nibble of byte k of a coordinate.
+  const __m128i lower = _mm_or_si128(lo, hi);
+  const __m128i middle = _mm_or_si128(lo, _mm_slli_epi16(hi, 4));
+  return _mm_or_si128(_mm_or_si128(lower, _mm_srli_epi32(middle, 8)),
+                      _mm_srli_epi32(_mm_slli_epi16(lower, 4), 16));
+}
+
+/// @brief Returns every third bit of 64-bit lanes collected into bytes 0, 3
+/// and 6 of the lanes. Other bytes are garbage.
+inline __m128i collect64(const __m128i m) noexcept {
+  __m128i lo, hi;
+  lookup(collect_table(), m, lo, hi);
+  const __m128i lower = _mm_or_si128(lo, hi);
+  const __m128i middle = _mm_or_si128(lo, _mm_slli_epi16(hi, 4));
+  return _mm_or_si128(_mm_or_si128(lower, _mm_srli_epi64(middle, 8)),
+                      _mm_srli_epi64(_mm_slli_epi16(lower, 4), 16));
+}
+
+/// @brief Encodes 4 coordinates of 16 bits into 32-bit lanes.
+/// @param[in] c0 Bytes 0-15 of the coordinates
+/// @param[in] c1 Bytes 8-23 of the coordinates
+inline __m128i encode32(const __m128i c0, const __m128i c1) noexcept {
+  // Byte k of x, y and z of item i to byte 3k of lane i
+  const __m128i x = _mm_or_si128(
+      _mm_shuffle_epi8(c0, _mm_setr_epi8(0, -1, -1, 1, 6, -1, -1, 7, -1, -1,
+                                         -1, -1, -1, -1, -1, -1)),
+      _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 4,
+                                         -1, -1, 5, 10, -1, -1, 11)));
+  const __m128i y = _mm_or_si128(
+      _mm_shuffle_epi8(c0, _mm_setr_epi8(2, -1, -1, 3, 8, -1, -1, 9, -1, -1,
+                                         -1, -1, -1, -1, -1, -1)),
+      _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 6,
+                                         -1, -1, 7, 12, -1, -1, 13)));
+  const __m128i z = _mm_or_si128(
+      _mm_shuffle_epi8(c0, _mm_setr_epi8(4, -1, -1, 5, 10, -1, -1, 11, -1, -1,
+                                         -1, -1, -1, -1, -1, -1)),
+      _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 8,
+                                         -1, -1, 9, 14, -1, -1, 15)));
+  return _mm_or_si128(_mm_or_si128(spread32(x),
+                                   _mm_slli_epi32(spread32(y), 1)),
+                      _mm_slli_epi32(spread32(z), 2));
+}
+
+/// @brief Decodes 4 morton codes in 32-bit lanes.
+/// @param[in] m Morton codes
+/// @param[out] c0 Bytes 0-15 of the coordinates
+/// @param[out] c1 Bytes 16-23 of the coordinates in the lower half
+inline void decode32(const __m128i m, __m128i& c0, __m128i& c1) noexcept {
+  const __m128i mask = _mm_set1_epi32(0x49249249);
+  const __m128i x = collect32(_mm_and_si128(m, mask));
+  const __m128i y = collect32(_mm_and_si128(_mm_srli_epi32(m, 1), mask));
+  const __m128i z = collect32(_mm_and_si128(_mm_srli_epi32(m, 2), mask));
+  // Bytes 0 and 3 of lane i to x, y and z of item i
+  c0 = _mm_or_si128(
+      _mm_or_si128(
+          _mm_shuffle_epi8(x, _mm_setr_epi8(0, 3, -1, -1, -1, -1, 4, 7, -1,
+                                            -1, -1, -1, 8, 11, -1, -1)),
+          _mm_shuffle_epi8(y, _mm_setr_epi8(-1, -1, 0, 3, -1, -1, -1, -1, 4,
+                                            7, -1, -1, -1, -1, 8, 11))),
+      _mm_shuffle_epi8(z, _mm_setr_epi8(-1, -1, -1, -1, 0, 3, -1, -1, -1, -1,
+                                        4, 7, -1, -1, -1, -1)));
+  c1 = _mm_or_si128(
+      _mm_or_si128(
+          _mm_shuffle_epi8(x, _mm_setr_epi8(-1, -1, 12, 15, -1, -1, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1, -1)),
+          _mm_shuffle_epi8(y, _mm_setr_epi8(-1, -1, -1, -1, 12, 15, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1, -1))),
+      _mm_shuffle_epi8(z, _mm_setr_epi8(8, 11, -1, -1, -1, -1, 12, 15, -1, -1,
+                                        -1, -1, -1, -1, -1, -1)));
+}
+
+/// @brief Encodes 2 coordinates of 32 bits into 64-bit lanes.
+/// @param[in] c0 Bytes 0-15 of the coordinates
+/// @param[in] c1 Bytes 8-23 of the coordinates
+inline __m128i encode64(const __m128i c0, const __m128i c1) noexcept {
+  const __m128i x = _mm_or_si128(
+      _mm_shuffle_epi8(c0, _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, -1,
+                                         -1, -1, -1, -1, -1, -1)),
+      _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 4,
+                                         -1, -1, 5, -1, -1, 6, -1)));
+  const __m128i y = _mm_or_si128(
+      _mm_shuffle_epi8(c0, _mm_setr_epi8(4, -1, -1, 5, -1, -1, 6, -1, -1, -1,
+                                         -1, -1, -1, -1, -1, -1)),
+      _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 8,
+                                         -1, -1, 9, -1, -1, 10, -1)));
+  const __m128i z = _mm_or_si128(
+      _mm_shuffle_epi8(c0, _mm_setr_epi8(8, -1, -1, 9, -1, -1, 10, -1, -1, -1,
+                                         -1, -1, -1, -1, -1, -1)),
+      _mm_shuffle_epi8(c1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 12,
+                                         -1, -1, 13, -1, -1, 14, -1)));
+  return _mm_or_si128(_mm_or_si128(spread64(x),
+                                   _mm_slli_epi64(spread64(y), 1)),
+                      _mm_slli_epi64(spread64(z), 2));
+}
+
+/// @brief Decodes 2 morton codes in 64-bit lanes.
+/// @param[in] m Morton codes
+/// @param[out] c0 Bytes 0-15 of the coordinates
+/// @param[out] c1 Bytes 16-23 of the coordinates in the lower half
+inline void decode64(const __m128i m, __m128i& c0, __m128i& c1) noexcept {
+  const __m128i mask = _mm_set1_epi64x(0x1249249249249249);
+  const __m128i x = collect64(_mm_and_si128(m, mask));
+  const __m128i y = collect64(_mm_and_si128(_mm_srli_epi64(m, 1), mask));
+  const __m128i z = collect64(_mm_and_si128(_mm_srli_epi64(m, 2), mask));
+  // Bytes 0, 3 and 6 of lane i to x, y and z of item i
+  c0 = _mm_or_si128(
+      _mm_or_si128(
+          _mm_shuffle_epi8(x, _mm_setr_epi8(0, 3, 6, -1, -1, -1, -1, -1, -1,
+                                            -1, -1, -1, 8, 11, 14, -1)),
+          _mm_shuffle_epi8(y, _mm_setr_epi8(-1, -1, -1, -1, 0, 3, 6, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1))),
+      _mm_shuffle_epi8(z, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 3,
+                                        6, -1, -1, -1, -1, -1)));
+  c1 = _mm_or_si128(
+      _mm_shuffle_epi8(y, _mm_setr_epi8(8, 11, 14, -1, -1, -1, -1, -1, -1, -1,
+                                        -1, -1, -1, -1, -1, -1)),
+      _mm_shuffle_epi8(z, _mm_setr_epi8(-1, -1, -1, -1, 8, 11, 14, -1, -1, -1,
+                                        -1, -1, -1, -1, -1, -1)));
+}
+
+}  // namespace nibble_shuffle
+
+/// @brief Morton code implementation looking up nibbles by pshufb for 32-bit
+/// morton codes.
+template <>
+class morton3d<uint32_t, uint16_t, tag::nibble_shuffle> {
+ public:
+  /// @brief Encode coordinates to morton code
+  /// @param[in] c Coordinates
+  /// @returns Moton code
+  static morton_code<uint32_t> encode(const coordinates<uint16_t>& c) noexcept;
+
+  /// @brief Decode morton code to coordinates
+  /// @param[in] m Morton code
+  /// @returns Coordinates
+  static coordinates<uint16_t> decode(const morton_code<uint32_t> m) noexcept;
+};
+
+inline morton_code<uint32_t>
+morton3d<uint32_t, uint16_t, tag::nibble_shuffle>::encode(
+    const coordinates<uint16_t>& c) noexcept {
+  const __m128i v = _mm_setr_epi16(static_cast<short>(c.x),
+                                   static_cast<short>(c.y),
+                                   static_cast<short>(c.z), 0, 0, 0, 0, 0);
+  const __m128i m = nibble_shuffle::encode32(v, _mm_setzero_si128());
+  return morton_code<uint32_t>{static_cast<uint32_t>(_mm_cvtsi128_si32(m))};
+}
+
+inline coordinates<uint16_t>
+morton3d<uint32_t, uint16_t, tag::nibble_shuffle>::decode(
+    const morton_code<uint32_t> m) noexcept {
+  __m128i c0, c1;
+  nibble_shuffle::decode32(_mm_cvtsi32_si128(static_cast<int>(m.value)), c0,
+                           c1);
+  return {static_cast<uint16_t>(_mm_extract_epi16(c0, 0)),
+          static_cast<uint16_t>(_mm_extract_epi16(c0, 1)),
+          static_cast<uint16_t>(_mm_extract_epi16(c0, 2))};
+}
+
+/// @brief Morton code implementation looking up nibbles by pshufb for 64-bit
+/// morton codes.
+template <>
+class morton3d<uint64_t, uint32_t, tag::nibble_shuffle> {
+ public:
+  /// @brief Encode coordinates to morton code
+  /// @param[in] c Coordinates
+  /// @returns Moton code
+  static morton_code<uint64_t> encode(const coordinates<uint32_t>& c) noexcept;
+
+  /// @brief Decode morton code to coordinates
+  /// @param[in] m Morton code
+  /// @returns Coordinates
+  static coordinates<uint32_t> decode(const morton_code<uint64_t> m) noexcept;
+};
+
+inline morton_code<uint64_t>
+morton3d<uint64_t, uint32_t, tag::nibble_shuffle>::encode(
+    const coordinates<uint32_t>& c) noexcept {
+  const __m128i v =
+      _mm_setr_epi32(static_cast<int>(c.x), static_cast<int>(c.y),
+                     static_cast<int>(c.z), 0);
+  const __m128i m = nibble_shuffle::encode64(v, _mm_setzero_si128());
+  uint64_t value;
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(&value), m);
+  return morton_code<uint64_t>{value};
+}
+
+inline coordinates<uint32_t>
+morton3d<uint64_t, uint32_t, tag::nibble_shuffle>::decode(
+    const morton_code<uint64_t> m) noexcept {
+  __m128i c0, c1;
+  nibble_shuffle::decode64(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&m.value)), c0, c1);
+  return {static_cast<uint32_t>(_mm_cvtsi128_si32(c0)),
+          static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(c0, 4))),
+          static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(c0, 8)))};
+}
+
+#endif  // MORTON3D_USE_SSSE3
+
+/// Tag used by tag::tuned unless morton/tuned_tags.hpp generated by the
+/// auto-tuner selects one
+#ifdef MORTON3D_USE_BMI
+using untuned_tag = tag::bmi;
+#else
+using untuned_tag = tag::preshifted_lookup_table;
+#endif
+
+/// @brief Tags selected by the auto-tuner.
+///
+/// encode and decode are used for single items, and batch_encode and
+/// batch_decode for arrays, whose implementations may differ, e.g. SIMD
+/// kernels. Batch tags default to those of single items.
+/// @tparam T Integral type for morton_code
+template <typename T>
+struct tuned_tags {};
+
+template <>
+struct tuned_tags<uint32_t> {
+#ifdef MORTON3D_TUNED_ENCODE32_TAG
+  using encode = tag::MORTON3D_TUNED_ENCODE32_TAG;
+#else
+  using encode = untuned_tag;
+#endif
+#ifdef MORTON3D_TUNED_DECODE32_TAG
+  using decode = tag::MORTON3D_TUNED_DECODE32_TAG;
+#else
+  using decode = untuned_tag;
+#endif
+#ifdef MORTON3D_TUNED_BATCH_ENCODE32_TAG
+  using batch_encode = tag::MORTON3D_TUNED_BATCH_ENCODE32_TAG;
+#else
+  using batch_encode = encode;
+#endif
+#ifdef MORTON3D_TUNED_BATCH_DECODE32_TAG
+  using batch_decode = tag::MORTON3D_TUNED_BATCH_DECODE32_TAG;
+#else
+  using batch_decode = decode;
+#endif
+};
+
+template <>
+struct tuned_tags<uint64_t> {
+#ifdef MORTON3D_TUNED_ENCODE64_TAG
+  using encode = tag::MORTON3D_TUNED_ENCODE64_TAG;
+#else
+  using encode = untuned_tag;
+#endif
+#ifdef MORTON3D_TUNED_DECODE64_TAG
+  using decode = tag::MORTON3D_TUNED_DECODE64_TAG;
+#else
+  using decode = untuned_tag;
+#endif
+#ifdef MORTON3D_TUNED_BATCH_ENCODE64_TAG
+  using batch_encode = tag::MORTON3D_TUNED_BATCH_ENCODE64_TAG;
+#else
+  using batch_encode = encode;
+#endif
+#ifdef MORTON3D_TUNED_BATCH_DECODE64_TAG
+  using batch_decode = tag::MORTON3D_TUNED_BATCH_DECODE64_TAG;
+#else
+  using batch_decode = decode;
+#endif
+};
+
+/// @brief Morton code implementation dispatching to the implementations
+/// selected by the auto-tuner for each operation and code width.
+/// @tparam T Integral type for morton_code
+/// @tparam U Integral type for coordinates
+template <typename T, typename U>
+class morton3d<T, U, tag::tuned> {
+ public:
+  /// @brief Encode coordinates to morton code
+  /// @param[in] c Coordinates
+  /// @returns Moton code
+  static morton_code<T> encode(const coordinates<U>& c) noexcept;
+
+  /// @brief Decode morton code to coordinates
+  /// @param[in] m Morton code
+  /// @returns Coordinates
+  static coordinates<U> decode(const morton_code<T> m) noexcept;
+};
+
+template <typename T, typename U>
+inline morton_code<T> morton3d<T, U, tag::tuned>::encode(
+    const coordinates<U>& c) noexcept {
+  return morton3d<T, U, typename tuned_tags<T>::encode>::encode(c);
+}
+
+template <typename T, typename U>
+inline coordinates<U> morton3d<T, U, tag::tuned>::decode(
+    const morton_code<T> m) noexcept {
+  return morton3d<T, U, typename tuned_tags<T>::decode>::decode(m);
+}
+
+/// @brief Conversion of arrays. Items are converted one by one unless an
+/// implementation is specialized for arrays.
+/// @tparam T Integral type for morton_code
+/// @tparam U Integral type for coordinates
+/// @tparam Tag Tag to switch implementation
+template <typename T, typename U, typename Tag>
+struct batch_impl {
+  static void encode(const coordinates<U>* c, std::size_t n,
+                     morton_code<T>* m) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      m[i] = morton3d<T, U, Tag>::encode(c[i]);
+    }
+  }
+
+  static void decode(const morton_code<T>* m, std::size_t n,
+                     coordinates<U>* c) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      c[i] = morton3d<T, U, Tag>::decode(m[i]);
+    }
+  }
+};
+
+template <typename T, typename U>
+struct batch_impl<T, U, tag::tuned> {
+  static void encode(const coordinates<U>* c, std::size_t n,
+                     morton_code<T>* m) noexcept {
+    using Tag = typename tuned_tags<T>::batch_encode;
+    batch_impl<T, U, Tag>::encode(c, n, m);
+  }
+
+  static void decode(const morton_code<T>* m, std::size_t n,
+                     coordinates<U>* c) noexcept {
+    using Tag = typename tuned_tags<T>::batch_decode;
+    batch_impl<T, U, Tag>::decode(m, n, c);
+  }
+};
+
+#ifdef MORTON3D_USE_SSSE3
+
+// Arrays are loaded into registers as they are.
+static_assert(sizeof(coordinates<uint16_t>) == 6 &&
+                  sizeof(coordinates<uint32_t>) == 12,
+              "coordinates are not packed");
+static_assert(sizeof(morton_code<uint32_t>) == 4 &&
+                  sizeof(morton_code<uint64_t>) == 8,
+              "morton codes are not packed");
+
+template <>
+struct batch_impl<uint32_t, uint16_t, tag::nibble_shuffle> {
+  using impl = morton3d<uint32_t, uint16_t, tag::nibble_shuffle>;
+
+  static void encode(const coordinates<uint16_t>* c, std::size_t n,
+                     morton_code<uint32_t>* m) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const char* p = reinterpret_cast<const char*>(c + i);
+      const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const __m128i c1 =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(m + i),
+                       nibble_shuffle::encode32(c0, c1));
+    }
+    for (; i < n; ++i) m[i] = impl::encode(c[i]);
+  }
+
+  static void decode(const morton_code<uint32_t>* m, std::size_t n,
+                     coordinates<uint16_t>* c) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m128i c0, c1;
+      nibble_shuffle::decode32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(m + i)), c0, c1);
+      char* p = reinterpret_cast<char*>(c + i);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p), c0);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(p + 16), c1);
+    }
+    for (; i < n; ++i) c[i] = impl::decode(m[i]);
+  }
+};
+
+template <>
+struct batch_impl<uint64_t, uint32_t, tag::nibble_shuffle> {
+  using impl = morton3d<uint64_t, uint32_t, tag::nibble_shuffle>;
+
+  static void encode(const coordinates<uint32_t>* c, std::size_t n,
+                     morton_code<uint64_t>* m) noexcept {
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+      const char* p = reinterpret_cast<const char*>(c + i);
+      const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const __m128i c1 =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(m + i),
+                       nibble_shuffle::encode64(c0, c1));
+    }
+    for (; i < n; ++i) m[i] = impl::encode(c[i]);
+  }
+
+  static void decode(const morton_code<uint64_t>* m, std::size_t n,
+                     coordinates<uint32_t>* c) noexcept {
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+      __m128i c0, c1;
+      nibble_shuffle::decode64(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(m + i)), c0, c1);
+      char* p = reinterpret_cast<char*>(c + i);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p), c0);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(p + 16), c1);
+    }
+    for (; i < n; ++i) c[i] = impl::decode(m[i]);
+  }
+};
+
+#endif  // MORTON3D_USE_SSSE3
+
 }  // namespace detail
 
 /// @brief Encode 3D coordinates into 32-bits morton code
@@ -777,6 +1340,56 @@ inline coordinates32_t decode(const morton_code64_t m, Tag = Tag{}) noexcept {
   return detail::morton3d<uint64_t, uint32_t, Tag>::decode(m);
 }
 
+/// @brief Encode an array of 3D coordinates into 32-bits morton codes.
+/// Every coordinate must be less than 2^10.
+/// @tparam Tag Tag to switch implementations
+/// @param[in] c Coordinates
+/// @param[in] n Number of coordinates
+/// @param[out] m Morton codes
+template <typename Tag = default_tag>
+inline void encode(const coordinates16_t* c, std::size_t n, morton_code32_t* m,
+                   Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  detail::batch_impl<uint32_t, uint16_t, Tag>::encode(c, n, m);
+}
+
+/// @brief Encode an array of 3D coordinates into 64-bits morton codes.
+/// Every coordinate must be less than 2^21.
+/// @tparam Tag Tag to switch implementations
+/// @param[in] c Coordinates
+/// @param[in] n Number of coordinates
+/// @param[out] m Morton codes
+template <typename Tag = default_tag>
+inline void encode(const coordinates32_t* c, std::size_t n, morton_code64_t* m,
+                   Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  detail::batch_impl<uint64_t, uint32_t, Tag>::encode(c, n, m);
+}
+
+/// @brief Decode an array of 32-bits morton codes into 3D coordinates.
+/// @tparam Tag Tag to switch implementation
+/// @param[in] m Morton codes
+/// @param[in] n Number of morton codes
+/// @param[out] c Coordinates
+template <typename Tag = default_tag>
+inline void decode(const morton_code32_t* m, std::size_t n, coordinates16_t* c,
+                   Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  detail::batch_impl<uint32_t, uint16_t, Tag>::decode(m, n, c);
+}
+
+/// @brief Decode an array of 64-bits morton codes into 3D coordinates.
+/// @tparam Tag Tag to switch implementation
+/// @param[in] m Morton codes
+/// @param[in] n Number of morton codes
+/// @param[out] c Coordinates
+template <typename Tag = default_tag>
+inline void decode(const morton_code64_t* m, std::size_t n, coordinates32_t* c,
+                   Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  detail::batch_impl<uint64_t, uint32_t, Tag>::decode(m, n, c);
+}
+
 }  // namespace morton3d
 
 #endif  // MORTON_MORTON3D_HPP
\ No newline at end of file
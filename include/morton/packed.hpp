@@ -0,0 +1,384 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_PACKED_HPP
+#define MORTON_PACKED_HPP
+
+#if defined(__SSSE3__)
+#define MORTON_PACKED_USE_SSSE3
+#include <tmmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Loads a little-endian integer of sizeof(T) bytes.
+template <typename T>
+inline T load_little_endian(const uint8_t* p) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  T v = 0;
+  for (std::size_t b = 0; b < sizeof(T); ++b) {
+    v |= static_cast<T>(static_cast<T>(p[b]) << 8 * b);
+  }
+  return v;
+#else
+  T v;
+  std::memcpy(&v, p, sizeof(T));
+  return v;
+#endif
+}
+
+/// @brief Stores the low Bytes bytes of an integer in little-endian order.
+template <std::size_t Bytes, typename T>
+inline void store_little_endian(uint8_t* p, const T v) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  for (std::size_t b = 0; b < Bytes; ++b) {
+    p[b] = static_cast<uint8_t>(v >> 8 * b);
+  }
+#else
+  std::memcpy(p, &v, Bytes);
+#endif
+}
+
+#ifdef MORTON_PACKED_USE_SSSE3
+
+/// @brief Returns the byte of two 64-bit lanes moved to byte k of two
+/// packed slots of Bytes bytes, or -128 for zero.
+constexpr char pack_index(unsigned int k, unsigned int bytes) {
+  return static_cast<char>(k < bytes       ? k
+                           : k < 2 * bytes ? 8 + k - bytes
+                                           : 0x80);
+}
+
+/// @brief Returns the byte of two packed slots of Bytes bytes moved to byte
+/// k of two 64-bit lanes, or -128 for zero.
+constexpr char unpack_index(unsigned int k, unsigned int bytes) {
+  return static_cast<char>(k % 8 < bytes ? k / 8 * bytes + k % 8 : 0x80);
+}
+
+/// @brief Returns the shuffle which packs two 64-bit lanes into 2 * Bytes
+/// bytes.
+template <unsigned int Bytes>
+inline __m128i pack_shuffle() noexcept {
+  return _mm_setr_epi8(
+      pack_index(0, Bytes), pack_index(1, Bytes), pack_index(2, Bytes),
+      pack_index(3, Bytes), pack_index(4, Bytes), pack_index(5, Bytes),
+      pack_index(6, Bytes), pack_index(7, Bytes), pack_index(8, Bytes),
+      pack_index(9, Bytes), pack_index(10, Bytes), pack_index(11, Bytes),
+      pack_index(12, Bytes), pack_index(13, Bytes), pack_index(14, Bytes),
+      pack_index(15, Bytes));
+}
+
+/// @brief Returns the shuffle which unpacks 2 * Bytes bytes into two 64-bit
+/// lanes.
+template <unsigned int Bytes>
+inline __m128i unpack_shuffle() noexcept {
+  return _mm_setr_epi8(
+      unpack_index(0, Bytes), unpack_index(1, Bytes), unpack_index(2, Bytes),
+      unpack_index(3, Bytes), unpack_index(4, Bytes), unpack_index(5, Bytes),
+      unpack_index(6, Bytes), unpack_index(7, Bytes), unpack_index(8, Bytes),
+      unpack_index(9, Bytes), unpack_index(10, Bytes),
+      unpack_index(11, Bytes), unpack_index(12, Bytes),
+      unpack_index(13, Bytes), unpack_index(14, Bytes),
+      unpack_index(15, Bytes));
+}
+
+#endif  // MORTON_PACKED_USE_SSSE3
+
+/// @brief Array of morton codes packed in slots of fewer bytes than their
+/// integral type.
+///
+/// Codes which use at most 8 * Bytes bits, e.g. 3D codes of 16 bits per axis
+/// in 6 bytes, are stored back to back in little-endian slots. Elements are
+/// read by a load of the whole integral type and a mask, which padding at the
+/// end of the storage keeps in bounds, and written by stores of exactly their
+/// slots. Ranges of 64-bit codes are packed and unpacked by SSSE3 byte
+/// shuffles of two codes at a time if available.
+///
+/// Writes never touch bytes outside their slots, so that different threads
+/// may set or pack disjoint ranges at the same time, e.g. to fill an array in
+/// parallel. Reads load bytes of neighbouring slots, so that codes must not
+/// be read while other threads write.
+/// @tparam Code morton_code type
+/// @tparam Bytes Number of bytes of a slot
+template <typename Code, unsigned int Bytes>
+class packed_array {
+ public:
+  using value_type = Code;
+  using T = typename Code::value_type;
+  static_assert(Bytes > 0 && Bytes < sizeof(T),
+                "Slots must be smaller than the integral type");
+
+  /// Number of bits of a slot
+  static constexpr unsigned int bits = 8 * Bytes;
+  /// Mask of the bits of a slot
+  static constexpr T mask = static_cast<T>((T(1) << bits) - 1);
+
+  packed_array() noexcept : size_{0} {}
+
+  /// @brief Creates an array of n codes of zero.
+  explicit packed_array(std::size_t n) : size_{n}, data_(storage_size(n)) {}
+
+  /// @brief Creates an array of codes.
+  /// @param[in] codes Codes of at most bits bits
+  /// @param[in] n Number of codes
+  packed_array(const Code* codes, std::size_t n) : packed_array(n) {
+    pack(codes, n, 0);
+  }
+
+  /// @brief Returns the number of codes.
+  std::size_t size() const noexcept { return size_; }
+
+  /// @brief Returns true if there are no codes.
+  bool empty() const noexcept { return size_ == 0; }
+
+  /// @brief Returns the number of bytes of the storage.
+  std::size_t storage_bytes() const noexcept { return data_.size(); }
+
+  /// @brief Returns the packed slots.
+  const uint8_t* data() const noexcept { return data_.data(); }
+
+  /// @brief Resizes the array. New codes are zero.
+  void resize(std::size_t n) {
+    data_.resize(storage_size(n));
+    // Clears slots of removed codes which may be added again.
+    if (n < size_) std::fill(data_.begin() + n * Bytes, data_.end(), 0);
+    size_ = n;
+  }
+
+  /// @brief Reserves storage for n codes.
+  void reserve(std::size_t n) { data_.reserve(storage_size(n)); }
+
+  /// @brief Removes every code.
+  void clear() noexcept {
+    data_.clear();
+    size_ = 0;
+  }
+
+  /// @brief Returns a code.
+  Code operator[](std::size_t i) const noexcept {
+    assert(i < size_ && "Index is out of range");
+    return Code(load(i));
+  }
+
+  /// @brief Replaces a code.
+  /// @param[in] i Index
+  /// @param[in] code Code of at most bits bits
+  void set(std::size_t i, const Code code) noexcept {
+    assert(i < size_ && "Index is out of range");
+    assert((code.value & ~mask) == 0 && "Code does not fit in a slot");
+    store_little_endian<Bytes>(data_.data() + i * Bytes, code.value);
+  }
+
+  /// @brief Appends a code.
+  void push_back(const Code code) {
+    resize(size_ + 1);
+    set(size_ - 1, code);
+  }
+
+  /// @brief Replaces codes in a range.
+  /// @param[in] codes Codes of at most bits bits
+  /// @param[in] n Number of codes
+  /// @param[in] first Index of the first code to replace
+  void pack(const Code* codes, std::size_t n, std::size_t first) noexcept {
+    assert(first + n <= size_ && "Range is out of the array");
+    if (n == 0) return;
+    uint8_t* p = data_.data() + first * Bytes;
+    std::size_t i = 0;
+    pack_simd(codes, n, p, i);
+    uint8_t* q = p + i * Bytes;
+    for (const Code* c = codes + i; c != codes + n; ++c, q += Bytes) {
+      assert((c->value & ~mask) == 0 && "Code does not fit in a slot");
+      store_little_endian<Bytes>(q, c->value);
+    }
+  }
+
+  /// @brief Copies codes in a range.
+  /// @param[in] first Index of the first code
+  /// @param[in] n Number of codes
+  /// @param[out] codes n codes
+  void unpack(std::size_t first, std::size_t n, Code* codes) const noexcept {
+    assert(first + n <= size_ && "Range is out of the array");
+    const uint8_t* p = data_.data() + first * Bytes;
+    std::size_t i = 0;
+    unpack_simd(p, n, codes, i);
+    p += i * Bytes;
+    for (Code* c = codes + i; c != codes + n; ++c, p += Bytes) {
+      *c = Code(static_cast<T>(load_little_endian<T>(p) & mask));
+    }
+  }
+
+  /// @brief Returns the index of the first code not less than a code in
+  /// sorted codes.
+  std::size_t lower_bound(const Code code) const noexcept {
+    std::size_t first = 0;
+    std::size_t count = size_;
+    while (count > 0) {
+      const std::size_t half = count / 2;
+      if (load(first + half) < code.value) {
+        first += half + 1;
+        count -= half + 1;
+      } else {
+        count = half;
+      }
+    }
+    return first;
+  }
+
+ private:
+  /// Padding for loads of 16 bytes from the last slot
+  static constexpr std::size_t padding = 16;
+
+  static std::size_t storage_size(std::size_t n) noexcept {
+    return n * Bytes + padding;
+  }
+
+  T load(std::size_t i) const noexcept {
+    return static_cast<T>(load_little_endian<T>(data_.data() + i * Bytes) &
+                          mask);
+  }
+
+  /// @brief Packs four 64-bit codes at a time, leaving the rest to scalar
+  /// stores.
+  ///
+  /// Two pairs are packed by shuffles and joined by byte shifts into the
+  /// 4 * Bytes bytes, which are written by two stores that do not overlap.
+  /// Overlapping stores of every pair would be slower than scalar stores.
+  /// The second store writes zeros after the 4 * Bytes bytes up to 32 bytes,
+  /// so groups are packed only while those bytes are in the range, where the
+  /// next group or scalar stores overwrite them.
+  template <typename U = T>
+  static typename std::enable_if<sizeof(U) == 8 && Bytes >= 4>::type
+  pack_simd(const Code* codes, std::size_t n, uint8_t* p,
+            std::size_t& i) noexcept {
+#ifdef MORTON_PACKED_USE_SSSE3
+    const __m128i shuffle = pack_shuffle<Bytes>();
+    for (; i * Bytes + 32 <= n * Bytes; i += 4) {
+      assert(((codes[i].value | codes[i + 1].value | codes[i + 2].value |
+               codes[i + 3].value) &
+              ~mask) == 0 &&
+             "Code does not fit in a slot");
+      const __m128i a = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i)),
+          shuffle);
+      const __m128i b = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i + 2)),
+          shuffle);
+      uint8_t* q = p + i * Bytes;
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(q),
+                       _mm_or_si128(a, _mm_slli_si128(b, 2 * Bytes)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(q + 16),
+                       _mm_srli_si128(b, 16 - 2 * Bytes));
+    }
+#else
+    (void)codes, (void)n, (void)p, (void)i;
+#endif
+  }
+
+  template <typename U = T>
+  static typename std::enable_if<sizeof(U) != 8 || Bytes < 4>::type
+  pack_simd(const Code*, std::size_t, uint8_t*, std::size_t&) noexcept {}
+
+  /// @brief Unpacks pairs of 64-bit codes.
+  template <typename U = T>
+  static typename std::enable_if<sizeof(U) == 8>::type unpack_simd(
+      const uint8_t* p, std::size_t n, Code* codes,
+      std::size_t& i) noexcept {
+#ifdef MORTON_PACKED_USE_SSSE3
+    const __m128i shuffle = unpack_shuffle<Bytes>();
+    for (; i + 2 <= n; i += 2) {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * Bytes));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + i),
+                       _mm_shuffle_epi8(v, shuffle));
+    }
+#else
+    (void)p, (void)n, (void)codes, (void)i;
+#endif
+  }
+
+  template <typename U = T>
+  static typename std::enable_if<sizeof(U) != 8>::type unpack_simd(
+      const uint8_t*, std::size_t, Code*, std::size_t&) noexcept {}
+
+  std::size_t size_;           /// Number of codes
+  std::vector<uint8_t> data_;  /// Slots followed by padding
+};
+
+template <typename Code, unsigned int Bytes>
+constexpr unsigned int packed_array<Code, Bytes>::bits;
+
+template <typename Code, unsigned int Bytes>
+constexpr typename packed_array<Code, Bytes>::T
+    packed_array<Code, Bytes>::mask;
+
+template <typename Code, unsigned int Bytes>
+constexpr std::size_t packed_array<Code, Bytes>::padding;
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Array of 2D morton codes packed in slots of Bytes bytes.
+///
+/// @code
+/// // Codes of 24 bits per axis in 6 instead of 8 bytes
+/// packed_array<6> keys(codes, n);
+/// const morton_code64_t m = keys[i];
+/// keys.unpack(first, count, buffer);
+/// @endcode
+/// @tparam Bytes Number of bytes of a slot
+/// @tparam T Integral type for morton_code
+template <unsigned int Bytes, typename T = uint64_t>
+using packed_array = morton::detail::packed_array<morton_code<T>, Bytes>;
+
+/// Codes of 20 bits per axis in 40 bits
+using packed_array40_t = packed_array<5>;
+/// Codes of 24 bits per axis in 48 bits
+using packed_array48_t = packed_array<6>;
+/// Codes of 28 bits per axis in 56 bits
+using packed_array56_t = packed_array<7>;
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Array of 3D morton codes packed in slots of Bytes bytes.
+///
+/// @code
+/// // Codes of 16 bits per axis in 6 instead of 8 bytes
+/// packed_array<6> keys(codes, n);
+/// const morton_code64_t m = keys[i];
+/// keys.unpack(first, count, buffer);
+/// @endcode
+/// @tparam Bytes Number of bytes of a slot
+/// @tparam T Integral type for morton_code
+template <unsigned int Bytes, typename T = uint64_t>
+using packed_array = morton::detail::packed_array<morton_code<T>, Bytes>;
+
+/// Codes of 13 bits per axis in 40 bits
+using packed_array40_t = packed_array<5>;
+/// Codes of 16 bits per axis in 48 bits
+using packed_array48_t = packed_array<6>;
+/// Codes of 18 bits per axis in 56 bits
+using packed_array56_t = packed_array<7>;
+
+}  // namespace morton3d
+
+#endif  // MORTON_PACKED_HPP
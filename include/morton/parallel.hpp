@@ -0,0 +1,202 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_PARALLEL_HPP
+#define MORTON_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// Minimum number of items processed by a thread. Below this, starting a
+/// thread costs more than the work it takes over.
+constexpr std::size_t min_items_per_thread = std::size_t(1) << 14;
+
+/// @brief Returns the number of threads to use.
+/// @param[in] num_threads Requested number of threads, or 0 for the number of
+/// hardware threads
+inline unsigned int resolve_threads(unsigned int num_threads) noexcept {
+  if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+  return num_threads == 0 ? 1 : num_threads;
+}
+
+/// @brief Returns the number of blocks to split n items into, so that every
+/// block has at least min_items items.
+/// @param[in] n Number of items
+/// @param[in] num_threads Requested number of threads, or 0 for the number of
+/// hardware threads
+/// @param[in] min_items Minimum number of items in a block
+inline std::size_t num_blocks(
+    std::size_t n, unsigned int num_threads,
+    std::size_t min_items = min_items_per_thread) noexcept {
+  return std::max<std::size_t>(
+      1, std::min<std::size_t>(resolve_threads(num_threads), n / min_items));
+}
+
+/// @brief Returns the first item of a block when n items are split into
+/// num_blocks blocks of almost equal sizes.
+inline std::size_t block_begin(std::size_t n, std::size_t num_blocks,
+                               std::size_t block) noexcept {
+  return static_cast<std::size_t>(static_cast<unsigned long long>(n) * block /
+                                  num_blocks);
+}
+
+/// @brief Calls f(b) for every block b in [0, num_blocks) on its own thread.
+///
+/// Block 0 runs on the calling thread. The function returns after all blocks
+/// are finished. If a thread cannot be started, started threads are joined
+/// and std::system_error is rethrown.
+/// @param[in] num_blocks Number of blocks
+/// @param[in] f Function object which must not throw
+template <typename F>
+void run_in_parallel(std::size_t num_blocks, const F& f) {
+  std::vector<std::thread> threads;
+  threads.reserve(num_blocks > 0 ? num_blocks - 1 : 0);
+  try {
+    for (std::size_t b = 1; b < num_blocks; ++b) threads.emplace_back(f, b);
+  } catch (...) {
+    for (auto&& t : threads) t.join();
+    throw;
+  }
+  if (num_blocks > 0) f(0);
+  for (auto&& t : threads) t.join();
+}
+
+/// @brief Computes inclusive prefix sums in parallel.
+///
+/// Items are split into a block per thread. Every thread sums its block, the
+/// block sums are scanned, and every thread then scans its block starting
+/// from the sum of the preceding blocks. Each item is read twice and written
+/// once, so that the speedup is bounded by memory bandwidth.
+/// @tparam T Arithmetic type of items
+/// @tparam U Arithmetic type of sums, which may be wider than T
+/// @param[in] in Items
+/// @param[in] n Number of items
+/// @param[out] out Prefix sums, which may be the same as in
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+template <typename T, typename U>
+void parallel_inclusive_scan(const T* in, std::size_t n, U* out,
+                             unsigned int num_threads = 0) {
+  const std::size_t t = num_blocks(n, num_threads);
+  if (t == 1) {
+    U acc = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      acc += in[i];
+      out[i] = acc;
+    }
+    return;
+  }
+  std::vector<U> sums(t);
+  run_in_parallel(t, [&](std::size_t b) {
+    sums[b] = std::accumulate(in + block_begin(n, t, b),
+                              in + block_begin(n, t, b + 1), U(0));
+  });
+  U offset = 0;
+  for (auto&& s : sums) {
+    const U sum = s;
+    s = offset;
+    offset += sum;
+  }
+  run_in_parallel(t, [&](std::size_t b) {
+    U acc = sums[b];
+    for (std::size_t i = block_begin(n, t, b); i < block_begin(n, t, b + 1);
+         ++i) {
+      acc += in[i];
+      out[i] = acc;
+    }
+  });
+}
+
+/// @brief Sorts morton codes with values by the low bits of the codes in
+/// parallel.
+///
+/// Least significant digit radix sort of 8-bit digits, which is stable. Every
+/// pass counts digits of a block of items per thread, and every thread then
+/// scatters its block to the offsets of its digits. Passes are skipped if all
+/// the items have the same digit, e.g. high bits of codes in a small grid.
+/// @tparam Code morton_code type
+/// @tparam Value Value type
+/// @param[in,out] codes Morton codes
+/// @param[in,out] values Values moved with the codes
+/// @param[in] n Number of items
+/// @param[in] bits Number of low bits of codes to sort by
+/// @param[out] code_buffer Buffer of n codes
+/// @param[out] value_buffer Buffer of n values
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+template <typename Code, typename Value>
+void parallel_radix_sort(Code* codes, Value* values, std::size_t n,
+                         unsigned int bits, Code* code_buffer,
+                         Value* value_buffer, unsigned int num_threads = 0) {
+  constexpr unsigned int digit_bits = 8;
+  constexpr std::size_t radix = std::size_t(1) << digit_bits;
+  const std::size_t t = num_blocks(n, num_threads);
+  std::vector<std::size_t> offsets(t * radix);
+  Code* src_codes = codes;
+  Value* src_values = values;
+  Code* dst_codes = code_buffer;
+  Value* dst_values = value_buffer;
+  for (unsigned int shift = 0; shift < bits; shift += digit_bits) {
+    const auto digit = [shift](const Code& c) -> std::size_t {
+      return static_cast<std::size_t>(c.value >> shift) & (radix - 1);
+    };
+    run_in_parallel(t, [&](std::size_t b) {
+      std::size_t* counts = offsets.data() + b * radix;
+      std::fill(counts, counts + radix, std::size_t(0));
+      const std::size_t last = block_begin(n, t, b + 1);
+      for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+        ++counts[digit(src_codes[i])];
+      }
+    });
+    // Offsets of digits in every block, in the order of digits and then
+    // blocks, so that the sort is stable.
+    std::size_t sum = 0;
+    bool skip = false;
+    for (std::size_t d = 0; d < radix; ++d) {
+      std::size_t total = 0;
+      for (std::size_t b = 0; b < t; ++b) {
+        const std::size_t count = offsets[b * radix + d];
+        offsets[b * radix + d] = sum;
+        sum += count;
+        total += count;
+      }
+      skip = skip || total == n;
+    }
+    if (skip) continue;
+    run_in_parallel(t, [&](std::size_t b) {
+      std::size_t* next = offsets.data() + b * radix;
+      const std::size_t last = block_begin(n, t, b + 1);
+      for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+        const std::size_t j = next[digit(src_codes[i])]++;
+        dst_codes[j] = src_codes[i];
+        dst_values[j] = src_values[i];
+      }
+    });
+    std::swap(src_codes, dst_codes);
+    std::swap(src_values, dst_values);
+  }
+  if (src_codes != codes) {
+    run_in_parallel(t, [&](std::size_t b) {
+      const std::size_t first = block_begin(n, t, b);
+      const std::size_t last = block_begin(n, t, b + 1);
+      std::copy(src_codes + first, src_codes + last, codes + first);
+      std::copy(src_values + first, src_values + last, values + first);
+    });
+  }
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+#endif  // MORTON_PARALLEL_HPP
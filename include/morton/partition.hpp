@@ -0,0 +1,246 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_PARTITION_HPP
+#define MORTON_PARTITION_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+#include "morton/parallel.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Weight of the first items when every item weighs 1.
+struct unit_weights {
+  double operator()(std::size_t i) const noexcept {
+    return static_cast<double>(i);
+  }
+};
+
+/// @brief Type of sums of weights of a type, which are 64-bit integers for
+/// integral weights not to overflow, and double for floating-point weights
+/// not to drop small weights added to large sums.
+template <typename W>
+using weight_sum_type =
+    typename std::conditional<std::is_floating_point<W>::value, double,
+                              uint64_t>::type;
+
+/// @brief Weight of the first items looked up in inclusive prefix sums.
+/// @tparam S Arithmetic type for sums of weights
+template <typename S>
+struct prefix_weights {
+  const S* prefix;  /// Inclusive prefix sums of weights
+
+  double operator()(std::size_t i) const noexcept {
+    return i == 0 ? 0.0 : static_cast<double>(prefix[i - 1]);
+  }
+};
+
+/// @brief Splits sorted morton codes into partitions of balanced weights
+/// whose boundaries are aligned to cells.
+///
+/// Every boundary is first placed where the weight of the preceding items is
+/// the closest to its share of the total weight, and then moved to the
+/// nearer boundary of the cell containing it. A cell heavier than a share
+/// may leave some partitions empty.
+/// @tparam Dimension Number of dimensions
+/// @tparam Traits morton_traits of codes
+/// @tparam Code morton_code type
+/// @tparam Weight Function object returning the weight of the first i items
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] n Number of codes
+/// @param[in] k Number of partitions
+/// @param[in] level Level of cells from the root, where the root is 0 and
+/// every code is a cell of its own at Traits::bits
+/// @param[in] weight Weight of the first items
+/// @returns k + 1 offsets. Partition p holds items [offsets[p], offsets[p+1]).
+template <unsigned int Dimension, typename Traits, typename Code,
+          typename Weight>
+std::vector<std::size_t> partition_sorted(const Code* codes, std::size_t n,
+                                          std::size_t k, unsigned int level,
+                                          const Weight& weight) {
+  using T = typename Code::value_type;
+  assert(k > 0 && "Number of partitions must be positive");
+  assert(level <= Traits::bits && "Level is deeper than leaves");
+  const unsigned int shift = Dimension * (Traits::bits - level);
+  // Cell of a code at the level. Shifting by all the bits of T is undefined.
+  const auto cell = [shift](const Code& c) -> T {
+    return shift < std::numeric_limits<T>::digits ? c.value >> shift : T(0);
+  };
+  const double total = weight(n);
+
+  std::vector<std::size_t> offsets(k + 1, 0);
+  offsets[k] = n;
+  for (std::size_t p = 1; p < k; ++p) {
+    const double target = total * static_cast<double>(p) / k;
+    // The first boundary whose preceding weight reaches the target
+    std::size_t lo = offsets[p - 1], hi = n;
+    while (lo < hi) {
+      const std::size_t mid = lo + (hi - lo) / 2;
+      if (weight(mid) < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    std::size_t b = lo;
+    if (b > offsets[p - 1] &&
+        target - weight(b - 1) <= weight(b) - target) {
+      --b;
+    }
+    if (b > 0 && b < n && cell(codes[b - 1]) == cell(codes[b])) {
+      // Move to the nearer end of the cell.
+      const T c = cell(codes[b]);
+      const std::size_t first = static_cast<std::size_t>(
+          std::partition_point(codes + offsets[p - 1], codes + b,
+                               [&](const Code& m) { return cell(m) < c; }) -
+          codes);
+      const std::size_t last = static_cast<std::size_t>(
+          std::partition_point(codes + b, codes + n,
+                               [&](const Code& m) { return cell(m) == c; }) -
+          codes);
+      b = target - weight(first) <= weight(last) - target ? first : last;
+    }
+    offsets[p] = std::max(b, offsets[p - 1]);
+  }
+  return offsets;
+}
+
+/// @brief Splits sorted morton codes into partitions of balanced weights
+/// whose boundaries are aligned to cells.
+/// @param[in] weights Weights of items
+/// @param[in] num_threads Number of threads computing prefix sums of weights,
+/// or 0 for the number of hardware threads
+template <unsigned int Dimension, typename Traits, typename Code, typename W>
+std::vector<std::size_t> partition_weighted(const Code* codes,
+                                            const W* weights, std::size_t n,
+                                            std::size_t k, unsigned int level,
+                                            unsigned int num_threads) {
+  using S = weight_sum_type<W>;
+  std::vector<S> prefix(n);
+  parallel_inclusive_scan(weights, n, prefix.data(), num_threads);
+  return partition_sorted<Dimension, Traits>(codes, n, k, level,
+                                             prefix_weights<S>{prefix.data()});
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Splits sorted morton codes into k contiguous partitions of almost
+/// equal numbers of items, whose boundaries are aligned to quadtree cells of
+/// a level.
+///
+/// Partitions are suitable for distributing work across threads or
+/// processes, since every cell at the level belongs to a single partition.
+/// A cell which holds more than n / k items may leave some partitions empty.
+/// @tparam T Integral type for morton_code
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] n Number of codes
+/// @param[in] k Number of partitions
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits), where every code is a cell of its own
+/// @returns k + 1 offsets. Partition p holds items [offsets[p], offsets[p+1]).
+template <typename T>
+std::vector<std::size_t> partition(const morton_code<T>* codes, std::size_t n,
+                                   std::size_t k, unsigned int level) {
+  return morton::detail::partition_sorted<2, morton_traits<T>>(
+      codes, n, k, level, morton::detail::unit_weights{});
+}
+
+/// @brief Splits sorted morton codes into k contiguous partitions of almost
+/// equal weights, whose boundaries are aligned to quadtree cells of a level.
+///
+/// Prefix sums of weights are computed in parallel, and every boundary is
+/// then found by binary search. Repartitioning after weights change costs
+/// O(n / num_threads + k log n).
+/// @tparam T Integral type for morton_code
+/// @tparam W Arithmetic type for weights, which must not be negative.
+/// Weights are summed in uint64_t if integral, or in double otherwise.
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] weights Weights of items
+/// @param[in] n Number of codes
+/// @param[in] k Number of partitions
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits), where every code is a cell of its own
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+/// @returns k + 1 offsets. Partition p holds items [offsets[p], offsets[p+1]).
+template <typename T, typename W>
+std::vector<std::size_t> partition(const morton_code<T>* codes,
+                                   const W* weights, std::size_t n,
+                                   std::size_t k, unsigned int level,
+                                   unsigned int num_threads = 0) {
+  return morton::detail::partition_weighted<2, morton_traits<T>>(
+      codes, weights, n, k, level, num_threads);
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Splits sorted morton codes into k contiguous partitions of almost
+/// equal numbers of items, whose boundaries are aligned to octree cells of a
+/// level.
+///
+/// Partitions are suitable for distributing work across threads or
+/// processes, since every cell at the level belongs to a single partition.
+/// A cell which holds more than n / k items may leave some partitions empty.
+/// @tparam T Integral type for morton_code
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] n Number of codes
+/// @param[in] k Number of partitions
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits), where every code is a cell of its own
+/// @returns k + 1 offsets. Partition p holds items [offsets[p], offsets[p+1]).
+template <typename T>
+std::vector<std::size_t> partition(const morton_code<T>* codes, std::size_t n,
+                                   std::size_t k, unsigned int level) {
+  return morton::detail::partition_sorted<3, morton_traits<T>>(
+      codes, n, k, level, morton::detail::unit_weights{});
+}
+
+/// @brief Splits sorted morton codes into k contiguous partitions of almost
+/// equal weights, whose boundaries are aligned to octree cells of a level.
+///
+/// Prefix sums of weights are computed in parallel, and every boundary is
+/// then found by binary search. Repartitioning after weights change costs
+/// O(n / num_threads + k log n).
+/// @tparam T Integral type for morton_code
+/// @tparam W Arithmetic type for weights, which must not be negative.
+/// Weights are summed in uint64_t if integral, or in double otherwise.
+/// @param[in] codes Morton codes sorted in increasing order
+/// @param[in] weights Weights of items
+/// @param[in] n Number of codes
+/// @param[in] k Number of partitions
+/// @param[in] level Level of cells from the root (0) to the leaves
+/// (morton_traits<T>::bits), where every code is a cell of its own
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+/// @returns k + 1 offsets. Partition p holds items [offsets[p], offsets[p+1]).
+template <typename T, typename W>
+std::vector<std::size_t> partition(const morton_code<T>* codes,
+                                   const W* weights, std::size_t n,
+                                   std::size_t k, unsigned int level,
+                                   unsigned int num_threads = 0) {
+  return morton::detail::partition_weighted<3, morton_traits<T>>(
+      codes, weights, n, k, level, num_threads);
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_PARTITION_HPP
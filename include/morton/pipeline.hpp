@@ -0,0 +1,318 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_PIPELINE_HPP
+#define MORTON_PIPELINE_HPP
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+#include "morton/parallel.hpp"
+#include "morton/queue.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// @brief Block of coordinates passed through an encode pipeline.
+/// @tparam Coordinates Coordinates type
+/// @tparam Code Morton code type
+template <typename Coordinates, typename Code>
+struct encode_block {
+  uint64_t id = 0;                       /// Sequence number given by users
+  std::vector<Coordinates> coordinates;  /// Coordinates to encode
+  std::vector<Code> codes;               /// Morton codes of coordinates
+};
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Waits for a condition by spinning briefly and then sleeping until
+/// notified.
+///
+/// Notifying costs an atomic load unless a thread sleeps, so that threads
+/// which do not wait stay lock-free.
+class waiter {
+ public:
+  waiter() noexcept : sleepers_{0} {}
+
+  waiter(const waiter&) = delete;
+  waiter& operator=(const waiter&) = delete;
+
+  /// @brief Waits until a predicate returns true.
+  ///
+  /// The predicate is called repeatedly and may have side effects such as
+  /// popping from a queue.
+  /// @param[in] ready Predicate
+  template <typename Predicate>
+  void wait(Predicate ready) {
+    for (int i = 0; i < spin_count; ++i) {
+      if (ready()) return;
+      std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleepers_.fetch_add(1, std::memory_order_relaxed);
+    // Either ready() sees the change before a notify, or notify() sees the
+    // sleeper and takes the lock after the sleeper waits.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!ready()) condition_.wait(lock);
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /// @brief Wakes threads waiting for a change made before the call.
+  void notify() noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) == 0) return;
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    condition_.notify_all();
+  }
+
+ private:
+  static constexpr int spin_count = 64;  /// Number of yields before sleeping
+
+  std::mutex mutex_;                    /// Mutex of condition_
+  std::condition_variable condition_;   /// Condition sleepers wait on
+  std::atomic<unsigned int> sleepers_;  /// Number of sleeping threads
+};
+
+/// @brief Pipeline stage encoding blocks of coordinates by worker threads.
+///
+/// Producers push blocks into a bounded input queue, workers encode them by
+/// the array encoder, and consumers pop encoded blocks from a bounded output
+/// queue. Both queues are lock-free. A push waits while the input queue is
+/// full, and workers wait while the output queue is full, so that producers
+/// are slowed down to the pace of consumers. Waiting threads spin briefly and
+/// then sleep, so that an idle pipeline takes no CPU time. Blocks may be
+/// reordered, which is why they carry ids.
+/// @tparam Coordinates Coordinates type
+/// @tparam Code Morton code type
+/// @tparam Encode Function object encoding an array of coordinates
+template <typename Coordinates, typename Code, typename Encode>
+class encode_pipeline {
+ public:
+  using block = encode_block<Coordinates, Code>;
+
+  /// @param[in] capacity Minimum number of blocks in each queue
+  /// @param[in] num_workers Number of worker threads, or 0 for the number of
+  /// hardware threads
+  explicit encode_pipeline(std::size_t capacity, unsigned int num_workers = 0)
+      : input_(capacity), output_(capacity), closed_{false}, stopped_{false},
+        active_{0} {
+    const unsigned int n = resolve_threads(num_workers);
+    active_.store(n, std::memory_order_relaxed);
+    workers_.reserve(n);
+    try {
+      for (unsigned int i = 0; i < n; ++i) {
+        workers_.emplace_back(&encode_pipeline::run, this);
+      }
+    } catch (...) {
+      stop();
+      throw;
+    }
+  }
+
+  /// @brief Stops workers. Blocks which are not popped yet are discarded.
+  ~encode_pipeline() { stop(); }
+
+  encode_pipeline(const encode_pipeline&) = delete;
+  encode_pipeline& operator=(const encode_pipeline&) = delete;
+
+  /// @brief Returns the number of worker threads.
+  std::size_t num_workers() const noexcept { return workers_.size(); }
+
+  /// @brief Pushes a block, waiting while the input queue is full.
+  /// @param[in,out] b Block, which is moved from
+  void push(block& b) {
+    assert(!closed_.load(std::memory_order_relaxed) &&
+           "Pipeline is closed");
+    input_waiter_.wait([&] { return input_.try_push(b); });
+    input_waiter_.notify();
+  }
+
+  /// @brief Pushes a block unless the input queue is full.
+  /// @returns False if the input queue is full, in which case b is not moved.
+  bool try_push(block& b) {
+    assert(!closed_.load(std::memory_order_relaxed) &&
+           "Pipeline is closed");
+    if (!input_.try_push(b)) return false;
+    input_waiter_.notify();
+    return true;
+  }
+
+  /// @brief Tells workers that no more blocks are pushed. This is called
+  /// after all the producers finish pushing.
+  void close() noexcept {
+    closed_.store(true, std::memory_order_release);
+    input_waiter_.notify();
+  }
+
+  /// @brief Pops an encoded block, waiting until one is encoded.
+  /// @returns False if the pipeline is closed and all the blocks are popped.
+  bool pop(block& b) {
+    bool popped = false;
+    output_waiter_.wait([&] {
+      // Blocks pushed by workers are visible once they are seen to quit.
+      const bool done = active_.load(std::memory_order_acquire) == 0;
+      popped = output_.try_pop(b);
+      return popped || done;
+    });
+    if (popped) output_waiter_.notify();
+    return popped;
+  }
+
+  /// @brief Pops an encoded block unless none is ready.
+  /// @returns False if no block is ready.
+  bool try_pop(block& b) {
+    if (!output_.try_pop(b)) return false;
+    output_waiter_.notify();
+    return true;
+  }
+
+ private:
+  /// @brief Encodes blocks until the pipeline is closed and drained.
+  void run() {
+    block b;
+    for (;;) {
+      bool popped = false;
+      input_waiter_.wait([&] {
+        // Blocks pushed before closing are visible once closed_ is seen.
+        const bool closed = closed_.load(std::memory_order_acquire);
+        popped = input_.try_pop(b);
+        return popped || closed || stopped_.load(std::memory_order_relaxed);
+      });
+      if (!popped) break;
+      input_waiter_.notify();
+      b.codes.resize(b.coordinates.size());
+      Encode{}(b.coordinates.data(), b.coordinates.size(), b.codes.data());
+      output_waiter_.wait([&] {
+        return output_.try_push(b) ||
+               stopped_.load(std::memory_order_relaxed);
+      });
+      output_waiter_.notify();
+    }
+    active_.fetch_sub(1, std::memory_order_release);
+    output_waiter_.notify();
+  }
+
+  /// @brief Stops and joins workers.
+  void stop() noexcept {
+    stopped_.store(true, std::memory_order_relaxed);
+    input_waiter_.notify();
+    output_waiter_.notify();
+    for (auto&& w : workers_) w.join();
+    workers_.clear();
+  }
+
+  mpmc_queue<block> input_;           /// Blocks to encode
+  mpmc_queue<block> output_;          /// Encoded blocks
+  waiter input_waiter_;               /// Waits for changes of input_
+  waiter output_waiter_;              /// Waits for changes of output_
+  std::atomic<bool> closed_;          /// True if no more blocks are pushed
+  std::atomic<bool> stopped_;         /// True if workers should quit
+  std::atomic<unsigned int> active_;  /// Number of running workers
+  std::vector<std::thread> workers_;  /// Worker threads
+};
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+using morton::mpmc_queue;
+using morton::spsc_queue;
+
+namespace detail {
+
+/// @brief Encodes arrays of coordinates with a tag.
+template <typename Tag>
+struct array_encoder {
+  template <typename U, typename T>
+  void operator()(const coordinates<U>* c, std::size_t n,
+                  morton_code<T>* m) const noexcept {
+    encode(c, n, m, Tag{});
+  }
+};
+
+}  // namespace detail
+
+/// @brief Block of coordinates passed through an encode pipeline.
+/// @tparam U Integral type for coordinates
+template <typename U>
+using encode_block =
+    morton::encode_block<coordinates<U>,
+                         decltype(encode(std::declval<coordinates<U>>()))>;
+
+/// @brief Pipeline stage encoding blocks of 2D coordinates by worker threads
+/// between bounded lock-free queues.
+/// @tparam U Integral type for coordinates
+/// @tparam Tag Tag to specify an implementation of encoding
+template <typename U, typename Tag = default_tag>
+using encode_pipeline = morton::detail::encode_pipeline<
+    coordinates<U>, decltype(encode(std::declval<coordinates<U>>())),
+    detail::array_encoder<Tag>>;
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+using morton::mpmc_queue;
+using morton::spsc_queue;
+
+namespace detail {
+
+/// @brief Encodes arrays of coordinates with a tag.
+template <typename Tag>
+struct array_encoder {
+  template <typename U, typename T>
+  void operator()(const coordinates<U>* c, std::size_t n,
+                  morton_code<T>* m) const noexcept {
+    encode(c, n, m, Tag{});
+  }
+};
+
+}  // namespace detail
+
+/// @brief Block of coordinates passed through an encode pipeline.
+/// @tparam U Integral type for coordinates
+template <typename U>
+using encode_block =
+    morton::encode_block<coordinates<U>,
+                         decltype(encode(std::declval<coordinates<U>>()))>;
+
+/// @brief Pipeline stage encoding blocks of 3D coordinates by worker threads
+/// between bounded lock-free queues.
+///
+/// @code
+/// encode_pipeline<uint32_t> p(16, 4);
+/// std::thread consumer([&] {
+///   encode_block<uint32_t> b;
+///   while (p.pop(b)) write(b.id, b.codes);
+/// });
+/// for (...) {
+///   encode_block<uint32_t> b;
+///   b.id = next_id++;
+///   b.coordinates = read_sensor();
+///   p.push(b);
+/// }
+/// p.close();
+/// consumer.join();
+/// @endcode
+/// @tparam U Integral type for coordinates
+/// @tparam Tag Tag to specify an implementation of encoding
+template <typename U, typename Tag = default_tag>
+using encode_pipeline = morton::detail::encode_pipeline<
+    coordinates<U>, decltype(encode(std::declval<coordinates<U>>())),
+    detail::array_encoder<Tag>>;
+
+}  // namespace morton3d
+
+#endif  // MORTON_PIPELINE_HPP
@@ -0,0 +1,189 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_QUEUE_HPP
+#define MORTON_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// Size of padding separating atomic counters written by different threads
+constexpr std::size_t cache_line_size = 64;
+
+/// @brief Returns the smallest power of two not less than n and 2.
+inline std::size_t ceil_power_of_two(std::size_t n) noexcept {
+  std::size_t p = 2;
+  while (p < n) p *= 2;
+  return p;
+}
+
+}  // namespace detail
+
+/// @brief Bounded lock-free queue for a single producer thread and a single
+/// consumer thread.
+///
+/// Each thread keeps a copy of the other thread's counter, so that the
+/// counter written by the other thread is read only when the queue looks
+/// full or empty.
+/// @tparam T Element type, which is default constructible and movable
+template <typename T>
+class spsc_queue {
+ public:
+  /// @param[in] capacity Minimum number of elements, which is rounded up to a
+  /// power of two
+  explicit spsc_queue(std::size_t capacity)
+      : mask_{detail::ceil_power_of_two(capacity) - 1},
+        buffer_{new T[mask_ + 1]}, head_{0}, tail_cache_{0}, tail_{0},
+        head_cache_{0} {}
+
+  spsc_queue(const spsc_queue&) = delete;
+  spsc_queue& operator=(const spsc_queue&) = delete;
+
+  /// @brief Returns the maximum number of elements.
+  std::size_t capacity() const noexcept { return mask_ + 1; }
+
+  /// @brief Pushes an element unless the queue is full. Called only by the
+  /// producer.
+  /// @returns False if the queue is full, in which case v is not moved.
+  bool try_push(T& v) {
+    const std::size_t t = tail_.load(std::memory_order_relaxed);
+    if (t - head_cache_ == capacity()) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (t - head_cache_ == capacity()) return false;
+    }
+    buffer_[t & mask_] = std::move(v);
+    tail_.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Pops an element unless the queue is empty. Called only by the
+  /// consumer.
+  /// @returns False if the queue is empty.
+  bool try_pop(T& v) {
+    const std::size_t h = head_.load(std::memory_order_relaxed);
+    if (h == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (h == tail_cache_) return false;
+    }
+    v = std::move(buffer_[h & mask_]);
+    head_.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  const std::size_t mask_;         /// Capacity minus one
+  std::unique_ptr<T[]> buffer_;    /// Ring buffer
+  char pad0_[detail::cache_line_size];
+  std::atomic<std::size_t> head_;  /// Number of popped elements
+  std::size_t tail_cache_;         /// Copy of tail_ read by the consumer
+  char pad1_[detail::cache_line_size];
+  std::atomic<std::size_t> tail_;  /// Number of pushed elements
+  std::size_t head_cache_;         /// Copy of head_ read by the producer
+  char pad2_[detail::cache_line_size];
+};
+
+/// @brief Bounded lock-free queue for multiple producer and consumer
+/// threads.
+///
+/// Every slot has a sequence number telling whether it is ready for the next
+/// push or pop at a position, and threads claim positions by compare and
+/// swap, i.e. the bounded MPMC queue by Dmitry Vyukov.
+/// @tparam T Element type, which is default constructible and movable
+template <typename T>
+class mpmc_queue {
+ public:
+  /// @param[in] capacity Minimum number of elements, which is rounded up to a
+  /// power of two
+  explicit mpmc_queue(std::size_t capacity)
+      : mask_{detail::ceil_power_of_two(capacity) - 1},
+        slots_{new slot[mask_ + 1]}, enqueue_pos_{0}, dequeue_pos_{0} {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  mpmc_queue(const mpmc_queue&) = delete;
+  mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+  /// @brief Returns the maximum number of elements.
+  std::size_t capacity() const noexcept { return mask_ + 1; }
+
+  /// @brief Pushes an element unless the queue is full.
+  /// @returns False if the queue is full, in which case v is not moved.
+  bool try_push(T& v) {
+    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    slot* s;
+    for (;;) {
+      s = &slots_[pos & mask_];
+      const std::size_t seq = s->sequence.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    s->value = std::move(v);
+    s->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Pops an element unless the queue is empty.
+  /// @returns False if the queue is empty.
+  bool try_pop(T& v) {
+    std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    slot* s;
+    for (;;) {
+      s = &slots_[pos & mask_];
+      const std::size_t seq = s->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq) -
+                        static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    v = std::move(s->value);
+    s->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  /// @brief Slot of an element
+  struct slot {
+    std::atomic<std::size_t> sequence;  /// Position the slot is ready for
+    T value;                            /// Element
+  };
+
+  const std::size_t mask_;                /// Capacity minus one
+  std::unique_ptr<slot[]> slots_;         /// Ring buffer
+  char pad0_[detail::cache_line_size];
+  std::atomic<std::size_t> enqueue_pos_;  /// Next position to push
+  char pad1_[detail::cache_line_size];
+  std::atomic<std::size_t> dequeue_pos_;  /// Next position to pop
+  char pad2_[detail::cache_line_size];
+};
+
+}  // namespace morton
+
+#endif  // MORTON_QUEUE_HPP
@@ -0,0 +1,373 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_RAY_HPP
+#define MORTON_RAY_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+#include "morton/parallel.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Traversal of the cells of a grid pierced by a line segment.
+///
+/// Cells are visited in the order of the segment by the algorithm of
+/// Amanatides and Woo: the parameter at which the segment crosses the next
+/// cell boundary is kept for each axis, and the axis of the nearest boundary
+/// is stepped. The morton code of the current cell is updated by adding or
+/// subtracting one in the dilated integer of the axis, so that no cell is
+/// encoded but the first.
+///
+/// The segment is clipped to the grid. The number of steps along each axis
+/// is fixed in advance by the cells of the end points, so that rounding errors
+/// can change the order of steps but never the last cell, and consecutive
+/// cells always share a face.
+/// @tparam T Integral type for morton_code
+/// @tparam Traits morton_traits
+/// @tparam Dimension Number of dimensions
+template <typename T, typename Traits, unsigned int Dimension>
+class basic_cell_traversal {
+ public:
+  basic_cell_traversal() noexcept : code_{0}, count_{0} {}
+
+  /// @brief Returns true if every cell has been visited.
+  bool done() const noexcept { return count_ == 0; }
+
+  /// @brief Returns the number of cells left including the current one.
+  std::size_t size() const noexcept { return count_; }
+
+  /// @brief Returns the morton code of the current cell.
+  T code() const noexcept { return code_; }
+
+  /// @brief Moves to the next cell.
+  void next() noexcept {
+    assert(count_ > 0 && "Traversal is done");
+    if (--count_ == 0) return;
+    unsigned int a = 0;
+    for (unsigned int i = 1; i < Dimension; ++i) {
+      if (t_max_[i] < t_max_[a]) a = i;
+    }
+    const T mask = static_cast<T>(Traits::mask_x << a);
+    code_ = static_cast<T>((((code_ | ~mask) + step_[a]) & mask) |
+                           (code_ & ~mask));
+    t_max_[a] = --steps_[a] == 0 ? infinity() : t_max_[a] + t_delta_[a];
+  }
+
+ protected:
+  /// @brief Clips a segment to a grid and sets up the traversal.
+  ///
+  /// The code of the first cell must be given by start() afterwards.
+  /// @param[in] from Start point in units of cells
+  /// @param[in] to End point in units of cells
+  /// @param[in] extent Number of cells along each axis
+  /// @param[out] first Coordinates of the first cell
+  /// @returns False if the segment does not touch the grid
+  template <typename Real>
+  bool clip(const Real* from, const Real* to,
+            const uint64_t (&extent)[Dimension],
+            uint64_t (&first)[Dimension]) noexcept {
+    count_ = 0;
+    double p[Dimension], d[Dimension];
+    double t0 = 0, t1 = 1;
+    for (unsigned int a = 0; a < Dimension; ++a) {
+      p[a] = from[a];
+      d[a] = static_cast<double>(to[a]) - p[a];
+      const double n = static_cast<double>(extent[a]);
+      if (extent[a] == 0) return false;
+      if (d[a] == 0) {
+        if (!(p[a] >= 0 && p[a] <= n)) return false;
+        continue;
+      }
+      double ta = -p[a] / d[a];
+      double tb = (n - p[a]) / d[a];
+      if (ta > tb) std::swap(ta, tb);
+      t0 = std::max(t0, ta);
+      t1 = std::min(t1, tb);
+    }
+    // Also rejects NaN.
+    if (!(t0 <= t1)) return false;
+
+    std::size_t count = 1;
+    for (unsigned int a = 0; a < Dimension; ++a) {
+      first[a] = cell_of(p[a] + t0 * d[a], extent[a]);
+      const uint64_t last = cell_of(p[a] + t1 * d[a], extent[a]);
+      if (d[a] > 0 && last > first[a]) {
+        steps_[a] = last - first[a];
+        step_[a] = static_cast<T>(T(1) << a);
+        t_delta_[a] = 1 / d[a];
+        t_max_[a] = (static_cast<double>(first[a] + 1) - p[a]) / d[a];
+      } else if (d[a] < 0 && last < first[a]) {
+        steps_[a] = first[a] - last;
+        // Adding all the bits of a dilated integer subtracts one.
+        step_[a] = static_cast<T>(Traits::mask_x << a);
+        t_delta_[a] = -1 / d[a];
+        t_max_[a] = (static_cast<double>(first[a]) - p[a]) / d[a];
+      } else {
+        steps_[a] = 0;
+        step_[a] = 0;
+        t_delta_[a] = 0;
+        t_max_[a] = infinity();
+      }
+      count += steps_[a];
+    }
+    count_ = count;
+    return true;
+  }
+
+  /// @brief Sets the morton code of the first cell.
+  void start(const T code) noexcept { code_ = code; }
+
+ private:
+  static double infinity() noexcept {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  /// @brief Returns the cell of a coordinate clamped into [0, extent).
+  static uint64_t cell_of(const double p, const uint64_t extent) noexcept {
+    if (!(p > 0)) return 0;
+    const double c = std::floor(p);
+    return c < static_cast<double>(extent) ? static_cast<uint64_t>(c)
+                                           : extent - 1;
+  }
+
+  T code_;                       /// Morton code of the current cell
+  std::size_t count_;            /// Number of cells left
+  uint64_t steps_[Dimension];    /// Number of steps left along each axis
+  T step_[Dimension];            /// Dilated integer added by a step
+  double t_max_[Dimension];      /// Parameter of the next boundary
+  double t_delta_[Dimension];    /// Parameter between boundaries
+};
+
+/// @brief Rasterizes line segments into morton codes of cells in parallel.
+/// @tparam Traversal cell_traversal type
+/// @tparam Code morton_code type
+/// @tparam Extent coordinates type
+template <typename Traversal, typename Code, typename Real, typename Extent,
+          typename Tag>
+void rasterize(const Real* from, const Real* to, std::size_t n,
+               const Extent& extent, std::vector<Code>& codes,
+               std::vector<std::size_t>& offsets, unsigned int num_threads,
+               Tag tag) {
+  constexpr unsigned int dim = Traversal::dimension;
+  // Segments usually visit many cells, so that a few make enough work for a
+  // thread.
+  const std::size_t t = num_blocks(n, num_threads, 256);
+  offsets.assign(n + 1, 0);
+  run_in_parallel(t, [&](std::size_t b) {
+    const std::size_t last = block_begin(n, t, b + 1);
+    for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+      offsets[i + 1] =
+          Traversal(from + dim * i, to + dim * i, extent, tag).size();
+    }
+  });
+  parallel_inclusive_scan(offsets.data(), n + 1, offsets.data(), num_threads);
+  codes.resize(offsets[n]);
+  run_in_parallel(t, [&](std::size_t b) {
+    const std::size_t last = block_begin(n, t, b + 1);
+    for (std::size_t i = block_begin(n, t, b); i < last; ++i) {
+      Code* out = codes.data() + offsets[i];
+      for (Traversal c(from + dim * i, to + dim * i, extent, tag); !c.done();
+           c.next()) {
+        *out++ = c.code();
+      }
+    }
+  });
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Traversal of the cells of a 2D grid pierced by a line segment.
+///
+/// Cells have unit size and the grid covers [0, extent.x] x [0, extent.y].
+/// A ray from o in direction d up to parameter t is the segment from o to
+/// o + t * d.
+///
+/// @code
+/// const double from[] = {0.5, 0.5}, to[] = {100.2, 30.7};
+/// for (cell_traversal<uint64_t> c(from, to, {256, 256}); !c.done();
+///      c.next()) {
+///   visit(c.code());
+/// }
+/// @endcode
+/// @tparam T Integral type for morton_code
+template <typename T>
+class cell_traversal
+    : public morton::detail::basic_cell_traversal<T, morton_traits<T>, 2> {
+  using base = morton::detail::basic_cell_traversal<T, morton_traits<T>, 2>;
+
+ public:
+  using coordinate_type = typename morton_traits<T>::coordinate_type;
+  static constexpr unsigned int dimension = 2;
+
+  /// @param[in] from Start point in units of cells
+  /// @param[in] to End point in units of cells
+  /// @param[in] extent Number of cells along each axis, which are at most
+  /// 2^morton_traits<T>::bits
+  template <typename Real, typename Tag = default_tag>
+  cell_traversal(const Real* from, const Real* to,
+                 const coordinates<coordinate_type>& extent,
+                 Tag tag = Tag{}) noexcept {
+    const uint64_t e[2] = {extent.x, extent.y};
+    uint64_t c[2];
+    if (this->clip(from, to, e, c)) {
+      this->start(encode(coordinates<coordinate_type>{
+                             static_cast<coordinate_type>(c[0]),
+                             static_cast<coordinate_type>(c[1])},
+                         tag)
+                      .value);
+    }
+  }
+
+  /// @brief Returns the morton code of the current cell.
+  morton_code<T> code() const noexcept { return morton_code<T>(base::code()); }
+};
+
+/// @brief Visits the cells of a 2D grid pierced by a line segment in order.
+/// @param[in] from Start point in units of cells
+/// @param[in] to End point in units of cells
+/// @param[in] extent Number of cells along each axis
+/// @param[in] f Function object called with the morton code of every cell
+template <typename T, typename Real, typename F, typename Tag = default_tag>
+void traverse(const Real* from, const Real* to,
+              const coordinates<typename morton_traits<T>::coordinate_type>&
+                  extent,
+              F f, Tag tag = Tag{}) {
+  for (cell_traversal<T> c(from, to, extent, tag); !c.done(); c.next()) {
+    f(c.code());
+  }
+}
+
+/// @brief Rasterizes line segments into morton codes of 2D cells in
+/// parallel.
+///
+/// Codes of segment i are codes[offsets[i]] to codes[offsets[i + 1] - 1] in
+/// the order of the segment.
+/// @param[in] from Start points of segments, 2 values per segment
+/// @param[in] to End points of segments, 2 values per segment
+/// @param[in] n Number of segments
+/// @param[in] extent Number of cells along each axis
+/// @param[out] codes Morton codes of cells
+/// @param[out] offsets n + 1 offsets of segments in codes
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+template <typename T, typename Real, typename Tag = default_tag>
+void rasterize(const Real* from, const Real* to, std::size_t n,
+               const coordinates<typename morton_traits<T>::coordinate_type>&
+                   extent,
+               std::vector<morton_code<T>>& codes,
+               std::vector<std::size_t>& offsets,
+               unsigned int num_threads = 0, Tag tag = Tag{}) {
+  morton::detail::rasterize<cell_traversal<T>>(from, to, n, extent, codes,
+                                               offsets, num_threads, tag);
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Traversal of the voxels of a 3D grid pierced by a line segment.
+///
+/// Voxels have unit size and the grid covers [0, extent.x] x [0, extent.y] x
+/// [0, extent.z]. A ray from o in direction d up to parameter t is the
+/// segment from o to o + t * d.
+///
+/// @code
+/// const double from[] = {0.5, 0.5, 0.5}, to[] = {100.2, 30.7, 12.0};
+/// for (cell_traversal<uint64_t> c(from, to, {256, 256, 64}); !c.done();
+///      c.next()) {
+///   visit(c.code());
+/// }
+/// @endcode
+/// @tparam T Integral type for morton_code
+template <typename T>
+class cell_traversal
+    : public morton::detail::basic_cell_traversal<T, morton_traits<T>, 3> {
+  using base = morton::detail::basic_cell_traversal<T, morton_traits<T>, 3>;
+
+ public:
+  using coordinate_type = typename morton_traits<T>::coordinate_type;
+  static constexpr unsigned int dimension = 3;
+
+  /// @param[in] from Start point in units of voxels
+  /// @param[in] to End point in units of voxels
+  /// @param[in] extent Number of voxels along each axis, which are at most
+  /// 2^morton_traits<T>::bits
+  template <typename Real, typename Tag = default_tag>
+  cell_traversal(const Real* from, const Real* to,
+                 const coordinates<coordinate_type>& extent,
+                 Tag tag = Tag{}) noexcept {
+    const uint64_t e[3] = {extent.x, extent.y, extent.z};
+    uint64_t c[3];
+    if (this->clip(from, to, e, c)) {
+      this->start(encode(coordinates<coordinate_type>{
+                             static_cast<coordinate_type>(c[0]),
+                             static_cast<coordinate_type>(c[1]),
+                             static_cast<coordinate_type>(c[2])},
+                         tag)
+                      .value);
+    }
+  }
+
+  /// @brief Returns the morton code of the current voxel.
+  morton_code<T> code() const noexcept { return morton_code<T>(base::code()); }
+};
+
+/// @brief Visits the voxels of a 3D grid pierced by a line segment in order.
+/// @param[in] from Start point in units of voxels
+/// @param[in] to End point in units of voxels
+/// @param[in] extent Number of voxels along each axis
+/// @param[in] f Function object called with the morton code of every voxel
+template <typename T, typename Real, typename F, typename Tag = default_tag>
+void traverse(const Real* from, const Real* to,
+              const coordinates<typename morton_traits<T>::coordinate_type>&
+                  extent,
+              F f, Tag tag = Tag{}) {
+  for (cell_traversal<T> c(from, to, extent, tag); !c.done(); c.next()) {
+    f(c.code());
+  }
+}
+
+/// @brief Rasterizes line segments, e.g. rays of range sensors, into morton
+/// codes of voxels in parallel.
+///
+/// Codes of segment i are codes[offsets[i]] to codes[offsets[i + 1] - 1] in
+/// the order of the segment.
+/// @param[in] from Start points of segments, 3 values per segment
+/// @param[in] to End points of segments, 3 values per segment
+/// @param[in] n Number of segments
+/// @param[in] extent Number of voxels along each axis
+/// @param[out] codes Morton codes of voxels
+/// @param[out] offsets n + 1 offsets of segments in codes
+/// @param[in] num_threads Number of threads, or 0 for the number of hardware
+/// threads
+template <typename T, typename Real, typename Tag = default_tag>
+void rasterize(const Real* from, const Real* to, std::size_t n,
+               const coordinates<typename morton_traits<T>::coordinate_type>&
+                   extent,
+               std::vector<morton_code<T>>& codes,
+               std::vector<std::size_t>& offsets,
+               unsigned int num_threads = 0, Tag tag = Tag{}) {
+  morton::detail::rasterize<cell_traversal<T>>(from, to, n, extent, codes,
+                                               offsets, num_threads, tag);
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_RAY_HPP
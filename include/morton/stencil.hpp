@@ -0,0 +1,253 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_STENCIL_HPP
+#define MORTON_STENCIL_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include "morton/grid.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Forward iterator visiting cells of a grid in Z-order together with
+/// their neighbors.
+///
+/// Dilated coordinates of the current cell and of its -1 and +1 neighbors
+/// along each axis are kept, and updated by dilated arithmetic along the axes
+/// whose coordinates change when the iterator moves. The index of any
+/// neighbor in a 3x3(x3) stencil is a bitwise OR of them.
+/// @tparam T Element type, which is const for constant grids
+/// @tparam Dimension Number of dimensions
+template <typename T, unsigned int Dimension>
+class stencil_iterator {
+ public:
+  using value_type = typename std::remove_const<T>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T*;
+  using reference = T&;
+  using iterator_category = std::forward_iterator_tag;
+
+  stencil_iterator() noexcept
+      : data_{nullptr}, bounds_{}, count_{0}, mask_{0}, index_{0} {}
+
+  /// @param[in] data Storage of a grid
+  /// @param[in] bounds Bounds of the grid
+  /// @param[in] count Number of cells visited so far, which is zero for the
+  /// begin iterator and the number of cells for the end iterator
+  stencil_iterator(T* data, const dilated_bounds<Dimension>& bounds,
+                   std::size_t count) noexcept
+      : data_{data}, bounds_(bounds), count_{count}, mask_{0}, index_{0} {
+    for (unsigned int a = 0; a < Dimension; ++a) {
+      mask_ |= bounds_.masks[a];
+      set_axis(a, 0);
+    }
+  }
+
+  /// @brief Returns the current cell.
+  reference operator*() const noexcept { return data_[index()]; }
+  pointer operator->() const noexcept { return data_ + index(); }
+
+  /// @brief Index of the current cell in the storage
+  std::size_t index() const noexcept { return index_; }
+
+  /// @brief Returns the dilated coordinate of the current cell.
+  /// @param[in] axis Axis
+  std::size_t dilated(unsigned int axis) const noexcept {
+    return coords_[axis][1];
+  }
+
+  /// @brief Check if the current cell has a neighbor.
+  /// @param[in] axis Axis
+  /// @param[in] direction -1 or +1
+  bool has_neighbor(unsigned int axis, int direction) const noexcept {
+    assert(direction == -1 || direction == 1);
+    // The +1 neighbor of the last cell wraps to zero for a power-of-two
+    // extent.
+    return direction < 0 ? coords_[axis][1] != 0
+                         : coords_[axis][2] != 0 &&
+                               coords_[axis][2] < bounds_.limits[axis];
+  }
+
+  /// @brief Check if the current cell is on the boundary of the grid.
+  bool on_boundary() const noexcept {
+    for (unsigned int a = 0; a < Dimension; ++a) {
+      if (!has_neighbor(a, -1) || !has_neighbor(a, 1)) return true;
+    }
+    return false;
+  }
+
+  /// @brief Returns the index of a neighbor in two dimensions.
+  ///
+  /// The neighbor must exist (see has_neighbor).
+  /// @param[in] i Offset along x axis in [-1, 1]
+  /// @param[in] j Offset along y axis in [-1, 1]
+  std::size_t neighbor_index(int i, int j) const noexcept {
+    static_assert(Dimension == 2, "Dimension is not 2");
+    assert(-1 <= i && i <= 1 && -1 <= j && j <= 1);
+    return coords_[0][i + 1] | coords_[1][j + 1];
+  }
+
+  /// @brief Returns the index of a neighbor in three dimensions.
+  ///
+  /// The neighbor must exist (see has_neighbor).
+  /// @param[in] i Offset along x axis in [-1, 1]
+  /// @param[in] j Offset along y axis in [-1, 1]
+  /// @param[in] k Offset along z axis in [-1, 1]
+  std::size_t neighbor_index(int i, int j, int k) const noexcept {
+    static_assert(Dimension == 3, "Dimension is not 3");
+    assert(-1 <= i && i <= 1 && -1 <= j && j <= 1 && -1 <= k && k <= 1);
+    return coords_[0][i + 1] | coords_[1][j + 1] | coords_[2][k + 1];
+  }
+
+  /// @brief Returns a neighbor in two dimensions.
+  reference operator()(int i, int j) const noexcept {
+    return data_[neighbor_index(i, j)];
+  }
+
+  /// @brief Returns a neighbor in three dimensions.
+  reference operator()(int i, int j, int k) const noexcept {
+    return data_[neighbor_index(i, j, k)];
+  }
+
+  /// @brief Moves to the next cell in Z-order, skipping the padding.
+  stencil_iterator& operator++() noexcept {
+    ++count_;
+    const std::size_t i = bounds_.next(index_, mask_);
+    // Only the axes whose bits the step changes are updated, which is mostly
+    // the x axis alone.
+    const std::size_t changed = index_ ^ i;
+    for (unsigned int a = 0; a < Dimension; ++a) {
+      if ((changed & bounds_.masks[a]) != 0) set_axis(a, i & bounds_.masks[a]);
+    }
+    index_ = i;
+    return *this;
+  }
+
+  stencil_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  friend bool operator==(const stencil_iterator& it1,
+                         const stencil_iterator& it2) noexcept {
+    return it1.count_ == it2.count_;
+  }
+
+  friend bool operator!=(const stencil_iterator& it1,
+                         const stencil_iterator& it2) noexcept {
+    return !(it1 == it2);
+  }
+
+ private:
+  /// @brief Sets the dilated coordinates of the current cell along an axis.
+  void set_axis(unsigned int a, std::size_t d) noexcept {
+    const std::size_t m = bounds_.masks[a];
+    coords_[a][0] = dilated_decrement(d, m);
+    coords_[a][1] = d;
+    coords_[a][2] = dilated_increment(d, m);
+  }
+
+  T* data_;                            /// Storage of the grid
+  dilated_bounds<Dimension> bounds_;   /// Bounds of the grid
+  std::size_t count_;                  /// Number of visited cells
+  std::size_t mask_;                   /// Bits of all axes
+  std::size_t index_;                  /// Index of the current cell
+  std::size_t coords_[Dimension][3];   /// Dilated coordinates -1, 0, +1
+};
+
+/// @brief Range of cells of a grid visited by stencil_iterator.
+template <typename T, unsigned int Dimension>
+class stencil_range {
+ public:
+  using iterator = stencil_iterator<T, Dimension>;
+  using const_iterator = iterator;
+
+  /// @param[in] data Storage of a grid
+  /// @param[in] bounds Bounds of the grid
+  /// @param[in] size Number of cells
+  stencil_range(T* data, const dilated_bounds<Dimension>& bounds,
+                std::size_t size) noexcept
+      : data_{data}, bounds_(bounds), size_{size} {}
+
+  iterator begin() const noexcept { return iterator(data_, bounds_, 0); }
+  iterator end() const noexcept { return iterator(data_, bounds_, size_); }
+
+  std::size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+
+ private:
+  T* data_;
+  dilated_bounds<Dimension> bounds_;
+  std::size_t size_;
+};
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Returns cells of a grid with their neighbors in Z-order.
+///
+/// @code
+/// for (auto it = s.begin(); it != s.end(); ++it) {
+///   if (it.on_boundary()) continue;
+///   out[it.index()] = it(-1, 0) + it(1, 0) + it(0, -1) + it(0, 1) - 4 * *it;
+/// }
+/// @endcode
+template <typename T, std::size_t Alignment>
+inline morton::detail::stencil_range<T, 2> stencil(
+    grid<T, Alignment>& g) noexcept {
+  return morton::detail::stencil_range<T, 2>(
+      g.data(), detail::bounds_of(g.layout()), g.size());
+}
+
+/// @brief Returns cells of a constant grid with their neighbors in Z-order.
+template <typename T, std::size_t Alignment>
+inline morton::detail::stencil_range<const T, 2> stencil(
+    const grid<T, Alignment>& g) noexcept {
+  return morton::detail::stencil_range<const T, 2>(
+      g.data(), detail::bounds_of(g.layout()), g.size());
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+/// @brief Returns cells of a grid with their neighbors in Z-order.
+///
+/// @code
+/// // 7-point Laplacian
+/// for (auto it = s.begin(); it != s.end(); ++it) {
+///   if (it.on_boundary()) continue;
+///   out[it.index()] = it(-1, 0, 0) + it(1, 0, 0) + it(0, -1, 0) +
+///                     it(0, 1, 0) + it(0, 0, -1) + it(0, 0, 1) - 6 * *it;
+/// }
+/// @endcode
+template <typename T, std::size_t Alignment>
+inline morton::detail::stencil_range<T, 3> stencil(
+    grid<T, Alignment>& g) noexcept {
+  return morton::detail::stencil_range<T, 3>(
+      g.data(), detail::bounds_of(g.layout()), g.size());
+}
+
+/// @brief Returns cells of a constant grid with their neighbors in Z-order.
+template <typename T, std::size_t Alignment>
+inline morton::detail::stencil_range<const T, 3> stencil(
+    const grid<T, Alignment>& g) noexcept {
+  return morton::detail::stencil_range<const T, 3>(
+      g.data(), detail::bounds_of(g.layout()), g.size());
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_STENCIL_HPP
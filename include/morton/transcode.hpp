@@ -0,0 +1,266 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+#ifndef MORTON_TRANSCODE_HPP
+#define MORTON_TRANSCODE_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+/// Implementation shared by morton2d and morton3d namespaces
+namespace morton {
+
+/// Detail implementation of morton library
+namespace detail {
+
+/// @brief Returns a code of a wider type whose coordinates are those of a
+/// code multiplied by 2^levels.
+template <unsigned int Dimension, typename To, typename From>
+inline To widen_code(const From value, const unsigned int levels) noexcept {
+  return static_cast<To>(static_cast<To>(value) << (Dimension * levels));
+}
+
+/// @brief Returns a code of a narrower type whose coordinates are those of a
+/// code divided by 2^levels, modulo 2^ToTraits::bits.
+template <unsigned int Dimension, typename ToTraits, typename To,
+          typename From>
+inline To narrow_code(const From value, const unsigned int levels) noexcept {
+  constexpr unsigned int bits = Dimension * ToTraits::bits;
+  constexpr From mask =
+      bits < static_cast<unsigned int>(std::numeric_limits<From>::digits)
+          ? static_cast<From>((From(1) << (bits % 64)) - 1)
+          : static_cast<From>(~From(0));
+  return static_cast<To>((value >> (Dimension * levels)) & mask);
+}
+
+/// @brief Moves pairs of bits at every third bit, i.e. bits 3k and 3k + 1,
+/// to bits 2k and 2k + 1.
+///
+/// The k-th pair moves right by k bits, which is done by moving pairs whose k
+/// has bit j set right by 2^j for every j. Pairs never overlap in between.
+inline uint32_t compact_pairs(uint32_t x) noexcept {
+  x &= 0x1b6db6db;
+  x = (x & ~0x18618618u) | ((x & 0x18618618u) >> 1);
+  x = (x & ~0x003c03c0u) | ((x & 0x003c03c0u) >> 2);
+  x = (x & ~0x000ff000u) | ((x & 0x000ff000u) >> 4);
+  x = (x & ~0x0f000000u) | ((x & 0x0f000000u) >> 8);
+  return x;
+}
+
+/// @brief Moves pairs of bits at every third bit, i.e. bits 3k and 3k + 1,
+/// to bits 2k and 2k + 1.
+inline uint64_t compact_pairs(uint64_t x) noexcept {
+  x &= 0x36db6db6db6db6db;
+  x = (x & ~0x0618618618618618ull) | ((x & 0x0618618618618618ull) >> 1);
+  x = (x & ~0x03c03c03c03c03c0ull) | ((x & 0x03c03c03c03c03c0ull) >> 2);
+  x = (x & ~0x30000ff0000ff000ull) | ((x & 0x30000ff0000ff000ull) >> 4);
+  x = (x & ~0x000000ffff000000ull) | ((x & 0x000000ffff000000ull) >> 8);
+  x = (x & ~0x03ff000000000000ull) | ((x & 0x03ff000000000000ull) >> 16);
+  return x;
+}
+
+}  // namespace detail
+
+}  // namespace morton
+
+namespace morton2d {
+
+/// @brief Converts a 32-bit morton code into a 64-bit one.
+///
+/// The bit layout of morton codes does not depend on their width, so that the
+/// code is extended by a shift instead of decoding and encoding it.
+/// @param[in] m Morton code
+/// @param[in] levels Number of levels added below the leaves, i.e.
+/// coordinates are multiplied by 2^levels, at most 16
+inline morton_code64_t widen(const morton_code32_t m,
+                             const unsigned int levels = 0) noexcept {
+  assert(levels <= 16 && "Coordinates overflow 32 bits");
+  return morton_code64_t{
+      morton::detail::widen_code<2, uint64_t>(m.value, levels)};
+}
+
+/// @brief Converts a 64-bit morton code into a 32-bit one.
+/// @param[in] m Morton code
+/// @param[in] levels Number of levels truncated from the leaves, i.e.
+/// coordinates are divided by 2^levels. Coordinates which still do not fit in
+/// 16 bits are truncated to their low bits.
+inline morton_code32_t narrow(const morton_code64_t m,
+                              const unsigned int levels = 0) noexcept {
+  assert(levels <= 32 && "Levels are more than those of codes");
+  return morton_code32_t{
+      morton::detail::narrow_code<2, morton_traits<uint32_t>, uint32_t>(
+          m.value, levels)};
+}
+
+/// @brief Converts an array of 32-bit morton codes into 64-bit ones.
+/// @param[in] m Morton codes
+/// @param[in] n Number of morton codes
+/// @param[out] result Converted morton codes
+/// @param[in] levels Number of levels added below the leaves
+inline void widen(const morton_code32_t* m, std::size_t n,
+                  morton_code64_t* result,
+                  const unsigned int levels = 0) noexcept {
+  for (std::size_t i = 0; i < n; ++i) result[i] = widen(m[i], levels);
+}
+
+/// @brief Converts an array of 64-bit morton codes into 32-bit ones.
+/// @param[in] m Morton codes
+/// @param[in] n Number of morton codes
+/// @param[out] result Converted morton codes
+/// @param[in] levels Number of levels truncated from the leaves
+inline void narrow(const morton_code64_t* m, std::size_t n,
+                   morton_code32_t* result,
+                   const unsigned int levels = 0) noexcept {
+  for (std::size_t i = 0; i < n; ++i) result[i] = narrow(m[i], levels);
+}
+
+}  // namespace morton2d
+
+namespace morton3d {
+
+namespace detail {
+
+/// @brief Projection of 3D morton codes onto 2D ones. Pairs of the remaining
+/// axes are gathered and compacted by magic bits unless specialized.
+/// @tparam T Integral type for morton_code
+/// @tparam Tag Tag to switch implementation
+template <typename T, typename Tag>
+struct project_impl {
+  static T project(const T m, const unsigned int axis) noexcept {
+    const T x = static_cast<T>(morton_traits<T>::mask_x);
+    switch (axis) {
+      case 0:  // y and z
+        return morton::detail::compact_pairs(static_cast<T>(m >> 1));
+      case 1:  // z next to x
+        return morton::detail::compact_pairs(
+            static_cast<T>((m & x) | ((m >> 1) & (x << 1))));
+      default:  // x and y
+        return morton::detail::compact_pairs(m);
+    }
+  }
+};
+
+#ifdef MORTON3D_USE_BMI
+
+template <>
+struct project_impl<uint32_t, tag::bmi> {
+  static uint32_t project(const uint32_t m, const unsigned int axis) noexcept {
+    const uint32_t masks[3] = {0x36db6db6, 0x2db6db6d, 0x1b6db6db};
+    return _pext_u32(m, masks[axis]);
+  }
+};
+
+template <>
+struct project_impl<uint64_t, tag::bmi> {
+  static uint64_t project(const uint64_t m, const unsigned int axis) noexcept {
+    const uint64_t masks[3] = {0x6db6db6db6db6db6, 0x5b6db6db6db6db6d,
+                               0x36db6db6db6db6db};
+    return _pext_u64(m, masks[axis]);
+  }
+};
+
+#endif  // MORTON3D_USE_BMI
+
+/// @brief Projection by the implementation selected for decoding.
+template <typename T>
+struct project_impl<T, tag::tuned>
+    : project_impl<T, typename tuned_tags<T>::decode> {};
+
+}  // namespace detail
+
+/// @brief Converts a 32-bit morton code into a 64-bit one.
+///
+/// The bit layout of morton codes does not depend on their width, so that the
+/// code is extended by a shift instead of decoding and encoding it.
+/// @param[in] m Morton code
+/// @param[in] levels Number of levels added below the leaves, i.e.
+/// coordinates are multiplied by 2^levels, at most 11
+inline morton_code64_t widen(const morton_code32_t m,
+                             const unsigned int levels = 0) noexcept {
+  assert(levels <= 11 && "Coordinates overflow 21 bits");
+  return morton_code64_t{
+      morton::detail::widen_code<3, uint64_t>(m.value, levels)};
+}
+
+/// @brief Converts a 64-bit morton code into a 32-bit one.
+/// @param[in] m Morton code
+/// @param[in] levels Number of levels truncated from the leaves, i.e.
+/// coordinates are divided by 2^levels. Coordinates which still do not fit in
+/// 10 bits are truncated to their low bits.
+inline morton_code32_t narrow(const morton_code64_t m,
+                              const unsigned int levels = 0) noexcept {
+  assert(levels <= 21 && "Levels are more than those of codes");
+  return morton_code32_t{
+      morton::detail::narrow_code<3, morton_traits<uint32_t>, uint32_t>(
+          m.value, levels)};
+}
+
+/// @brief Projects a 3D morton code onto the plane of the other two axes.
+///
+/// Bits of the dropped axis are removed from the code, which is PEXT for
+/// tag::bmi, or gathering and compacting pairs of bits by magic bits
+/// otherwise. The remaining axes keep their order, e.g. dropping y gives the
+/// 2D code of (x, z).
+/// @tparam T Integral type for morton_code
+/// @tparam Tag Tag to switch implementation
+/// @param[in] m Morton code
+/// @param[in] axis Axis to drop, 0 (x), 1 (y) or 2 (z)
+/// @returns 2D morton code of the same width
+template <typename T, typename Tag = default_tag>
+inline morton2d::morton_code<T> project(const morton_code<T> m,
+                                        const unsigned int axis,
+                                        Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  assert(axis < 3 && "Axis is not 0, 1 or 2");
+  return morton2d::morton_code<T>{
+      detail::project_impl<T, Tag>::project(m.value, axis)};
+}
+
+/// @brief Converts an array of 32-bit morton codes into 64-bit ones.
+/// @param[in] m Morton codes
+/// @param[in] n Number of morton codes
+/// @param[out] result Converted morton codes
+/// @param[in] levels Number of levels added below the leaves
+inline void widen(const morton_code32_t* m, std::size_t n,
+                  morton_code64_t* result,
+                  const unsigned int levels = 0) noexcept {
+  for (std::size_t i = 0; i < n; ++i) result[i] = widen(m[i], levels);
+}
+
+/// @brief Converts an array of 64-bit morton codes into 32-bit ones.
+/// @param[in] m Morton codes
+/// @param[in] n Number of morton codes
+/// @param[out] result Converted morton codes
+/// @param[in] levels Number of levels truncated from the leaves
+inline void narrow(const morton_code64_t* m, std::size_t n,
+                   morton_code32_t* result,
+                   const unsigned int levels = 0) noexcept {
+  for (std::size_t i = 0; i < n; ++i) result[i] = narrow(m[i], levels);
+}
+
+/// @brief Projects an array of 3D morton codes onto 2D ones.
+/// @tparam T Integral type for morton_code
+/// @tparam Tag Tag to switch implementation
+/// @param[in] m Morton codes
+/// @param[in] n Number of morton codes
+/// @param[in] axis Axis to drop, 0 (x), 1 (y) or 2 (z)
+/// @param[out] result 2D morton codes
+template <typename T, typename Tag = default_tag>
+inline void project(const morton_code<T>* m, std::size_t n,
+                    const unsigned int axis, morton2d::morton_code<T>* result,
+                    Tag = Tag{}) noexcept {
+  static_assert(is_tag<Tag>::value, "Tag is not a tag type");
+  assert(axis < 3 && "Axis is not 0, 1 or 2");
+  for (std::size_t i = 0; i < n; ++i) {
+    result[i].value = detail::project_impl<T, Tag>::project(m[i].value, axis);
+  }
+}
+
+}  // namespace morton3d
+
+#endif  // MORTON_TRANSCODE_HPP
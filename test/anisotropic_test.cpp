@@ -0,0 +1,132 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/anisotropic.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+
+namespace {
+
+/// @brief Deposits bits of a value to positions of set bits in a mask.
+template <typename T>
+T deposit(uint64_t value, T mask) {
+  T result = 0;
+  for (uint64_t bit = 1; mask != 0; bit <<= 1) {
+    const T lowest = static_cast<T>(mask & (~mask + 1));
+    if (value & bit) result = static_cast<T>(result | lowest);
+    mask = static_cast<T>(mask & (mask - 1));
+  }
+  return result;
+}
+
+/// @brief Checks encoding and decoding of random coordinates with a tag.
+template <typename Code, typename Tag>
+void check2d() {
+  using U = typename Code::coordinate_type;
+  std::mt19937 engine(20200401);
+  std::uniform_int_distribution<uint64_t> dist_x(0, (1ULL << Code::bits_x) - 1);
+  std::uniform_int_distribution<uint64_t> dist_y(0, (1ULL << Code::bits_y) - 1);
+  for (int i = 0; i < 1000; ++i) {
+    const typename Code::coordinates_type c(static_cast<U>(dist_x(engine)),
+                                            static_cast<U>(dist_y(engine)));
+    const auto m = Code::encode(c, Tag{});
+    EXPECT_EQ(m.value, deposit(c.x, Code::mask_x) | deposit(c.y, Code::mask_y));
+    const auto d = Code::decode(m, Tag{});
+    EXPECT_EQ(d.x, c.x);
+    EXPECT_EQ(d.y, c.y);
+  }
+}
+
+/// @brief Checks encoding and decoding of random coordinates with a tag.
+template <typename Code, typename Tag>
+void check3d() {
+  using U = typename Code::coordinate_type;
+  std::mt19937 engine(20200401);
+  std::uniform_int_distribution<uint64_t> dist_x(0, (1ULL << Code::bits_x) - 1);
+  std::uniform_int_distribution<uint64_t> dist_y(0, (1ULL << Code::bits_y) - 1);
+  std::uniform_int_distribution<uint64_t> dist_z(0, (1ULL << Code::bits_z) - 1);
+  for (int i = 0; i < 1000; ++i) {
+    const typename Code::coordinates_type c(static_cast<U>(dist_x(engine)),
+                                            static_cast<U>(dist_y(engine)),
+                                            static_cast<U>(dist_z(engine)));
+    const auto m = Code::encode(c, Tag{});
+    EXPECT_EQ(m.value, deposit(c.x, Code::mask_x) |
+                           deposit(c.y, Code::mask_y) |
+                           deposit(c.z, Code::mask_z));
+    const auto d = Code::decode(m, Tag{});
+    EXPECT_EQ(d.x, c.x);
+    EXPECT_EQ(d.y, c.y);
+    EXPECT_EQ(d.z, c.z);
+  }
+}
+
+}  // namespace
+
+TEST(Morton2dAnisotropicTest, Masks) {
+  using namespace morton2d;
+  using square = anisotropic<uint32_t, 16, 16>;
+  EXPECT_EQ(square::mask_x, 0x55555555u);
+  EXPECT_EQ(square::mask_y, 0xAAAAAAAAu);
+  using wide = anisotropic<uint32_t, 20, 12>;
+  EXPECT_EQ(wide::mask_x, 0xFF555555u);
+  EXPECT_EQ(wide::mask_y, 0x00AAAAAAu);
+  using tall = anisotropic<uint64_t, 4, 8>;
+  EXPECT_EQ(tall::mask_x, 0x55u);
+  EXPECT_EQ(tall::mask_y, 0xFAAu);
+}
+
+TEST(Morton2dAnisotropicTest, SameAsUniformCodes) {
+  using namespace morton2d;
+  using code = anisotropic<uint32_t, 16, 16>;
+  const coordinates16_t c(12345, 54321);
+  EXPECT_EQ(code::encode(c), encode(c));
+  EXPECT_EQ(code::decode(encode(c)).x, c.x);
+}
+
+TEST(Morton2dAnisotropicTest, EncodingAndDecoding) {
+  using namespace morton2d;
+  check2d<anisotropic<uint32_t, 20, 12>, tag::magic_bits>();
+  check2d<anisotropic<uint32_t, 20, 12>, tag::bmi>();
+  check2d<anisotropic<uint32_t, 5, 27>, tag::magic_bits>();
+  check2d<anisotropic<uint64_t, 32, 24>, tag::magic_bits>();
+  check2d<anisotropic<uint64_t, 32, 24>, tag::bmi>();
+  check2d<anisotropic<uint64_t, 3, 30>, tag::lookup_table>();
+  check2d<anisotropic<uint32_t, 20, 12>, tag::nibble_shuffle>();
+  check2d<anisotropic<uint32_t, 20, 12>, tag::tuned>();
+  check2d<anisotropic<uint64_t, 32, 24>, tag::tuned>();
+}
+
+TEST(Morton3dAnisotropicTest, Masks) {
+  using namespace morton3d;
+  using terrain = anisotropic<uint32_t, 12, 12, 8>;
+  // 8 levels of xyz followed by 4 levels of xy
+  EXPECT_EQ(terrain::mask_x, 0x55249249u);
+  EXPECT_EQ(terrain::mask_y, 0xAA492492u);
+  EXPECT_EQ(terrain::mask_z, 0x00924924u);
+  EXPECT_EQ(terrain::mask_x | terrain::mask_y | terrain::mask_z, 0xFFFFFFFFu);
+}
+
+TEST(Morton3dAnisotropicTest, SameAsUniformCodes) {
+  using namespace morton3d;
+  const coordinates16_t c16(1000, 523, 17);
+  EXPECT_EQ((anisotropic<uint32_t, 10, 10, 10>::encode(c16)), encode(c16));
+  const coordinates32_t c32(2000000, 52300, 1700000);
+  EXPECT_EQ((anisotropic<uint64_t, 21, 21, 21>::encode(c32)), encode(c32));
+}
+
+TEST(Morton3dAnisotropicTest, EncodingAndDecoding) {
+  using namespace morton3d;
+  check3d<anisotropic<uint32_t, 12, 12, 8>, tag::magic_bits>();
+  check3d<anisotropic<uint32_t, 12, 12, 8>, tag::bmi>();
+  check3d<anisotropic<uint32_t, 4, 16, 9>, tag::magic_bits>();
+  check3d<anisotropic<uint64_t, 24, 24, 16>, tag::magic_bits>();
+  check3d<anisotropic<uint64_t, 24, 24, 16>, tag::bmi>();
+  check3d<anisotropic<uint64_t, 1, 30, 32>, tag::preshifted_lookup_table>();
+  check3d<anisotropic<uint32_t, 12, 12, 8>, tag::nibble_shuffle>();
+  check3d<anisotropic<uint32_t, 12, 12, 8>, tag::tuned>();
+  check3d<anisotropic<uint64_t, 24, 24, 16>, tag::tuned>();
+}
@@ -0,0 +1,111 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/box_count.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// @brief Counts points inside a box by brute force.
+template <typename Points, typename Box>
+std::size_t CountInside(const Points& points, const Box& b) {
+  std::size_t n = 0;
+  for (auto&& p : points) n += b.contains(p) ? 1 : 0;
+  return n;
+}
+
+/// @brief Draws the lower and upper bounds of a random range.
+template <typename Distribution>
+std::pair<typename Distribution::result_type,
+          typename Distribution::result_type>
+RandomRange(Distribution& dist, std::mt19937& engine) {
+  const auto a = dist(engine);
+  const auto b = dist(engine);
+  return std::make_pair(std::min(a, b), std::max(a, b));
+}
+
+}  // namespace
+
+TEST(BoxCount2dTest, MatchesBruteForce) {
+  using morton2d::box;
+  using morton2d::coordinates16_t;
+  std::mt19937 engine(7);
+  std::uniform_int_distribution<uint16_t> dist(0, 1023);
+  std::vector<coordinates16_t> points;
+  std::vector<morton2d::morton_code32_t> codes;
+  for (int i = 0; i < 20000; ++i) {
+    points.push_back(coordinates16_t{dist(engine), dist(engine)});
+    codes.push_back(morton2d::encode(points.back()));
+  }
+  std::sort(codes.begin(), codes.end());
+
+  std::vector<box<uint16_t>> boxes = {
+      {coordinates16_t{0, 0}, coordinates16_t{65535, 65535}},
+      {coordinates16_t{5, 5}, coordinates16_t{5, 5}},
+      {coordinates16_t{1024, 0}, coordinates16_t{2000, 2000}}};
+  for (int i = 0; i < 200; ++i) {
+    const auto x = RandomRange(dist, engine);
+    const auto y = RandomRange(dist, engine);
+    boxes.push_back({coordinates16_t{x.first, y.first},
+                     coordinates16_t{x.second, y.second}});
+  }
+  std::vector<std::size_t> expected;
+  for (auto&& b : boxes) expected.push_back(CountInside(points, b));
+
+  for (std::size_t max_scan : {0, 1, 16, 512, 100000}) {
+    const morton2d::box_count_index<uint32_t> index(codes.data(),
+                                                    codes.size(), max_scan);
+    EXPECT_EQ(index.size(), codes.size());
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+      EXPECT_EQ(index.count(morton2d::codes_in_box(boxes[i])), expected[i])
+          << "  box " << i << ", max_scan " << max_scan;
+    }
+  }
+}
+
+TEST(BoxCount3dTest, BatchMatchesSingleQueries) {
+  using morton3d::box;
+  using morton3d::coordinates32_t;
+  std::mt19937 engine(8);
+  std::uniform_int_distribution<uint32_t> dist(0, 4095);
+  std::vector<coordinates32_t> points;
+  std::vector<morton3d::morton_code64_t> codes;
+  for (int i = 0; i < 50000; ++i) {
+    points.push_back(coordinates32_t{dist(engine), dist(engine), dist(engine)});
+    codes.push_back(morton3d::encode(points.back()));
+  }
+  std::sort(codes.begin(), codes.end());
+  const morton3d::box_count_index<uint64_t> index(codes.data(), codes.size());
+
+  std::vector<morton3d::box_range<uint64_t>> queries;
+  std::vector<std::size_t> expected;
+  for (int i = 0; i < 500; ++i) {
+    const auto x = RandomRange(dist, engine);
+    const auto y = RandomRange(dist, engine);
+    const auto z = RandomRange(dist, engine);
+    const box<uint32_t> b{coordinates32_t{x.first, y.first, z.first},
+                          coordinates32_t{x.second, y.second, z.second}};
+    queries.push_back(morton3d::codes_in_box(b));
+    expected.push_back(CountInside(points, b));
+  }
+  for (unsigned int threads : {1u, 4u}) {
+    std::vector<std::size_t> counts(queries.size());
+    index.count(queries.data(), queries.size(), counts.data(), threads);
+    EXPECT_EQ(counts, expected) << "  threads " << threads;
+  }
+}
+
+TEST(BoxCount3dTest, Empty) {
+  const morton3d::box_count_index<uint32_t> index;
+  const morton3d::box<uint16_t> b{morton3d::coordinates16_t{0, 0, 0},
+                                  morton3d::coordinates16_t{10, 10, 10}};
+  EXPECT_EQ(index.count(morton3d::codes_in_box(b)), 0u);
+}
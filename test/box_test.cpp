@@ -0,0 +1,140 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/box.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+/// @brief Enumerates codes inside a box by brute force.
+template <typename T, typename U>
+std::vector<morton2d::morton_code<T>> brute_force(const morton2d::box<U>& b) {
+  std::vector<morton2d::morton_code<T>> codes;
+  // Loop with 64 bits not to overflow at the maximum coordinate.
+  for (uint64_t y = b.lower.y; y <= b.upper.y; ++y) {
+    for (uint64_t x = b.lower.x; x <= b.upper.x; ++x) {
+      const morton2d::coordinates<U> c{static_cast<U>(x), static_cast<U>(y)};
+      codes.push_back(morton2d::encode(c));
+    }
+  }
+  std::sort(codes.begin(), codes.end());
+  return codes;
+}
+
+/// @brief Enumerates codes inside a box by brute force.
+template <typename T, typename U>
+std::vector<morton3d::morton_code<T>> brute_force(const morton3d::box<U>& b) {
+  std::vector<morton3d::morton_code<T>> codes;
+  for (U z = b.lower.z; z <= b.upper.z; ++z) {
+    for (U y = b.lower.y; y <= b.upper.y; ++y) {
+      for (U x = b.lower.x; x <= b.upper.x; ++x) {
+        codes.push_back(morton3d::encode(morton3d::coordinates<U>{x, y, z}));
+      }
+    }
+  }
+  std::sort(codes.begin(), codes.end());
+  return codes;
+}
+
+template <typename Range>
+std::vector<typename Range::value_type> collect(const Range& r) {
+  return {r.begin(), r.end()};
+}
+
+}  // namespace
+
+TEST(Morton2dBoxTest, CodesInBox32) {
+  using namespace morton2d;
+  const box<uint16_t> boxes[] = {{{0, 0}, {7, 7}},
+                                 {{3, 5}, {3, 5}},
+                                 {{1, 2}, {6, 3}},
+                                 {{5, 1}, {13, 18}},
+                                 {{0, 10}, {31, 10}},
+                                 {{9, 0}, {9, 40}},
+                                 {{100, 37}, {140, 59}},
+                                 {{65530, 65530}, {65535, 65535}}};
+  for (auto&& b : boxes) {
+    EXPECT_EQ(collect(codes_in_box(b)), (brute_force<uint32_t>(b)))
+        << "  box: " << b.lower << " - " << b.upper << '\n';
+  }
+}
+
+TEST(Morton2dBoxTest, CodesInBox64) {
+  using namespace morton2d;
+  const box<uint32_t> boxes[] = {
+      {{5, 1}, {13, 18}},
+      {{4294967290U, 4294967280U}, {4294967295U, 4294967295U}},
+      {{1000000, 2000000}, {1000020, 2000011}}};
+  for (auto&& b : boxes) {
+    EXPECT_EQ(collect(codes_in_box(b)), (brute_force<uint64_t>(b)))
+        << "  box: " << b.lower << " - " << b.upper << '\n';
+  }
+}
+
+TEST(Morton2dBoxTest, LowerBound) {
+  using namespace morton2d;
+  const box<uint16_t> b{{5, 1}, {13, 18}};
+  const auto r = codes_in_box(b);
+  const auto expected = brute_force<uint32_t>(b);
+  for (uint32_t m = 0; m < 1024; ++m) {
+    const auto it = r.lower_bound(morton_code32_t{m});
+    const auto e = std::lower_bound(expected.begin(), expected.end(),
+                                    morton_code32_t{m});
+    if (e == expected.end()) {
+      EXPECT_TRUE(it == r.end()) << "  m = " << m << '\n';
+    } else {
+      ASSERT_TRUE(it != r.end()) << "  m = " << m << '\n';
+      EXPECT_EQ(*it, *e) << "  m = " << m << '\n';
+    }
+    EXPECT_EQ(r.contains(morton_code32_t{m}),
+              b.contains(decode(morton_code32_t{m})));
+  }
+}
+
+TEST(Morton3dBoxTest, CodesInBox32) {
+  using namespace morton3d;
+  const box<uint16_t> boxes[] = {{{0, 0, 0}, {3, 3, 3}},
+                                 {{2, 3, 4}, {2, 3, 4}},
+                                 {{1, 2, 3}, {6, 3, 9}},
+                                 {{5, 1, 0}, {13, 18, 7}},
+                                 {{1000, 1010, 1020}, {1023, 1023, 1023}}};
+  for (auto&& b : boxes) {
+    EXPECT_EQ(collect(codes_in_box(b)), (brute_force<uint32_t>(b)))
+        << "  box: " << b.lower << " - " << b.upper << '\n';
+  }
+}
+
+TEST(Morton3dBoxTest, CodesInBox64) {
+  using namespace morton3d;
+  const box<uint32_t> boxes[] = {
+      {{5, 1, 0}, {13, 18, 7}},
+      {{2097140, 2097150, 2097145}, {2097151, 2097151, 2097151}},
+      {{300000, 20000, 1000}, {300010, 20004, 1003}}};
+  for (auto&& b : boxes) {
+    EXPECT_EQ(collect(codes_in_box(b)), (brute_force<uint64_t>(b)))
+        << "  box: " << b.lower << " - " << b.upper << '\n';
+  }
+}
+
+TEST(Morton3dBoxTest, LowerBound) {
+  using namespace morton3d;
+  const box<uint16_t> b{{1, 2, 3}, {6, 3, 9}};
+  const auto r = codes_in_box(b);
+  const auto expected = brute_force<uint32_t>(b);
+  for (uint32_t m = 0; m < 4096; ++m) {
+    const auto it = r.lower_bound(morton_code32_t{m});
+    const auto e = std::lower_bound(expected.begin(), expected.end(),
+                                    morton_code32_t{m});
+    if (e == expected.end()) {
+      EXPECT_TRUE(it == r.end()) << "  m = " << m << '\n';
+    } else {
+      ASSERT_TRUE(it != r.end()) << "  m = " << m << '\n';
+      EXPECT_EQ(*it, *e) << "  m = " << m << '\n';
+    }
+  }
+}
@@ -0,0 +1,158 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/cell_list.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// @brief Returns pairs of particles closer than a cutoff by brute force.
+template <unsigned int Dimension>
+std::vector<std::pair<std::size_t, std::size_t>> close_pairs(
+    const std::vector<double>& p, double cutoff) {
+  const std::size_t n = p.size() / Dimension;
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = i + 1; j < n; ++j) {
+      double d2 = 0;
+      for (unsigned int a = 0; a < Dimension; ++a) {
+        const double d = p[Dimension * i + a] - p[Dimension * j + a];
+        d2 += d * d;
+      }
+      if (d2 < cutoff * cutoff) pairs.emplace_back(i, j);
+    }
+  }
+  return pairs;
+}
+
+/// @brief Returns pairs of particles closer than a cutoff by a cell list.
+template <unsigned int Dimension, typename CellList>
+std::vector<std::pair<std::size_t, std::size_t>> close_pairs(
+    const CellList& cells, const std::vector<double>& p, double cutoff) {
+  const auto& order = cells.order();
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  for (std::size_t c = 0; c < cells.num_cells(); ++c) {
+    cells.for_each_neighbor(c, [&](std::size_t d) {
+      for (auto k = cells.begin(c); k < cells.end(c); ++k) {
+        for (auto l = cells.begin(d); l < cells.end(d); ++l) {
+          const std::size_t i = order[k], j = order[l];
+          if (i >= j) continue;
+          double d2 = 0;
+          for (unsigned int a = 0; a < Dimension; ++a) {
+            const double x = p[Dimension * i + a] - p[Dimension * j + a];
+            d2 += x * x;
+          }
+          if (d2 < cutoff * cutoff) pairs.emplace_back(i, j);
+        }
+      }
+    });
+  }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+/// @brief Checks that every particle is in its cell exactly once.
+template <typename CellList>
+void check_cells(const CellList& cells, std::size_t n) {
+  ASSERT_EQ(cells.size(), n);
+  std::vector<std::size_t> order(cells.order());
+  std::sort(order.begin(), order.end());
+  for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(order[i], i);
+  ASSERT_EQ(cells.begin(0), 0u);
+  ASSERT_EQ(cells.end(cells.num_cells() - 1), n);
+  for (std::size_t c = 0; c < cells.num_cells(); ++c) {
+    ASSERT_LT(cells.begin(c), cells.end(c));
+    if (c > 0) {
+      ASSERT_LT(cells.cell(c - 1), cells.cell(c));
+    }
+    EXPECT_EQ(cells.find(cells.cell(c)), c);
+    for (auto k = cells.begin(c); k < cells.end(c); ++k) {
+      ASSERT_EQ(cells.codes()[k], cells.cell(c));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(RadixSortTest, SortsStably) {
+  std::mt19937 engine(0);
+  for (unsigned int threads : {1u, 4u}) {
+    const std::size_t n = 200000;
+    std::vector<morton3d::morton_code64_t> codes(n), buffer(n);
+    std::vector<std::size_t> values(n), value_buffer(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      codes[i].value = engine() % 5000;
+      values[i] = i;
+    }
+    auto expected = codes;
+    std::stable_sort(expected.begin(), expected.end());
+    morton::detail::parallel_radix_sort(codes.data(), values.data(), n, 13,
+                                        buffer.data(), value_buffer.data(),
+                                        threads);
+    ASSERT_EQ(codes, expected);
+    for (std::size_t i = 1; i < n; ++i) {
+      if (codes[i] == codes[i - 1]) {
+        ASSERT_LT(values[i - 1], values[i]);
+      }
+    }
+  }
+}
+
+TEST(Morton3dCellListTest, NeighborPairs) {
+  std::mt19937 engine(1);
+  std::uniform_real_distribution<double> uniform(-3.0, 5.0);
+  std::normal_distribution<double> cluster(1.0, 0.3);
+  const std::size_t n = 3000;
+  std::vector<double> p(3 * n);
+  for (std::size_t i = 0; i < 3 * n; ++i) {
+    p[i] = i < 3 * n / 2 ? uniform(engine) : cluster(engine);
+  }
+  const double cutoff = 0.4;
+  const auto expected = close_pairs<3>(p, cutoff);
+  ASSERT_FALSE(expected.empty());
+
+  morton3d::cell_list<uint64_t> cells;
+  for (unsigned int threads : {1u, 3u}) {
+    cells.build(p.data(), n, cutoff, threads);
+    check_cells(cells, n);
+    EXPECT_EQ(close_pairs<3>(cells, p, cutoff), expected);
+  }
+  // Sparse lookup of cells in a large grid
+  morton3d::cell_list<uint32_t> sparse;
+  sparse.build(p.data(), n, 0.01);
+  EXPECT_EQ(sparse.level(), 10u);
+  check_cells(sparse, n);
+  EXPECT_EQ(close_pairs<3>(sparse, p, 0.01), close_pairs<3>(p, 0.01));
+  EXPECT_EQ(sparse.find(morton3d::morton_code32_t(0x3FFFFFFF)),
+            sparse.npos);
+}
+
+TEST(Morton2dCellListTest, NeighborPairs) {
+  std::mt19937 engine(2);
+  std::uniform_real_distribution<double> uniform(0.0, 10.0);
+  const std::size_t n = 5000;
+  std::vector<double> p(2 * n);
+  for (auto&& x : p) x = uniform(engine);
+  const double cutoff = 0.15;
+
+  morton2d::cell_list<uint32_t> cells;
+  cells.build(p.data(), n, cutoff, 2);
+  check_cells(cells, n);
+  EXPECT_EQ(cells.level(), 7u);
+  EXPECT_EQ(close_pairs<2>(cells, p, cutoff), close_pairs<2>(p, cutoff));
+
+  // Rebuild with fewer particles
+  cells.build(p.data(), 1, cutoff);
+  EXPECT_EQ(cells.num_cells(), 1u);
+  EXPECT_EQ(cells.level(), 0u);
+  int count = 0;
+  cells.for_each_neighbor(0, [&](std::size_t) { ++count; });
+  EXPECT_EQ(count, 1);
+}
@@ -0,0 +1,135 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/downsample.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// @brief Expected summary of a voxel
+struct expected_voxel {
+  std::size_t count = 0;
+  std::size_t first_index = 0;
+  uint64_t first_code = 0;
+  float first_attributes[2] = {0, 0};
+  double sums[3] = {0, 0, 0};
+  float min[2] = {1e30f, 1e30f};
+  float max[2] = {-1e30f, -1e30f};
+  double attribute_sums[2] = {0, 0};
+};
+
+}  // namespace
+
+TEST(VoxelDownsampler3dTest, ChunksMatchMapOfVoxels) {
+  std::mt19937 engine(3);
+  std::uniform_int_distribution<uint32_t> dist(0, 5000);
+  std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+  std::vector<morton3d::morton_code64_t> codes;
+  for (int i = 0; i < 20000; ++i) {
+    codes.push_back(morton3d::encode(
+        morton3d::coordinates32_t{dist(engine), dist(engine), dist(engine)}));
+  }
+  std::sort(codes.begin(), codes.end());
+  std::vector<float> attributes(2 * codes.size());
+  for (auto&& a : attributes) a = value(engine);
+
+  const unsigned int level = 12;  // Voxels of 512^3
+  const unsigned int shift = morton3d::morton_traits<uint64_t>::bits - level;
+  std::map<uint64_t, expected_voxel> expected;
+  for (std::size_t i = 0; i < codes.size(); ++i) {
+    const auto c = morton3d::decode(codes[i]);
+    auto& v = expected[codes[i].value >> (3 * shift)];
+    if (v.count++ == 0) {
+      v.first_index = i;
+      v.first_code = codes[i].value;
+      v.first_attributes[0] = attributes[2 * i];
+      v.first_attributes[1] = attributes[2 * i + 1];
+    }
+    v.sums[0] += c.x;
+    v.sums[1] += c.y;
+    v.sums[2] += c.z;
+    for (int a = 0; a < 2; ++a) {
+      v.min[a] = std::min(v.min[a], attributes[2 * i + a]);
+      v.max[a] = std::max(v.max[a], attributes[2 * i + a]);
+      v.attribute_sums[a] += attributes[2 * i + a];
+    }
+  }
+
+  for (std::size_t chunk : {1, 7, 1000, 100000}) {
+    morton3d::voxel_downsampler<uint64_t> d(level, 2);
+    auto it = expected.begin();
+    std::size_t num_voxels = 0;
+    const auto check = [&](const morton3d::voxel_summary<uint64_t>& v) {
+      ASSERT_NE(it, expected.end());
+      EXPECT_EQ(v.cell.value, it->first);
+      EXPECT_EQ(v.count, it->second.count);
+      EXPECT_EQ(v.first_index, it->second.first_index);
+      EXPECT_EQ(v.first_code.value, it->second.first_code);
+      for (int a = 0; a < 3; ++a) {
+        EXPECT_DOUBLE_EQ(v.centroid[a], it->second.sums[a] / v.count);
+      }
+      for (int a = 0; a < 2; ++a) {
+        EXPECT_EQ(v.first_attributes[a], it->second.first_attributes[a]);
+        EXPECT_EQ(v.min[a], it->second.min[a]);
+        EXPECT_EQ(v.max[a], it->second.max[a]);
+        const double mean = it->second.attribute_sums[a] / v.count;
+        EXPECT_FLOAT_EQ(v.mean[a], static_cast<float>(mean));
+      }
+      ++it;
+      ++num_voxels;
+    };
+    // Chunks are copied to a buffer overwritten by the next chunk, so that
+    // voxels must not refer to points of earlier chunks.
+    std::vector<morton3d::morton_code64_t> chunk_codes;
+    std::vector<float> chunk_attributes;
+    for (std::size_t i = 0; i < codes.size(); i += chunk) {
+      const std::size_t n = std::min(chunk, codes.size() - i);
+      chunk_codes.assign(codes.begin() + i, codes.begin() + i + n);
+      chunk_attributes.assign(attributes.begin() + 2 * i,
+                              attributes.begin() + 2 * (i + n));
+      d.push(chunk_codes.data(), chunk_attributes.data(), n, check);
+      std::fill(chunk_codes.begin(), chunk_codes.end(),
+                morton3d::morton_code64_t{0});
+      std::fill(chunk_attributes.begin(), chunk_attributes.end(), 0.0f);
+    }
+    d.flush(check);
+    EXPECT_EQ(num_voxels, expected.size()) << "  chunk " << chunk;
+    EXPECT_EQ(d.num_points(), codes.size());
+  }
+}
+
+TEST(VoxelDownsampler2dTest, WithoutAttributes) {
+  using morton2d::coordinates16_t;
+  const std::vector<morton2d::morton_code32_t> codes = {
+      morton2d::encode(coordinates16_t{0, 0}),
+      morton2d::encode(coordinates16_t{1, 3}),
+      morton2d::encode(coordinates16_t{6, 2}),
+      morton2d::encode(coordinates16_t{5, 7})};
+  // Cells of 4 x 4
+  morton2d::voxel_downsampler<uint32_t> d(14);
+  std::vector<morton2d::voxel_summary<uint32_t>> voxels;
+  const auto collect = [&](const morton2d::voxel_summary<uint32_t>& v) {
+    voxels.push_back(v);
+  };
+  d.push(codes.data(), nullptr, codes.size(), collect);
+  d.flush(collect);
+  ASSERT_EQ(voxels.size(), 3u);
+  EXPECT_EQ(voxels[0].count, 2u);
+  EXPECT_DOUBLE_EQ(voxels[0].centroid[0], 0.5);
+  EXPECT_DOUBLE_EQ(voxels[0].centroid[1], 1.5);
+  EXPECT_EQ(voxels[1].cell.value, 1u);  // (1, 0)
+  EXPECT_EQ(voxels[2].cell.value, 3u);  // (1, 1)
+  EXPECT_EQ(voxels[2].first_index, 3u);
+  EXPECT_EQ(voxels[2].first_code, codes[3]);
+  // Flushing twice does nothing.
+  d.flush(collect);
+  EXPECT_EQ(voxels.size(), 3u);
+}
@@ -0,0 +1,140 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/geo.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// @brief Returns the tile of a point by the formulas of web maps.
+morton2d::tile reference_tile(double lat, double lon, unsigned int zoom) {
+  const double n = std::ldexp(1.0, static_cast<int>(zoom));
+  const double r = lat * 3.14159265358979323846 / 180.0;
+  const double x = (lon + 180.0) / 360.0 * n;
+  const double y =
+      (1.0 - std::log(std::tan(r) + 1.0 / std::cos(r)) /
+                 3.14159265358979323846) /
+      2.0 * n;
+  return {zoom, static_cast<uint32_t>(x), static_cast<uint32_t>(y)};
+}
+
+}  // namespace
+
+TEST(GeoTest, WebMercatorTiles) {
+  using namespace morton2d;
+  // Tokyo Tower
+  const lat_lon p{35.658581, 139.745433};
+  const auto m = encode_web_mercator(p);
+  EXPECT_EQ(to_tile(m, 0), (tile{0, 0, 0}));
+  EXPECT_EQ(to_tile(m, 1), (tile{1, 1, 0}));
+  for (unsigned int z = 0; z <= 22; ++z) {
+    EXPECT_EQ(to_tile(m, z), reference_tile(p.lat, p.lon, z));
+  }
+  EXPECT_EQ(to_quadkey(m, 4), "1330");
+
+  const auto c = decode_web_mercator(m);
+  EXPECT_NEAR(c.lat, p.lat, 1e-7);
+  EXPECT_NEAR(c.lon, p.lon, 1e-7);
+
+  // Latitudes are clamped into the first and last rows.
+  const auto north = decode(encode_web_mercator(lat_lon{90.0, 0.0}));
+  EXPECT_EQ(north.y, 0u);
+  const auto south = decode(encode_web_mercator(lat_lon{-89.0, 0.0}));
+  EXPECT_EQ(south.y, 0xFFFFFFFFu);
+}
+
+TEST(GeoTest, LatLon) {
+  using namespace morton2d;
+  EXPECT_EQ(decode(encode_lat_lon(lat_lon{90.0, -180.0})),
+            (coordinates32_t{0, 0}));
+  EXPECT_EQ(decode(encode_lat_lon(lat_lon{-90.0, 180.0})),
+            (coordinates32_t{0xFFFFFFFF, 0xFFFFFFFF}));
+  EXPECT_EQ(decode(encode_lat_lon(lat_lon{0.0, 0.0})),
+            (coordinates32_t{0x80000000, 0x80000000}));
+  EXPECT_EQ(decode(encode_lat_lon(lat_lon{std::nan(""), 0.0})).y, 0u);
+
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<double> lat(-90, 90), lon(-180, 180);
+  for (int i = 0; i < 1000; ++i) {
+    const lat_lon p{lat(engine), lon(engine)};
+    const auto c = decode_lat_lon(encode_lat_lon(p));
+    EXPECT_NEAR(c.lat, p.lat, 180.0 / 4294967296.0);
+    EXPECT_NEAR(c.lon, p.lon, 360.0 / 4294967296.0);
+  }
+}
+
+TEST(GeoTest, Batch) {
+  using namespace morton2d;
+  std::mt19937 engine(1);
+  std::uniform_real_distribution<double> lat(-85, 85), lon(-180, 180);
+  std::vector<lat_lon> points(1000);
+  for (auto&& p : points) p = {lat(engine), lon(engine)};
+  std::vector<morton_code64_t> codes(points.size());
+  std::vector<lat_lon> centers(points.size());
+
+  encode_web_mercator(points.data(), points.size(), codes.data());
+  decode_web_mercator(codes.data(), codes.size(), centers.data());
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(codes[i], encode_web_mercator(points[i]));
+    EXPECT_EQ(centers[i].lat, decode_web_mercator(codes[i]).lat);
+    EXPECT_EQ(centers[i].lon, decode_web_mercator(codes[i]).lon);
+  }
+
+  encode_lat_lon(points.data(), points.size(), codes.data());
+  decode_lat_lon(codes.data(), codes.size(), centers.data());
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(codes[i], encode_lat_lon(points[i]));
+    EXPECT_EQ(centers[i].lat, decode_lat_lon(codes[i]).lat);
+    EXPECT_EQ(centers[i].lon, decode_lat_lon(codes[i]).lon);
+  }
+}
+
+TEST(GeoTest, Quadkey) {
+  using namespace morton2d;
+  // Example of Bing Maps tile system
+  const tile t{3, 3, 5};
+  EXPECT_EQ(to_quadkey(t), "213");
+  tile parsed{};
+  EXPECT_TRUE(parse_quadkey("213", parsed));
+  EXPECT_EQ(parsed, t);
+
+  morton_code64_t m;
+  unsigned int zoom;
+  EXPECT_TRUE(parse_quadkey("213", m, zoom));
+  EXPECT_EQ(zoom, 3u);
+  EXPECT_EQ(m, first_code(t));
+  EXPECT_TRUE(parse_quadkey("", parsed));
+  EXPECT_EQ(parsed, (tile{0, 0, 0}));
+
+  EXPECT_FALSE(parse_quadkey("214", parsed));
+  EXPECT_FALSE(parse_quadkey("21a", parsed));
+  EXPECT_FALSE(parse_quadkey(std::string(33, '0'), parsed));
+  EXPECT_EQ(parsed, (tile{0, 0, 0}));
+
+  const std::string key = "0123012301230123012301230123";
+  EXPECT_TRUE(parse_quadkey(key, parsed));
+  EXPECT_EQ(to_quadkey(parsed), key);
+}
+
+TEST(GeoTest, TileRange) {
+  using namespace morton2d;
+  const tile t{10, 909, 403};
+  const auto first = first_code(t);
+  const auto last = last_code(t);
+  EXPECT_EQ(to_tile(first, 10), t);
+  EXPECT_EQ(to_tile(last, 10), t);
+  EXPECT_NE(to_tile(morton_code64_t(last.value + 1), 10), t);
+  EXPECT_NE(to_tile(morton_code64_t(first.value - 1), 10), t);
+  EXPECT_EQ(first_code(tile{0, 0, 0}).value, 0u);
+  EXPECT_EQ(last_code(tile{0, 0, 0}).value, ~uint64_t(0));
+  const tile leaf{max_zoom, 12345, 67890};
+  EXPECT_EQ(first_code(leaf), last_code(leaf));
+  EXPECT_EQ(to_tile(first_code(leaf), max_zoom), leaf);
+}
@@ -0,0 +1,208 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/grid.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(DilatedArithmeticTest, IncrementAndDecrement) {
+  using namespace morton::detail;
+  const std::size_t mask = 0x2d;  // 0b101101
+  std::size_t d = 0;
+  for (int i = 0; i < 15; ++i) {
+    const std::size_t next = dilated_increment(d, mask);
+    EXPECT_GT(next, d);
+    EXPECT_EQ(next & ~mask, 0u);
+    EXPECT_EQ(dilated_decrement(next, mask), d);
+    d = next;
+  }
+  EXPECT_EQ(d, mask);
+  EXPECT_EQ(dilated_increment(mask, mask), 0u);
+  EXPECT_EQ(dilated_add(0x01, 0x04, mask), 0x05u);
+  EXPECT_EQ(dilated_add(0x05, 0x05, mask), 0x0cu);
+}
+
+namespace {
+
+/// @brief Element counting live instances, whose copies throw after a number
+/// of copies.
+struct counted {
+  static int live;
+  static int copies_left;
+
+  counted() { ++live; }
+  counted(const counted&) {
+    if (copies_left-- == 0) throw std::runtime_error("copy");
+    ++live;
+  }
+  ~counted() { --live; }
+};
+
+int counted::live = 0;
+int counted::copies_left = 0;
+
+}  // namespace
+
+TEST(AlignedBufferTest, ThrowingCopyDestroysCopies) {
+  using buffer = morton::detail::aligned_buffer<counted, 64>;
+  {
+    const buffer b(10);
+    EXPECT_EQ(counted::live, 10);
+    counted::copies_left = 4;
+    EXPECT_THROW(buffer{b}, std::runtime_error);
+    EXPECT_EQ(counted::live, 10);
+    counted::copies_left = 10;
+    const buffer copied(b);
+    EXPECT_EQ(copied.size(), 10u);
+    EXPECT_EQ(counted::live, 20);
+  }
+  EXPECT_EQ(counted::live, 0);
+}
+
+TEST(Morton2dGridTest, Access) {
+  morton2d::grid<int> g(5, 7);
+  EXPECT_EQ(g.size(), 35u);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(g.data()) % 64, 0u);
+  for (std::size_t y = 0; y < 7; ++y) {
+    for (std::size_t x = 0; x < 5; ++x) {
+      g(x, y) = static_cast<int>(y * 10 + x);
+    }
+  }
+  for (std::size_t y = 0; y < 7; ++y) {
+    for (std::size_t x = 0; x < 5; ++x) {
+      EXPECT_EQ(g.data()[g.layout().index(x, y)], static_cast<int>(y * 10 + x));
+    }
+  }
+}
+
+TEST(Morton2dGridTest, Iterators) {
+  const std::size_t extents[][2] = {{1, 1}, {4, 4}, {5, 7}, {16, 3}, {3, 16}};
+  for (auto&& e : extents) {
+    morton2d::grid<int> g(e[0], e[1]);
+    for (std::size_t y = 0; y < e[1]; ++y) {
+      for (std::size_t x = 0; x < e[0]; ++x) {
+        g(x, y) = static_cast<int>(y * e[0] + x);
+      }
+    }
+
+    // Every element is visited once in increasing order of indices.
+    std::vector<bool> visited(g.size(), false);
+    std::size_t count = 0;
+    std::size_t prev = 0;
+    const auto& cg = g;
+    for (auto it = cg.begin(); it != cg.end(); ++it) {
+      if (count > 0) {
+        EXPECT_GT(it.index(), prev);
+      }
+      prev = it.index();
+      const auto c = g.layout().coordinates_of(it.index());
+      EXPECT_EQ(*it, static_cast<int>(c.y * e[0] + c.x));
+      ASSERT_LT(static_cast<std::size_t>(*it), g.size());
+      EXPECT_FALSE(visited[*it]);
+      visited[*it] = true;
+      ++count;
+    }
+    EXPECT_EQ(count, g.size());
+
+    for (std::size_t y = 0; y < e[1]; ++y) {
+      int x = 0;
+      for (auto&& v : g.row(y)) {
+        EXPECT_EQ(v, static_cast<int>(y * e[0]) + x);
+        ++x;
+      }
+      EXPECT_EQ(static_cast<std::size_t>(x), e[0]);
+    }
+  }
+}
+
+TEST(Morton2dGridTest, RowMajor) {
+  std::vector<uint16_t> src(30 * 20);
+  for (std::size_t i = 0; i < src.size(); ++i) {
+    src[i] = static_cast<uint16_t>(i);
+  }
+  morton2d::grid<uint16_t> g(30, 20);
+  g.assign_row_major(src.data());
+  EXPECT_EQ(g(13, 11), src[11 * 30 + 13]);
+  std::vector<uint16_t> dst(src.size());
+  g.copy_row_major(dst.data());
+  EXPECT_EQ(dst, src);
+}
+
+TEST(Morton2dGridTest, CopyAndMove) {
+  morton2d::grid<std::string> g(3, 2, "a");
+  g(2, 1) = "b";
+  auto copied = g;
+  EXPECT_EQ(copied(2, 1), "b");
+  EXPECT_EQ(copied(0, 0), "a");
+  copied(0, 0) = "c";
+  EXPECT_EQ(g(0, 0), "a");
+  const auto moved = std::move(copied);
+  EXPECT_EQ(moved(0, 0), "c");
+  EXPECT_EQ(moved.width(), 3u);
+}
+
+TEST(Morton3dGridTest, Iterators) {
+  const std::size_t extents[][3] = {
+      {1, 1, 1}, {4, 4, 4}, {5, 7, 3},
+      {16, 3, 2}, {2, 9, 17}, {33, 2, 65}};
+  for (auto&& e : extents) {
+    morton3d::grid<int> g(e[0], e[1], e[2]);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(g.data()) % 64, 0u);
+    for (std::size_t z = 0; z < e[2]; ++z) {
+      for (std::size_t y = 0; y < e[1]; ++y) {
+        for (std::size_t x = 0; x < e[0]; ++x) {
+          g(x, y, z) = static_cast<int>((z * e[1] + y) * e[0] + x);
+        }
+      }
+    }
+
+    std::vector<bool> visited(g.size(), false);
+    std::size_t count = 0;
+    std::size_t last = 0;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+      const auto v = *it;
+      ASSERT_LT(static_cast<std::size_t>(v), g.size());
+      EXPECT_FALSE(visited[v]);
+      visited[v] = true;
+      if (count > 0) {
+        EXPECT_GT(it.index(), last);
+      }
+      last = it.index();
+      ++count;
+    }
+    EXPECT_EQ(count, g.size());
+
+    for (std::size_t z = 0; z < e[2]; ++z) {
+      for (std::size_t y = 0; y < e[1]; ++y) {
+        int x = 0;
+        for (auto&& v : g.row(y, z)) {
+          EXPECT_EQ(v, static_cast<int>((z * e[1] + y) * e[0]) + x);
+          ++x;
+        }
+        EXPECT_EQ(static_cast<std::size_t>(x), e[0]);
+      }
+
+      // A slab visits every element of a constant z in Z-order.
+      const auto slab = g.slab(z);
+      EXPECT_EQ(slab.size(), e[0] * e[1]);
+      std::size_t n = 0;
+      std::size_t prev = 0;
+      for (auto it = slab.begin(); it != slab.end(); ++it) {
+        if (n > 0) {
+          EXPECT_GT(it.index(), prev);
+        }
+        prev = it.index();
+        EXPECT_EQ(static_cast<std::size_t>(*it) / (e[0] * e[1]), z);
+        ++n;
+      }
+      EXPECT_EQ(n, e[0] * e[1]);
+    }
+  }
+}
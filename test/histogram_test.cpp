@@ -0,0 +1,139 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/histogram.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// @brief Counts codes in cells by decoding them and binning coordinates.
+template <typename Code, typename Decode>
+std::map<uint64_t, std::size_t> BinByCoordinates(const std::vector<Code>& codes,
+                                                 unsigned int shift,
+                                                 Decode decode) {
+  std::map<uint64_t, std::size_t> counts;
+  for (auto&& m : codes) ++counts[decode(m, shift)];
+  return counts;
+}
+
+/// @brief Checks a histogram against expected non-empty cells.
+template <typename Histogram>
+void ExpectCounts(const Histogram& h,
+                  const std::map<uint64_t, std::size_t>& expected) {
+  const auto bins = h.bins();
+  ASSERT_EQ(bins.size(), expected.size());
+  auto it = expected.begin();
+  for (auto&& b : bins) {
+    EXPECT_EQ(b.cell.value, it->first);
+    EXPECT_EQ(b.count, it->second);
+    EXPECT_EQ(h.count(b.cell), it->second);
+    ++it;
+  }
+}
+
+/// @brief Returns random 2D morton codes clustered near the origin.
+std::vector<morton2d::morton_code32_t> RandomCodes2d(std::size_t n) {
+  std::mt19937 engine(12345);
+  std::uniform_int_distribution<uint16_t> dist(0, 4095);
+  std::vector<morton2d::morton_code32_t> codes;
+  for (std::size_t i = 0; i < n; ++i) {
+    codes.push_back(morton2d::encode(
+        morton2d::coordinates16_t{dist(engine), dist(engine)}));
+  }
+  return codes;
+}
+
+/// @brief Cell of a 2D code by decoding its coordinates.
+struct Decode2d {
+  uint64_t operator()(morton2d::morton_code32_t m, unsigned int shift) const {
+    auto c = morton2d::decode(m);
+    const unsigned int s = shift / 2;
+    c.x = static_cast<uint16_t>(s < 16 ? c.x >> s : 0);
+    c.y = static_cast<uint16_t>(s < 16 ? c.y >> s : 0);
+    return morton2d::encode(c).value;
+  }
+};
+
+}  // namespace
+
+TEST(Histogram2dTest, DenseAndSparseMatchBinning) {
+  auto codes = RandomCodes2d(100000);
+  const unsigned int bits = morton2d::morton_traits<uint32_t>::bits;
+  for (unsigned int level : {0u, 1u, 4u, 8u, 9u, 12u, 16u}) {
+    const unsigned int shift = 2 * (bits - level);
+    const auto expected = BinByCoordinates(codes, shift, Decode2d{});
+    for (unsigned int threads : {1u, 3u, 8u}) {
+      const auto h = morton2d::occupancy(codes.data(), codes.size(), level,
+                                         threads);
+      EXPECT_EQ(h.level(), level);
+      ExpectCounts(h, expected);
+    }
+  }
+  std::sort(codes.begin(), codes.end());
+  for (unsigned int level : {0u, 1u, 4u, 8u, 9u, 12u, 16u}) {
+    const unsigned int shift = 2 * (bits - level);
+    const auto expected = BinByCoordinates(codes, shift, Decode2d{});
+    for (unsigned int threads : {1u, 3u, 8u}) {
+      ExpectCounts(morton2d::sorted_occupancy(codes.data(), codes.size(),
+                                              level, threads),
+                   expected);
+    }
+  }
+}
+
+TEST(Histogram2dTest, ChoosesDenseArrayForCoarseLevels) {
+  const auto codes = RandomCodes2d(1000);
+  const auto coarse = morton2d::occupancy(codes.data(), codes.size(), 4);
+  EXPECT_TRUE(coarse.is_dense());
+  EXPECT_EQ(coarse.dense_counts().size(), 256u);
+  const auto fine = morton2d::occupancy(codes.data(), codes.size(), 16);
+  EXPECT_FALSE(fine.is_dense());
+  EXPECT_TRUE(fine.dense_counts().empty());
+  EXPECT_EQ(fine.count(morton2d::morton_code32_t{0xFFFFFFFF}), 0u);
+}
+
+TEST(Histogram2dTest, Empty) {
+  const morton2d::morton_code32_t* codes = nullptr;
+  const auto h = morton2d::occupancy(codes, 0, 2);
+  EXPECT_EQ(h.count(morton2d::morton_code32_t{0}), 0u);
+  EXPECT_TRUE(h.bins().empty());
+  EXPECT_TRUE(morton2d::sorted_occupancy(codes, 0, 16).bins().empty());
+}
+
+TEST(Histogram3dTest, DenseAndSparseMatchBinning) {
+  std::mt19937 engine(54321);
+  std::uniform_int_distribution<uint32_t> dist(0, (1U << 21) - 1);
+  std::vector<morton3d::morton_code64_t> codes;
+  for (int i = 0; i < 200000; ++i) {
+    codes.push_back(morton3d::encode(
+        morton3d::coordinates32_t{dist(engine), dist(engine), dist(engine)}));
+  }
+  const auto decode = [](morton3d::morton_code64_t m, unsigned int shift) {
+    auto c = morton3d::decode(m);
+    const unsigned int s = shift / 3;
+    c.x >>= s;
+    c.y >>= s;
+    c.z >>= s;
+    return morton3d::encode(c).value;
+  };
+  const unsigned int bits = morton3d::morton_traits<uint64_t>::bits;
+  std::vector<morton3d::morton_code64_t> sorted = codes;
+  std::sort(sorted.begin(), sorted.end());
+  for (unsigned int level : {0u, 2u, 5u, 6u, 10u, 21u}) {
+    const unsigned int shift = 3 * (bits - level);
+    const auto expected = BinByCoordinates(codes, shift, decode);
+    ExpectCounts(morton3d::occupancy(codes.data(), codes.size(), level, 4),
+                 expected);
+    ExpectCounts(
+        morton3d::sorted_occupancy(sorted.data(), sorted.size(), level, 4),
+        expected);
+  }
+}
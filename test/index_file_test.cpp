@@ -0,0 +1,242 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/index_file.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+/// @brief Returns random sorted 3D morton codes with duplicates, which spread
+/// over many blocks of cells of directories.
+std::vector<morton3d::morton_code64_t> RandomCodes(std::size_t n) {
+  std::mt19937 engine(99);
+  std::uniform_int_distribution<uint32_t> dist(0, (1u << 21) - 1);
+  std::vector<morton3d::morton_code64_t> codes;
+  for (std::size_t i = 0; i < n; ++i) {
+    codes.push_back(morton3d::encode(
+        morton3d::coordinates32_t{dist(engine), dist(engine), dist(engine)}));
+  }
+  codes.push_back(codes.front());
+  std::sort(codes.begin(), codes.end());
+  return codes;
+}
+
+/// @brief Reads a whole file.
+std::vector<char> ReadFile(const char* path) {
+  std::vector<char> bytes;
+  std::FILE* file = std::fopen(path, "rb");
+  if (!file) return bytes;
+  char buffer[4096];
+  std::size_t n;
+  while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    bytes.insert(bytes.end(), buffer, buffer + n);
+  }
+  std::fclose(file);
+  return bytes;
+}
+
+/// @brief Writes a whole file.
+void WriteFile(const char* path, const std::vector<char>& bytes) {
+  std::FILE* file = std::fopen(path, "wb");
+  ASSERT_NE(file, nullptr);
+  std::fwrite(bytes.data(), 1, bytes.size(), file);
+  std::fclose(file);
+}
+
+/// @brief Fixture removing the index file written by a test, whose path is
+/// unique to the test and the process so that tests can run in parallel.
+class IndexFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+    path_ = ::testing::TempDir() + "morton_" + info->test_suite_name() + "_" +
+            info->name() + "_" + std::to_string(::getpid()) + ".bin";
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  /// @brief Returns the path of the index file.
+  const char* path() const { return path_.c_str(); }
+
+ private:
+  std::string path_;
+};
+
+class IndexFile3dTest : public IndexFileTest {};
+class IndexFile2dTest : public IndexFileTest {};
+
+}  // namespace
+
+TEST_F(IndexFile3dTest, QueriesMatchSearchesOnArray) {
+  const auto codes = RandomCodes(5000);
+  const std::size_t n = codes.size();
+  // Payload of the i-th code is the decimal string of i.
+  std::string payload;
+  std::vector<uint64_t> offsets{0};
+  for (std::size_t i = 0; i < n; ++i) {
+    payload += std::to_string(i);
+    offsets.push_back(payload.size());
+  }
+
+  for (unsigned int level : {0u, 1u, 4u, 10u}) {
+    ASSERT_TRUE(morton3d::write_index_file(path(), codes.data(), n,
+                                           offsets.data(), payload.data(),
+                                           level));
+    morton3d::index_view<uint64_t> view;
+    ASSERT_TRUE(view.open(path()));
+    EXPECT_TRUE(view.is_open());
+    EXPECT_EQ(view.size(), n);
+    EXPECT_EQ(view.directory_level(), level);
+    EXPECT_TRUE(std::equal(codes.begin(), codes.end(), view.codes()));
+    ASSERT_TRUE(view.has_payload());
+    for (std::size_t i : {std::size_t(0), std::size_t(123), n - 1}) {
+      const auto p = view.payload(i);
+      EXPECT_EQ(std::string(reinterpret_cast<const char*>(p.data), p.size),
+                std::to_string(i));
+    }
+
+    std::mt19937 engine(level);
+    std::uniform_int_distribution<uint64_t> dist(
+        0, codes.back().value + 1000);
+    for (int q = 0; q < 2000; ++q) {
+      const morton3d::morton_code64_t m{q % 2 ? codes[q % n].value
+                                              : dist(engine)};
+      const auto lo = std::lower_bound(codes.begin(), codes.end(), m);
+      const auto hi = std::upper_bound(codes.begin(), codes.end(), m);
+      EXPECT_EQ(view.lower_bound(m), lo - codes.begin());
+      EXPECT_EQ(view.upper_bound(m), hi - codes.begin());
+      const morton3d::morton_code64_t m2{m.value + dist(engine) % 100000};
+      const auto r = view.range(m, m2);
+      EXPECT_EQ(r.first, lo - codes.begin());
+      EXPECT_EQ(r.second,
+                std::upper_bound(codes.begin(), codes.end(), m2) -
+                    codes.begin());
+    }
+  }
+}
+
+TEST_F(IndexFile3dTest, RejectsMismatchingFiles) {
+  const auto codes = RandomCodes(100);
+  ASSERT_TRUE(
+      morton3d::write_index_file(path(), codes.data(), codes.size()));
+  {
+    morton3d::index_view<uint64_t> view;
+    ASSERT_TRUE(view.open(path()));
+    EXPECT_FALSE(view.has_payload());
+    EXPECT_EQ(view.payload(0).size, 0u);
+  }
+  // Different code type and dimension
+  morton3d::index_view<uint32_t> narrow;
+  EXPECT_FALSE(narrow.open(path()));
+  EXPECT_FALSE(narrow.is_open());
+  morton2d::index_view<uint64_t> flat;
+  EXPECT_FALSE(flat.open(path()));
+
+  // Truncated file
+  std::FILE* file = std::fopen(path(), "r+b");
+  ASSERT_NE(file, nullptr);
+  std::fseek(file, 0, SEEK_END);
+  const long size = std::ftell(file);
+  std::fclose(file);
+  std::vector<char> bytes(static_cast<std::size_t>(size));
+  file = std::fopen(path(), "rb");
+  ASSERT_EQ(std::fread(bytes.data(), 1, bytes.size(), file), bytes.size());
+  std::fclose(file);
+  file = std::fopen(path(), "wb");
+  std::fwrite(bytes.data(), 1, bytes.size() - 8, file);
+  std::fclose(file);
+  morton3d::index_view<uint64_t> truncated;
+  EXPECT_FALSE(truncated.open(path()));
+
+  EXPECT_FALSE(morton3d::index_view<uint64_t>().open("no/such/file"));
+}
+
+TEST_F(IndexFile3dTest, RejectsCorruptSections) {
+  // Codes spread over many cells of the directory
+  std::vector<morton3d::morton_code64_t> codes;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    codes.push_back(morton3d::morton_code64_t{i << 50});
+  }
+  const std::size_t n = codes.size();
+  std::string payload(2 * n, 'x');
+  std::vector<uint64_t> offsets;
+  for (std::size_t i = 0; i <= n; ++i) offsets.push_back(2 * i);
+  ASSERT_TRUE(morton3d::write_index_file(path(), codes.data(), n,
+                                         offsets.data(), payload.data(), 4));
+  const std::vector<char> original = ReadFile(path());
+  ASSERT_GT(original.size(), sizeof(morton::detail::index_file_header));
+  morton::detail::index_file_header h;
+  std::memcpy(&h, original.data(), sizeof(h));
+  ASSERT_GT(h.num_cells, 2u);
+
+  // Cells of two codes take two bytes, or one at the beginning of a block.
+  using block = morton::detail::index_directory_block;
+  const uint64_t num_blocks = morton::detail::num_directory_blocks(h.num_cells);
+  ASSERT_EQ(num_blocks, 8u);
+  EXPECT_EQ(h.directory_deltas_size, 2 * h.num_cells - num_blocks);
+
+  // Replaces bytes at an offset of the file.
+  const auto corrupt = [&](uint64_t offset, const void* value,
+                           std::size_t size) {
+    std::vector<char> bytes = original;
+    std::memcpy(bytes.data() + offset, value, size);
+    WriteFile(path(), bytes);
+    morton3d::index_view<uint64_t> view;
+    return view.open(path());
+  };
+  const auto corrupt64 = [&](uint64_t offset, uint64_t value) {
+    return corrupt(offset, &value, sizeof(value));
+  };
+  const auto corrupt32 = [&](uint64_t offset, uint32_t value) {
+    return corrupt(offset, &value, sizeof(value));
+  };
+  const auto corrupt8 = [&](uint64_t offset, unsigned char value) {
+    return corrupt(offset, &value, sizeof(value));
+  };
+  const uint64_t blocks = h.directory_blocks_offset;
+  const uint64_t deltas = h.directory_deltas_offset;
+  EXPECT_TRUE(corrupt64(blocks + sizeof(block) + offsetof(block, first), 128));
+  // Blocks not sampling the cells
+  EXPECT_FALSE(corrupt64(blocks + offsetof(block, first), 1));
+  EXPECT_FALSE(corrupt64(blocks + sizeof(block) + offsetof(block, first), 2));
+  EXPECT_FALSE(
+      corrupt64(blocks + sizeof(block) + offsetof(block, position), 128));
+  EXPECT_FALSE(corrupt32(blocks + sizeof(block) + offsetof(block, key), 0));
+  // Keys beyond the level
+  EXPECT_FALSE(
+      corrupt32(blocks + 7 * sizeof(block) + offsetof(block, key), 5000));
+  // Cells without codes, with equal keys, or not covering the codes
+  EXPECT_FALSE(corrupt8(deltas, 0));
+  EXPECT_FALSE(corrupt8(deltas + 1, 0));
+  EXPECT_FALSE(corrupt8(deltas + h.directory_deltas_size - 1, 3));
+  // Truncated varint
+  EXPECT_FALSE(corrupt8(deltas + h.directory_deltas_size - 1, 0x82));
+  // Payload offsets beyond the payload or decreasing
+  const uint64_t payload_offsets = h.payload_offsets_offset;
+  EXPECT_FALSE(corrupt64(payload_offsets + n * 8, 2 * n + 1));
+  EXPECT_FALSE(corrupt64(payload_offsets + 10 * 8, uint64_t(1) << 40));
+  EXPECT_FALSE(corrupt64(payload_offsets + 10 * 8, 0));
+}
+
+TEST_F(IndexFile2dTest, EmptyIndex) {
+  const morton2d::morton_code32_t* codes = nullptr;
+  ASSERT_TRUE(morton2d::write_index_file(path(), codes, 0, nullptr,
+                                         nullptr, 8));
+  morton2d::index_view<uint32_t> view;
+  ASSERT_TRUE(view.open(path()));
+  EXPECT_EQ(view.size(), 0u);
+  EXPECT_EQ(view.lower_bound(morton2d::morton_code32_t{5}), 0u);
+}
@@ -0,0 +1,167 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/join.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// @brief Point with an identifier
+struct point {
+  morton3d::morton_code64_t code;
+  uint32_t id;
+};
+
+/// @brief Key of points
+struct point_key {
+  const morton3d::morton_code64_t& operator()(const point& p) const {
+    return p.code;
+  }
+};
+
+/// @brief Returns random points sorted by morton codes.
+std::vector<point> RandomPoints(std::size_t n, uint32_t max,
+                                std::mt19937& engine) {
+  std::uniform_int_distribution<uint32_t> dist(0, max);
+  std::vector<point> points;
+  for (std::size_t i = 0; i < n; ++i) {
+    const morton3d::coordinates32_t c{dist(engine), dist(engine),
+                                      dist(engine)};
+    points.push_back({morton3d::encode(c), static_cast<uint32_t>(i)});
+  }
+  std::sort(points.begin(), points.end(), [](const point& p, const point& q) {
+    return p.code.value < q.code.value;
+  });
+  return points;
+}
+
+/// @brief Check if two cells are the same or neighbors.
+bool Near(morton3d::morton_code64_t p, morton3d::morton_code64_t q,
+          unsigned int shift, bool neighbors) {
+  const auto c = morton3d::decode(p);
+  const auto d = morton3d::decode(q);
+  const auto near = [&](uint32_t x, uint32_t y) {
+    const int64_t dx = static_cast<int64_t>(x >> shift) - (y >> shift);
+    return neighbors ? dx >= -1 && dx <= 1 : dx == 0;
+  };
+  return near(c.x, d.x) && near(c.y, d.y) && near(c.z, d.z);
+}
+
+using pair_list = std::vector<std::pair<uint32_t, uint32_t>>;
+
+/// @brief Returns pairs in the same or neighboring cells by brute force.
+pair_list BruteForce(const std::vector<point>& a, const std::vector<point>& b,
+                     unsigned int level, bool neighbors) {
+  const unsigned int shift = morton3d::morton_traits<uint64_t>::bits - level;
+  pair_list pairs;
+  for (auto&& p : a) {
+    for (auto&& q : b) {
+      if (Near(p.code, q.code, shift, neighbors)) {
+        pairs.emplace_back(p.id, q.id);
+      }
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+}  // namespace
+
+TEST(MergeJoin3dTest, SameCellMatchesBruteForce) {
+  std::mt19937 engine(2020);
+  const auto a = RandomPoints(500, 255, engine);
+  const auto b = RandomPoints(700, 255, engine);
+  for (unsigned int level : {0u, 1u, 15u, 17u, 21u}) {
+    morton3d::span_reader<point> ra(a.data(), a.data() + a.size());
+    morton3d::span_reader<point> rb(b.data(), b.data() + b.size());
+    pair_list pairs;
+    morton3d::merge_join(
+        ra, rb, level,
+        [&](const point& p, const point& q) { pairs.emplace_back(p.id, q.id); },
+        point_key{});
+    std::sort(pairs.begin(), pairs.end());
+    EXPECT_EQ(pairs, BruteForce(a, b, level, false)) << "  level " << level;
+  }
+}
+
+TEST(MergeJoin3dTest, NeighborCellsMatchBruteForce) {
+  std::mt19937 engine(2021);
+  const auto a = RandomPoints(500, 255, engine);
+  const auto b = RandomPoints(700, 255, engine);
+  for (unsigned int level : {0u, 1u, 2u, 15u, 16u, 17u}) {
+    morton3d::span_reader<point> ra(a.data(), a.data() + a.size());
+    morton3d::span_reader<point> rb(b.data(), b.data() + b.size());
+    pair_list pairs;
+    morton3d::merge_join_neighbors(
+        ra, rb, level,
+        [&](const point& p, const point& q) { pairs.emplace_back(p.id, q.id); },
+        point_key{});
+    std::sort(pairs.begin(), pairs.end());
+    EXPECT_EQ(pairs, BruteForce(a, b, level, true)) << "  level " << level;
+  }
+}
+
+TEST(MergeJoin3dTest, FileReaders) {
+  std::mt19937 engine(2022);
+  const auto a = RandomPoints(300, 63, engine);
+  const auto b = RandomPoints(300, 63, engine);
+  std::FILE* fa = std::tmpfile();
+  std::FILE* fb = std::tmpfile();
+  ASSERT_NE(fa, nullptr);
+  ASSERT_NE(fb, nullptr);
+  std::fwrite(a.data(), sizeof(point), a.size(), fa);
+  std::fwrite(b.data(), sizeof(point), b.size(), fb);
+  std::rewind(fa);
+  std::rewind(fb);
+  // Buffers smaller than the number of items are refilled.
+  morton3d::file_reader<point> ra(fa, 7);
+  morton3d::file_reader<point> rb(fb, 64);
+  pair_list pairs;
+  morton3d::merge_join_neighbors(
+      ra, rb, 18,
+      [&](const point& p, const point& q) { pairs.emplace_back(p.id, q.id); },
+      point_key{});
+  EXPECT_FALSE(ra.error());
+  EXPECT_FALSE(rb.error());
+  std::sort(pairs.begin(), pairs.end());
+  EXPECT_EQ(pairs, BruteForce(a, b, 18, true));
+  std::fclose(fa);
+  std::fclose(fb);
+}
+
+TEST(MergeJoin2dTest, CodesWithNeighbors) {
+  using morton2d::coordinates16_t;
+  using morton2d::morton_code32_t;
+  // Cells of 4 x 4 at level 14
+  const std::vector<morton_code32_t> a = {
+      morton2d::encode(coordinates16_t{1, 1}),
+      morton2d::encode(coordinates16_t{9, 1})};
+  const std::vector<morton_code32_t> b = {
+      morton2d::encode(coordinates16_t{2, 3}),
+      morton2d::encode(coordinates16_t{5, 6}),
+      morton2d::encode(coordinates16_t{13, 13})};
+  std::vector<std::pair<uint32_t, uint32_t>> same, near;
+  const auto collect = [](std::vector<std::pair<uint32_t, uint32_t>>& out) {
+    return [&out](morton_code32_t p, morton_code32_t q) {
+      out.emplace_back(p.value, q.value);
+    };
+  };
+  morton2d::span_reader<morton_code32_t> ra(a.data(), a.data() + a.size());
+  morton2d::span_reader<morton_code32_t> rb(b.data(), b.data() + b.size());
+  morton2d::merge_join(ra, rb, 14, collect(same));
+  EXPECT_EQ(same.size(), 1u);
+  morton2d::span_reader<morton_code32_t> na(a.data(), a.data() + a.size());
+  morton2d::span_reader<morton_code32_t> nb(b.data(), b.data() + b.size());
+  morton2d::merge_join_neighbors(na, nb, 14, collect(near));
+  // (1, 1) is near (2, 3) and (5, 6), and (9, 1) is near (5, 6).
+  EXPECT_EQ(near.size(), 3u);
+}
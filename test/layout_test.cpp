@@ -0,0 +1,185 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/layout.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+namespace {
+
+/// @brief Deposits bits of a value to positions of set bits in a mask.
+std::size_t deposit(std::size_t value, std::size_t mask) {
+  std::size_t result = 0;
+  for (std::size_t bit = 1; mask != 0; bit <<= 1) {
+    const std::size_t lowest = mask & (~mask + 1);
+    if (value & bit) result |= lowest;
+    mask &= mask - 1;
+  }
+  return result;
+}
+
+/// @brief Returns bytes which differ from element to element.
+std::vector<unsigned char> make_elements(std::size_t n,
+                                         std::size_t element_size) {
+  std::vector<unsigned char> v(n * element_size);
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    v[i] = static_cast<unsigned char>(i * 7 + i / element_size);
+  }
+  return v;
+}
+
+}  // namespace
+
+TEST(Morton2dLayoutTest, IndexOfSquare) {
+  using namespace morton2d;
+  const layout l(64, 64);
+  EXPECT_EQ(l.size(), 64u * 64u);
+  for (uint32_t y = 0; y < 64; ++y) {
+    for (uint32_t x = 0; x < 64; ++x) {
+      EXPECT_EQ(l.index(x, y), encode(coordinates32_t(x, y)).value);
+    }
+  }
+}
+
+TEST(Morton2dLayoutTest, IndexOfRectangle) {
+  using namespace morton2d;
+  const std::size_t extents[][2] = {{1, 1}, {1, 9},   {13, 1},
+                                    {5, 7}, {100, 20}, {20, 100}};
+  for (auto&& e : extents) {
+    const layout l(e[0], e[1]);
+    EXPECT_EQ(l.mask_x() & l.mask_y(), 0u);
+    EXPECT_EQ(l.size(), (l.mask_x() | l.mask_y()) + 1);
+    std::set<std::size_t> indices;
+    for (std::size_t y = 0; y < e[1]; ++y) {
+      for (std::size_t x = 0; x < e[0]; ++x) {
+        const auto i = l.index(x, y);
+        EXPECT_EQ(i, deposit(x, l.mask_x()) | deposit(y, l.mask_y()));
+        EXPECT_LT(i, l.size());
+        const auto c = l.coordinates_of(i);
+        EXPECT_EQ(c.x, x);
+        EXPECT_EQ(c.y, y);
+        indices.insert(i);
+      }
+    }
+    EXPECT_EQ(indices.size(), e[0] * e[1]);
+  }
+  EXPECT_EQ(layout(100, 20).size(), 128u * 32u);
+  EXPECT_EQ(layout(0, 20).size(), 0u);
+}
+
+TEST(Morton2dLayoutTest, Swizzle) {
+  using namespace morton2d;
+  const std::size_t extents[][2] = {
+      {1, 1}, {2, 2}, {3, 5}, {64, 64}, {100, 37}, {7, 130}, {256, 4}};
+  const std::size_t sizes[] = {1, 2, 3, 4, 8, 12, 16};
+  for (auto&& e : extents) {
+    const layout l(e[0], e[1]);
+    for (auto es : sizes) {
+      const auto src = make_elements(e[0] * e[1], es);
+      std::vector<unsigned char> z(l.size() * es);
+      swizzle(src.data(), z.data(), l, es);
+      for (std::size_t y = 0; y < e[1]; ++y) {
+        for (std::size_t x = 0; x < e[0]; ++x) {
+          EXPECT_EQ(std::memcmp(&z[l.index(x, y) * es],
+                                &src[(y * e[0] + x) * es], es),
+                    0)
+              << e[0] << "x" << e[1] << " size " << es << " at " << x << ","
+              << y;
+        }
+      }
+      std::vector<unsigned char> dst(src.size());
+      unswizzle(z.data(), dst.data(), l, es);
+      EXPECT_EQ(dst, src);
+    }
+  }
+}
+
+TEST(Morton2dLayoutTest, SwizzleTyped) {
+  using namespace morton2d;
+  const layout l(40, 24);
+  std::vector<float> src(40 * 24);
+  for (std::size_t i = 0; i < src.size(); ++i) src[i] = 0.5f * i;
+  std::vector<float> z(l.size());
+  swizzle(src.data(), z.data(), l);
+  EXPECT_EQ(z[l.index(17, 9)], src[9 * 40 + 17]);
+  std::vector<float> dst(src.size());
+  unswizzle(z.data(), dst.data(), l);
+  EXPECT_EQ(dst, src);
+}
+
+TEST(Morton3dLayoutTest, IndexOfCube) {
+  using namespace morton3d;
+  const layout l(16, 16, 16);
+  EXPECT_EQ(l.size(), 16u * 16u * 16u);
+  for (uint32_t z = 0; z < 16; ++z) {
+    for (uint32_t y = 0; y < 16; ++y) {
+      for (uint32_t x = 0; x < 16; ++x) {
+        EXPECT_EQ(l.index(x, y, z), encode(coordinates32_t(x, y, z)).value);
+      }
+    }
+  }
+}
+
+TEST(Morton3dLayoutTest, IndexOfCuboid) {
+  using namespace morton3d;
+  const std::size_t extents[][3] = {{1, 1, 1},  {5, 7, 3},  {32, 8, 2},
+                                    {2, 32, 8}, {8, 2, 32}, {1, 1, 40},
+                                    {9, 9, 3},  {3, 9, 9},  {17, 4, 17}};
+  for (auto&& e : extents) {
+    const layout l(e[0], e[1], e[2]);
+    EXPECT_EQ(l.mask_x() & l.mask_y(), 0u);
+    EXPECT_EQ(l.mask_y() & l.mask_z(), 0u);
+    EXPECT_EQ(l.mask_z() & l.mask_x(), 0u);
+    EXPECT_EQ(l.size(), (l.mask_x() | l.mask_y() | l.mask_z()) + 1);
+    std::set<std::size_t> indices;
+    for (std::size_t z = 0; z < e[2]; ++z) {
+      for (std::size_t y = 0; y < e[1]; ++y) {
+        for (std::size_t x = 0; x < e[0]; ++x) {
+          const auto i = l.index(x, y, z);
+          EXPECT_EQ(i, deposit(x, l.mask_x()) | deposit(y, l.mask_y()) |
+                           deposit(z, l.mask_z()));
+          EXPECT_LT(i, l.size());
+          const auto c = l.coordinates_of(i);
+          EXPECT_EQ(c.x, x);
+          EXPECT_EQ(c.y, y);
+          EXPECT_EQ(c.z, z);
+          indices.insert(i);
+        }
+      }
+    }
+    EXPECT_EQ(indices.size(), e[0] * e[1] * e[2]);
+  }
+}
+
+TEST(Morton3dLayoutTest, Swizzle) {
+  using namespace morton3d;
+  const std::size_t extents[][3] = {
+      {1, 1, 1}, {2, 2, 2}, {3, 5, 7}, {32, 32, 32}, {33, 17, 20}, {64, 4, 2}};
+  const std::size_t sizes[] = {1, 2, 3, 4, 8, 12, 16};
+  for (auto&& e : extents) {
+    const layout l(e[0], e[1], e[2]);
+    for (auto es : sizes) {
+      const auto src = make_elements(e[0] * e[1] * e[2], es);
+      std::vector<unsigned char> t(l.size() * es);
+      swizzle(src.data(), t.data(), l, es);
+      for (std::size_t z = 0; z < e[2]; ++z) {
+        for (std::size_t y = 0; y < e[1]; ++y) {
+          for (std::size_t x = 0; x < e[0]; ++x) {
+            const auto j = (z * e[1] + y) * e[0] + x;
+            ASSERT_EQ(
+                std::memcmp(&t[l.index(x, y, z) * es], &src[j * es], es), 0)
+                << e[0] << "x" << e[1] << "x" << e[2] << " size " << es;
+          }
+        }
+      }
+      std::vector<unsigned char> dst(src.size());
+      unswizzle(t.data(), dst.data(), l, es);
+      EXPECT_EQ(dst, src);
+    }
+  }
+}
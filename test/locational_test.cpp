@@ -0,0 +1,163 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/locational.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+TEST(Morton2dLocationalTest, Levels) {
+  using morton2d::locational_code32_t;
+  using morton2d::locational_code64_t;
+  EXPECT_EQ(locational_code32_t::max_level, 15u);
+  EXPECT_EQ(locational_code64_t::max_level, 31u);
+
+  const auto root = locational_code32_t::root();
+  EXPECT_EQ(root.level(), 0u);
+  EXPECT_EQ(root.cell(), 0u);
+  auto c = root;
+  for (unsigned int l = 1; l <= locational_code32_t::max_level; ++l) {
+    const unsigned int i = l % 4;
+    const auto child = c.child(i);
+    EXPECT_EQ(child.level(), l);
+    EXPECT_EQ(child.child_index(), i);
+    EXPECT_EQ(child.parent(), c);
+    EXPECT_EQ(child.ancestor(0), root);
+    EXPECT_TRUE(c.contains(child));
+    EXPECT_TRUE(root.contains(child));
+    EXPECT_FALSE(child.contains(c));
+    EXPECT_FALSE(c.child((i + 1) % 4).contains(child));
+    c = child;
+  }
+  EXPECT_TRUE(c.contains(c));
+}
+
+TEST(Morton2dLocationalTest, MortonCodes) {
+  using namespace morton2d;
+  std::mt19937 engine(0);
+  std::uniform_int_distribution<uint32_t> dist;
+  for (int i = 0; i < 1000; ++i) {
+    const coordinates32_t p(dist(engine), dist(engine));
+    const auto m = encode(p);
+    for (unsigned int l = 0; l <= locational_code64_t::max_level; ++l) {
+      const auto c = to_locational_code(m, l);
+      ASSERT_EQ(c.level(), l);
+      EXPECT_LE(first_code(c), m);
+      EXPECT_GE(last_code(c), m);
+      const auto q = cell_coordinates(c);
+      EXPECT_EQ(q.x, l == 0 ? 0 : p.x >> (32 - l));
+      EXPECT_EQ(q.y, l == 0 ? 0 : p.y >> (32 - l));
+      EXPECT_EQ(make_locational_code(q, l), c);
+    }
+  }
+  const auto root = locational_code32_t::root();
+  EXPECT_EQ(first_code(root), morton_code32_t(0));
+  EXPECT_EQ(last_code(root), morton_code32_t(0xFFFFFFFF));
+}
+
+TEST(Morton2dLocationalTest, Neighbors) {
+  using namespace morton2d;
+  const unsigned int level = 3;
+  for (uint16_t y = 0; y < 8; ++y) {
+    for (uint16_t x = 0; x < 8; ++x) {
+      const auto c = make_locational_code(coordinates16_t(x, y), level);
+      for (int dy = -2; dy <= 2; ++dy) {
+        for (int dx = -2; dx <= 2; ++dx) {
+          auto n = c;
+          const int nx = x + dx;
+          const int ny = y + dy;
+          const bool inside = nx >= 0 && nx < 8 && ny >= 0 && ny < 8;
+          ASSERT_EQ(neighbor(c, dx, dy, n), inside);
+          if (!inside) {
+            EXPECT_EQ(n, c);
+            continue;
+          }
+          const auto q = cell_coordinates(n);
+          EXPECT_EQ(n.level(), level);
+          EXPECT_EQ(q.x, nx);
+          EXPECT_EQ(q.y, ny);
+        }
+      }
+    }
+  }
+}
+
+TEST(Morton3dLocationalTest, MortonCodes) {
+  using namespace morton3d;
+  EXPECT_EQ(locational_code32_t::max_level, 10u);
+  EXPECT_EQ(locational_code64_t::max_level, 21u);
+  std::mt19937 engine(0);
+  std::uniform_int_distribution<uint32_t> dist(0, (1u << 21) - 1);
+  for (int i = 0; i < 1000; ++i) {
+    const coordinates32_t p(dist(engine), dist(engine), dist(engine));
+    const auto m = encode(p);
+    for (unsigned int l = 0; l <= 21; ++l) {
+      const auto c = to_locational_code(m, l);
+      ASSERT_EQ(c.level(), l);
+      EXPECT_LE(first_code(c), m);
+      EXPECT_GE(last_code(c), m);
+      const auto q = cell_coordinates(c);
+      EXPECT_EQ(q, coordinates32_t(p.x >> (21 - l), p.y >> (21 - l),
+                                   p.z >> (21 - l)));
+      EXPECT_EQ(make_locational_code(q, l), c);
+    }
+    // Cells of the deepest level are the same as morton codes.
+    EXPECT_EQ(first_code(to_locational_code(m, 21)), m);
+    EXPECT_EQ(last_code(to_locational_code(m, 21)), m);
+  }
+}
+
+TEST(Morton3dLocationalTest, Neighbors) {
+  using namespace morton3d;
+  const auto c = make_locational_code(coordinates16_t(0, 3, 7), 3);
+  locational_code32_t n;
+  EXPECT_FALSE(neighbor(c, -1, 0, 0, n));
+  EXPECT_FALSE(neighbor(c, 0, 0, 1, n));
+  ASSERT_TRUE(neighbor(c, 1, -1, -7, n));
+  EXPECT_EQ(cell_coordinates(n), coordinates16_t(1, 2, 0));
+  EXPECT_EQ(n.level(), 3u);
+}
+
+TEST(Morton3dLocationalTest, DepthFirstOrder) {
+  using namespace morton3d;
+  // Cells of an adaptive octree refined at random
+  std::mt19937 engine(1);
+  std::vector<locational_code32_t> cells;
+  std::vector<locational_code32_t> stack(1, locational_code32_t::root());
+  while (!stack.empty()) {
+    const auto c = stack.back();
+    stack.pop_back();
+    cells.push_back(c);
+    if (c.level() < 2 || (c.level() < 5 && engine() % 3 == 0)) {
+      for (unsigned int i = 0; i < 8; ++i) stack.push_back(c.child(i));
+    }
+  }
+  ASSERT_GT(cells.size(), 100u);
+  std::shuffle(cells.begin(), cells.end(), engine);
+  std::sort(cells.begin(), cells.end());
+  for (std::size_t i = 0; i < cells.size(); ++i) {
+    // Descendants immediately follow a cell.
+    std::size_t j = i + 1;
+    while (j < cells.size() && cells[i].contains(cells[j])) ++j;
+    for (std::size_t k = j; k < cells.size(); ++k) {
+      ASSERT_FALSE(cells[i].contains(cells[k]));
+      // Other cells follow in Z-order.
+      ASSERT_LT(last_code(cells[i]), first_code(cells[k]));
+    }
+    if (i > 0) {
+      EXPECT_FALSE(cells[i].contains(cells[i - 1]));
+    }
+  }
+
+  // Cells with the same prefix but different levels are different keys.
+  std::unordered_set<locational_code32_t> set(cells.begin(), cells.end());
+  EXPECT_EQ(set.size(), cells.size());
+  const auto root = locational_code32_t::root();
+  EXPECT_EQ(set.count(root.child(0)), 1u);
+  EXPECT_EQ(set.count(root.child(0).child(0).child(0).child(0).child(0)), 0u);
+}
@@ -0,0 +1,98 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/lod.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+
+/// @brief Checks that every prefix of levels has a code in every non-empty
+/// cell exactly once.
+template <unsigned int Dimension, unsigned int Bits, typename Code>
+void check_levels(const std::vector<Code>& codes,
+                  const std::vector<std::size_t>& order,
+                  const std::vector<std::size_t>& ends) {
+  using T = typename Code::value_type;
+  const std::size_t n = codes.size();
+  ASSERT_EQ(ends.size(), Bits + 2);
+  ASSERT_EQ(ends.back(), n);
+  std::vector<std::size_t> sorted(order);
+  std::sort(sorted.begin(), sorted.end());
+  for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(sorted[i], i);
+
+  std::size_t first = 0;
+  for (unsigned int l = 0; l <= Bits; ++l) {
+    const unsigned int shift = Dimension * (Bits - l);
+    const auto cell = [&](T v) -> T {
+      return shift < sizeof(T) * 8 ? v >> shift : T(0);
+    };
+    std::set<T> all, prefix;
+    for (auto&& c : codes) all.insert(cell(c.value));
+    for (std::size_t k = 0; k < ends[l]; ++k) {
+      EXPECT_TRUE(prefix.insert(cell(codes[order[k]].value)).second);
+    }
+    EXPECT_EQ(prefix, all);
+    // Z-order within a level
+    for (std::size_t k = first + 1; k < ends[l]; ++k) {
+      ASSERT_LT(order[k - 1], order[k]);
+    }
+    first = ends[l];
+  }
+  // Duplicates
+  for (std::size_t k = first; k < n; ++k) {
+    EXPECT_EQ(codes[order[k]], codes[order[k] - 1]);
+  }
+}
+
+}  // namespace
+
+TEST(Morton2dLodTest, Order) {
+  std::mt19937 engine(0);
+  std::uniform_int_distribution<uint32_t> dist(0, 1000);
+  std::vector<morton2d::morton_code64_t> codes;
+  for (int i = 0; i < 20000; ++i) {
+    codes.push_back(morton2d::encode(
+        morton2d::coordinates32_t(dist(engine), dist(engine) / 8)));
+  }
+  std::sort(codes.begin(), codes.end());
+  std::vector<std::size_t> order(codes.size());
+  const auto ends =
+      morton2d::lod_order(codes.data(), codes.size(), order.data());
+  check_levels<2, 32>(codes, order, ends);
+  EXPECT_EQ(ends[0], 1u);
+  EXPECT_LT(ends.end()[-2], codes.size());  // Duplicates
+}
+
+TEST(Morton3dLodTest, Order) {
+  std::mt19937 engine(1);
+  std::uniform_int_distribution<uint32_t> dist(0, 1023);
+  std::normal_distribution<double> cluster(300, 20);
+  std::vector<morton3d::morton_code32_t> codes;
+  for (int i = 0; i < 100000; ++i) {
+    const auto x = static_cast<uint16_t>(dist(engine));
+    const auto y = static_cast<uint16_t>(dist(engine));
+    const auto z = static_cast<uint16_t>(
+        i % 2 == 0 ? dist(engine)
+                   : std::min(1023.0, std::max(0.0, cluster(engine))));
+    codes.push_back(morton3d::encode(morton3d::coordinates16_t(x, y, z)));
+  }
+  std::sort(codes.begin(), codes.end());
+  for (unsigned int threads : {1u, 4u}) {
+    std::vector<std::size_t> order(codes.size());
+    const auto ends = morton3d::lod_order(codes.data(), codes.size(),
+                                          order.data(), threads);
+    check_levels<3, 10>(codes, order, ends);
+    // All 8 octants at level 1
+    EXPECT_EQ(ends[1], 8u);
+  }
+  std::vector<std::size_t> order;
+  const auto ends = morton3d::lod_order(codes.data(), 0, order.data());
+  EXPECT_EQ(ends.back(), 0u);
+}
@@ -0,0 +1,88 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/matrix.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace {
+
+/// @brief Returns a matrix of random integers.
+morton2d::grid<double> random_matrix(std::size_t width, std::size_t height,
+                                     std::mt19937& engine) {
+  std::uniform_int_distribution<int> dist(-8, 8);
+  // Padding is not zero.
+  morton2d::grid<double> g(width, height, 1e9);
+  for (std::size_t y = 0; y < height; ++y) {
+    for (std::size_t x = 0; x < width; ++x) g(x, y) = dist(engine);
+  }
+  return g;
+}
+
+}  // namespace
+
+TEST(Morton2dMatrixTest, Transpose) {
+  std::mt19937 engine(0);
+  const std::size_t extents[][2] = {{1, 1}, {1, 9},   {7, 3},
+                                    {64, 64}, {100, 37}, {3, 130}};
+  for (auto&& e : extents) {
+    const auto a = random_matrix(e[0], e[1], engine);
+    morton2d::grid<double> b(e[1], e[0]);
+    morton2d::transpose(a, b);
+    for (std::size_t y = 0; y < e[1]; ++y) {
+      for (std::size_t x = 0; x < e[0]; ++x) {
+        ASSERT_EQ(b(y, x), a(x, y));
+      }
+    }
+  }
+}
+
+TEST(Morton2dMatrixTest, Copy) {
+  std::mt19937 engine(1);
+  const auto src = random_matrix(150, 90, engine);
+  // Aligned and unaligned blocks
+  const std::size_t blocks[][6] = {{0, 0, 150, 90, 0, 0},
+                                   {32, 64, 70, 26, 64, 32},
+                                   {3, 5, 40, 41, 60, 1},
+                                   {32, 0, 64, 64, 0, 32}};
+  for (auto&& b : blocks) {
+    morton2d::grid<double> dst(160, 100, -1.0);
+    morton2d::copy(src, b[0], b[1], b[2], b[3], dst, b[4], b[5]);
+    for (std::size_t y = 0; y < dst.height(); ++y) {
+      for (std::size_t x = 0; x < dst.width(); ++x) {
+        const bool inside = x >= b[4] && x < b[4] + b[2] && y >= b[5] &&
+                            y < b[5] + b[3];
+        ASSERT_EQ(dst(x, y),
+                  inside ? src(x - b[4] + b[0], y - b[5] + b[1]) : -1.0);
+      }
+    }
+  }
+}
+
+TEST(Morton2dMatrixTest, Multiply) {
+  std::mt19937 engine(2);
+  const std::size_t extents[][3] = {{1, 1, 1},    {5, 1, 7},    {32, 32, 32},
+                                    {37, 45, 29}, {64, 100, 3}, {130, 70, 90}};
+  for (auto&& e : extents) {
+    const std::size_t m = e[0], n = e[1], k = e[2];
+    const auto a = random_matrix(k, m, engine);
+    const auto b = random_matrix(n, k, engine);
+    auto c = random_matrix(n, m, engine);
+    const auto c0 = c;
+    morton2d::multiply_add(a, b, c);
+    for (std::size_t i = 0; i < m; ++i) {
+      for (std::size_t j = 0; j < n; ++j) {
+        double sum = c0(j, i);
+        for (std::size_t l = 0; l < k; ++l) sum += a(l, i) * b(j, l);
+        ASSERT_EQ(c(j, i), sum) << m << "x" << n << "x" << k;
+      }
+    }
+    morton2d::multiply(a, b, c);
+    double sum = 0;
+    for (std::size_t l = 0; l < k; ++l) sum += a(l, m - 1) * b(n - 1, l);
+    EXPECT_EQ(c(n - 1, m - 1), sum);
+  }
+}
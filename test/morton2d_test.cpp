@@ -7,6 +7,9 @@
 
 #include <gtest/gtest.h>
 
+#include <random>
+#include <vector>
+
 using namespace morton2d;
 
 class Morton2d32BitTest : public ::testing::Test {
@@ -57,6 +60,16 @@ TEST_F(Morton2d32BitTest, EncodingUsingMagicBits) {
   }
 }
 
+TEST_F(Morton2d32BitTest, EncodingUsingTunedTags) {
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 7; ++j) {
+      const auto m = encode(coordinates16_t{x_[j], y_[i]}, tag::tuned{});
+      EXPECT_EQ(m.value, m_[i * 8 + j])
+          << "  x = " << x_[j] << ", y = " << y_[i] << '\n';
+    }
+  }
+}
+
 #ifdef MORTON2D_USE_BMI
 TEST_F(Morton2d32BitTest, EncodingUsingBmi) {
   for (int i = 0; i < 7; ++i) {
@@ -69,6 +82,19 @@ TEST_F(Morton2d32BitTest, EncodingUsingBmi) {
 }
 #endif
 
+#ifdef MORTON2D_USE_SSSE3
+TEST_F(Morton2d32BitTest, EncodingUsingNibbleShuffle) {
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 7; ++j) {
+      const auto m =
+          encode(coordinates16_t{x_[j], y_[i]}, tag::nibble_shuffle{});
+      EXPECT_EQ(m.value, m_[i * 8 + j])
+          << "  x = " << x_[j] << ", y = " << y_[i] << '\n';
+    }
+  }
+}
+#endif
+
 TEST_F(Morton2d32BitTest, DecodingUsingPreshiftedLookupTable) {
   for (int i = 0; i < 7; ++i) {
     for (int j = 0; j < 7; ++j) {
@@ -103,6 +129,17 @@ TEST_F(Morton2d32BitTest, DecodingUsingMagicBits) {
   }
 }
 
+TEST_F(Morton2d32BitTest, DecodingUsingTunedTags) {
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 7; ++j) {
+      const auto k = i * 8 + j;
+      const auto c = decode(morton_code32_t{m_[k]}, tag::tuned{});
+      EXPECT_EQ(c.x, x_[j]) << "  m = " << m_[k] << '\n';
+      EXPECT_EQ(c.y, y_[i]) << "  m = " << m_[k] << '\n';
+    }
+  }
+}
+
 #ifdef MORTON2D_USE_BMI
 TEST_F(Morton2d32BitTest, DecodingUsingBmi) {
   for (int i = 0; i < 7; ++i) {
@@ -116,6 +153,19 @@ TEST_F(Morton2d32BitTest, DecodingUsingBmi) {
 }
 #endif
 
+#ifdef MORTON2D_USE_SSSE3
+TEST_F(Morton2d32BitTest, DecodingUsingNibbleShuffle) {
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 7; ++j) {
+      const auto k = i * 8 + j;
+      const auto c = decode(morton_code32_t{m_[k]}, tag::nibble_shuffle{});
+      EXPECT_EQ(c.x, x_[j]) << "  m = " << m_[k] << '\n';
+      EXPECT_EQ(c.y, y_[i]) << "  m = " << m_[k] << '\n';
+    }
+  }
+}
+#endif
+
 class Morton2d64BitTest : public ::testing::Test {
  protected:
   const uint32_t x_[8] = {0, 1, 2, 3, 4, 5, 6, 7};
@@ -164,6 +214,16 @@ TEST_F(Morton2d64BitTest, EncodingUsingMagicBits) {
   }
 }
 
+TEST_F(Morton2d64BitTest, EncodingUsingTunedTags) {
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 7; ++j) {
+      const auto m = encode(coordinates32_t{x_[j], y_[i]}, tag::tuned{});
+      EXPECT_EQ(m.value, m_[i * 8 + j])
+          << "  x = " << x_[j] << ", y = " << y_[i] << '\n';
+    }
+  }
+}
+
 #ifdef MORTON2D_USE_BMI
 TEST_F(Morton2d64BitTest, EncodingUsingBmi) {
   for (int i = 0; i < 7; ++i) {
@@ -176,6 +236,19 @@ TEST_F(Morton2d64BitTest, EncodingUsingBmi) {
 }
 #endif
 
+#ifdef MORTON2D_USE_SSSE3
+TEST_F(Morton2d64BitTest, EncodingUsingNibbleShuffle) {
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 7; ++j) {
+      const auto m =
+          encode(coordinates32_t{x_[j], y_[i]}, tag::nibble_shuffle{});
+      EXPECT_EQ(m.value, m_[i * 8 + j])
+          << "  x = " << x_[j] << ", y = " << y_[i] << '\n';
+    }
+  }
+}
+#endif
+
 TEST_F(Morton2d64BitTest, DecodingUsingPreshiftedLookupTable) {
   for (int i = 0; i < 7; ++i) {
     for (int j = 0; j < 7; ++j) {
@@ -210,6 +283,17 @@ TEST_F(Morton2d64BitTest, DecodingUsingMagicBits) {
   }
 }
 
+TEST_F(Morton2d64BitTest, DecodingUsingTunedTags) {
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 7; ++j) {
+      const auto k = i * 8 + j;
+      const auto c = decode(morton_code64_t{m_[k]}, tag::tuned{});
+      EXPECT_EQ(c.x, x_[j]) << "  m = " << m_[k] << '\n';
+      EXPECT_EQ(c.y, y_[i]) << "  m = " << m_[k] << '\n';
+    }
+  }
+}
+
 #ifdef MORTON2D_USE_BMI
 TEST_F(Morton2d64BitTest, DecodingUsingBmi) {
   for (int i = 0; i < 7; ++i) {
@@ -221,4 +305,88 @@ TEST_F(Morton2d64BitTest, DecodingUsingBmi) {
     }
   }
 }
-#endif
\ No newline at end of file
+#endif
+
+#ifdef MORTON2D_USE_SSSE3
+TEST_F(Morton2d64BitTest, DecodingUsingNibbleShuffle) {
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 7; ++j) {
+      const auto k = i * 8 + j;
+      const auto c = decode(morton_code64_t{m_[k]}, tag::nibble_shuffle{});
+      EXPECT_EQ(c.x, x_[j]) << "  m = " << m_[k] << '\n';
+      EXPECT_EQ(c.y, y_[i]) << "  m = " << m_[k] << '\n';
+    }
+  }
+}
+#endif
+
+// Coordinates using their most significant bits, which live in the upper
+// half of morton codes.
+TEST(Morton2dPreshiftedLookupTableTest, DecodingHighBits) {
+  const coordinates16_t c16(0xFEDC, 0x8421);
+  const auto d16 = decode(encode(c16, tag::magic_bits{}),
+                          tag::preshifted_lookup_table{});
+  EXPECT_EQ(d16.x, c16.x);
+  EXPECT_EQ(d16.y, c16.y);
+
+  const coordinates32_t c32(0xFEDCBA98, 0x84218421);
+  const auto d32 = decode(encode(c32, tag::magic_bits{}),
+                          tag::preshifted_lookup_table{});
+  EXPECT_EQ(d32.x, c32.x);
+  EXPECT_EQ(d32.y, c32.y);
+}
+
+/// @brief Checks that arrays converted with a tag match items converted one
+/// by one. The number of items is not a multiple of any vector width so that
+/// the remainder is converted too.
+template <typename Tag>
+void ExpectBatchMatchesSingleItems(Tag tag) {
+  constexpr std::size_t n = 37;
+  std::mt19937 engine(20200401);
+  std::uniform_int_distribution<uint32_t> dist;
+  std::vector<coordinates16_t> c16;
+  std::vector<coordinates32_t> c32;
+  for (std::size_t i = 0; i < n; ++i) {
+    c16.emplace_back(static_cast<uint16_t>(dist(engine)),
+                     static_cast<uint16_t>(dist(engine)));
+    c32.emplace_back(dist(engine), dist(engine));
+  }
+
+  std::vector<morton_code32_t> m32(n);
+  std::vector<morton_code64_t> m64(n);
+  encode(c16.data(), n, m32.data(), tag);
+  encode(c32.data(), n, m64.data(), tag);
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(m32[i], encode(c16[i], tag::magic_bits{})) << "  i = " << i;
+    EXPECT_EQ(m64[i], encode(c32[i], tag::magic_bits{})) << "  i = " << i;
+  }
+
+  std::vector<coordinates16_t> d16(n);
+  std::vector<coordinates32_t> d32(n);
+  decode(m32.data(), n, d16.data(), tag);
+  decode(m64.data(), n, d32.data(), tag);
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(d16[i].x, c16[i].x) << "  i = " << i;
+    EXPECT_EQ(d16[i].y, c16[i].y) << "  i = " << i;
+    EXPECT_EQ(d32[i].x, c32[i].x) << "  i = " << i;
+    EXPECT_EQ(d32[i].y, c32[i].y) << "  i = " << i;
+  }
+}
+
+TEST(Morton2dBatchTest, PreshiftedLookupTable) {
+  ExpectBatchMatchesSingleItems(tag::preshifted_lookup_table{});
+}
+
+TEST(Morton2dBatchTest, MagicBits) {
+  ExpectBatchMatchesSingleItems(tag::magic_bits{});
+}
+
+TEST(Morton2dBatchTest, TunedTags) {
+  ExpectBatchMatchesSingleItems(tag::tuned{});
+}
+
+#ifdef MORTON2D_USE_SSSE3
+TEST(Morton2dBatchTest, NibbleShuffle) {
+  ExpectBatchMatchesSingleItems(tag::nibble_shuffle{});
+}
+#endif
@@ -8,6 +8,8 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <random>
+#include <vector>
 
 using namespace morton3d;
 
@@ -87,6 +89,20 @@ TEST_F(Morton3d32BitTest, EncodingUsingMagicBits) {
   }
 }
 
+TEST_F(Morton3d32BitTest, EncodingUsingTunedTags) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 4; ++k) {
+        const auto m =
+            encode(coordinates32_t{x_[k], y_[j], z_[i]}, tag::tuned{});
+        EXPECT_EQ(m.value, m_[(i * 4 + j) * 4 + k])
+            << "  x = " << x_[k] << ", y = " << y_[j] << ", z = " << z_[i]
+            << '\n';
+      }
+    }
+  }
+}
+
 #ifdef MORTON3D_USE_BMI
 TEST_F(Morton3d32BitTest, EncodingUsingBmi) {
   for (int i = 0; i < 4; ++i) {
@@ -103,6 +119,22 @@ TEST_F(Morton3d32BitTest, EncodingUsingBmi) {
 }
 #endif
 
+#ifdef MORTON3D_USE_SSSE3
+TEST_F(Morton3d32BitTest, EncodingUsingNibbleShuffle) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 4; ++k) {
+        const auto m =
+            encode(coordinates32_t{x_[k], y_[j], z_[i]}, tag::nibble_shuffle{});
+        EXPECT_EQ(m.value, m_[(i * 4 + j) * 4 + k])
+            << "  x = " << x_[k] << ", y = " << y_[j] << ", z = " << z_[i]
+            << '\n';
+      }
+    }
+  }
+}
+#endif
+
 TEST_F(Morton3d32BitTest, DecodingUsingPreshiftedLookupTable) {
   for (int i = 0; i < 4; ++i) {
     for (int j = 0; j < 4; ++j) {
@@ -146,6 +178,20 @@ TEST_F(Morton3d32BitTest, DecodingUsingMagicBits) {
   }
 }
 
+TEST_F(Morton3d32BitTest, DecodingUsingTunedTags) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 4; ++k) {
+        const auto l = (i * 4 + j) * 4 + k;
+        const auto c = decode(morton_code32_t{m_[l]}, tag::tuned{});
+        EXPECT_EQ(c.x, x_[k]) << "  m = " << m_[l] << '\n';
+        EXPECT_EQ(c.y, y_[j]) << "  m = " << m_[l] << '\n';
+        EXPECT_EQ(c.z, z_[i]) << "  m = " << m_[l] << '\n';
+      }
+    }
+  }
+}
+
 #ifdef MORTON3D_USE_BMI
 TEST_F(Morton3d32BitTest, DecodingUsingBmi) {
   for (int i = 0; i < 4; ++i) {
@@ -162,6 +208,22 @@ TEST_F(Morton3d32BitTest, DecodingUsingBmi) {
 }
 #endif
 
+#ifdef MORTON3D_USE_SSSE3
+TEST_F(Morton3d32BitTest, DecodingUsingNibbleShuffle) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 4; ++k) {
+        const auto l = (i * 4 + j) * 4 + k;
+        const auto c = decode(morton_code32_t{m_[l]}, tag::nibble_shuffle{});
+        EXPECT_EQ(c.x, x_[k]) << "  m = " << m_[l] << '\n';
+        EXPECT_EQ(c.y, y_[j]) << "  m = " << m_[l] << '\n';
+        EXPECT_EQ(c.z, z_[i]) << "  m = " << m_[l] << '\n';
+      }
+    }
+  }
+}
+#endif
+
 class Morton3d64BitTest : public ::testing::Test {
  protected:
   const uint32_t x_[4] = {0, 1, 2, 3};
@@ -235,6 +297,19 @@ TEST_F(Morton3d64BitTest, EncodingUsingMagicBits) {
   }
 }
 
+TEST_F(Morton3d64BitTest, EncodingUsingTunedTags) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 4; ++k) {
+        const coordinates32_t c{x_[k], y_[j], z_[i]};
+        const auto m = encode(c, tag::tuned{});
+        EXPECT_EQ(m.value, m_[(i * 4 + j) * 4 + k])
+            << "  coordinates: " << c << '\n';
+      }
+    }
+  }
+}
+
 #ifdef MORTON3D_USE_BMI
 TEST_F(Morton3d64BitTest, EncodingUsingBmi) {
   for (int i = 0; i < 4; ++i) {
@@ -250,6 +325,21 @@ TEST_F(Morton3d64BitTest, EncodingUsingBmi) {
 }
 #endif
 
+#ifdef MORTON3D_USE_SSSE3
+TEST_F(Morton3d64BitTest, EncodingUsingNibbleShuffle) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 4; ++k) {
+        const coordinates32_t c{x_[k], y_[j], z_[i]};
+        const auto m = encode(c, tag::nibble_shuffle{});
+        EXPECT_EQ(m.value, m_[(i * 4 + j) * 4 + k])
+            << "  coordinates: " << c << '\n';
+      }
+    }
+  }
+}
+#endif
+
 TEST_F(Morton3d64BitTest, DecodingUsingPreshiftedLookupTable) {
   for (int i = 0; i < 4; ++i) {
     for (int j = 0; j < 4; ++j) {
@@ -298,6 +388,22 @@ TEST_F(Morton3d64BitTest, DecodingUsingMagicBits) {
   }
 }
 
+TEST_F(Morton3d64BitTest, DecodingUsingTunedTags) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 4; ++k) {
+        const auto l = (i * 4 + j) * 4 + k;
+        const morton_code64_t m{m_[l]};
+        const coordinates32_t ct{x_[k], y_[j], z_[i]};
+        const auto c = decode(m, tag::tuned{});
+        EXPECT_EQ(ct, c) << "  morton code: " << m
+                         << "\n  correct coordinates: " << ct
+                         << "\n  decoded coordinates: " << c << '\n';
+      }
+    }
+  }
+}
+
 #ifdef MORTON3D_USE_BMI
 TEST_F(Morton3d64BitTest, DecodingUsingBmi) {
   for (int i = 0; i < 4; ++i) {
@@ -316,6 +422,24 @@ TEST_F(Morton3d64BitTest, DecodingUsingBmi) {
 }
 #endif
 
+#ifdef MORTON3D_USE_SSSE3
+TEST_F(Morton3d64BitTest, DecodingUsingNibbleShuffle) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 4; ++k) {
+        const auto l = (i * 4 + j) * 4 + k;
+        const morton_code64_t m{m_[l]};
+        const coordinates32_t ct{x_[k], y_[j], z_[i]};
+        const auto c = decode(m, tag::nibble_shuffle{});
+        EXPECT_EQ(ct, c) << "  morton code: " << m
+                         << "\n  correct coordinates: " << ct
+                         << "\n  decoded coordinates: " << c << '\n';
+      }
+    }
+  }
+}
+#endif
+
 TEST(Morton3dEdgeCaseTest, EdgeCase) {
   // 32 bits
   {
@@ -331,6 +455,10 @@ TEST(Morton3dEdgeCaseTest, EdgeCase) {
     EXPECT_EQ(encode(c, tag::bmi{}), m);
     EXPECT_EQ(decode(m, tag::bmi{}), c);
 #endif  // MORTON3D_USE_BMI
+#ifdef MORTON3D_USE_SSSE3
+    EXPECT_EQ(encode(c, tag::nibble_shuffle{}), m);
+    EXPECT_EQ(decode(m, tag::nibble_shuffle{}), c);
+#endif  // MORTON3D_USE_SSSE3
   }
 
 #if defined(_DEBUG) || !NDEBUG
@@ -356,5 +484,62 @@ TEST(Morton3dEdgeCaseTest, EdgeCase) {
     EXPECT_EQ(encode(c, tag::bmi{}), m);
     EXPECT_EQ(decode(m, tag::bmi{}), c);
 #endif  // MORTON3D_USE_BMI
+#ifdef MORTON3D_USE_SSSE3
+    EXPECT_EQ(encode(c, tag::nibble_shuffle{}), m);
+    EXPECT_EQ(decode(m, tag::nibble_shuffle{}), c);
+#endif  // MORTON3D_USE_SSSE3
+  }
+}
+
+/// @brief Checks that arrays converted with a tag match items converted one
+/// by one. The number of items is not a multiple of any vector width so that
+/// the remainder is converted too.
+template <typename Tag>
+void ExpectBatchMatchesSingleItems(Tag tag) {
+  constexpr std::size_t n = 37;
+  std::mt19937 engine(20200401);
+  std::uniform_int_distribution<uint16_t> dist16(0, (1U << 10) - 1);
+  std::uniform_int_distribution<uint32_t> dist32(0, (1U << 21) - 1);
+  std::vector<coordinates16_t> c16;
+  std::vector<coordinates32_t> c32;
+  for (std::size_t i = 0; i < n; ++i) {
+    c16.emplace_back(dist16(engine), dist16(engine), dist16(engine));
+    c32.emplace_back(dist32(engine), dist32(engine), dist32(engine));
   }
-}
\ No newline at end of file
+
+  std::vector<morton_code32_t> m32(n);
+  std::vector<morton_code64_t> m64(n);
+  encode(c16.data(), n, m32.data(), tag);
+  encode(c32.data(), n, m64.data(), tag);
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(m32[i], encode(c16[i], tag::magic_bits{})) << "  i = " << i;
+    EXPECT_EQ(m64[i], encode(c32[i], tag::magic_bits{})) << "  i = " << i;
+  }
+
+  std::vector<coordinates16_t> d16(n);
+  std::vector<coordinates32_t> d32(n);
+  decode(m32.data(), n, d16.data(), tag);
+  decode(m64.data(), n, d32.data(), tag);
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(d16[i], c16[i]) << "  i = " << i;
+    EXPECT_EQ(d32[i], c32[i]) << "  i = " << i;
+  }
+}
+
+TEST(Morton3dBatchTest, PreshiftedLookupTable) {
+  ExpectBatchMatchesSingleItems(tag::preshifted_lookup_table{});
+}
+
+TEST(Morton3dBatchTest, MagicBits) {
+  ExpectBatchMatchesSingleItems(tag::magic_bits{});
+}
+
+TEST(Morton3dBatchTest, TunedTags) {
+  ExpectBatchMatchesSingleItems(tag::tuned{});
+}
+
+#ifdef MORTON3D_USE_SSSE3
+TEST(Morton3dBatchTest, NibbleShuffle) {
+  ExpectBatchMatchesSingleItems(tag::nibble_shuffle{});
+}
+#endif
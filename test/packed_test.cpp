@@ -0,0 +1,150 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/packed.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// @brief Returns random codes of at most Bits bits.
+template <typename Code, unsigned int Bits>
+std::vector<Code> make_codes(std::size_t n, unsigned int seed) {
+  using T = typename Code::value_type;
+  std::mt19937_64 engine(seed);
+  std::vector<Code> codes(n);
+  for (auto&& c : codes) {
+    c = Code(static_cast<T>(engine() >> (64 - Bits)));
+  }
+  return codes;
+}
+
+template <typename Array>
+void check_array() {
+  using Code = typename Array::value_type;
+  const std::size_t n = 1001;
+  const auto codes = make_codes<Code, Array::bits>(n, Array::bits);
+  Array a(codes.data(), n);
+  ASSERT_EQ(a.size(), n);
+  EXPECT_LT(a.storage_bytes(), n * sizeof(Code));
+  for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(a[i], codes[i]);
+
+  // Ranges at every offset
+  for (std::size_t first = 0; first < 9; ++first) {
+    for (std::size_t count = 0; count < 20; ++count) {
+      std::vector<Code> out(count);
+      a.unpack(first, count, out.data());
+      EXPECT_TRUE(std::equal(out.begin(), out.end(), codes.begin() + first));
+    }
+  }
+
+  // Writes touch only the bytes of their slots.
+  const std::size_t bytes = Array::bits / 8;
+  Array b(codes.data(), n);
+  const auto more = make_codes<Code, Array::bits>(40, 2);
+  for (std::size_t first = 0; first < 9; ++first) {
+    for (std::size_t count = 0; count <= more.size(); ++count) {
+      const std::vector<uint8_t> before(b.data(),
+                                        b.data() + b.storage_bytes());
+      b.pack(more.data(), count, first);
+      if (count > 0) b.set(first + count - 1, more[count % more.size()]);
+      const std::size_t lo = first * bytes, hi = (first + count) * bytes;
+      EXPECT_TRUE(std::equal(before.begin(), before.begin() + lo, b.data()));
+      EXPECT_TRUE(std::equal(before.begin() + hi, before.end(), b.data() + hi))
+          << "  first = " << first << ", count = " << count;
+    }
+  }
+
+  // Packing a range keeps the others.
+  auto expected = codes;
+  const auto other = make_codes<Code, Array::bits>(17, 1);
+  a.pack(other.data(), other.size(), 101);
+  std::copy(other.begin(), other.end(), expected.begin() + 101);
+  a.set(0, other[0]);
+  expected[0] = other[0];
+  a.set(n - 1, other[1]);
+  expected[n - 1] = other[1];
+  std::vector<Code> out(n);
+  a.unpack(0, n, out.data());
+  EXPECT_EQ(out, expected);
+
+  // Removed codes are not seen again.
+  a.resize(10);
+  a.push_back(other[2]);
+  a.resize(13);
+  ASSERT_EQ(a.size(), 13u);
+  for (std::size_t i = 0; i < 10; ++i) EXPECT_EQ(a[i], expected[i]);
+  EXPECT_EQ(a[10], other[2]);
+  EXPECT_EQ(a[11], Code(0));
+  EXPECT_EQ(a[12], Code(0));
+}
+
+}  // namespace
+
+TEST(PackedArrayTest, Morton3d) {
+  check_array<morton3d::packed_array40_t>();
+  check_array<morton3d::packed_array48_t>();
+  check_array<morton3d::packed_array56_t>();
+  check_array<morton3d::packed_array<3, uint32_t>>();
+}
+
+TEST(PackedArrayTest, Morton2d) {
+  check_array<morton2d::packed_array40_t>();
+  check_array<morton2d::packed_array48_t>();
+  check_array<morton2d::packed_array56_t>();
+  check_array<morton2d::packed_array<2>>();
+}
+
+TEST(PackedArrayTest, ConcurrentWritesToDisjointRanges) {
+  using Code = morton3d::morton_code64_t;
+  const std::size_t num_threads = 4;
+  const std::size_t m = 1001;  // Ranges do not start at a multiple of 16
+  const auto codes = make_codes<Code, 48>(num_threads * m, 5);
+  morton3d::packed_array48_t a(codes.size());
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      const std::size_t first = t * m;
+      for (int r = 0; r < 50; ++r) {
+        if (r % 2 == 0) {
+          a.pack(codes.data() + first, m, first);
+        } else {
+          for (std::size_t i = first; i < first + m; ++i) a.set(i, codes[i]);
+        }
+      }
+    });
+  }
+  for (auto&& t : threads) t.join();
+  std::vector<Code> out(codes.size());
+  a.unpack(0, out.size(), out.data());
+  EXPECT_EQ(out, codes);
+}
+
+TEST(PackedArrayTest, EncodedCodes) {
+  using namespace morton3d;
+  std::mt19937 engine(0);
+  std::uniform_int_distribution<uint32_t> dist(0, 0xFFFF);
+  std::vector<morton_code64_t> codes(1000);
+  for (auto&& m : codes) {
+    m = encode(coordinates32_t{dist(engine), dist(engine), dist(engine)});
+  }
+  std::sort(codes.begin(), codes.end());
+  const packed_array48_t a(codes.data(), codes.size());
+  EXPECT_EQ(a.storage_bytes(), 6 * codes.size() + 16);
+  for (std::size_t i = 0; i < codes.size(); ++i) {
+    EXPECT_EQ(a.lower_bound(codes[i]),
+              static_cast<std::size_t>(
+                  std::lower_bound(codes.begin(), codes.end(), codes[i]) -
+                  codes.begin()));
+  }
+  EXPECT_EQ(a.lower_bound(morton_code64_t(0)), 0u);
+  EXPECT_EQ(a.lower_bound(morton_code64_t(uint64_t(1) << 48)), codes.size());
+  EXPECT_EQ(decode(a[10]), decode(codes[10]));
+}
@@ -0,0 +1,160 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/partition.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// @brief Returns all 32-bit morton codes of a square of side 2^bits.
+std::vector<morton2d::morton_code32_t> square(unsigned int bits) {
+  std::vector<morton2d::morton_code32_t> codes;
+  for (uint32_t m = 0; m < (1U << (2 * bits)); ++m) codes.emplace_back(m);
+  return codes;
+}
+
+/// @brief Checks that offsets are non-decreasing from 0 to n and every
+/// boundary is aligned to cells whose codes share bits above shift.
+template <typename Code>
+void ExpectAligned(const std::vector<std::size_t>& offsets,
+                   const std::vector<Code>& codes, unsigned int shift) {
+  ASSERT_FALSE(offsets.empty());
+  EXPECT_EQ(offsets.front(), 0u);
+  EXPECT_EQ(offsets.back(), codes.size());
+  for (std::size_t p = 1; p < offsets.size(); ++p) {
+    EXPECT_LE(offsets[p - 1], offsets[p]);
+    const auto b = offsets[p];
+    if (b == 0 || b == codes.size()) continue;
+    EXPECT_NE(codes[b - 1].value >> shift, codes[b].value >> shift)
+        << "  boundary " << p << " at " << b << " splits a cell";
+  }
+}
+
+}  // namespace
+
+TEST(ParallelInclusiveScanTest, MatchesPartialSum) {
+  for (std::size_t n : {0, 1, 1000, 100000, 1000003}) {
+    std::vector<uint64_t> in(n);
+    std::iota(in.begin(), in.end(), uint64_t(1));
+    std::vector<uint64_t> expected(n);
+    std::partial_sum(in.begin(), in.end(), expected.begin());
+    for (unsigned int threads : {1, 3, 8}) {
+      std::vector<uint64_t> out(n);
+      morton::detail::parallel_inclusive_scan(in.data(), n, out.data(),
+                                              threads);
+      EXPECT_EQ(out, expected) << "  n = " << n << ", threads = " << threads;
+    }
+    // In place
+    morton::detail::parallel_inclusive_scan(in.data(), n, in.data(), 4);
+    EXPECT_EQ(in, expected) << "  n = " << n;
+  }
+}
+
+TEST(Partition2dTest, EqualCountsAtLeaves) {
+  const auto codes = square(5);  // 1024 codes
+  const auto offsets =
+      morton2d::partition(codes.data(), codes.size(), 4,
+                          morton2d::morton_traits<uint32_t>::bits);
+  EXPECT_EQ(offsets, (std::vector<std::size_t>{0, 256, 512, 768, 1024}));
+}
+
+TEST(Partition2dTest, BoundariesMoveToNearerCellBoundaries) {
+  const auto codes = square(4);  // 256 codes
+  // Cells of 4 x 4 = 16 codes
+  const unsigned int level = morton2d::morton_traits<uint32_t>::bits - 2;
+  const auto offsets =
+      morton2d::partition(codes.data(), codes.size(), 3, level);
+  // Ideal boundaries 85.3 and 170.7 move to 80 and 176.
+  EXPECT_EQ(offsets, (std::vector<std::size_t>{0, 80, 176, 256}));
+  ExpectAligned(offsets, codes, 4);
+}
+
+TEST(Partition2dTest, Weighted) {
+  const auto codes = square(4);  // 256 codes
+  // The first half is three times as heavy as the second half.
+  std::vector<double> weights(codes.size(), 1.0);
+  std::fill(weights.begin(), weights.begin() + 128, 3.0);
+  const unsigned int leaves = morton2d::morton_traits<uint32_t>::bits;
+  auto offsets =
+      morton2d::partition(codes.data(), weights.data(), codes.size(), 2,
+                          leaves);
+  // Total is 512, so the boundary is after 256 / 3 items.
+  EXPECT_EQ(offsets, (std::vector<std::size_t>{0, 85, 256}));
+
+  // Aligned to quadrants of 64 codes
+  offsets = morton2d::partition(codes.data(), weights.data(), codes.size(), 2,
+                                leaves - 3, 2);
+  EXPECT_EQ(offsets, (std::vector<std::size_t>{0, 64, 256}));
+}
+
+TEST(Partition2dTest, NarrowIntegralWeights) {
+  const auto codes = square(4);  // 256 codes
+  // The total of 512 overflows uint8_t, so weights are summed in 64 bits.
+  std::vector<uint8_t> weights(codes.size(), 1);
+  std::fill(weights.begin(), weights.begin() + 128, 3);
+  const unsigned int leaves = morton2d::morton_traits<uint32_t>::bits;
+  for (unsigned int threads : {1u, 4u}) {
+    const auto offsets =
+        morton2d::partition(codes.data(), weights.data(), codes.size(), 2,
+                            leaves, threads);
+    EXPECT_EQ(offsets, (std::vector<std::size_t>{0, 85, 256}));
+  }
+}
+
+TEST(Partition2dTest, CellHeavierThanShareLeavesEmptyPartitions) {
+  const auto codes = square(3);  // 64 codes
+  // The root is the only cell.
+  const auto offsets = morton2d::partition(codes.data(), codes.size(), 4, 0);
+  ASSERT_EQ(offsets.size(), 5u);
+  for (std::size_t p = 1; p < 4; ++p) {
+    EXPECT_TRUE(offsets[p] == 0 || offsets[p] == codes.size());
+  }
+  ExpectAligned(offsets, codes, 32);
+}
+
+TEST(Partition2dTest, EmptyInput) {
+  const std::vector<morton2d::morton_code64_t> codes;
+  const std::vector<uint32_t> weights;
+  EXPECT_EQ(morton2d::partition(codes.data(), 0, 3, 5),
+            (std::vector<std::size_t>{0, 0, 0, 0}));
+  EXPECT_EQ(morton2d::partition(codes.data(), weights.data(), 0, 3, 5),
+            (std::vector<std::size_t>{0, 0, 0, 0}));
+}
+
+TEST(Partition3dTest, RandomPointsAreBalancedAndAligned) {
+  using namespace morton3d;
+  constexpr std::size_t n = 200000;
+  constexpr std::size_t k = 7;
+  std::mt19937 engine(20200401);
+  std::uniform_int_distribution<uint32_t> dist(0, (1U << 21) - 1);
+  std::vector<morton_code64_t> codes;
+  std::vector<uint32_t> weights;
+  for (std::size_t i = 0; i < n; ++i) {
+    codes.push_back(encode(coordinates32_t{dist(engine), dist(engine),
+                                           dist(engine)}));
+    weights.push_back(1 + dist(engine) % 10);
+  }
+  std::sort(codes.begin(), codes.end());
+
+  // Cells of 2^12 codes, each holding about 0.4 points
+  const unsigned int level = morton_traits<uint64_t>::bits - 4;
+  const auto offsets =
+      partition(codes.data(), weights.data(), n, k, level, 4);
+  ExpectAligned(offsets, codes, 12);
+
+  const double total =
+      std::accumulate(weights.begin(), weights.end(), 0.0);
+  for (std::size_t p = 0; p < k; ++p) {
+    const double w = std::accumulate(weights.begin() + offsets[p],
+                                     weights.begin() + offsets[p + 1], 0.0);
+    EXPECT_NEAR(w, total / k, total / k * 0.01) << "  partition " << p;
+  }
+}
@@ -0,0 +1,163 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/pipeline.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <random>
+#include <thread>
+#include <vector>
+
+TEST(SpscQueueTest, KeepsOrderAcrossThreads) {
+  morton::spsc_queue<int> q(5);
+  EXPECT_EQ(q.capacity(), 8u);
+  constexpr int n = 100000;
+  std::thread producer([&] {
+    for (int i = 0; i < n; ++i) {
+      int v = i;
+      while (!q.try_push(v)) std::this_thread::yield();
+    }
+  });
+  for (int i = 0; i < n; ++i) {
+    int v;
+    while (!q.try_pop(v)) std::this_thread::yield();
+    ASSERT_EQ(v, i);
+  }
+  producer.join();
+  int v;
+  EXPECT_FALSE(q.try_pop(v));
+}
+
+TEST(MpmcQueueTest, FullAndEmpty) {
+  morton::mpmc_queue<int> q(2);
+  int v = 1;
+  EXPECT_TRUE(q.try_push(v));
+  v = 2;
+  EXPECT_TRUE(q.try_push(v));
+  v = 3;
+  EXPECT_FALSE(q.try_push(v));
+  EXPECT_TRUE(q.try_pop(v));
+  EXPECT_EQ(v, 1);
+  EXPECT_TRUE(q.try_pop(v));
+  EXPECT_EQ(v, 2);
+  EXPECT_FALSE(q.try_pop(v));
+}
+
+TEST(MpmcQueueTest, EveryElementIsPoppedOnce) {
+  morton::mpmc_queue<int> q(64);
+  constexpr int num_threads = 4;
+  constexpr int n = 20000;
+  std::vector<std::vector<int>> popped(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < n; ++i) {
+        int v = t * n + i;
+        while (!q.try_push(v)) std::this_thread::yield();
+      }
+    });
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < n; ++i) {
+        int v;
+        while (!q.try_pop(v)) std::this_thread::yield();
+        popped[t].push_back(v);
+      }
+    });
+  }
+  for (auto&& t : threads) t.join();
+  std::vector<int> count(num_threads * n, 0);
+  for (auto&& p : popped) {
+    for (int v : p) ++count[v];
+  }
+  for (int c : count) ASSERT_EQ(c, 1);
+}
+
+TEST(EncodePipeline3dTest, EncodesAllBlocks) {
+  using block = morton3d::encode_block<uint32_t>;
+  // Small queues so that producers wait for the consumer.
+  morton3d::encode_pipeline<uint32_t> p(2, 3);
+  EXPECT_EQ(p.num_workers(), 3u);
+  constexpr int num_producers = 2;
+  constexpr int blocks_per_producer = 100;
+
+  std::vector<std::thread> producers;
+  for (int t = 0; t < num_producers; ++t) {
+    producers.emplace_back([&p, t] {
+      std::mt19937 engine(t);
+      std::uniform_int_distribution<uint32_t> dist(0, (1U << 21) - 1);
+      for (int i = 0; i < blocks_per_producer; ++i) {
+        block b;
+        b.id = static_cast<uint64_t>(t * blocks_per_producer + i);
+        b.coordinates.resize(b.id % 500);
+        for (auto&& c : b.coordinates) {
+          c = morton3d::coordinates32_t{dist(engine), dist(engine),
+                                        dist(engine)};
+        }
+        p.push(b);
+      }
+    });
+  }
+  std::thread closer([&] {
+    for (auto&& t : producers) t.join();
+    p.close();
+  });
+
+  std::vector<int> seen(num_producers * blocks_per_producer, 0);
+  block b;
+  while (p.pop(b)) {
+    ASSERT_LT(b.id, seen.size());
+    ++seen[b.id];
+    ASSERT_EQ(b.codes.size(), b.coordinates.size());
+    EXPECT_EQ(b.coordinates.size(), b.id % 500);
+    for (std::size_t i = 0; i < b.codes.size(); ++i) {
+      ASSERT_EQ(b.codes[i], morton3d::encode(b.coordinates[i]));
+    }
+  }
+  closer.join();
+  for (int s : seen) EXPECT_EQ(s, 1);
+}
+
+TEST(EncodePipeline2dTest, DestructorDiscardsUnpoppedBlocks) {
+  morton2d::encode_pipeline<uint16_t> p(4, 2);
+  for (int i = 0; i < 4; ++i) {
+    morton2d::encode_block<uint16_t> b;
+    b.coordinates.assign(10, morton2d::coordinates16_t{1, 2});
+    ASSERT_TRUE(p.try_push(b));
+  }
+  // Workers wait on the full output queue until the pipeline is destroyed.
+}
+
+TEST(EncodePipeline3dTest, IdlePipelineSleeps) {
+  morton3d::encode_pipeline<uint32_t> p(4, 4);
+  int popped = 0;
+  std::thread consumer([&p, &popped] {
+    morton3d::encode_block<uint32_t> b;
+    while (p.pop(b)) {
+      EXPECT_EQ(b.codes.size(), 3u);
+      ++popped;
+    }
+  });
+  // Let the workers and the consumer finish spinning.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // Five threads yielding in a loop would take about as much CPU time as
+  // five times the wall time.
+  const std::clock_t start = std::clock();
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  const double cpu_seconds =
+      static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+  EXPECT_LT(cpu_seconds, 0.05);
+
+  // The sleeping threads wake up for blocks and for closing.
+  morton3d::encode_block<uint32_t> b;
+  b.coordinates.assign(3, morton3d::coordinates32_t{1, 2, 3});
+  p.push(b);
+  p.close();
+  consumer.join();
+  EXPECT_EQ(popped, 1);
+}
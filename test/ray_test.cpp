@@ -0,0 +1,170 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/ray.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// @brief Returns true if a segment touches a unit voxel.
+bool touches(const double* from, const double* to, const uint32_t* voxel) {
+  const double eps = 1e-9;
+  double t0 = 0, t1 = 1;
+  for (int a = 0; a < 3; ++a) {
+    const double d = to[a] - from[a];
+    const double lo = voxel[a] - eps, hi = voxel[a] + 1 + eps;
+    if (d == 0) {
+      if (from[a] < lo || from[a] > hi) return false;
+      continue;
+    }
+    double ta = (lo - from[a]) / d, tb = (hi - from[a]) / d;
+    if (ta > tb) std::swap(ta, tb);
+    t0 = std::max(t0, ta);
+    t1 = std::min(t1, tb);
+  }
+  return t0 <= t1;
+}
+
+/// @brief Checks voxels of a segment which lies inside the grid.
+void check_segment(const double* from, const double* to,
+                   const std::vector<morton3d::morton_code64_t>& codes) {
+  ASSERT_FALSE(codes.empty());
+  std::size_t expected = 1;
+  for (int a = 0; a < 3; ++a) {
+    expected += static_cast<std::size_t>(
+        std::abs(std::floor(to[a]) - std::floor(from[a])));
+  }
+  EXPECT_EQ(codes.size(), expected);
+  const auto first = morton3d::decode(codes.front());
+  EXPECT_EQ(first.x, static_cast<uint32_t>(from[0]));
+  EXPECT_EQ(first.y, static_cast<uint32_t>(from[1]));
+  EXPECT_EQ(first.z, static_cast<uint32_t>(from[2]));
+  const auto last = morton3d::decode(codes.back());
+  EXPECT_EQ(last.x, static_cast<uint32_t>(to[0]));
+  EXPECT_EQ(last.y, static_cast<uint32_t>(to[1]));
+  EXPECT_EQ(last.z, static_cast<uint32_t>(to[2]));
+  for (std::size_t i = 0; i < codes.size(); ++i) {
+    const auto c = morton3d::decode(codes[i]);
+    const uint32_t v[] = {c.x, c.y, c.z};
+    EXPECT_TRUE(touches(from, to, v));
+    if (i == 0) continue;
+    // Consecutive voxels share a face.
+    const auto p = morton3d::decode(codes[i - 1]);
+    const int dist = std::abs(int(c.x) - int(p.x)) +
+                     std::abs(int(c.y) - int(p.y)) +
+                     std::abs(int(c.z) - int(p.z));
+    EXPECT_EQ(dist, 1);
+  }
+}
+
+}  // namespace
+
+TEST(Morton3dRayTest, RandomSegments) {
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<double> dist(0, 64);
+  const morton3d::coordinates32_t extent{64, 64, 64};
+  for (int i = 0; i < 1000; ++i) {
+    const double from[] = {dist(engine), dist(engine), dist(engine)};
+    const double to[] = {dist(engine), dist(engine), dist(engine)};
+    std::vector<morton3d::morton_code64_t> codes;
+    morton3d::traverse<uint64_t>(
+        from, to, extent,
+        [&](morton3d::morton_code64_t m) { codes.push_back(m); });
+    check_segment(from, to, codes);
+  }
+}
+
+TEST(Morton3dRayTest, AxisAligned) {
+  const morton3d::coordinates16_t extent{16, 16, 16};
+  const float from[] = {3.5f, 15.5f, 2.0f};
+  const float to[] = {3.5f, 0.5f, 2.0f};
+  morton3d::cell_traversal<uint32_t> c(from, to, extent);
+  EXPECT_EQ(c.size(), 16u);
+  for (uint16_t y = 16; y-- > 0; c.next()) {
+    ASSERT_FALSE(c.done());
+    EXPECT_EQ(c.code(), morton3d::encode(morton3d::coordinates16_t{3, y, 2}));
+  }
+  EXPECT_TRUE(c.done());
+}
+
+TEST(Morton3dRayTest, Clipping) {
+  const morton3d::coordinates32_t extent{8, 8, 8};
+  {
+    // Passes through the grid along the diagonal of the xy plane.
+    const double from[] = {-4.0, -3.5, 4.5}, to[] = {12.0, 12.5, 4.5};
+    morton3d::cell_traversal<uint64_t> c(from, to, extent);
+    EXPECT_EQ(morton3d::decode(c.code()),
+              (morton3d::coordinates32_t{0, 0, 4}));
+    morton3d::morton_code64_t last{};
+    std::size_t n = 0;
+    for (; !c.done(); c.next(), ++n) last = c.code();
+    EXPECT_EQ(n, 15u);
+    EXPECT_EQ(morton3d::decode(last), (morton3d::coordinates32_t{7, 7, 4}));
+  }
+  {
+    // Misses the grid.
+    const double from[] = {-4.0, 9.0, 4.5}, to[] = {12.0, 9.5, 4.5};
+    EXPECT_TRUE(morton3d::cell_traversal<uint64_t>(from, to, extent).done());
+  }
+  {
+    // Ends on the boundary of the grid.
+    const double from[] = {4.5, 4.5, 4.5}, to[] = {8.0, 4.5, 4.5};
+    EXPECT_EQ(morton3d::cell_traversal<uint64_t>(from, to, extent).size(), 4u);
+  }
+}
+
+TEST(Morton3dRayTest, Rasterize) {
+  std::mt19937 engine(1);
+  std::uniform_real_distribution<double> dist(0, 1000);
+  const std::size_t n = 2000;
+  std::vector<double> from(3 * n), to(3 * n);
+  for (auto&& p : from) p = dist(engine);
+  for (auto&& p : to) p = dist(engine);
+  const morton3d::coordinates32_t extent{1000, 1000, 1000};
+  std::vector<morton3d::morton_code64_t> codes;
+  std::vector<std::size_t> offsets;
+  morton3d::rasterize(from.data(), to.data(), n, extent, codes, offsets, 4);
+  ASSERT_EQ(offsets.size(), n + 1);
+  EXPECT_EQ(offsets[0], 0u);
+  EXPECT_EQ(offsets[n], codes.size());
+  for (std::size_t i = 0; i < n; ++i) {
+    std::vector<morton3d::morton_code64_t> expected;
+    morton3d::traverse<uint64_t>(
+        &from[3 * i], &to[3 * i], extent,
+        [&](morton3d::morton_code64_t m) { expected.push_back(m); });
+    ASSERT_EQ(offsets[i + 1] - offsets[i], expected.size());
+    EXPECT_TRUE(
+        std::equal(expected.begin(), expected.end(), &codes[offsets[i]]));
+  }
+}
+
+TEST(Morton2dRayTest, Line) {
+  const morton2d::coordinates16_t extent{100, 100};
+  const double from[] = {10.5, 20.5}, to[] = {90.5, 60.5};
+  std::vector<morton2d::morton_code32_t> codes;
+  morton2d::traverse<uint32_t>(
+      from, to, extent,
+      [&](morton2d::morton_code32_t m) { codes.push_back(m); });
+  ASSERT_EQ(codes.size(), 121u);
+  EXPECT_EQ(morton2d::decode(codes.front()),
+            (morton2d::coordinates16_t{10, 20}));
+  EXPECT_EQ(morton2d::decode(codes.back()),
+            (morton2d::coordinates16_t{90, 60}));
+  for (std::size_t i = 1; i < codes.size(); ++i) {
+    const auto c = morton2d::decode(codes[i]);
+    const auto p = morton2d::decode(codes[i - 1]);
+    EXPECT_EQ(std::abs(int(c.x) - int(p.x)) + std::abs(int(c.y) - int(p.y)),
+              1);
+    // Distance from the line
+    const double d = std::abs((c.x + 0.5 - 10.5) * 40 - (c.y + 0.5 - 20.5) * 80);
+    EXPECT_LE(d / std::sqrt(80.0 * 80 + 40 * 40), std::sqrt(0.5) + 1e-9);
+  }
+}
@@ -0,0 +1,97 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/stencil.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(Morton2dStencilTest, Neighbors) {
+  const std::size_t extents[][2] = {{1, 1}, {1, 5}, {4, 4}, {5, 7}, {16, 3}};
+  for (auto&& e : extents) {
+    morton2d::grid<int> g(e[0], e[1]);
+    const auto& l = g.layout();
+    std::size_t count = 0;
+    auto cells = g.begin();
+    for (auto it = morton2d::stencil(g).begin();
+         it != morton2d::stencil(g).end(); ++it, ++cells, ++count) {
+      // Cells are visited in the same order as grid iterators.
+      ASSERT_EQ(it.index(), cells.index());
+      const auto c = l.coordinates_of(it.index());
+      const std::size_t coords[2] = {c.x, c.y};
+      for (unsigned int a = 0; a < 2; ++a) {
+        EXPECT_EQ(it.has_neighbor(a, -1), coords[a] > 0);
+        EXPECT_EQ(it.has_neighbor(a, 1), coords[a] + 1 < e[a]);
+      }
+      for (int j = -1; j <= 1; ++j) {
+        for (int i = -1; i <= 1; ++i) {
+          const auto x = static_cast<std::size_t>(c.x + i);
+          const auto y = static_cast<std::size_t>(c.y + j);
+          if (x >= e[0] || y >= e[1]) continue;
+          EXPECT_EQ(it.neighbor_index(i, j), l.index(x, y));
+          EXPECT_EQ(&it(i, j), &g(x, y));
+        }
+      }
+    }
+    EXPECT_EQ(count, g.size());
+  }
+}
+
+TEST(Morton3dStencilTest, Neighbors) {
+  const std::size_t extents[][3] = {
+      {1, 1, 1}, {4, 4, 4}, {5, 7, 3}, {16, 3, 2}, {2, 9, 17}, {33, 2, 65}};
+  for (auto&& e : extents) {
+    const morton3d::grid<int> g(e[0], e[1], e[2]);
+    const auto& l = g.layout();
+    std::size_t count = 0;
+    const auto s = morton3d::stencil(g);
+    for (auto it = s.begin(); it != s.end(); ++it, ++count) {
+      const auto c = l.coordinates_of(it.index());
+      const std::size_t coords[3] = {c.x, c.y, c.z};
+      bool boundary = false;
+      for (unsigned int a = 0; a < 3; ++a) {
+        EXPECT_EQ(it.has_neighbor(a, -1), coords[a] > 0);
+        EXPECT_EQ(it.has_neighbor(a, 1), coords[a] + 1 < e[a]);
+        boundary = boundary || coords[a] == 0 || coords[a] + 1 == e[a];
+      }
+      EXPECT_EQ(it.on_boundary(), boundary);
+      for (int k = -1; k <= 1; ++k) {
+        for (int j = -1; j <= 1; ++j) {
+          for (int i = -1; i <= 1; ++i) {
+            const auto x = static_cast<std::size_t>(c.x + i);
+            const auto y = static_cast<std::size_t>(c.y + j);
+            const auto z = static_cast<std::size_t>(c.z + k);
+            if (x >= e[0] || y >= e[1] || z >= e[2]) continue;
+            EXPECT_EQ(it.neighbor_index(i, j, k), l.index(x, y, z));
+          }
+        }
+      }
+    }
+    EXPECT_EQ(count, g.size());
+  }
+}
+
+TEST(Morton3dStencilTest, Laplacian) {
+  // The 7-point Laplacian of x^2 + y^2 + z^2 is 6 everywhere inside.
+  morton3d::grid<double> g(9, 6, 5);
+  for (std::size_t z = 0; z < 5; ++z) {
+    for (std::size_t y = 0; y < 6; ++y) {
+      for (std::size_t x = 0; x < 9; ++x) {
+        g(x, y, z) = static_cast<double>(x * x + y * y + z * z);
+      }
+    }
+  }
+  std::size_t inside = 0;
+  const auto s = morton3d::stencil(g);
+  for (auto it = s.begin(); it != s.end(); ++it) {
+    if (it.on_boundary()) continue;
+    const double laplacian = it(-1, 0, 0) + it(1, 0, 0) + it(0, -1, 0) +
+                             it(0, 1, 0) + it(0, 0, -1) + it(0, 0, 1) -
+                             6 * *it;
+    EXPECT_DOUBLE_EQ(laplacian, 6.0);
+    ++inside;
+  }
+  EXPECT_EQ(inside, 7u * 4u * 3u);
+}
@@ -0,0 +1,100 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+#include "morton/transcode.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+TEST(Morton2dTranscodeTest, WidenAndNarrow) {
+  using namespace morton2d;
+  std::mt19937 engine(0);
+  std::uniform_int_distribution<uint32_t> dist;
+  for (int i = 0; i < 10000; ++i) {
+    const auto x = static_cast<uint16_t>(dist(engine));
+    const auto y = static_cast<uint16_t>(dist(engine));
+    const auto m = encode(coordinates16_t(x, y));
+    EXPECT_EQ(widen(m), encode(coordinates32_t(x, y)));
+    EXPECT_EQ(widen(m, 16), encode(coordinates32_t(uint32_t(x) << 16,
+                                                   uint32_t(y) << 16)));
+
+    const coordinates32_t c(dist(engine), dist(engine));
+    const auto m64 = encode(c);
+    EXPECT_EQ(narrow(m64, 16), encode(coordinates16_t(c.x >> 16, c.y >> 16)));
+    EXPECT_EQ(narrow(m64, 5), encode(coordinates16_t(
+                                  static_cast<uint16_t>(c.x >> 5),
+                                  static_cast<uint16_t>(c.y >> 5))));
+    EXPECT_EQ(narrow(widen(m, 3), 3), m);
+  }
+}
+
+TEST(Morton3dTranscodeTest, WidenAndNarrow) {
+  using namespace morton3d;
+  std::mt19937 engine(1);
+  std::uniform_int_distribution<uint32_t> dist(0, (1u << 21) - 1);
+  std::vector<morton_code32_t> m32;
+  std::vector<morton_code64_t> m64;
+  for (int i = 0; i < 10000; ++i) {
+    const coordinates32_t c(dist(engine), dist(engine), dist(engine));
+    m64.push_back(encode(c));
+    m32.push_back(encode(coordinates16_t(c.x >> 11, c.y >> 11, c.z >> 11)));
+    EXPECT_EQ(narrow(m64.back(), 11), m32.back());
+    EXPECT_EQ(narrow(m64.back()),
+              encode(coordinates16_t(c.x & 1023, c.y & 1023, c.z & 1023)));
+    EXPECT_EQ(widen(m32.back(), 11),
+              encode(coordinates32_t(c.x >> 11 << 11, c.y >> 11 << 11,
+                                     c.z >> 11 << 11)));
+  }
+  std::vector<morton_code64_t> wide(m32.size());
+  widen(m32.data(), m32.size(), wide.data(), 11);
+  std::vector<morton_code32_t> narrowed(m64.size());
+  narrow(wide.data(), wide.size(), narrowed.data(), 11);
+  EXPECT_EQ(narrowed, m32);
+  narrow(m64.data(), m64.size(), narrowed.data(), 11);
+  EXPECT_EQ(narrowed, m32);
+}
+
+namespace {
+
+template <typename Coordinates, typename Tag>
+void check_projection(unsigned int bits, unsigned int seed) {
+  using U = typename Coordinates::value_type;
+  std::mt19937 engine(seed);
+  std::uniform_int_distribution<U> dist(0, static_cast<U>((1u << bits) - 1));
+  using Code = decltype(morton3d::encode(Coordinates{}));
+  std::vector<Code> codes;
+  for (int i = 0; i < 10000; ++i) {
+    const Coordinates c(dist(engine), dist(engine), dist(engine));
+    const auto m = morton3d::encode(c);
+    codes.push_back(m);
+    EXPECT_EQ(morton3d::project(m, 0, Tag{}),
+              morton2d::encode(morton2d::coordinates<U>(c.y, c.z)));
+    EXPECT_EQ(morton3d::project(m, 1, Tag{}),
+              morton2d::encode(morton2d::coordinates<U>(c.x, c.z)));
+    EXPECT_EQ(morton3d::project(m, 2, Tag{}),
+              morton2d::encode(morton2d::coordinates<U>(c.x, c.y)));
+  }
+  using Code2 = decltype(morton3d::project(codes[0], 0));
+  std::vector<Code2> projected(codes.size());
+  morton3d::project(codes.data(), codes.size(), 1, projected.data(), Tag{});
+  for (std::size_t i = 0; i < codes.size(); ++i) {
+    EXPECT_EQ(projected[i], morton3d::project(codes[i], 1, Tag{}));
+  }
+}
+
+}  // namespace
+
+TEST(Morton3dTranscodeTest, Project) {
+  namespace tag = morton3d::tag;
+  check_projection<morton3d::coordinates16_t, tag::magic_bits>(10, 2);
+  check_projection<morton3d::coordinates32_t, tag::magic_bits>(21, 3);
+  check_projection<morton3d::coordinates16_t, tag::tuned>(10, 4);
+  check_projection<morton3d::coordinates32_t, tag::tuned>(21, 5);
+#ifdef MORTON3D_USE_BMI
+  check_projection<morton3d::coordinates16_t, tag::bmi>(10, 6);
+  check_projection<morton3d::coordinates32_t, tag::bmi>(21, 7);
+#endif
+}
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+# This software is released under the MIT license.
+#
+# Copyright (c) 2020 Sho Hirose
+
+"""Compares results of Google benchmark with a baseline.
+
+Usage: compare_benchmarks.py [options] baseline.json current.json
+
+Both files are written by a benchmark executable with
+--benchmark_out=<file> --benchmark_out_format=json (see benchmark_json target).
+Throughput (items_per_second) is compared if reported, otherwise real time.
+If repetitions are run, medians are compared.
+
+A benchmark regresses if it is slower than the baseline by more than the
+tolerance. Results are summarized per tag (e.g. tag::bmi) by the geometric
+mean of ratios. The program exits with 1 if any benchmark regresses, so that
+it can be used as a step of a qualification pipeline.
+
+Host and build configuration (CPU model, instruction sets, compiler, tuned
+tags) recorded in the context of both files are compared, because results of
+different hosts are not comparable.
+"""
+
+import argparse
+import json
+import math
+import re
+import sys
+
+TIME_UNITS = {'ns': 1e-9, 'us': 1e-6, 'ms': 1e-3, 's': 1.0}
+TAG_PATTERN = re.compile(r'tag::(\w+)')
+
+
+def load(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def speeds(results, pattern):
+    """Returns a dict from benchmark names to speed (larger is faster)."""
+    benchmarks = results.get('benchmarks', [])
+    has_median = any(b.get('aggregate_name') == 'median' for b in benchmarks)
+    speed = {}
+    for b in benchmarks:
+        if b.get('error_occurred'):
+            continue
+        if has_median:
+            if b.get('aggregate_name') != 'median':
+                continue
+            name = b.get('run_name', b['name'])
+        else:
+            if b.get('run_type') == 'aggregate':
+                continue
+            name = b.get('run_name', b['name'])
+            if name in speed:  # Repetitions without aggregates
+                continue
+        if pattern and not pattern.search(name):
+            continue
+        if 'items_per_second' in b:
+            speed[name] = b['items_per_second']
+        else:
+            seconds = b['real_time'] * TIME_UNITS[b.get('time_unit', 'ns')]
+            speed[name] = 1.0 / seconds if seconds > 0 else math.inf
+    return speed
+
+
+def tag_of(name):
+    m = TAG_PATTERN.search(name)
+    return m.group(1) if m else '(none)'
+
+
+def compare_context(baseline, current):
+    """Returns a list of differences of the host configuration."""
+    a = baseline.get('context', {})
+    b = current.get('context', {})
+    # The frequency (mhz_per_cpu) is read at run time and varies between runs
+    # on hosts scaling it, so it does not identify hosts.
+    keys = sorted(k for k in set(a) | set(b)
+                  if k.startswith('morton_') or k == 'num_cpus')
+    return ['%s: %r != %r' % (k, a.get(k), b.get(k))
+            for k in keys if a.get(k) != b.get(k)]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Compares benchmark results with a baseline.')
+    parser.add_argument('baseline', help='JSON output of the baseline run')
+    parser.add_argument('current', help='JSON output of the current run')
+    parser.add_argument('--tolerance', type=float, default=0.05,
+                        help='allowed slowdown ratio (default: 0.05)')
+    parser.add_argument('--filter', default=None,
+                        help='regular expression of benchmarks to compare')
+    parser.add_argument('--strict-host', action='store_true',
+                        help='fail if host configurations differ')
+    parser.add_argument('--verbose', action='store_true',
+                        help='print every benchmark')
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    status = 0
+
+    differences = compare_context(baseline, current)
+    for d in differences:
+        print('%s: host differs: %s' %
+              ('error' if args.strict_host else 'warning', d))
+    if differences and args.strict_host:
+        status = 1
+
+    pattern = re.compile(args.filter) if args.filter else None
+    old = speeds(baseline, pattern)
+    new = speeds(current, pattern)
+
+    for name in sorted(set(old) - set(new)):
+        print('warning: missing in current: %s' % name)
+    for name in sorted(set(new) - set(old)):
+        print('warning: missing in baseline: %s' % name)
+
+    names = sorted(set(old) & set(new))
+    if not names:
+        print('error: no benchmarks to compare')
+        return 1
+
+    by_tag = {}
+    regressions = []
+    for name in names:
+        ratio = new[name] / old[name]
+        by_tag.setdefault(tag_of(name), []).append(ratio)
+        regressed = ratio < 1.0 - args.tolerance
+        if regressed:
+            regressions.append(name)
+        if args.verbose or regressed:
+            print('%-10s %+7.1f%%  %s' % ('REGRESSED' if regressed else 'ok',
+                                         (ratio - 1.0) * 100.0, name))
+
+    print()
+    print('%-24s %6s %10s' % ('tag', 'count', 'speedup'))
+    for tag in sorted(by_tag):
+        ratios = by_tag[tag]
+        mean = math.exp(sum(math.log(r) for r in ratios) / len(ratios))
+        print('%-24s %6d %+9.1f%%' % (tag, len(ratios), (mean - 1.0) * 100.0))
+
+    print()
+    print('%d of %d benchmarks regressed by more than %.1f%%' %
+          (len(regressions), len(names), args.tolerance * 100.0))
+    if regressions:
+        status = 1
+    return status
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,359 @@
+// This software is released under the MIT license.
+//
+// Copyright (c) 2020 Sho Hirose
+
+// Auto-tuner which times every implementation of encoding and decoding for
+// each dimension and code width on this machine and prints
+// morton/tuned_tags.hpp selecting the fastest ones to the standard output.
+//
+// Usage: morton_autotune [--workload=throughput|latency]
+//
+// - throughput: items are independent of each other (e.g. bulk conversion).
+// - latency   : each item depends on the previous result (e.g. traversal).
+//
+// Conversions of arrays are timed separately through the array overloads,
+// whose implementations may differ from those of single items (e.g. SIMD
+// kernels of tag::nibble_shuffle). They are always timed for throughput.
+//
+// This program is run by CMake at configure time when MORTON_AUTOTUNE option
+// is ON.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "morton/morton2d.hpp"
+#include "morton/morton3d.hpp"
+
+namespace {
+
+/// Number of items converted in a trial
+constexpr std::size_t num_items = 4096;
+/// Number of trials. The fastest trial is taken.
+constexpr int num_trials = 200;
+
+/// Sink to prevent the compiler from removing conversions
+volatile uint64_t sink;
+
+enum class workload { throughput, latency };
+
+/// @brief Result of a candidate
+struct candidate {
+  const char* name;
+  double seconds;
+};
+
+template <typename F>
+double fastest_trial(F f) {
+  double best = 1e300;
+  for (int i = 0; i < num_trials; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto stop = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(stop - start).count());
+  }
+  return best;
+}
+
+/// @brief Returns the maximum value of Bits bits.
+template <typename U, int Bits>
+U max_value() {
+  return static_cast<U>(std::numeric_limits<U>::max() >>
+                        (std::numeric_limits<U>::digits - Bits));
+}
+
+/// @brief Generates random coordinates whose components have at most Bits
+/// bits.
+template <typename Coordinates, int Bits>
+std::vector<Coordinates> make_coordinates() {
+  using U = typename Coordinates::value_type;
+  std::mt19937 engine(20200401);
+  std::uniform_int_distribution<U> dist(0, max_value<U, Bits>());
+  std::vector<Coordinates> coords(num_items);
+  for (auto&& c : coords) {
+    c.x = dist(engine);
+    c.y = dist(engine);
+  }
+  return coords;
+}
+
+/// @brief Fills z components for 3D coordinates.
+template <typename Coordinates, int Bits>
+std::vector<Coordinates> make_coordinates3() {
+  using U = typename Coordinates::value_type;
+  auto coords = make_coordinates<Coordinates, Bits>();
+  std::mt19937 engine(19700101);
+  std::uniform_int_distribution<U> dist(0, max_value<U, Bits>());
+  for (auto&& c : coords) c.z = dist(engine);
+  return coords;
+}
+
+/// @brief Times encoding of coordinates with a tag.
+template <typename Tag, typename Coordinates, typename Encode>
+double time_encode(const std::vector<Coordinates>& coords, workload w,
+                   Encode encode) {
+  using U = typename Coordinates::value_type;
+  if (w == workload::throughput) {
+    return fastest_trial([&] {
+      uint64_t acc = 0;
+      for (auto&& c : coords) acc ^= encode(c, Tag{}).value;
+      sink = acc;
+    });
+  }
+  return fastest_trial([&] {
+    uint64_t prev = 0;
+    for (auto c : coords) {
+      // Make the input depend on the previous output.
+      c.x = static_cast<U>(c.x ^ (prev & 1));
+      prev = encode(c, Tag{}).value;
+    }
+    sink = prev;
+  });
+}
+
+/// @brief Times decoding of morton codes with a tag.
+template <typename Tag, typename Code, typename Decode>
+double time_decode(const std::vector<Code>& codes, workload w, Decode decode) {
+  using T = typename Code::value_type;
+  if (w == workload::throughput) {
+    return fastest_trial([&] {
+      uint64_t acc = 0;
+      for (auto&& m : codes) acc ^= decode(m, Tag{}).x;
+      sink = acc;
+    });
+  }
+  return fastest_trial([&] {
+    uint64_t prev = 0;
+    for (auto m : codes) {
+      // Make the input depend on the previous output.
+      m.value = static_cast<T>(m.value ^ (prev & 1));
+      prev = decode(m, Tag{}).x;
+    }
+    sink = prev;
+  });
+}
+
+/// @brief Times encoding of an array of coordinates with a tag.
+template <typename Tag, typename Coordinates, typename Code, typename Encode>
+double time_batch_encode(const std::vector<Coordinates>& coords,
+                         std::vector<Code>& codes, Encode encode) {
+  return fastest_trial([&] {
+    encode(coords.data(), coords.size(), codes.data(), Tag{});
+    sink = codes[codes.size() / 2].value;
+  });
+}
+
+/// @brief Times decoding of an array of morton codes with a tag.
+template <typename Tag, typename Code, typename Coordinates, typename Decode>
+double time_batch_decode(const std::vector<Code>& codes,
+                         std::vector<Coordinates>& coords, Decode decode) {
+  return fastest_trial([&] {
+    decode(codes.data(), codes.size(), coords.data(), Tag{});
+    sink = coords[coords.size() / 2].x;
+  });
+}
+
+/// @brief Results of tuning a dimension and a code width
+struct selection {
+  const char* encode;
+  const char* decode;
+  const char* batch_encode;
+  const char* batch_decode;
+};
+
+/// @brief Candidates of every operation
+struct candidates {
+  std::vector<candidate> encode, decode, batch_encode, batch_decode;
+};
+
+/// @brief Returns the name of the fastest candidate.
+const char* fastest(const std::vector<candidate>& candidates) {
+  return std::min_element(candidates.begin(), candidates.end(),
+                          [](const candidate& a, const candidate& b) {
+                            return a.seconds < b.seconds;
+                          })
+      ->name;
+}
+
+/// @brief Conversions in two dimensions through the public API
+struct api2d {
+  template <typename C, typename Tag>
+  auto encode(const C& c, Tag t) const -> decltype(morton2d::encode(c, t)) {
+    return morton2d::encode(c, t);
+  }
+  template <typename M, typename Tag>
+  auto decode(M m, Tag t) const -> decltype(morton2d::decode(m, t)) {
+    return morton2d::decode(m, t);
+  }
+  template <typename C, typename M, typename Tag>
+  void encode(const C* c, std::size_t n, M* m, Tag t) const {
+    morton2d::encode(c, n, m, t);
+  }
+  template <typename M, typename C, typename Tag>
+  void decode(const M* m, std::size_t n, C* c, Tag t) const {
+    morton2d::decode(m, n, c, t);
+  }
+};
+
+/// @brief Conversions in three dimensions through the public API
+struct api3d {
+  template <typename C, typename Tag>
+  auto encode(const C& c, Tag t) const -> decltype(morton3d::encode(c, t)) {
+    return morton3d::encode(c, t);
+  }
+  template <typename M, typename Tag>
+  auto decode(M m, Tag t) const -> decltype(morton3d::decode(m, t)) {
+    return morton3d::decode(m, t);
+  }
+  template <typename C, typename M, typename Tag>
+  void encode(const C* c, std::size_t n, M* m, Tag t) const {
+    morton3d::encode(c, n, m, t);
+  }
+  template <typename M, typename C, typename Tag>
+  void decode(const M* m, std::size_t n, C* c, Tag t) const {
+    morton3d::decode(m, n, c, t);
+  }
+};
+
+/// @brief Times every operation of a tag and adds it to the candidates.
+template <typename Tag, typename Api, typename Coordinates, typename Code>
+void add_candidate(const char* name, const std::vector<Coordinates>& coords,
+                   const std::vector<Code>& codes, workload w,
+                   candidates& result) {
+  const Api api;
+  std::vector<Code> code_buffer(codes.size());
+  std::vector<Coordinates> coord_buffer(coords.size());
+  result.encode.push_back(
+      {name, time_encode<Tag>(coords, w, [&](const Coordinates& c, Tag t) {
+         return api.encode(c, t);
+       })});
+  result.decode.push_back(
+      {name, time_decode<Tag>(codes, w, [&](const Code& m, Tag t) {
+         return api.decode(m, t);
+       })});
+  result.batch_encode.push_back(
+      {name, time_batch_encode<Tag>(
+                 coords, code_buffer,
+                 [&](const Coordinates* c, std::size_t n, Code* m, Tag t) {
+                   api.encode(c, n, m, t);
+                 })});
+  result.batch_decode.push_back(
+      {name, time_batch_decode<Tag>(
+                 codes, coord_buffer,
+                 [&](const Code* m, std::size_t n, Coordinates* c, Tag t) {
+                   api.decode(m, n, c, t);
+                 })});
+}
+
+/// @brief Returns the fastest candidates of every operation.
+selection select(const candidates& c) {
+  return {fastest(c.encode), fastest(c.decode), fastest(c.batch_encode),
+          fastest(c.batch_decode)};
+}
+
+/// @brief Selects tags in two dimensions.
+/// @tparam Coordinates Coordinates type
+/// @tparam Bits Number of bits of each coordinate
+template <typename Coordinates, int Bits>
+selection tune2d(workload w) {
+  namespace tag = morton2d::tag;
+  const auto coords = make_coordinates<Coordinates, Bits>();
+  using Code = decltype(morton2d::encode(coords[0]));
+  std::vector<Code> codes;
+  for (auto&& c : coords) codes.push_back(morton2d::encode(c));
+
+  candidates c;
+  add_candidate<tag::preshifted_lookup_table, api2d>(
+      "preshifted_lookup_table", coords, codes, w, c);
+  add_candidate<tag::lookup_table, api2d>("lookup_table", coords, codes, w,
+                                          c);
+  add_candidate<tag::magic_bits, api2d>("magic_bits", coords, codes, w, c);
+#ifdef MORTON2D_USE_BMI
+  add_candidate<tag::bmi, api2d>("bmi", coords, codes, w, c);
+#endif
+#ifdef MORTON2D_USE_SSSE3
+  add_candidate<tag::nibble_shuffle, api2d>("nibble_shuffle", coords, codes,
+                                            w, c);
+#endif
+  return select(c);
+}
+
+/// @brief Selects tags in three dimensions.
+/// @tparam Coordinates Coordinates type
+/// @tparam Bits Number of bits of each coordinate
+template <typename Coordinates, int Bits>
+selection tune3d(workload w) {
+  namespace tag = morton3d::tag;
+  const auto coords = make_coordinates3<Coordinates, Bits>();
+  using Code = decltype(morton3d::encode(coords[0]));
+  std::vector<Code> codes;
+  for (auto&& c : coords) codes.push_back(morton3d::encode(c));
+
+  candidates c;
+  add_candidate<tag::preshifted_lookup_table, api3d>(
+      "preshifted_lookup_table", coords, codes, w, c);
+  add_candidate<tag::lookup_table, api3d>("lookup_table", coords, codes, w,
+                                          c);
+  add_candidate<tag::magic_bits, api3d>("magic_bits", coords, codes, w, c);
+#ifdef MORTON3D_USE_BMI
+  add_candidate<tag::bmi, api3d>("bmi", coords, codes, w, c);
+#endif
+#ifdef MORTON3D_USE_SSSE3
+  add_candidate<tag::nibble_shuffle, api3d>("nibble_shuffle", coords, codes,
+                                            w, c);
+#endif
+  return select(c);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  workload w = workload::throughput;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--workload=throughput") == 0) {
+      w = workload::throughput;
+    } else if (std::strcmp(argv[i], "--workload=latency") == 0) {
+      w = workload::latency;
+    } else {
+      std::fprintf(stderr, "usage: %s [--workload=throughput|latency]\n",
+                   argv[0]);
+      return 1;
+    }
+  }
+
+  const selection tags[2][2] = {  // [dimension][width]
+      {tune2d<morton2d::coordinates16_t, 16>(w),
+       tune2d<morton2d::coordinates32_t, 32>(w)},
+      {tune3d<morton3d::coordinates16_t, 10>(w),
+       tune3d<morton3d::coordinates32_t, 21>(w)}};
+
+  std::printf(
+      "// Generated by morton_autotune. Do not edit.\n"
+      "// Workload: %s\n"
+      "#ifndef MORTON_TUNED_TAGS_HPP\n"
+      "#define MORTON_TUNED_TAGS_HPP\n\n",
+      w == workload::throughput ? "throughput" : "latency");
+  const char* dims[2] = {"2D", "3D"};
+  const char* widths[2] = {"32", "64"};
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      const selection& s = tags[i][j];
+      std::printf("#define MORTON%s_TUNED_ENCODE%s_TAG %s\n", dims[i],
+                  widths[j], s.encode);
+      std::printf("#define MORTON%s_TUNED_DECODE%s_TAG %s\n", dims[i],
+                  widths[j], s.decode);
+      std::printf("#define MORTON%s_TUNED_BATCH_ENCODE%s_TAG %s\n", dims[i],
+                  widths[j], s.batch_encode);
+      std::printf("#define MORTON%s_TUNED_BATCH_DECODE%s_TAG %s\n", dims[i],
+                  widths[j], s.batch_decode);
+    }
+  }
+  std::printf("\n#endif  // MORTON_TUNED_TAGS_HPP\n");
+  return 0;
+}